@@ -4,6 +4,7 @@
 
 /* Application lifecycle helpers */
 void app_bootstrap(void);
-void app_shutdown(void);
+/* Returns 0 if any data file write was lost (see core/csv.h). */
+int app_shutdown(void);
 
 #endif /* APP_H */
@@ -3,9 +3,71 @@
 #define CORE_CSV_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+/* Tail iterator over the last N lines of a file.
+ * Lines are yielded oldest-first as (pointer, length) slices into one
+ * internal buffer; the trailing '\n' is not included.
+ */
+typedef struct CsvTail {
+    char *buf;   /* tail region of the file (owned) */
+    size_t len;  /* bytes in buf */
+    size_t pos;  /* forward cursor */
+    size_t rpos; /* backward cursor */
+} CsvTail;
 
 int csv_ensure_dir(const char *path);
 int csv_append_row(const char *path, const char *fmt, ...);
 int csv_read_last_lines(const char *path, int max_lines, char **out_buf, size_t *out_len);
 
+/* Appends go through a small LRU cache of open handles and are flushed in
+ * groups; flush a path before reading it directly, close it before
+ * rewriting or removing it.
+ * Write failures (open, write, flush, fsync, rename) are recorded per path
+ * and stay until a whole-file replace or remove of that path succeeds.
+ * csv_flush_path returns 0 while its path has such a lost write, and
+ * csv_flush_all / csv_shutdown return 0 while any path has one; callers
+ * that need data on disk check these after queuing their write.
+ */
+void csv_set_flush_policy(long interval_ms, size_t max_pending_bytes);
+int csv_flush_all(void);
+int csv_flush_path(const char *path);
+void csv_close_path(const char *path);
+
+/* Whole-file writes. With the background writer running these are queued
+ * behind earlier appends to the same path; rewrites go through a temp file
+ * and rename so a crash never leaves a half-written file.
+ */
+int csv_append_raw(const char *path, const char *data, size_t len);
+int csv_write_file(const char *path, const char *data, size_t len);
+int csv_remove_file(const char *path);
+/* Positioned overwrite (pwrite) for fixed-width record files; the file is
+ * created if missing. Ordered with the other queued writes to the path.
+ */
+int csv_write_at(const char *path, long long offset, const char *data, size_t len);
+
+/* Move all writes onto the background writer thread; csv_shutdown drains
+ * the queue, stops the thread and closes cached handles.
+ */
+int csv_async_start(void);
+/* While the writer runs, every write is a queue submission, so reads and
+ * writes may be issued from several threads at once.
+ */
+int csv_async_running(void);
+int csv_shutdown(void);
+
+/* Delimiter scanner. csv_scan_block fills one bit per byte for up to 64
+ * bytes (SSE2/AVX2 picked at runtime, scalar elsewhere); the helpers
+ * below walk whole buffers a block at a time. csv_scan_find stops at the
+ * first delim or '\n', so pass '\n' as delim to split lines.
+ */
+void csv_scan_block(const char *p, size_t len, char delim, uint64_t *delim_bits, uint64_t *nl_bits);
+const char *csv_scan_find(const char *p, size_t len, char delim);
+size_t csv_scan_count_newlines(const char *p, size_t len);
+
+int csv_tail_open(CsvTail *it, const char *path, int max_lines);
+int csv_tail_next(CsvTail *it, const char **line, size_t *len);
+int csv_tail_prev(CsvTail *it, const char **line, size_t *len);
+void csv_tail_close(CsvTail *it);
+
 #endif // CORE_CSV_H
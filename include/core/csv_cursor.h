@@ -0,0 +1,65 @@
+
+#ifndef CORE_CSV_CURSOR_H
+#define CORE_CSV_CURSOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A field is a slice into the cursor's memory: not NUL-terminated and only
+ * valid until csv_cursor_close.
+ */
+typedef struct CsvField {
+    const char *ptr;
+    size_t len;
+} CsvField;
+
+/* Zero-copy reader over a memory-mapped file (or any caller-owned buffer).
+ * Rows are yielded one at a time with the line ending stripped; blank lines
+ * are skipped. Fields keep CSV semantics: "a,,b" is three fields and a
+ * trailing delimiter yields a final empty field.
+ * Files written by this program are replaced via rename, never truncated in
+ * place, so an open mapping stays valid while the writer thread runs.
+ */
+typedef struct CsvCursor {
+    const char *data; /* whole input */
+    size_t len;
+    size_t pos;       /* start of the next row */
+    CsvField row;     /* current row */
+    size_t fpos;      /* next field offset within row (row.len + 1 when done) */
+    char delim;       /* may be changed between rows */
+    void *map;        /* mapping to release, NULL for memory cursors */
+    size_t map_len;
+    /* bitmaps of the current 64-byte block (see csv_scan_block) */
+    size_t blk_off;
+    uint64_t blk_delim;
+    uint64_t blk_nl;
+    char blk_sep;     /* delimiter the bitmaps were built for */
+    int blk_valid;
+} CsvCursor;
+
+/* Read-only mapping of a whole file. An empty file succeeds with *out_map NULL. */
+int csv_map_file(const char *path, void **out_map, size_t *out_len);
+void csv_unmap_file(void *map, size_t len);
+
+int csv_cursor_open(CsvCursor *c, const char *path, char delim);
+void csv_cursor_init(CsvCursor *c, const char *data, size_t len, char delim);
+void csv_cursor_close(CsvCursor *c);
+
+int csv_cursor_next_row(CsvCursor *c);
+int csv_cursor_next_field(CsvCursor *c, CsvField *out);
+/* Everything after the last field returned, delimiters included. */
+int csv_cursor_rest(CsvCursor *c, CsvField *out);
+int csv_cursor_fields(CsvCursor *c, CsvField *out, int max);
+
+CsvField csv_field_trim(CsvField f);
+int csv_field_eq(CsvField f, const char *s);
+/* Typed accessors parse a leading number after optional blanks, like atoi,
+ * and return 0 when the field has no digits (out is left untouched).
+ */
+int csv_field_int(CsvField f, int *out);
+int csv_field_long(CsvField f, long *out);
+int csv_field_double(CsvField f, double *out);
+/* Copies into dst with truncation; always NUL-terminates when cap > 0. */
+size_t csv_field_copy(CsvField f, char *dst, size_t cap);
+
+#endif // CORE_CSV_CURSOR_H
@@ -0,0 +1,46 @@
+#ifndef CORE_CSV_INDEX_H
+#define CORE_CSV_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Sidecar line-offset index for an append-only CSV file.
+ * <path>.idx holds a header followed by one entry for every stride-th line:
+ * the byte offset where the line starts and the number it begins with
+ * (the timestamp column of transaction logs). Opening the index catches it
+ * up with whatever was appended since the last open, so maintenance costs
+ * only the new bytes. Any line is reached by one seek plus at most
+ * stride - 1 skipped lines; a key lookup is a binary search over entries.
+ * Keys are assumed non-decreasing, as timestamps of an append-only log are.
+ */
+#define CSV_INDEX_STRIDE 64
+
+typedef struct CsvIndexEntry {
+    int64_t offset;
+    int64_t key;
+} CsvIndexEntry;
+
+typedef struct CsvIndex {
+    char path[512];
+    uint32_t stride;
+    uint64_t lines;         /* complete lines in the data file */
+    int64_t covered;        /* bytes of the data file indexed so far */
+    CsvIndexEntry *entries; /* entries[i] describes line i * stride */
+    size_t count;
+    size_t cap;
+} CsvIndex;
+
+/* Called per line (without the line ending); return 0 to stop. */
+typedef int (*CsvIndexLineFn)(const char *line, size_t len, uint64_t lineno, void *ctx);
+
+/* Loads <path>.idx (rebuilding it if missing or stale) and syncs it. */
+int csv_index_open(CsvIndex *ix, const char *path);
+/* Indexes lines appended since the last sync and persists the new entries. */
+int csv_index_sync(CsvIndex *ix);
+void csv_index_close(CsvIndex *ix);
+/* Visits lines [first, first + count), clipped to the indexed lines. */
+int csv_index_read(const CsvIndex *ix, uint64_t first, uint64_t count, CsvIndexLineFn fn, void *ctx);
+/* First line whose key is >= key; ix->lines if there is none. */
+uint64_t csv_index_find_key(const CsvIndex *ix, int64_t key);
+
+#endif /* CORE_CSV_INDEX_H */
@@ -0,0 +1,27 @@
+
+#ifndef CORE_IO_WRITER_H
+#define CORE_IO_WRITER_H
+
+#include <stddef.h>
+
+/* Background persistence pipeline.
+ * Producers push write records into a bounded lock-free queue; one writer
+ * thread applies them in submission order. apply runs on the writer thread;
+ * flush(force) runs after each batch and on idle wakeups and may defer
+ * (group flush) unless force is set. It returns 1 once everything applied
+ * so far is on disk, which is when waiters are released.
+ */
+typedef void (*IoApplyFn)(const char *path, const char *data, size_t len, long long offset);
+typedef int (*IoFlushFn)(int force);
+
+int io_writer_start(IoFlushFn flush);
+int io_writer_running(void);
+/* Copies path and data; blocks (backpressure) while the queue is full. */
+int io_writer_submit(IoApplyFn apply, const char *path, const char *data, size_t len, long long offset);
+/* Wait until every record submitted so far for path has been applied and flushed. */
+void io_writer_wait_path(const char *path);
+/* Drain barrier: wait until every record submitted so far has been applied and flushed. */
+void io_writer_drain(void);
+void io_writer_stop(void);
+
+#endif /* CORE_IO_WRITER_H */
@@ -0,0 +1,84 @@
+#ifndef CORE_ORDER_BOOK_H
+#define CORE_ORDER_BOOK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Limit order books with price-time priority, one per instrument.
+ * A book keeps its price levels in one array indexed by price - lo; each
+ * level is an intrusive FIFO of orders linked by index through a shared
+ * order pool, so matching walks contiguous memory and never allocates per
+ * order. Prices and quantities are positive ints. The level array grows on
+ * demand; an order that would stretch a book past OB_MAX_LEVELS ticks is
+ * rejected.
+ *
+ * Every call queues its execution reports and hands them to the report
+ * callback once the books are consistent again, so the callback may call
+ * back into ob_*. Not thread-safe: callers serialize (the world lock).
+ */
+#define OB_MAX_LEVELS 65536
+
+typedef enum ObSide { OB_BUY = 0, OB_SELL = 1 } ObSide;
+
+typedef enum ObExecType {
+    OB_EXEC_NEW,      /* accepted; leaves = quantity before matching */
+    OB_EXEC_FILL,     /* qty traded at price against counter */
+    OB_EXEC_CANCELED, /* qty taken off the book (cancel, self-trade, no room) */
+    OB_EXEC_REPLACED, /* counter replaced by order; leaves = new open qty */
+    OB_EXEC_REJECTED  /* order never entered the book; qty as submitted */
+} ObExecType;
+
+typedef struct ObReport {
+    ObExecType type;
+    uint64_t order;
+    uint64_t counter;
+    int book;
+    uint32_t owner;
+    uint32_t counter_owner;
+    ObSide side;
+    int price;  /* execution price for FILL, otherwise the limit */
+    int limit;  /* the order's limit price */
+    int qty;
+    int leaves; /* quantity still open after this event */
+} ObReport;
+
+typedef void (*ObReportFn)(const ObReport *r, void *ctx);
+
+typedef struct ObOrderInfo {
+    uint64_t id;
+    int book;
+    uint32_t owner;
+    ObSide side;
+    int price;
+    int leaves;
+} ObOrderInfo;
+
+/* Sets up `books` empty books, dropping any previous state. */
+int ob_init(int books, ObReportFn fn, void *ctx);
+void ob_free(void);
+
+/* Returns the order id (never 0), or 0 when rejected. The order matches
+ * against the opposite side first; whatever is left rests on the book.
+ */
+uint64_t ob_submit(int book, uint32_t owner, ObSide side, int price, int qty);
+int ob_cancel(uint64_t order);
+/* Lowering the quantity at the same price keeps time priority and the id;
+ * anything else re-enters the book under a new id. Returns the live id, or
+ * 0 when the order is unknown or the new terms are invalid (the old order
+ * is then left untouched).
+ */
+uint64_t ob_replace(uint64_t order, int price, int qty);
+
+int ob_order(uint64_t order, ObOrderInfo *out);
+/* Best bid and ask (0 for an empty side); returns 0 for an unknown book. */
+int ob_best(int book, int *bid, int *ask);
+/* Up to max levels from the top of one side: price and total open quantity. */
+int ob_depth(int book, ObSide side, int *prices, long *qtys, int max);
+/* Open orders of owner across all books, or of everyone when owner is
+ * OB_ANY_OWNER, in book and price order and, within a level, time priority.
+ * Writes up to max entries and returns how many there are in total.
+ */
+#define OB_ANY_OWNER UINT32_MAX
+int ob_orders(uint32_t owner, ObOrderInfo *out, int max);
+
+#endif /* CORE_ORDER_BOOK_H */
@@ -0,0 +1,38 @@
+#ifndef CORE_RANK_TREE_H
+#define CORE_RANK_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Order-statistics tree over members identified by small dense ids.
+ * Members are ordered by score, highest first, ties broken by lower id.
+ * It is a treap whose nodes carry subtree sizes, stored in arrays indexed by
+ * id, so setting a score, a member's rank and the member at a rank are all
+ * O(log n) expected. Not thread-safe.
+ */
+typedef struct RankTree {
+    uint32_t *left;   /* child ids, RANK_TREE_NIL when absent */
+    uint32_t *right;
+    uint32_t *size;   /* subtree size, 0 for ids not in the tree */
+    uint32_t *prio;
+    long long *score;
+    uint32_t cap;
+    uint32_t root;
+    uint32_t count;
+    uint64_t rng;
+} RankTree;
+
+#define RANK_TREE_NIL UINT32_MAX
+
+void rank_tree_init(RankTree *t);
+void rank_tree_free(RankTree *t);
+/* Inserts id or moves it to its new score. Returns 0 on allocation failure. */
+int rank_tree_set(RankTree *t, uint32_t id, long long score);
+void rank_tree_remove(RankTree *t, uint32_t id);
+int rank_tree_contains(const RankTree *t, uint32_t id);
+/* 0-based rank of id (0 is the highest score), or -1 if absent. */
+long rank_tree_rank(const RankTree *t, uint32_t id);
+/* Member at 0-based rank k; returns 0 when k is out of range. */
+int rank_tree_at(const RankTree *t, uint32_t k, uint32_t *out_id, long long *out_score);
+
+#endif /* CORE_RANK_TREE_H */
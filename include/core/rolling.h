@@ -0,0 +1,97 @@
+#ifndef CORE_ROLLING_H
+#define CORE_ROLLING_H
+
+/* Sliding-window kernels for price series. Each one is fed a value per step
+ * and answers in O(1) (amortized O(1) for the extrema and the sum refresh),
+ * so a whole series of n points costs O(n) whatever the window. State lives
+ * in fixed arrays, so a kernel can be copied to look one step ahead without
+ * disturbing it.
+ *
+ * Precision of RollingSum: sum and sumsq are doubles. With integer inputs
+ * they are exact while every partial total stays below 2^53, i.e. while
+ * period * max|x|^2 < 2^53 for sumsq (max|x| < 2^23 at period 128, about
+ * 2.1e7 at period 20; game prices are far below that). Past that each add
+ * or subtract rounds with relative error 2^-53, and both totals are
+ * recomputed from the window every `period` pushes so the rounding cannot
+ * build up along the series: a total carries at most 3 * period roundings,
+ * |error| <= 3 * period * 2^-53 * S, where S is the largest window total of
+ * |x| (for sum) or x^2 (for sumsq) since the last refresh.
+ */
+#define ROLLING_MAX_PERIOD 128
+
+/* Last `period` values with their sum and sum of squares (SMA, Bollinger). */
+typedef struct RollingSum {
+    double buf[ROLLING_MAX_PERIOD];
+    int period;
+    int n;     /* values in the window, up to period */
+    int head;  /* next slot to overwrite */
+    int since; /* pushes since sum/sumsq were last recomputed from buf */
+    double sum;
+    double sumsq;
+} RollingSum;
+
+/* Exponential moving average, seeded with the SMA of the first period values. */
+typedef struct RollingEma {
+    double alpha;
+    double value;
+    double seed_sum;
+    int period;
+    int n;
+} RollingEma;
+
+/* Min or max of the last `period` values: a monotonic deque of candidates. */
+typedef struct RollingExtrema {
+    long idx[ROLLING_MAX_PERIOD];
+    double val[ROLLING_MAX_PERIOD];
+    int head;
+    int count;
+    int period;
+    int want_max;
+    long next; /* index of the next value */
+} RollingExtrema;
+
+/* Relative strength index with Wilder smoothing. */
+typedef struct RollingRsi {
+    double avg_gain;
+    double avg_loss;
+    double prev;
+    int period;
+    int n; /* values seen */
+} RollingRsi;
+
+/* Volume-weighted price over the last `period` steps. */
+typedef struct RollingVwap {
+    RollingSum notional;
+    RollingSum volume;
+} RollingVwap;
+
+/* Periods are clamped to 1..ROLLING_MAX_PERIOD. */
+void rolling_sum_init(RollingSum *r, int period);
+void rolling_sum_push(RollingSum *r, double x);
+int rolling_sum_full(const RollingSum *r);
+double rolling_mean(const RollingSum *r);
+/* Population standard deviation of the window. */
+double rolling_stddev(const RollingSum *r);
+
+void rolling_ema_init(RollingEma *e, int period);
+void rolling_ema_push(RollingEma *e, double x);
+int rolling_ema_ready(const RollingEma *e);
+
+void rolling_extrema_init(RollingExtrema *m, int period, int want_max);
+void rolling_extrema_push(RollingExtrema *m, double x);
+/* Extreme of the values pushed so far within the window; 0 when empty. */
+double rolling_extrema_value(const RollingExtrema *m);
+
+void rolling_rsi_init(RollingRsi *r, int period);
+void rolling_rsi_push(RollingRsi *r, double x);
+int rolling_rsi_ready(const RollingRsi *r);
+/* 0..100; 50 for a flat window. */
+double rolling_rsi_value(const RollingRsi *r);
+
+void rolling_vwap_init(RollingVwap *v, int period);
+/* One step: total traded quantity and notional (sum of price x qty). */
+void rolling_vwap_push(RollingVwap *v, double qty, double notional);
+/* Returns 0 when nothing traded within the window. */
+int rolling_vwap_value(const RollingVwap *v, double *out);
+
+#endif /* CORE_ROLLING_H */
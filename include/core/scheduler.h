@@ -0,0 +1,40 @@
+#ifndef CORE_SCHEDULER_H
+#define CORE_SCHEDULER_H
+
+#include <stddef.h>
+
+/* In-process scheduler for periodic jobs, kept on a hierarchical timer wheel.
+ * Time is whole epoch seconds. Four levels of 64 slots cover 64 s, ~68 min,
+ * ~73 h and ~194 days; a job further out waits in the top level and cascades
+ * down as the wheel turns. Adding, cancelling and firing a job are O(1).
+ *
+ * Due jobs run on one background thread with the world lock held. State the
+ * jobs touch (accounts, stock prices, the QOTD of the day) may only be used
+ * with that lock held: the UI thread holds it except while it waits for a
+ * key. If the thread is not running, sched_run_due runs jobs on the caller.
+ */
+#define SCHED_MAX_JOBS 32
+#define SCHED_LEVELS 4
+#define SCHED_SLOT_BITS 6
+
+typedef void (*SchedFn)(long now, void *ctx);
+
+/* Runs fn at first_due and then every period seconds (0 = once). name is
+ * kept by pointer. Returns a job id, or -1 when the table is full.
+ */
+int sched_add(const char *name, long first_due, long period, SchedFn fn, void *ctx);
+int sched_cancel(int job);
+/* Fires every job due at or before now on the calling thread, which must
+ * hold the world lock. Returns the number of jobs run.
+ */
+int sched_run_due(long now);
+
+int sched_start(void);
+void sched_stop(void);
+int sched_running(void);
+
+/* The world lock. Not recursive. */
+void sched_lock(void);
+void sched_unlock(void);
+
+#endif /* CORE_SCHEDULER_H */
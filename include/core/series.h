@@ -0,0 +1,43 @@
+#ifndef CORE_SERIES_H
+#define CORE_SERIES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Append-only integer time series, stored column-wise in blocks.
+ * Every SERIES_BLOCK values are sealed into a block: the first value is kept
+ * as is and the rest as zig-zag varint deltas, so a slowly moving price costs
+ * about one byte per tick. The newest, not yet sealed values stay in a small
+ * uncompressed hot tail. Reads decode only the blocks they touch.
+ */
+#define SERIES_BLOCK 128
+
+typedef struct SeriesBlock {
+    int first;       /* value at the start of the block */
+    uint32_t offset; /* start of its deltas in bytes */
+} SeriesBlock;
+
+typedef struct Series {
+    uint8_t *bytes; /* deltas of all sealed blocks */
+    size_t nbytes;
+    size_t bytes_cap;
+    SeriesBlock *blocks;
+    long nblocks;
+    long blocks_cap;
+    int tail[SERIES_BLOCK]; /* hot tail: values after the last sealed block */
+    int tail_len;
+    long len;
+    int last;
+} Series;
+
+void series_init(Series *s);
+void series_free(Series *s);
+int series_push(Series *s, int value);
+/* Value at index i (0 <= i < len); O(SERIES_BLOCK) at worst. */
+int series_get(const Series *s, long i);
+/* Copies up to n values starting at from into out and returns how many. */
+long series_read(const Series *s, long from, int *out, long n);
+/* Heap bytes in use, tail included. */
+size_t series_footprint(const Series *s);
+
+#endif /* CORE_SERIES_H */
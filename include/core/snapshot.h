@@ -0,0 +1,82 @@
+#ifndef CORE_SNAPSHOT_H
+#define CORE_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Versioned binary snapshot file.
+ * Layout: header, section table, then the section payloads. Every section
+ * is tagged with a four-character code and carries its own checksum, so a
+ * reader can skip sections it does not know and reject damaged ones.
+ * Values are stored in host byte order; a snapshot is a cache of the CSV
+ * state, not an interchange format.
+ */
+#define SNAP_TAG(a, b, c, d) \
+    ((uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+#define SNAP_MAX_SECTIONS 16
+
+typedef struct SnapSection {
+    uint32_t tag;
+    uint32_t checksum;
+    uint64_t offset; /* from the start of the file */
+    uint64_t length;
+} SnapSection;
+
+typedef struct SnapWriter {
+    char *buf;      /* payload of all sections so far */
+    size_t len;
+    size_t cap;
+    SnapSection sections[SNAP_MAX_SECTIONS];
+    uint32_t count;
+    int open;       /* a section is being written */
+    int failed;
+} SnapWriter;
+
+typedef struct SnapReader {
+    void *map;
+    size_t len;
+    int64_t created; /* epoch seconds the snapshot was taken */
+    uint32_t count;
+    const SnapSection *table;
+} SnapReader;
+
+/* Sequential reader over one section. Reads past the end or of damaged
+ * data set bad and return zeros, so callers check bad once at the end.
+ */
+typedef struct SnapCursor {
+    const unsigned char *p;
+    size_t len;
+    size_t pos;
+    int bad;
+} SnapCursor;
+
+void snap_writer_init(SnapWriter *w);
+int snap_writer_begin(SnapWriter *w, uint32_t tag);
+void snap_put(SnapWriter *w, const void *data, size_t len);
+void snap_put_u32(SnapWriter *w, uint32_t v);
+void snap_put_i32(SnapWriter *w, int32_t v);
+void snap_put_i64(SnapWriter *w, int64_t v);
+void snap_put_str(SnapWriter *w, const char *s);
+void snap_writer_end(SnapWriter *w);
+/* Writes the file atomically (temp + rename) through the csv writer. */
+int snap_writer_commit(SnapWriter *w, const char *path, int64_t created);
+void snap_writer_free(SnapWriter *w);
+
+int snap_open(SnapReader *r, const char *path);
+int snap_section(const SnapReader *r, uint32_t tag, SnapCursor *out);
+void snap_close(SnapReader *r);
+
+uint32_t snap_get_u32(SnapCursor *c);
+int32_t snap_get_i32(SnapCursor *c);
+int64_t snap_get_i64(SnapCursor *c);
+/* Copies a string into dst (truncating); always NUL-terminates when cap > 0. */
+void snap_get_str(SnapCursor *c, char *dst, size_t cap);
+
+/* Source-file fingerprints: a snapshot records the size of each file it
+ * was built from. A file is unchanged if it still has that size (-1 for a
+ * missing file) and was last modified strictly before the snapshot second.
+ */
+int64_t snap_file_size(const char *path);
+int snap_file_unchanged(const char *path, int64_t recorded_size, int64_t created);
+
+#endif /* CORE_SNAPSHOT_H */
@@ -0,0 +1,22 @@
+#ifndef CORE_WORKER_POOL_H
+#define CORE_WORKER_POOL_H
+
+#include <stddef.h>
+
+/* Small fixed pool of worker threads for parallel loops.
+ * Workers are started on first use and sleep between jobs. One job runs at a
+ * time; the calling thread takes indices too and returns once every index has
+ * been processed. fn must be safe to call concurrently for different indices.
+ * If the pool cannot start, the loop runs on the calling thread.
+ */
+#define WORKER_POOL_MAX 8
+
+typedef void (*WorkerFn)(size_t index, void *ctx);
+
+/* Calls fn(i, ctx) for every i in [0, count). */
+void worker_pool_for(size_t count, WorkerFn fn, void *ctx);
+/* Number of threads a job runs on, the caller included. */
+int worker_pool_size(void);
+void worker_pool_stop(void);
+
+#endif /* CORE_WORKER_POOL_H */
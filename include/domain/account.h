@@ -3,9 +3,19 @@
 #define DOMAIN_ACCOUNT_H
 
 #include "../types.h"
+#include "ledger.h"
+#include "../core/csv_index.h"
 
 int account_get_by_user(const char *username, Bank *out);
 int account_adjust(Bank *acc, int amount);
+/* Records a change already applied to user->bank: ledger first, then the
+ * data/txs/<username>.csv view row. Every money movement goes through here.
+ */
+int account_post(User *user, LedgerType type, int amount, const char *reason);
+/* account_post for many changes at once: a single ledger append, then the
+ * view rows. Entries carry the user name and post-change state.
+ */
+size_t account_post_batch(LedgerEntry *entries, size_t count);
 /* Adjust user's account and persist transaction to data/txs/<username>.csv.
  * reason is a short string describing why the change happened (no commas/newlines).
  */
@@ -14,6 +24,10 @@ int account_add_tx(User *user, int amount, const char *reason);
 int account_add_tx_by_username(const char *username, int amount, const char *reason);
 /* Get recent transactions for user into buf (newline separated). Returns bytes written or -1 on error. */
 int account_recent_tx(const char *username, int limit, char *buf, size_t buflen);
+/* Formats one data/txs row as "[date] reason +amount Cr (bal n)"; returns snprintf's result. */
+int account_format_tx(const char *line, size_t len, char *out, size_t cap);
+/* Opens the line index over the user's whole transaction log for paging. */
+int account_tx_open(const char *username, CsvIndex *ix);
 
 /* Move funds between bank (deposit) and cash on-hand. */
 int account_withdraw_to_cash(User *user, int amount, const char *reason); /* deposit -> cash */
@@ -23,5 +37,7 @@ int account_take_loan(User *user, int amount, const char *reason);
 int account_repay_loan(User *user, int amount, const char *reason);
 /* Grant cash directly to user's on-hand cash (does not change deposit balance). */
 int account_grant_cash(User *user, int amount, const char *reason);
+/* Spend on-hand cash; fails without change if cash is short. */
+int account_spend_cash(User *user, int amount, const char *reason);
 
 #endif /* DOMAIN_ACCOUNT_H */
@@ -16,4 +16,22 @@ int econ_repay(Bank *acc, int amount);
  */
 int econ_apply_hourly_interest(User *user, int hours);
 
+/* Seconds between scheduled runs of econ_accrue_all (core/scheduler.h). */
+#define ECON_ACCRUAL_PERIOD 60
+
+typedef struct EconAccrualStats {
+    size_t accounts;           /* accounts that had at least one whole hour due */
+    size_t postings;           /* ledger records written */
+    long long deposit_interest;
+    long long loan_interest;
+} EconAccrualStats;
+
+/* Accrues interest on every account in one pass. Whole hours since each
+ * account's last_interest_ts are compounded from a Q32 factor table and the
+ * timestamp advances by exactly those hours, so partial hours carry over.
+ * All postings go to the ledger in one append and accounts.dat is written
+ * once. out may be NULL.
+ */
+int econ_accrue_all(long now, EconAccrualStats *out);
+
 #endif /* DOMAIN_ECONOMY_H */
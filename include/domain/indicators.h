@@ -0,0 +1,47 @@
+#ifndef DOMAIN_INDICATORS_H
+#define DOMAIN_INDICATORS_H
+
+/* Technical indicators over a symbol's visible price history, for the graph
+ * view. Series are computed with the O(1)-per-step kernels of core/rolling.h
+ * and cached per symbol, keyed by history length (which grows by one per
+ * board version): a longer request pushes only the new steps through the
+ * saved kernel state, and a redraw or scroll just indexes the cached arrays.
+ * Only the last point's VWAP is recomputed per call, since trades keep
+ * landing on the newest step. Points whose window is not full yet, and VWAP
+ * points without trades in their window, are NAN.
+ * Callers hold the world lock.
+ */
+#define INDICATOR_SMA_PERIOD   20
+#define INDICATOR_EMA_PERIOD   10
+#define INDICATOR_BAND_PERIOD  20
+#define INDICATOR_BAND_WIDTH   2.0 /* Bollinger bands at mean +- 2 sigma */
+#define INDICATOR_RANGE_PERIOD 20  /* rolling low / high */
+#define INDICATOR_RSI_PERIOD   14
+#define INDICATOR_VWAP_PERIOD  20
+/* Symbols kept at once; the least recently used one is dropped. */
+#define INDICATOR_CACHE_SLOTS  4
+
+typedef enum IndicatorKind {
+    IND_SMA,
+    IND_EMA,
+    IND_BAND_UPPER,
+    IND_BAND_LOWER,
+    IND_LOW,
+    IND_HIGH,
+    IND_RSI,
+    IND_VWAP,
+    IND_COUNT
+} IndicatorKind;
+
+typedef struct IndicatorSeries {
+    long len;                      /* points covered, at least the requested len */
+    const float *value[IND_COUNT]; /* value[kind][i] for price index i */
+} IndicatorSeries;
+
+/* Series for the first len visible prices of symbol (len is usually the
+ * quote's visible_len). Valid until the next call; NULL on failure.
+ */
+const IndicatorSeries *indicators_get(const char *symbol, long len);
+void indicators_reset(void);
+
+#endif /* DOMAIN_INDICATORS_H */
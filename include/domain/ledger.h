@@ -0,0 +1,76 @@
+#ifndef DOMAIN_LEDGER_H
+#define DOMAIN_LEDGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Write-ahead ledger of every money movement.
+ * One sequential stream of segment files under data/ledger/ (NNNNNN.csv).
+ * Each line is a typed record carrying the account state after the change:
+ *   seq,ts,type,user,amount,balance,cash,loan,reason,checksum
+ * where checksum is FNV-1a (hex) over the bytes before its comma. Every
+ * LEDGER_CHECKPOINT_EVERY records the balances of all users are written
+ * to data/ledger/checkpoint.csv, so recovery replays only the records after
+ * the last checkpoint. data/txs/<user>.csv are views derived from the same
+ * postings and are never read back for balances.
+ */
+#define LEDGER_DIR "data/ledger"
+#define LEDGER_CHECKPOINT_PATH "data/ledger/checkpoint.csv"
+#define LEDGER_SEGMENT_BYTES (1L << 20)
+#define LEDGER_CHECKPOINT_EVERY 256
+
+typedef enum LedgerType {
+    LEDGER_ADJUST,        /* deposit balance +/- (grants, stock trades) */
+    LEDGER_WITHDRAW,      /* deposit -> cash */
+    LEDGER_DEPOSIT,       /* cash -> deposit */
+    LEDGER_LOAN,          /* loan + cash */
+    LEDGER_REPAY,         /* loan - cash */
+    LEDGER_GRANT,         /* cash + (rewards, refunds, sales) */
+    LEDGER_SPEND,         /* cash - (shop, seats) */
+    LEDGER_INTEREST,      /* deposit interest */
+    LEDGER_LOAN_INTEREST, /* loan interest */
+    LEDGER_CHECKPOINT,    /* marker: checkpoint written up to seq - 1 */
+    LEDGER_TYPE_COUNT
+} LedgerType;
+
+typedef struct LedgerEntry {
+    uint64_t seq;    /* assigned by ledger_append */
+    long ts;
+    LedgerType type;
+    char user[50];
+    int amount;      /* signed change as shown in the transaction view */
+    int balance;     /* account state after the change */
+    int cash;
+    int loan;
+    char reason[64];
+} LedgerEntry;
+
+typedef struct LedgerBalance {
+    const char *user;
+    int balance;
+    int cash;
+    int loan;
+} LedgerBalance;
+
+/* Called for every checkpoint row and every replayed record, in order. */
+typedef void (*LedgerApplyFn)(const char *user, int balance, int cash, int loan, void *ctx);
+/* Return 0 to stop the scan. */
+typedef int (*LedgerScanFn)(const LedgerEntry *e, void *ctx);
+
+const char *ledger_type_name(LedgerType type);
+/* Queues one record on the writer thread; sets e->seq. Returns 0 on failure. */
+int ledger_append(LedgerEntry *e);
+/* Same records and seqs as ledger_append in a loop, but one queued write per
+ * segment. Returns the number of records written.
+ */
+size_t ledger_append_batch(LedgerEntry *entries, size_t count);
+int ledger_checkpoint_due(void);
+int ledger_checkpoint(const LedgerBalance *rows, size_t count);
+/* Applies the last checkpoint and replays the records after it. Runs once;
+ * returns the number of records replayed.
+ */
+long ledger_recover(LedgerApplyFn apply, void *ctx);
+/* Visits valid records with seq > after_seq in order. */
+int ledger_scan(uint64_t after_seq, LedgerScanFn fn, void *ctx);
+
+#endif /* DOMAIN_LEDGER_H */
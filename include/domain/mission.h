@@ -4,11 +4,31 @@
 
 #include "../types.h"
 
+/* *out_n is the capacity of out_arr on entry and the number copied on return. */
 int mission_list_open(Mission *out_arr, int *out_n);
 int mission_create(const Mission *m);
 int mission_complete(const char *username, int mission_id);
+/* Rebuilds the user's completion bitset from data/missions/<user>.csv. Read-only. */
 int mission_load_user(const char *username, User *user);
-/* Force re-read of data/missions.csv into the in-memory catalog */
+/* One-time cleanup of legacy per-user mission files (drops ASSIGN rows);
+ * leaves a marker so later calls return 0 without scanning.
+ */
+int mission_migrate_legacy(void);
+/* Every user is assigned the whole catalog; completion is a per-user bitset
+ * indexed by catalog slot (see user_mission_done). Slots stay put while
+ * data/missions.csv only grows; when it is truncated or replaced the catalog
+ * is rebuilt from the file and every loaded bitset is remapped by mission id.
+ */
+int mission_catalog_count(void);
+/* Slot of the mission with this id, -1 if it is not in the catalog. */
+int mission_catalog_slot(int mission_id);
+/* Copies catalog slot `slot` into *out with completed set for this user. */
+int mission_user_at(const User *user, int slot, Mission *out);
+/* Rebuild the user's completion bitset from the given completed ids (no file access). */
+int mission_apply_completed(User *user, const int *completed_ids, int completed_count);
+/* Pick up changes to data/missions.csv: only appended CREATE rows are parsed
+ * unless the file was truncated or replaced, which rebuilds the catalog.
+ */
 int mission_refresh_catalog(void);
 
 #endif /* DOMAIN_MISSION_H */
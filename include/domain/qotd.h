@@ -20,8 +20,15 @@ int qotd_record_entry(const char *date, const char *user, const char *question,
 /* returns 1 on success, 0 on error. On success *out_users is an array of malloc'd strings, caller must free each and free the array. */
 int qotd_get_solved_users_for_date(const char *date, char ***out_users, int *out_count);
 
-/* Domain helpers to access today's QOTD and mark it solved for a user. */
+/* Domain helpers to access today's QOTD and mark it solved for a user.
+ * Today's question and solved set are cached; qotd_rollover rebuilds them
+ * when the local date changes (run by the scheduler at midnight).
+ */
 int qotd_get_today(QOTD *out);
+int qotd_solved_today(const char *username);
 int qotd_mark_solved(const char *username);
+int qotd_rollover(long now);
+/* Call after changing data/qotd_questions.csv; the next lookup reloads today. */
+void qotd_invalidate(void);
 
 #endif /* DOMAIN_QOTD_H */
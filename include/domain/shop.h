@@ -3,10 +3,12 @@
 #define DOMAIN_SHOP_H
 
 #include "../types.h"
+#include "../core/snapshot.h"
 
 int shop_list(Shop *out_arr, int *out_n);
 int shop_buy(const char *username, const Item *item, int qty);
 int shop_sell(const char *username, const Item *item, int qty);
+int shop_snapshot_write(SnapWriter *w);
 
 
 #endif /* DOMAIN_SHOP_H */
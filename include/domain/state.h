@@ -0,0 +1,21 @@
+#ifndef DOMAIN_STATE_H
+#define DOMAIN_STATE_H
+
+#include "../core/snapshot.h"
+
+#define STATE_SNAPSHOT_PATH "data/state.snap"
+/* Seconds between scheduled checkpoints (core/scheduler.h), besides logout and exit. */
+#define STATE_CHECKPOINT_SECONDS 600
+
+/* Sections of data/state.snap, each written and restored by its owning module. */
+#define STATE_SEC_USERS SNAP_TAG('U', 'S', 'E', 'R')
+#define STATE_SEC_STOCKS SNAP_TAG('S', 'T', 'C', 'K') /* legacy: read once for the market start */
+#define STATE_SEC_SHOP SNAP_TAG('S', 'H', 'O', 'P')
+
+/* Snapshot present at boot, mapped on first use; NULL if missing or invalid. */
+const SnapReader *state_snapshot(void);
+/* Drain pending writes and write a fresh snapshot of the in-memory world. */
+int state_checkpoint(void);
+void state_release(void);
+
+#endif /* DOMAIN_STATE_H */
@@ -2,13 +2,143 @@
 #ifndef DOMAIN_STOCK_H
 #define DOMAIN_STOCK_H
 
+#include <stdint.h>
+
 #include "../types.h"
 
-int stock_list(Stock *out_arr, int *out_n);
+/* Seconds per price step; the scheduler runs stock_maybe_update_by_time this often.
+ * Once a symbol's scripted prices in data/stocks.csv run out, new ticks come
+ * from a seeded geometric random walk and are appended to data/stock_ticks.csv:
+ *   p' = p * exp(m + sigma*z),  z ~ N(0,1)
+ * where m and sigma are the mean and standard deviation of the per-tick log
+ * returns of the script (m clamped to +-0.0001, sigma to 0.002..0.01). This
+ * is p * exp(mu - sigma^2/2 + sigma*z) with arithmetic drift
+ * mu = m + sigma^2/2; since m is already a log-return mean, no further
+ * -sigma^2/2 is applied. Symbols that carry news also get jump shocks.
+ * data/stock_params.csv overrides m, sigma and the jump/dividend parameters.
+ */
+#define STOCK_STEP_SECONDS 600
+
+/* Immutable quote board, republished on every market tick. Readers borrow
+ * the current board without locks and must hand it back; a board stays valid
+ * until it is released even if newer ones are published meanwhile (retired
+ * boards are freed by epoch once no reader that might see them is left).
+ * version increases by one per publish, so a reader still holding the
+ * current version has nothing to redraw.
+ */
+#define STOCK_QUOTE_READERS 8
+
+typedef struct StockQuote {
+    char name[64];
+    char news[200];
+    int id;
+    int current_price;
+    int previous_price;
+    int visible_len; /* prices visible so far; see stock_history_range */
+} StockQuote;
+
+typedef struct StockQuotes {
+    unsigned long long version;
+    int count;
+    StockQuote quotes[];
+} StockQuotes;
+
+/* NULL when there are no stocks or all STOCK_QUOTE_READERS slots are taken. */
+const StockQuotes *stock_quotes_acquire(void);
+void stock_quotes_release(const StockQuotes *q);
+unsigned long long stock_quotes_version(void);
+/* Copies the visible prices [from, from + max_len) of one symbol and returns
+ * how many were copied; only the compressed blocks in that window are decoded.
+ */
+int stock_history_range(const char *symbol, long from, int *out_buf, int max_len);
+/* Traded volume per visible price step, aligned with stock_history_range:
+ * out_qty gets the shares and out_notional the sum of price x qty traded
+ * during each step of [from, from + max_len), 0 where nothing traded. Counts
+ * market deals and book fills (once per fill) since start-up; not persisted.
+ * Returns how many steps were written.
+ */
+int stock_trade_range(const char *symbol, long from, long long *out_qty, long long *out_notional, int max_len);
 int stock_deal(const char *username, const char *symbol, int qty, int is_buy);
-int stock_pay_dividends(User *user);  // 🔹 배당 지급
+
+/* A trade ticket: several legs at the current quotes, executed all or
+ * nothing. Sells apply before buys so their proceeds fund the buys (shares
+ * bought on the same ticket cannot be sold by it). Each leg becomes one
+ * ledger record, all appended in one batch, and the holdings file is
+ * written once. stock_deal is a one-leg ticket.
+ */
+#define STOCK_TICKET_MAX_LEGS 32
+
+typedef struct StockLeg {
+    char symbol[64];
+    int qty;
+    int is_buy;
+} StockLeg;
+
+/* *out_net gets the change to the deposit balance. */
+int stock_trade_ticket(const char *username, const StockLeg *legs, int n, int *out_net);
+
+/* Limit orders between users, one price-time book per symbol. Placing an
+ * order escrows its cash (buy: price * qty) or shares (sell); fills settle
+ * at the resting order's price and refund a buyer's unused escrow, cancels
+ * return the rest. Limits must lie within 50%..150% of the current quote.
+ * Trades do not move the quoted price. Open orders persist in
+ * data/orders.csv.
+ */
+typedef struct StockOrder {
+    uint64_t id;
+    char symbol[64];
+    int is_buy;
+    int price;
+    int leaves;
+} StockOrder;
+
+/* Returns the order id, or 0 when rejected; *out_filled gets the quantity
+ * that traded immediately.
+ */
+uint64_t stock_order_place(const char *username, const char *symbol, int is_buy, int price, int qty, int *out_filled);
+int stock_order_cancel(const char *username, uint64_t id);
+/* Returns the live id (a new one unless only the quantity went down), or 0. */
+uint64_t stock_order_replace(const char *username, uint64_t id, int price, int qty);
+int stock_order_list(const char *username, StockOrder *out, int max);
+/* Best bid and ask, 0 for an empty side; returns 0 for an unknown symbol. */
+int stock_book_top(const char *symbol, int *bid, int *ask);
+
+/* Dividends. On each record date every share held (including shares escrowed
+ * in open sell orders) pays current price x yield; yields default to
+ * STOCK_DIVIDEND_YIELD and can be set per symbol in the 7th column of
+ * data/stock_params.csv. One pass over all holdings, one ledger append and
+ * one accounts.dat write per payout. The last record date is kept in
+ * data/market.csv.
+ */
+#define STOCK_DIVIDEND_PERIOD 86400
+#define STOCK_DIVIDEND_YIELD 0.005
+/* Seconds between scheduled checks for a due payout (core/scheduler.h). */
+#define STOCK_DIVIDEND_CHECK_PERIOD 3600
+
+typedef struct StockDividendStats {
+    size_t holders;   /* users credited */
+    size_t postings;  /* ledger records written */
+    long long paid;
+} StockDividendStats;
+
+/* by is the teacher who ordered the payout (paid at once), or NULL for the
+ * scheduler (paid only once STOCK_DIVIDEND_PERIOD has passed since the last
+ * record date). Returns 1 when a payout ran. out may be NULL.
+ */
+int stock_pay_dividends(User *by, long now, StockDividendStats *out);
 bool shop_decrease_stock_csv(const char *item_name);
 void stock_maybe_update_by_time(void);
+/* Price visible at epoch second t on the market clock (clamped to the ends of
+ * the series). The clock's start is persisted in data/market.csv. Returns -1
+ * for an unknown symbol.
+ */
+int stock_price_at(const char *symbol, long t);
+/* Builds the net-worth valuation (domain/valuation.h) from the current
+ * holdings, open orders and prices; later changes are pushed as deltas.
+ */
+int stock_valuation_seed(void);
+/* Reads data/stocks/<user>.csv into user->holdings. */
+void stock_load_holdings(User *user);
 
 
 #endif /* DOMAIN_STOCK_H */
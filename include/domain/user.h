@@ -3,12 +3,61 @@
 #define DOMAIN_USER_H
 
 #include "../types.h"
+#include "../core/snapshot.h"
 
 int user_register(const User *new_user);
 int user_auth(const char *username, const char *password);
 User *user_lookup(const char *username);
 size_t user_count(void);
 const User *user_at(size_t index);
+User *user_at_mut(size_t index);
+/* Persists the user's whole account record (one fixed-width slot in data/accounts.dat). */
 int user_update_balance(const char *username, int new_balance);
+/* Rewrites every slot of data/accounts.dat in one write, for batch updates. */
+int user_store_flush(void);
+/* Writes the human-readable accounts.csv view (path NULL = data/accounts.csv). */
+int user_export_accounts_csv(const char *path);
+int user_snapshot_write(SnapWriter *w);
+
+/* Cold per-user side tables, keyed by User.id and allocated on first use.
+ * The _peek variants never allocate and return NULL for untouched users.
+ */
+Item *user_items(User *user); /* USER_ITEM_SLOTS entries */
+Item *user_items_peek(const User *user);
+UserHoldings *user_holdings(User *user);
+UserHoldings *user_holdings_peek(const User *user);
+/* Mission completion bitset indexed by catalog slot (domain/mission.h). */
+int user_mission_done(const User *user, int slot);
+int user_mission_mark(User *user, int slot);
+void user_missions_reset(User *user);
+/* Moves completion bits after the catalog was rebuilt: new_slot[k] is the new
+ * slot of old slot k, or -1 if that mission is gone. Returns the completed
+ * count, or -1 if the user has no bitset yet.
+ */
+int user_missions_remap(User *user, const int *new_slot, int old_count);
+
+/* Per-user files (mission completions, stock holdings, the interest timestamp
+ * derived from the tx log) are read the first time a user is logged in or
+ * viewed, not at startup. user_hydrate_all loads everyone still pending on
+ * the worker pool (core/worker_pool.h) for screens that list every user.
+ */
+int user_hydrate(User *user);
+int user_hydrate_all(void);
+/* bank.last_interest_ts, first deriving it from the tx log when it is unset. */
+long user_interest_ts(User *user);
+
+typedef struct UserMemoryStats {
+    size_t users;
+    size_t table_bytes;  /* hot User records, whole chunks */
+    size_t index_bytes;  /* name hash index */
+    size_t string_bytes; /* name/password pool */
+    size_t side_bytes;   /* side table slots plus materialized entries */
+    size_t total_bytes;
+} UserMemoryStats;
+
+/* Bytes held by the user table and everything hanging off it. */
+void user_memory_stats(UserMemoryStats *out);
+/* Writes a ledger checkpoint of every account (see domain/ledger.h). */
+int user_ledger_checkpoint(void);
 
 #endif /* DOMAIN_USER_H */
@@ -0,0 +1,44 @@
+#ifndef DOMAIN_VALUATION_H
+#define DOMAIN_VALUATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../types.h"
+
+/* Mark-to-market net worth of every user, kept current by deltas:
+ *   deposit + cash - loan + inventory at cost + cash escrowed in open buy
+ *   orders + shares (held or escrowed in sell orders) x current price.
+ * Money and inventory are re-read on valuation_touch; share positions and
+ * escrow arrive as deltas from domain/stock; a price tick revalues only the
+ * holders of that symbol through a symbol -> holders index. Students are
+ * ranked in an order-statistics tree (core/rank_tree.h), so a user's rank
+ * is O(log n) and the top k cost O(k log n).
+ *
+ * The valuation is built on the first query (stock_valuation_seed); until
+ * then every hook is a no-op. Callers hold the world lock.
+ */
+
+typedef struct NetWorthEntry {
+    const User *user;
+    long long worth;
+} NetWorthEntry;
+
+/* Drops everything and starts over with `symbols` symbols priced at 0. */
+int valuation_reset(int symbols);
+int valuation_ready(void);
+/* Re-reads the user's money and inventory (and role, for ranking). */
+void valuation_touch(const User *user);
+void valuation_escrow(uint32_t user, long long delta);
+void valuation_position(uint32_t user, int symbol, int delta_qty);
+void valuation_price(int symbol, int price);
+
+/* -1 for an unknown user. */
+long long valuation_net_worth(const User *user);
+/* 0-based rank among students, or -1 when the user is not ranked. */
+long valuation_rank(const User *user);
+/* Writes up to k entries from the top and returns how many. */
+int valuation_top(NetWorthEntry *out, int k);
+size_t valuation_ranked(void);
+
+#endif /* DOMAIN_VALUATION_H */
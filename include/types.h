@@ -7,16 +7,18 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 /* -------------------------------------------------------------------------- */
 /*  Macro configuration                                                        */
 /* -------------------------------------------------------------------------- */
 
 #define MAX_ITEM_SIZE 100
 #define MAX_NAME_LEN 30
-#define MAX_STUDENTS 50
-#define MAX_MISSIONS 128
 #define MAX_NOTIFICATIONS 256
 #define MAX_HOLDINGS 16
+#define USER_NAME_MAX 50
+#define USER_PW_MAX 100
+#define USER_ITEM_SLOTS 10
 #define CP_DEFAULT 1
 #define BOX_WIDTH 40
 #define BOX_HEIGHT 20
@@ -48,11 +50,9 @@ typedef struct StockHolding {
 } StockHolding;
 
 struct Bank {
-    char name[50];
     int balance; /* deposit/bank balance (backward-compatible) */
     int cash;   /* physical/portable cash (new) */
     int loan;   /* outstanding loan amount (new) */
-    char log[128];
     long last_interest_ts; /* epoch seconds when interest was last applied */
 };
 
@@ -84,26 +84,30 @@ struct Stock {
     int base_price;
     int current_price;
     int previous_price;
-    int log[200];
-    int log_len;
+    int log_len; /* prices visible so far; read them with stock_history_range */
     char news[200];
 };
 
+/* Hot per-user record: only what most screens read. Inventory, stock
+ * holdings and mission completion live in side tables in domain/user.c,
+ * keyed by id and allocated the first time they are touched
+ * (user_items, user_holdings, user_mission_done).
+ */
 struct User {
-    char name[50];
-    Bank bank;
-    char pw[100];
-    char id[50];
+    const char *name; /* interned; valid for the life of the process */
+    const char *pw;   /* interned */
+    uint32_t id;      /* position in the user table */
     RankEnum isadmin;
-    Item items[10];
+    Bank bank;
     int completed_missions;
     int total_missions;
-    Mission missions[99];
-    int mission_count;
-    StockHolding holdings[MAX_HOLDINGS];
-    int holding_count;
 };
 
+typedef struct UserHoldings {
+    int count;
+    StockHolding items[MAX_HOLDINGS];
+} UserHoldings;
+
 struct AssetPoint{
     long timestamp;
     long total_asset;
@@ -11,5 +11,7 @@ void tui_common_draw_menu(WINDOW *win, const char **entries, int entry_count, in
 void tui_common_draw_progress(WINDOW *win, int row, int col, int width, int percent);
 void tui_common_draw_help(const char *text);
 void tui_common_print_multiline(WINDOW *win, int row, int col, const char *const *lines, size_t line_count);
+/* First row to draw so that row `highlight` stays inside a `visible`-row list. */
+int tui_common_list_top(int highlight, int visible);
 
 #endif /* UI_TUI_COMMON_H */
@@ -14,5 +14,9 @@ void tui_ncurses_draw_status(const char *message);
 int tui_ncurses_prompt_line(WINDOW *win, int row, int col, const char *label, char *buffer, size_t len, int hidden);
 int tui_ncurses_prompt_number(WINDOW *context, const char *label, int *out_value);
 void tui_ncurses_toast(const char *message, int delay_ms);
+/* wgetch with the scheduler's world lock released while waiting (core/scheduler.h).
+ * All UI input goes through here; the UI thread holds the lock otherwise.
+ */
+int tui_ncurses_getch(WINDOW *win);
 
 #endif /* UI_TUI_NCURSES_H */
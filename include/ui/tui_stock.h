@@ -5,8 +5,28 @@
 #ifndef UI_TUI_STOCK_H
 #define UI_TUI_STOCK_H
 
+#include <ncurses.h>
+
 #include "../types.h"
+#include "../domain/stock.h"
+
+/* Trade ticket shared by the market screens. Enter/s ask for a quantity
+ * ("m" = most the deposit can buy, "a" = every share held; empty = 1).
+ * With basket mode on, legs are queued instead and 'e' sends them all as
+ * one stock_trade_ticket.
+ */
+typedef struct TuiStockBasket {
+    StockLeg legs[STOCK_TICKET_MAX_LEGS];
+    int quoted[STOCK_TICKET_MAX_LEGS]; /* price when queued, for the estimate */
+    int count;
+    int active;
+} TuiStockBasket;
 
 void tui_stock_show_market(User *user);
+void tui_stock_ticket(WINDOW *win, User *user, const StockQuote *quote, int is_buy, TuiStockBasket *basket);
+void tui_stock_basket_execute(User *user, TuiStockBasket *basket);
+/* Estimated deposit change of the queued legs at their queued prices. */
+long tui_stock_basket_net(const TuiStockBasket *basket);
+void tui_stock_basket_draw(WINDOW *win, int row, const TuiStockBasket *basket);
 
 #endif /* UI_TUI_STOCK_H */
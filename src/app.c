@@ -4,9 +4,102 @@
  */
 #include "../include/app.h"
 #include "../include/ui/tui.h"
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/core/csv.h"
+#include "../include/core/scheduler.h"
+#include "../include/core/worker_pool.h"
+#include "../include/domain/economy.h"
+#include "../include/domain/mission.h"
+#include "../include/domain/qotd.h"
+#include "../include/domain/state.h"
+#include "../include/domain/stock.h"
+#include "../include/domain/user.h"
 
 static int g_bootstrapped = 0;
 
+/* 스케줄러 작업들. 모두 세계 잠금을 쥔 스케줄러 스레드에서 돈다 (core/scheduler.h) */
+
+/* 함수 목적: 주가를 한 칸 진행한다. (밀린 칸이 있으면 함께)
+ * 매개변수: now, ctx
+ * 반환 값: 없음
+ */
+static void job_stock_tick(long now, void *ctx) {
+    (void)now;
+    (void)ctx;
+    stock_maybe_update_by_time();
+}
+
+/* 함수 목적: 모든 계좌의 밀린 이자를 정산한다.
+ * 매개변수: now, ctx
+ * 반환 값: 없음
+ */
+static void job_interest(long now, void *ctx) {
+    (void)ctx;
+    econ_accrue_all(now, NULL);
+}
+
+/* 함수 목적: 배당 기준일이 지났으면 모든 주주에게 배당을 지급한다.
+ * 매개변수: now, ctx
+ * 반환 값: 없음
+ */
+static void job_dividend(long now, void *ctx) {
+    (void)ctx;
+    stock_pay_dividends(NULL, now, NULL);
+}
+
+/* 함수 목적: 다음 지역 자정 시각을 구한다. (일광 절약 시간에도 맞도록 mktime 사용)
+ * 매개변수: now
+ * 반환 값: epoch 초
+ */
+static long next_local_midnight(long now) {
+    time_t t = (time_t)now;
+    struct tm *lt = localtime(&t);
+    if (!lt) return now + 86400;
+    struct tm tm = *lt;
+    tm.tm_mday += 1;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    time_t next = mktime(&tm);
+    return next > t ? (long)next : now + 86400;
+}
+
+/* 함수 목적: 날짜가 바뀌면 오늘의 QOTD 를 교체하고 다음 자정에 다시 예약한다.
+ * 매개변수: now, ctx
+ * 반환 값: 없음
+ */
+static void job_qotd_rollover(long now, void *ctx) {
+    (void)ctx;
+    qotd_rollover(now);
+    sched_add("qotd", next_local_midnight(now), 0, job_qotd_rollover, NULL);
+}
+
+/* 함수 목적: 스냅샷 체크포인트를 남긴다.
+ * 매개변수: now, ctx
+ * 반환 값: 없음
+ */
+static void job_checkpoint(long now, void *ctx) {
+    (void)now;
+    (void)ctx;
+    state_checkpoint();
+}
+
+/* 함수 목적: 시간에 따라 도는 경제 작업을 스케줄러에 등록하고 스레드를 띄운다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void schedule_jobs(void) {
+    long now = (long)time(NULL);
+    qotd_rollover(now);
+    sched_add("stock", now, STOCK_STEP_SECONDS, job_stock_tick, NULL);
+    sched_add("interest", now, ECON_ACCRUAL_PERIOD, job_interest, NULL);
+    sched_add("dividend", now, STOCK_DIVIDEND_CHECK_PERIOD, job_dividend, NULL);
+    sched_add("qotd", next_local_midnight(now), 0, job_qotd_rollover, NULL);
+    sched_add("checkpoint", now + STATE_CHECKPOINT_SECONDS, STATE_CHECKPOINT_SECONDS, job_checkpoint, NULL);
+    sched_start();
+}
+
 /* 함수 목적: ui 함수로 넘어가는 역할을 한다.
  * 매개변수: 없음
  * 반환 값: 없음
@@ -16,13 +109,28 @@ void app_bootstrap(void) {
         return;
     }
     g_bootstrapped = 1;
+    /* 디스크 쓰기는 백그라운드 스레드로 넘겨 키 입력이 I/O 를 기다리지 않게 한다 */
+    csv_async_start();
+    /* 예전 형식의 사용자별 미션 파일은 처음 한 번만 정리한다 (이후 읽기는 파일을 쓰지 않음) */
+    mission_migrate_legacy();
+    /* 주가, 이자, 배당, QOTD 교체, 체크포인트는 스케줄러 스레드가 맡고 화면은 결과만 읽는다 */
+    schedule_jobs();
     tui_run();
 }
 
 /* 함수 목적: 앱을 종료한다.
  * 매개변수: 없음
- * 반환 값: 없음
+ * 반환 값: 모든 파일 쓰기가 반영되었으면 1, 잃은 쓰기가 있으면 0
  */
-void app_shutdown(void) {
+int app_shutdown(void) {
+    sched_stop();
+    /* 계좌 원본은 accounts.dat 이고, 종료할 때 사람이 읽는 CSV 를 한 번 갱신한다 */
+    user_export_accounts_csv(NULL);
+    state_checkpoint();
+    worker_pool_stop();
+    int ok = csv_shutdown();
+    state_release();
     g_bootstrapped = 0;
+    if (!ok) fprintf(stderr, "some data files could not be written; check free space and permissions under data/\n");
+    return ok;
 }
@@ -1,102 +1,933 @@
 
 #include "../../include/core/csv.h"
+#include "../../include/core/io_writer.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CSV_SCAN_X86 1
+#endif
 
 #if defined(_WIN32)
 #include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
 #define MKDIR(p) _mkdir(p)
+#define FSYNC(fd) _commit(fd)
+#define OPEN_RW(p) _open(p, _O_RDWR | _O_CREAT | _O_BINARY, 0644)
+#define CLOSE_FD(fd) _close(fd)
+/* rename 은 대상이 있으면 실패하므로, 한 번에 덮어쓰는 MoveFileEx 를 쓴다 */
+#define RENAME_OVER(from, to) (MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1)
 #else
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
 #define MKDIR(p) mkdir(p, 0755)
+#define FSYNC(fd) fsync(fd)
+#define OPEN_RW(p) open(p, O_RDWR | O_CREAT, 0644)
+#define CLOSE_FD(fd) close(fd)
+#define RENAME_OVER(from, to) rename(from, to)
+#endif
+
+/* 동시에 열어 둘 append 핸들 수 (LRU 로 교체) */
+#define CSV_HANDLE_SLOTS 16
+/* 제자리 쓰기(pwrite)용으로 열어 둘 파일 수 */
+#define CSV_RW_SLOTS 4
+/* 한 번 만든 디렉터리를 기억해 둘 개수 */
+#define CSV_DIR_SLOTS 32
+/* 쓰기에 실패한 경로를 기억해 둘 개수 (넘치면 모든 경로를 실패로 본다) */
+#define CSV_ERROR_SLOTS 16
+#define CSV_PATH_MAX 512
+/* 스캐너가 한 번에 비트맵으로 만드는 바이트 수 */
+#define CSV_SCAN_BLOCK 64
+
+typedef struct {
+    char path[CSV_PATH_MAX];
+    FILE *fp;
+    unsigned long last_use; /* LRU 교체용 사용 시각(틱) */
+    size_t pending;         /* 마지막 flush 이후 쓴 바이트 수 */
+} CsvHandle;
+
+static CsvHandle g_handles[CSV_HANDLE_SLOTS];
+static unsigned long g_use_tick = 0;
+
+/* 고정 길이 레코드 파일처럼 제자리에 덮어쓰는 파일의 fd 캐시 */
+typedef struct {
+    char path[CSV_PATH_MAX];
+    int fd; /* 0 이면 빈 슬롯 (fd+1 을 저장) */
+    unsigned long last_use;
+} CsvRwHandle;
+
+static CsvRwHandle g_rw_handles[CSV_RW_SLOTS];
+static char g_dirs[CSV_DIR_SLOTS][CSV_PATH_MAX];
+static int g_dir_count = 0;
+
+/* 여러 스레드가 함께 쓰는 표(디렉터리 캐시, 쓰기 실패 기록)를 지키는 잠금.
+ * 쓰기 실패는 쓰기 스레드가 남기고 읽는 쪽(csv_flush_path 등)이 확인한다. 한 번 실패한 경로는 파일 전체 교체나 삭제가 성공할
+ * 때까지 실패로 남는다 (그 전에 잃은 쓰기를 새 내용이 덮어쓰므로).
+ */
+static pthread_mutex_t g_csv_lock = PTHREAD_MUTEX_INITIALIZER;
+static char g_err_paths[CSV_ERROR_SLOTS][CSV_PATH_MAX];
+static int g_err_count = 0;
+static int g_err_overflow = 0;
+
+/* 그룹 flush 정책: 주기(ms) 또는 누적 바이트 중 먼저 도달하는 쪽 */
+static long g_flush_interval_ms = 1000;
+static size_t g_flush_bytes = 64 * 1024;
+static size_t g_pending_total = 0;
+static long long g_last_flush_ms = 0;
+
+/* 함수 목적: 단조 증가 시계를 밀리초 단위로 읽습니다.
+ * 매개변수: 없음
+ * 반환 값: 밀리초
+ */
+static long long now_ms(void) {
+#if defined(_WIN32)
+    return (long long)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 #endif
+}
+
+/* 함수 목적: 경로의 쓰기 실패를 기록합니다. 이미 기록된 경로면 그대로 둡니다.
+ * 매개변수: path
+ * 반환 값: 없음
+ */
+static void note_write_error(const char *path) {
+    pthread_mutex_lock(&g_csv_lock);
+    int found = 0;
+    for (int i = 0; i < g_err_count && !found; ++i) {
+        found = strcmp(g_err_paths[i], path) == 0;
+    }
+    if (!found) {
+        if (g_err_count < CSV_ERROR_SLOTS && strlen(path) < CSV_PATH_MAX) {
+            snprintf(g_err_paths[g_err_count++], CSV_PATH_MAX, "%s", path);
+        } else {
+            g_err_overflow = 1;
+        }
+    }
+    pthread_mutex_unlock(&g_csv_lock);
+}
+
+/* 함수 목적: 파일 전체를 새로 쓰거나 지운 경로의 실패 기록을 지웁니다.
+ * 매개변수: path
+ * 반환 값: 없음
+ */
+static void clear_write_error(const char *path) {
+    pthread_mutex_lock(&g_csv_lock);
+    for (int i = 0; i < g_err_count; ++i) {
+        if (strcmp(g_err_paths[i], path) == 0) {
+            memmove(g_err_paths[i], g_err_paths[g_err_count - 1], CSV_PATH_MAX);
+            g_err_count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_csv_lock);
+}
 
-/* 함수 목적: csv_ensure_dir 함수는 핵심 유틸리티 및 데이터 처리 구현에서 필요한 동작을 수행합니다.
+/* 함수 목적: 경로(NULL 이면 아무 경로든)에 잃은 쓰기가 남아 있는지 봅니다.
+ * 매개변수: path
+ * 반환 값: 실패 기록이 없으면 1, 있으면 0
+ */
+static int write_status(const char *path) {
+    pthread_mutex_lock(&g_csv_lock);
+    int ok = !g_err_overflow && (path ? 1 : g_err_count == 0);
+    for (int i = 0; ok && path && i < g_err_count; ++i) {
+        if (strcmp(g_err_paths[i], path) == 0) ok = 0;
+    }
+    pthread_mutex_unlock(&g_csv_lock);
+    return ok;
+}
+
+/* 함수 목적: csv_ensure_dir 함수는 디렉터리를 만들되, 이미 만든 경로는 기억해 두고
+ *           다시 mkdir 시스템 콜을 하지 않습니다.
  * 매개변수: path
  * 반환 값: 함수 수행 결과를 나타냅니다.
  */
 int csv_ensure_dir(const char *path) {
     if (!path) return 0;
+    /* UI, 스케줄러, 작업자 풀이 함께 부르므로 캐시는 잠금 안에서만 본다 */
+    pthread_mutex_lock(&g_csv_lock);
+    for (int i = 0; i < g_dir_count; ++i) {
+        if (strcmp(g_dirs[i], path) == 0) {
+            pthread_mutex_unlock(&g_csv_lock);
+            return 1;
+        }
+    }
     /* try to create; ignore errors if exists */
     MKDIR(path);
+    if (g_dir_count < CSV_DIR_SLOTS && strlen(path) < CSV_PATH_MAX) {
+        snprintf(g_dirs[g_dir_count++], CSV_PATH_MAX, "%s", path);
+    }
+    pthread_mutex_unlock(&g_csv_lock);
+    return 1;
+}
+
+/* 함수 목적: 경로에 해당하는 열린 핸들을 찾습니다.
+ * 매개변수: path
+ * 반환 값: 핸들 슬롯 포인터, 없으면 NULL
+ */
+static CsvHandle *find_handle(const char *path) {
+    for (int i = 0; i < CSV_HANDLE_SLOTS; ++i) {
+        if (g_handles[i].fp && strcmp(g_handles[i].path, path) == 0) {
+            return &g_handles[i];
+        }
+    }
+    return NULL;
+}
+
+/* 함수 목적: 핸들을 닫고 슬롯을 비웁니다.
+ * 매개변수: h
+ * 반환 값: 없음
+ */
+static void close_handle(CsvHandle *h) {
+    if (!h || !h->fp) return;
+    if (fclose(h->fp) != 0 && h->pending > 0) note_write_error(h->path);
+    g_pending_total -= h->pending < g_pending_total ? h->pending : g_pending_total;
+    memset(h, 0, sizeof(*h));
+}
+
+/* 함수 목적: 경로에 대한 append 핸들을 캐시에서 꺼내거나 새로 엽니다.
+ *           슬롯이 가득 차면 가장 오래 쓰이지 않은 핸들을 닫습니다.
+ * 매개변수: path
+ * 반환 값: 핸들 슬롯 포인터, 실패 시 NULL
+ */
+static CsvHandle *acquire_handle(const char *path) {
+    if (strlen(path) >= CSV_PATH_MAX) {
+        note_write_error(path);
+        return NULL;
+    }
+    CsvHandle *h = find_handle(path);
+    if (!h) {
+        CsvHandle *victim = &g_handles[0];
+        for (int i = 0; i < CSV_HANDLE_SLOTS; ++i) {
+            if (!g_handles[i].fp) {
+                victim = &g_handles[i];
+                break;
+            }
+            if (g_handles[i].last_use < victim->last_use) victim = &g_handles[i];
+        }
+        close_handle(victim);
+        FILE *fp = fopen(path, "a");
+        if (!fp) {
+            note_write_error(path);
+            return NULL;
+        }
+        victim->fp = fp;
+        snprintf(victim->path, sizeof(victim->path), "%s", path);
+        h = victim;
+    }
+    h->last_use = ++g_use_tick;
+    return h;
+}
+
+/* 함수 목적: 열린 모든 append 핸들의 버퍼를 한꺼번에 디스크로 내보냅니다.
+ * 매개변수: 없음
+ * 반환 값: 모든 flush 가 성공하면 1, 하나라도 실패하면 0
+ */
+static int flush_handles(void) {
+    int ok = 1;
+    for (int i = 0; i < CSV_HANDLE_SLOTS; ++i) {
+        if (g_handles[i].fp && g_handles[i].pending > 0) {
+            if (fflush(g_handles[i].fp) != 0) {
+                note_write_error(g_handles[i].path);
+                ok = 0;
+            }
+            g_handles[i].pending = 0;
+        }
+    }
+    g_pending_total = 0;
+    g_last_flush_ms = now_ms();
+    return ok;
+}
+
+/* 함수 목적: 그룹 flush 정책(주기 또는 누적 바이트)에 도달했는지 확인합니다.
+ * 매개변수: 없음
+ * 반환 값: flush 해야 하면 1
+ */
+static int flush_due(void) {
+    long long now = now_ms();
+    if (g_last_flush_ms == 0) g_last_flush_ms = now;
+    return g_pending_total >= g_flush_bytes || now - g_last_flush_ms >= g_flush_interval_ms;
+}
+
+/* 함수 목적: 캐시된 핸들에 이미 만들어진 바이트열을 덧붙입니다. flush 는 하지 않습니다.
+ * 매개변수: path, data, len
+ * 반환 값: 성공 1, 실패 0
+ */
+static int append_bytes(const char *path, const char *data, size_t len) {
+    CsvHandle *h = acquire_handle(path);
+    if (!h) return 0;
+    if (len > 0 && fwrite(data, 1, len, h->fp) != len) {
+        note_write_error(path);
+        close_handle(h);
+        return 0;
+    }
+    h->pending += len;
+    g_pending_total += len;
+    return 1;
+}
+
+/* 함수 목적: 경로에 대해 열어 둔 제자리 쓰기 fd 를 닫습니다.
+ *           rename 으로 파일이 바뀌면 예전 fd 는 옛 inode 를 가리키므로 반드시 닫아야 합니다.
+ * 매개변수: path (NULL 이면 전부)
+ * 반환 값: 없음
+ */
+static void close_rw_handle(const char *path) {
+    for (int i = 0; i < CSV_RW_SLOTS; ++i) {
+        CsvRwHandle *h = &g_rw_handles[i];
+        if (h->fd && (!path || strcmp(h->path, path) == 0)) {
+            CLOSE_FD(h->fd - 1);
+            memset(h, 0, sizeof(*h));
+        }
+    }
+}
+
+/* 함수 목적: offset 위치에 len 바이트를 덮어씁니다. 파일이 없으면 만들고,
+ *           fd 는 캐시해 두어 같은 파일에 대한 다음 쓰기는 시스템 콜 하나로 끝납니다.
+ * 매개변수: path, data, len, offset
+ * 반환 값: 성공 1, 실패 0
+ */
+static int write_at(const char *path, const char *data, size_t len, long long offset) {
+    if (strlen(path) >= CSV_PATH_MAX || offset < 0) return 0;
+    CsvRwHandle *h = NULL;
+    for (int i = 0; i < CSV_RW_SLOTS; ++i) {
+        if (g_rw_handles[i].fd && strcmp(g_rw_handles[i].path, path) == 0) {
+            h = &g_rw_handles[i];
+            break;
+        }
+    }
+    if (!h) {
+        CsvRwHandle *victim = &g_rw_handles[0];
+        for (int i = 0; i < CSV_RW_SLOTS; ++i) {
+            if (!g_rw_handles[i].fd) {
+                victim = &g_rw_handles[i];
+                break;
+            }
+            if (g_rw_handles[i].last_use < victim->last_use) victim = &g_rw_handles[i];
+        }
+        int fd = OPEN_RW(path);
+        if (fd < 0) {
+            note_write_error(path);
+            return 0;
+        }
+        if (victim->fd) CLOSE_FD(victim->fd - 1);
+        victim->fd = fd + 1;
+        snprintf(victim->path, sizeof(victim->path), "%s", path);
+        h = victim;
+    }
+    h->last_use = ++g_use_tick;
+    int fd = h->fd - 1;
+    size_t done = 0;
+    while (done < len) {
+#if defined(_WIN32)
+        int n = -1;
+        if (_lseeki64(fd, offset + (long long)done, SEEK_SET) >= 0) {
+            n = _write(fd, data + done, (unsigned)(len - done));
+        }
+#else
+        ssize_t n = pwrite(fd, data + done, len - done, (off_t)(offset + (long long)done));
+#endif
+        if (n <= 0) {
+            note_write_error(path);
+            close_rw_handle(path);
+            return 0;
+        }
+        done += (size_t)n;
+    }
+    return 1;
+}
+
+/* 함수 목적: 파일 전체를 임시 파일에 쓴 뒤 rename 으로 교체합니다.
+ *           도중에 실패해도 기존 파일은 그대로 남습니다. 성공하면 그 경로의
+ *           이전 실패 기록은 지웁니다.
+ * 매개변수: path, data, len
+ * 반환 값: 성공 1, 실패 0
+ */
+static int replace_file(const char *path, const char *data, size_t len) {
+    close_handle(find_handle(path));
+    close_rw_handle(path);
+    char tmp[CSV_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        note_write_error(path);
+        return 0;
+    }
+    int ok = (len == 0 || fwrite(data, 1, len, f) == len);
+    if (fflush(f) != 0) ok = 0;
+    if (ok && FSYNC(fileno(f)) != 0) ok = 0;
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) {
+        remove(tmp);
+        note_write_error(path);
+        return 0;
+    }
+    if (RENAME_OVER(tmp, path) != 0) {
+        remove(tmp);
+        note_write_error(path);
+        return 0;
+    }
+    clear_write_error(path);
+    return 1;
+}
+
+/* 쓰기 스레드에서 실행되는 적용 함수들. 실패는 note_write_error 로 남고
+ * csv_flush_path / csv_flush_all / csv_shutdown 이 알려 준다. */
+static void apply_append(const char *path, const char *data, size_t len, long long offset) {
+    (void)offset;
+    append_bytes(path, data, len);
+}
+
+static void apply_replace(const char *path, const char *data, size_t len, long long offset) {
+    (void)offset;
+    replace_file(path, data, len);
+}
+
+static void apply_remove(const char *path, const char *data, size_t len, long long offset) {
+    (void)data;
+    (void)len;
+    (void)offset;
+    close_handle(find_handle(path));
+    close_rw_handle(path);
+    remove(path);
+    clear_write_error(path);
+}
+
+static void apply_write_at(const char *path, const char *data, size_t len, long long offset) {
+    write_at(path, data, len, offset);
+}
+
+static void apply_close(const char *path, const char *data, size_t len, long long offset) {
+    (void)data;
+    (void)len;
+    (void)offset;
+    close_handle(find_handle(path));
+}
+
+/* 함수 목적: 쓰기 스레드가 한 묶음을 처리한 뒤 호출하는 flush 함수입니다.
+ *           기다리는 쪽이 없으면 그룹 flush 정책을 그대로 따릅니다.
+ * 매개변수: force
+ * 반환 값: 적용된 쓰기가 모두 내보내졌으면 1
+ */
+static int writer_flush(int force) {
+    if (g_pending_total == 0) return 1;
+    if (!force && !flush_due()) return 0;
+    flush_handles();
+    return 1;
+}
+
+/* 함수 목적: 모든 쓰기를 디스크로 내보냅니다. 쓰기 스레드가 동작 중이면
+ *           지금까지 제출된 쓰기가 모두 반영될 때까지 기다립니다.
+ * 매개변수: 없음
+ * 반환 값: 잃은 쓰기가 남은 경로가 없으면 1, 있으면 0
+ */
+int csv_flush_all(void) {
+    if (io_writer_running()) {
+        io_writer_drain();
+    } else {
+        flush_handles();
+    }
+    return write_status(NULL);
+}
+
+/* 함수 목적: 특정 경로의 쓰기 버퍼만 내보냅니다. 파일을 직접 읽기 전에 호출하고,
+ *           내용이 디스크에 있어야 하는 쓰기 뒤에는 반환 값을 확인합니다.
+ * 매개변수: path
+ * 반환 값: 그 경로에 제출한 쓰기가 모두 반영되었으면 1, 잃은 쓰기가 있으면 0
+ *          (파일 전체 교체나 삭제가 성공할 때까지 0 으로 남는다)
+ */
+int csv_flush_path(const char *path) {
+    if (!path) return 0;
+    if (io_writer_running()) {
+        io_writer_wait_path(path);
+        return write_status(path);
+    }
+    CsvHandle *h = find_handle(path);
+    if (h && h->pending > 0) {
+        if (fflush(h->fp) != 0) note_write_error(path);
+        g_pending_total -= h->pending < g_pending_total ? h->pending : g_pending_total;
+        h->pending = 0;
+    }
+    return write_status(path);
+}
+
+/* 함수 목적: 특정 경로의 핸들을 닫습니다. 파일을 덮어쓰거나 지우기 전에 호출합니다.
+ * 매개변수: path
+ * 반환 값: 없음
+ */
+void csv_close_path(const char *path) {
+    if (!path) return;
+    if (io_writer_running()) {
+        io_writer_submit(apply_close, path, NULL, 0, 0);
+        io_writer_wait_path(path);
+        return;
+    }
+    close_handle(find_handle(path));
+}
+
+/* 함수 목적: 그룹 flush 주기와 바이트 임계값을 설정합니다.
+ * 매개변수: interval_ms (0 이하이면 매 행마다 flush), max_pending_bytes
+ * 반환 값: 없음
+ */
+void csv_set_flush_policy(long interval_ms, size_t max_pending_bytes) {
+    g_flush_interval_ms = interval_ms;
+    g_flush_bytes = max_pending_bytes;
+}
+
+/* 함수 목적: 이미 만들어진 바이트열을 파일 끝에 덧붙입니다.
+ *           쓰기 스레드가 동작 중이면 큐에 넣고 바로 돌아옵니다.
+ * 매개변수: path, data, len
+ * 반환 값: 성공 1, 실패 0
+ */
+int csv_append_raw(const char *path, const char *data, size_t len) {
+    if (!path || (!data && len > 0)) return 0;
+    if (io_writer_running()) {
+        return io_writer_submit(apply_append, path, data, len, 0);
+    }
+    if (!append_bytes(path, data, len)) return 0;
+    if (flush_due()) flush_handles();
     return 1;
 }
 
-/* 함수 목적: csv_append_row 함수는 핵심 유틸리티 및 데이터 처리 구현에서 필요한 동작을 수행합니다.
+/* 함수 목적: csv_append_row 함수는 한 행을 만들어 덧붙입니다. 쓰기 스레드가
+ *           동작 중이면 큐에 넣고, 아니면 캐시된 핸들에 바로 씁니다.
+ *           어느 쪽이든 주기나 누적 바이트가 정책을 넘으면 모아서 flush 합니다.
  * 매개변수: path, fmt, ...
  * 반환 값: 함수 수행 결과를 나타냅니다.
  */
 int csv_append_row(const char *path, const char *fmt, ...) {
     if (!path || !fmt) return 0;
-    FILE *f = fopen(path, "a");
-    if (!f) return 0;
+    char stack_buf[512];
+    char *line = stack_buf;
     va_list ap;
     va_start(ap, fmt);
-    vfprintf(f, fmt, ap);
+    int n = vsnprintf(stack_buf, sizeof(stack_buf), fmt, ap);
     va_end(ap);
-    fprintf(f, "\n");
-    fclose(f);
+    if (n < 0) return 0;
+    if ((size_t)n + 1 >= sizeof(stack_buf)) {
+        line = malloc((size_t)n + 2);
+        if (!line) return 0;
+        va_start(ap, fmt);
+        vsnprintf(line, (size_t)n + 1, fmt, ap);
+        va_end(ap);
+    }
+    line[n] = '\n';
+    int ok = csv_append_raw(path, line, (size_t)n + 1);
+    if (line != stack_buf) free(line);
+    return ok;
+}
+
+/* 함수 목적: 파일 내용을 통째로 교체합니다. (임시 파일에 쓴 뒤 rename)
+ *           쓰기 스레드가 동작 중이면 같은 경로의 앞선 append 뒤에 순서대로 반영됩니다.
+ * 매개변수: path, data, len
+ * 반환 값: 성공 1, 실패 0
+ */
+int csv_write_file(const char *path, const char *data, size_t len) {
+    if (!path || (!data && len > 0) || strlen(path) >= CSV_PATH_MAX) return 0;
+    if (io_writer_running()) {
+        return io_writer_submit(apply_replace, path, data, len, 0);
+    }
+    return replace_file(path, data, len);
+}
+
+/* 함수 목적: 파일의 offset 위치에 len 바이트를 제자리에서 덮어씁니다. (pwrite)
+ *           고정 길이 레코드 파일에서 바뀐 레코드 하나만 쓸 때 사용합니다.
+ *           쓰기 스레드가 동작 중이면 같은 경로의 앞선 쓰기 뒤에 순서대로 반영됩니다.
+ * 매개변수: path, offset, data, len
+ * 반환 값: 성공 1, 실패 0
+ */
+int csv_write_at(const char *path, long long offset, const char *data, size_t len) {
+    if (!path || !data || len == 0 || offset < 0 || strlen(path) >= CSV_PATH_MAX) return 0;
+    if (io_writer_running()) {
+        return io_writer_submit(apply_write_at, path, data, len, offset);
+    }
+    return write_at(path, data, len, offset);
+}
+
+/* 함수 목적: 파일을 지웁니다. 쓰기 스레드가 동작 중이면 큐를 거쳐 순서대로 지웁니다.
+ * 매개변수: path
+ * 반환 값: 성공 1, 실패 0
+ */
+int csv_remove_file(const char *path) {
+    if (!path) return 0;
+    if (io_writer_running()) {
+        return io_writer_submit(apply_remove, path, NULL, 0, 0);
+    }
+    close_handle(find_handle(path));
+    close_rw_handle(path);
+    return remove(path) == 0;
+}
+
+/* 함수 목적: 백그라운드 쓰기 스레드를 시작합니다. 이후의 모든 쓰기는 큐를 거칩니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부 (실패하면 동기식으로 계속 동작)
+ */
+int csv_async_start(void) {
+    if (io_writer_running()) return 1;
+    flush_handles();
+    return io_writer_start(writer_flush);
+}
+
+/* 함수 목적: 백그라운드 쓰기 스레드가 도는지 알려 줍니다.
+ * 매개변수: 없음
+ * 반환 값: 돌고 있으면 1
+ */
+int csv_async_running(void) {
+    return io_writer_running();
+}
+
+/* 함수 목적: 남은 쓰기를 모두 반영하고 쓰기 스레드를 멈춘 뒤 핸들을 닫습니다.
+ * 매개변수: 없음
+ * 반환 값: 잃은 쓰기가 남은 경로가 없으면 1, 있으면 0
+ */
+int csv_shutdown(void) {
+    io_writer_stop();
+    flush_handles();
+    for (int i = 0; i < CSV_HANDLE_SLOTS; ++i) {
+        close_handle(&g_handles[i]);
+    }
+    close_rw_handle(NULL);
+    return write_status(NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  구분자 스캐너: 64바이트 블록마다 구분자/개행 위치를 비트맵으로 만든다        */
+/* -------------------------------------------------------------------------- */
+
+typedef void (*CsvScanFn)(const char *p, char delim, uint64_t *delim_bits, uint64_t *nl_bits);
+
+/* 함수 목적: 64바이트 블록을 한 바이트씩 비교하는 이식용 구현입니다.
+ * 매개변수: p, delim, delim_bits, nl_bits
+ * 반환 값: 없음
+ */
+static void scan_block_scalar(const char *p, char delim, uint64_t *delim_bits, uint64_t *nl_bits) {
+    uint64_t d = 0, n = 0;
+    for (int i = 0; i < CSV_SCAN_BLOCK; ++i) {
+        d |= (uint64_t)(p[i] == delim) << i;
+        n |= (uint64_t)(p[i] == '\n') << i;
+    }
+    *delim_bits = d;
+    *nl_bits = n;
+}
+
+#if defined(CSV_SCAN_X86)
+/* 함수 목적: SSE2 로 16바이트씩 네 번 비교합니다.
+ * 매개변수: p, delim, delim_bits, nl_bits
+ * 반환 값: 없음
+ */
+__attribute__((target("sse2")))
+static void scan_block_sse2(const char *p, char delim, uint64_t *delim_bits, uint64_t *nl_bits) {
+    const __m128i vd = _mm_set1_epi8(delim);
+    const __m128i vn = _mm_set1_epi8('\n');
+    uint64_t d = 0, n = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i * 16));
+        d |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vd)) << (i * 16);
+        n |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vn)) << (i * 16);
+    }
+    *delim_bits = d;
+    *nl_bits = n;
+}
+
+/* 함수 목적: AVX2 로 32바이트씩 두 번 비교합니다.
+ * 매개변수: p, delim, delim_bits, nl_bits
+ * 반환 값: 없음
+ */
+__attribute__((target("avx2")))
+static void scan_block_avx2(const char *p, char delim, uint64_t *delim_bits, uint64_t *nl_bits) {
+    const __m256i vd = _mm256_set1_epi8(delim);
+    const __m256i vn = _mm256_set1_epi8('\n');
+    __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 32));
+    *delim_bits = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, vd)) |
+                  (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, vd)) << 32;
+    *nl_bits = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, vn)) |
+               (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, vn)) << 32;
+}
+#endif
+
+static CsvScanFn g_scan_block = NULL;
+
+/* 함수 목적: 실행 중인 CPU 에 맞는 블록 스캐너를 고릅니다. (처음 한 번)
+ * 매개변수: 없음
+ * 반환 값: 스캐너 함수
+ */
+static CsvScanFn scan_impl(void) {
+    CsvScanFn fn = g_scan_block;
+    if (fn) return fn;
+    fn = scan_block_scalar;
+#if defined(CSV_SCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        fn = scan_block_avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        fn = scan_block_sse2;
+    }
+#endif
+    g_scan_block = fn;
+    return fn;
+}
+
+/* 함수 목적: 최대 64바이트 블록에서 구분자와 개행의 위치를 비트맵으로 돌려줍니다.
+ *           (비트 i 가 p[i] 에 해당) 64바이트보다 짧으면 남는 비트는 0 입니다.
+ * 매개변수: p, len, delim, delim_bits, nl_bits
+ * 반환 값: 없음
+ */
+void csv_scan_block(const char *p, size_t len, char delim, uint64_t *delim_bits, uint64_t *nl_bits) {
+    uint64_t d = 0, n = 0;
+    if (len >= CSV_SCAN_BLOCK) {
+        scan_impl()(p, delim, &d, &n);
+    } else if (len > 0) {
+        /* 블록 끝을 넘어 읽지 않도록 짧은 꼬리는 채움 바이트로 복사해 검사 */
+        char pad[CSV_SCAN_BLOCK];
+        memset(pad, delim == '\0' ? 0x01 : '\0', sizeof(pad));
+        memcpy(pad, p, len);
+        scan_impl()(pad, delim, &d, &n);
+    }
+    if (delim_bits) *delim_bits = d;
+    if (nl_bits) *nl_bits = n;
+}
+
+/* 함수 목적: [p, p+len) 에서 처음 나오는 구분자 또는 개행을 찾습니다.
+ *           줄 나누기는 delim 에 '\n' 을 넘겨 씁니다.
+ * 매개변수: p, len, delim
+ * 반환 값: 찾은 위치, 없으면 NULL
+ */
+const char *csv_scan_find(const char *p, size_t len, char delim) {
+    if (!p) return NULL;
+    size_t off = 0;
+    while (off < len) {
+        size_t chunk = len - off < CSV_SCAN_BLOCK ? len - off : CSV_SCAN_BLOCK;
+        uint64_t d = 0, n = 0;
+        csv_scan_block(p + off, chunk, delim, &d, &n);
+        uint64_t hits = d | n;
+        if (hits) return p + off + (size_t)__builtin_ctzll(hits);
+        off += chunk;
+    }
+    return NULL;
+}
+
+/* 함수 목적: [p, p+len) 의 개행 개수를 셉니다.
+ * 매개변수: p, len
+ * 반환 값: 개행 개수
+ */
+size_t csv_scan_count_newlines(const char *p, size_t len) {
+    size_t count = 0;
+    for (size_t off = 0; off < len; off += CSV_SCAN_BLOCK) {
+        size_t chunk = len - off < CSV_SCAN_BLOCK ? len - off : CSV_SCAN_BLOCK;
+        uint64_t n = 0;
+        csv_scan_block(p + off, chunk, '\n', NULL, &n);
+        count += (size_t)__builtin_popcountll(n);
+    }
+    return count;
+}
+
+/* 뒤에서부터 읽을 때 한 번에 읽는 블록 크기 */
+#define CSV_TAIL_BLOCK 4096
+/* 역방향 커서가 소진되었음을 나타내는 값 */
+#define CSV_TAIL_DONE ((size_t)-1)
+
+/* 함수 목적: 파일 끝에서부터 블록 단위로 거슬러 올라가며 마지막 max_lines 줄이
+ *           시작되는 지점을 찾고, 그 구간만 하나의 버퍼로 읽어옵니다.
+ *           max_lines 번째 개행을 찾는 즉시 멈추므로 비용은 파일 크기가 아니라
+ *           요청한 줄 수에 비례합니다. max_lines <= 0 이면 파일 전체를 읽습니다.
+ * 매개변수: f, max_lines, extra, out_buf, out_len
+ *           (extra: 호출자가 뒤에 덧붙일 수 있도록 여유로 확보할 바이트 수)
+ * 반환 값: 성공 1, 실패 0. 성공 시 *out_buf 는 NUL 종료된 malloc 버퍼입니다.
+ */
+static int tail_read_region(FILE *f, int max_lines, size_t extra, char **out_buf, size_t *out_len) {
+    if (fseek(f, 0, SEEK_END) != 0) return 0;
+    long size = ftell(f);
+    if (size < 0) return 0;
+
+    /* 블록을 앞쪽으로 붙여 나가기 위해 데이터는 [cap - len, cap) 에 유지합니다. */
+    size_t cap = CSV_TAIL_BLOCK * 2;
+    size_t len = 0;
+    char *buf = malloc(cap + extra + 1);
+    if (!buf) return 0;
+
+    long end = size;
+    long region_start = 0;
+    int newlines = 0;
+    int found = 0;
+    while (end > 0 && !found) {
+        size_t chunk = end >= CSV_TAIL_BLOCK ? CSV_TAIL_BLOCK : (size_t)end;
+        long off = end - (long)chunk;
+        if (len + chunk > cap) {
+            size_t ncap = cap * 2;
+            while (ncap < len + chunk) ncap *= 2;
+            char *nbuf = malloc(ncap + extra + 1);
+            if (!nbuf) {
+                free(buf);
+                return 0;
+            }
+            memcpy(nbuf + ncap - len, buf + cap - len, len);
+            free(buf);
+            buf = nbuf;
+            cap = ncap;
+        }
+        char *dst = buf + cap - len - chunk;
+        if (fseek(f, off, SEEK_SET) != 0 || fread(dst, 1, chunk, f) != chunk) {
+            free(buf);
+            return 0;
+        }
+        if (max_lines > 0) {
+            /* 64바이트 단위로 개행 비트맵을 만들어 뒤에서부터 센다.
+             * 필요한 개수에 못 미치는 블록은 popcount 로 한 번에 건너뛴다. */
+            size_t bend = chunk;
+            while (bend > 0 && !found) {
+                size_t bstart = bend >= CSV_SCAN_BLOCK ? bend - CSV_SCAN_BLOCK : 0;
+                uint64_t nl = 0;
+                csv_scan_block(dst + bstart, bend - bstart, '\n', NULL, &nl);
+                /* 파일 마지막 개행은 마지막 줄의 끝일 뿐 구분자가 아님 */
+                if (off + (long)bend == size && dst[bend - 1] == '\n') {
+                    nl &= ~((uint64_t)1 << (bend - bstart - 1));
+                }
+                int cnt = __builtin_popcountll(nl);
+                if (newlines + cnt < max_lines) {
+                    newlines += cnt;
+                } else {
+                    /* 이 블록 안에서 위쪽 비트부터 하나씩 지워 정확한 위치를 찾는다 */
+                    while (nl) {
+                        int bit = 63 - __builtin_clzll(nl);
+                        if (++newlines == max_lines) {
+                            region_start = off + (long)(bstart + (size_t)bit) + 1;
+                            found = 1;
+                            break;
+                        }
+                        nl &= ~((uint64_t)1 << bit);
+                    }
+                }
+                bend = bstart;
+            }
+        }
+        len += chunk;
+        end = off;
+    }
+
+    /* 찾은 구간을 버퍼 앞쪽으로 한 번만 옮깁니다. */
+    size_t region_len = (size_t)(size - region_start);
+    memmove(buf, buf + cap - region_len, region_len);
+    buf[region_len] = '\0';
+    *out_buf = buf;
+    *out_len = region_len;
     return 1;
 }
 
-/* 함수 목적: csv_read_last_lines 함수는 핵심 유틸리티 및 데이터 처리 구현에서 필요한 동작을 수행합니다.
+/* 함수 목적: 파일의 마지막 max_lines 줄을 하나의 버퍼로 읽어옵니다.
+ *           각 줄은 개행으로 끝나도록 보장됩니다.
  * 매개변수: path, max_lines, out_buf, out_len
  * 반환 값: 함수 수행 결과를 나타냅니다.
  */
 int csv_read_last_lines(const char *path, int max_lines, char **out_buf, size_t *out_len) {
     if (!path || !out_buf || !out_len) return 0;
-    FILE *f = fopen(path, "r");
+    *out_buf = NULL;
+    *out_len = 0;
+    csv_flush_path(path);
+    FILE *f = fopen(path, "rb");
     if (!f) {
-        *out_buf = NULL;
-        *out_len = 0;
         return 0;
     }
-    char *lines[1024];
-    int count = 0;
-    size_t cap = 0;
-    char tmp[1024];
-    while (fgets(tmp, sizeof(tmp), f) != NULL) {
-        if (count < (int) (sizeof(lines)/sizeof(lines[0]))) {
-            lines[count++] = strdup(tmp);
-        } else {
-            free(lines[0]);
-            lines[0] = NULL;
-            memmove(lines, lines+1, (count-1)*sizeof(char*));
-            lines[count-1] = strdup(tmp);
-        }
-    }
+    char *buf = NULL;
+    size_t len = 0;
+    int ok = tail_read_region(f, max_lines, 1, &buf, &len);
     fclose(f);
+    if (!ok) return 0;
 
-    int start = 0;
-    if (max_lines > 0 && count > max_lines) start = count - max_lines;
-
-    /* compute total length */
-    for (int i = start; i < count; ++i) {
-        cap += strlen(lines[i]) + 1;
+    /* ensure newline at end */
+    if (len > 0 && buf[len - 1] != '\n') {
+        buf[len++] = '\n';
+        buf[len] = '\0';
     }
-    char *buf = malloc(cap + 1);
-    if (!buf) {
-        for (int i = 0; i < count; ++i) {
-            free(lines[i]);
-            lines[i] = NULL;
-        }
+    *out_buf = buf;
+    *out_len = len;
+    return 1;
+}
+
+/* 함수 목적: 파일의 마지막 max_lines 줄을 순회하는 반복자를 엽니다.
+ *           버퍼는 한 번만 읽고 이후 줄은 복사 없이 슬라이스로 돌려줍니다.
+ * 매개변수: it, path, max_lines
+ * 반환 값: 성공 1, 파일이 없거나 실패 시 0
+ */
+int csv_tail_open(CsvTail *it, const char *path, int max_lines) {
+    if (!it) return 0;
+    memset(it, 0, sizeof(*it));
+    it->rpos = CSV_TAIL_DONE;
+    if (!path) return 0;
+    csv_flush_path(path);
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    int ok = tail_read_region(f, max_lines, 0, &it->buf, &it->len);
+    fclose(f);
+    if (!ok) {
+        it->buf = NULL;
+        it->len = 0;
         return 0;
     }
-    buf[0] = '\0';
-    for (int i = start; i < count; ++i) {
-        strcat(buf, lines[i]);
-        /* ensure newline at end */
-        size_t L = strlen(buf);
-        if (L == 0 || buf[L-1] != '\n') strcat(buf, "\n");
-        free(lines[i]);
-        lines[i] = NULL;
+    if (it->len > 0) {
+        it->rpos = it->buf[it->len - 1] == '\n' ? it->len - 1 : it->len;
     }
+    return 1;
+}
 
-    *out_buf = buf;
-    *out_len = strlen(buf);
+/* 함수 목적: 줄 끝의 '\r' 을 잘라낸 길이를 돌려줍니다.
+ * 매개변수: line, len
+ * 반환 값: 잘라낸 뒤의 길이
+ */
+static size_t strip_cr(const char *line, size_t len) {
+    if (len > 0 && line[len - 1] == '\r') len--;
+    return len;
+}
+
+/* 함수 목적: 다음 줄(오래된 줄부터)을 돌려줍니다.
+ * 매개변수: it, line, len
+ * 반환 값: 줄이 있으면 1, 끝이면 0
+ */
+int csv_tail_next(CsvTail *it, const char **line, size_t *len) {
+    if (!it || !it->buf || it->pos >= it->len || !line || !len) return 0;
+    const char *start = it->buf + it->pos;
+    const char *nl = csv_scan_find(start, it->len - it->pos, '\n');
+    size_t n = nl ? (size_t)(nl - start) : it->len - it->pos;
+    it->pos += n + (nl ? 1 : 0);
+    *line = start;
+    *len = strip_cr(start, n);
     return 1;
 }
+
+/* 함수 목적: 이전 줄(최신 줄부터)을 돌려줍니다.
+ * 매개변수: it, line, len
+ * 반환 값: 줄이 있으면 1, 끝이면 0
+ */
+int csv_tail_prev(CsvTail *it, const char **line, size_t *len) {
+    if (!it || !it->buf || it->rpos == CSV_TAIL_DONE || !line || !len) return 0;
+    size_t end = it->rpos;
+    size_t start = end;
+    while (start > 0 && it->buf[start - 1] != '\n') start--;
+    it->rpos = start > 0 ? start - 1 : CSV_TAIL_DONE;
+    *line = it->buf + start;
+    *len = strip_cr(*line, end - start);
+    return 1;
+}
+
+/* 함수 목적: 반복자가 잡고 있는 버퍼를 해제합니다.
+ * 매개변수: it
+ * 반환 값: 없음
+ */
+void csv_tail_close(CsvTail *it) {
+    if (!it) return;
+    free(it->buf);
+    memset(it, 0, sizeof(*it));
+    it->rpos = CSV_TAIL_DONE;
+}
@@ -0,0 +1,307 @@
+
+#include "../../include/core/csv_cursor.h"
+#include "../../include/core/csv.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* 함수 목적: 파일 전체를 읽기 전용으로 메모리에 매핑합니다.
+ * 매개변수: path, out_map, out_len
+ * 반환 값: 성공 1, 파일이 없거나 실패 시 0. 빈 파일은 *out_map 이 NULL 인 채로 성공입니다.
+ */
+int csv_map_file(const char *path, void **out_map, size_t *out_len) {
+    *out_map = NULL;
+    *out_len = 0;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return 0;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return 1;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return 0;
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) return 0;
+    *out_map = view;
+    *out_len = (size_t)size.QuadPart;
+    return 1;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return 0;
+#if defined(MADV_SEQUENTIAL)
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    *out_map = map;
+    *out_len = (size_t)st.st_size;
+    return 1;
+#endif
+}
+
+/* 스캐너 블록 크기 (csv_scan_block 과 같아야 함) */
+#define CURSOR_BLOCK 64
+
+/* 함수 목적: from 이후 처음 나오는 구분자 또는 개행 위치를 찾습니다.
+ *           64바이트 블록마다 비트맵을 한 번만 만들고, 같은 블록 안의 다음
+ *           필드나 행은 남은 비트에서 바로 꺼냅니다.
+ * 매개변수: c, from, nl_only (1 이면 개행만 찾음)
+ * 반환 값: 찾은 오프셋, 없으면 c->len
+ */
+static size_t cursor_find(CsvCursor *c, size_t from, int nl_only) {
+    while (from < c->len) {
+        size_t blk = from & ~(size_t)(CURSOR_BLOCK - 1);
+        if (!c->blk_valid || c->blk_off != blk || c->blk_sep != c->delim) {
+            size_t n = c->len - blk < CURSOR_BLOCK ? c->len - blk : CURSOR_BLOCK;
+            uint64_t d = 0, nl = 0;
+            csv_scan_block(c->data + blk, n, c->delim, &d, &nl);
+            c->blk_off = blk;
+            c->blk_delim = d;
+            c->blk_nl = nl;
+            c->blk_sep = c->delim;
+            c->blk_valid = 1;
+        }
+        uint64_t m = nl_only ? c->blk_nl : (c->blk_delim | c->blk_nl);
+        m &= ~(uint64_t)0 << (from - blk);
+        if (m) return blk + (size_t)__builtin_ctzll(m);
+        from = blk + CURSOR_BLOCK;
+    }
+    return c->len;
+}
+
+/* 함수 목적: 호출자가 가진 메모리 구간 위에 커서를 만듭니다. (한 줄만 파싱할 때 등)
+ * 매개변수: c, data, len, delim
+ * 반환 값: 없음
+ */
+void csv_cursor_init(CsvCursor *c, const char *data, size_t len, char delim) {
+    if (!c) return;
+    memset(c, 0, sizeof(*c));
+    c->data = data ? data : "";
+    c->len = data ? len : 0;
+    c->delim = delim;
+    c->fpos = 1; /* 아직 행이 없음 */
+}
+
+/* 함수 목적: 파일을 매핑해 커서를 엽니다. 쓰기 스레드에 남은 쓰기를 먼저 반영합니다.
+ * 매개변수: c, path, delim
+ * 반환 값: 성공 1, 파일이 없거나 실패 시 0
+ */
+int csv_cursor_open(CsvCursor *c, const char *path, char delim) {
+    if (!c) return 0;
+    csv_cursor_init(c, NULL, 0, delim);
+    if (!path) return 0;
+    csv_flush_path(path);
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(path, &map, &len)) return 0;
+    c->map = map;
+    c->map_len = len;
+    if (map) {
+        c->data = (const char *)map;
+        c->len = len;
+    }
+    return 1;
+}
+
+/* 함수 목적: 매핑을 해제합니다.
+ * 매개변수: c
+ * 반환 값: 없음
+ */
+void csv_cursor_close(CsvCursor *c) {
+    if (!c) return;
+    csv_unmap_file(c->map, c->map_len);
+    memset(c, 0, sizeof(*c));
+}
+
+/* 함수 목적: csv_map_file 로 만든 매핑을 해제합니다.
+ * 매개변수: map, len
+ * 반환 값: 없음
+ */
+void csv_unmap_file(void *map, size_t len) {
+    if (!map) return;
+#if defined(_WIN32)
+    (void)len;
+    UnmapViewOfFile(map);
+#else
+    munmap(map, len);
+#endif
+}
+
+/* 함수 목적: 다음 행으로 이동합니다. 빈 줄은 건너뜁니다.
+ * 매개변수: c
+ * 반환 값: 행이 있으면 1, 끝이면 0
+ */
+int csv_cursor_next_row(CsvCursor *c) {
+    if (!c) return 0;
+    while (c->pos < c->len) {
+        const char *start = c->data + c->pos;
+        size_t nl = cursor_find(c, c->pos, 1);
+        size_t n = nl - c->pos;
+        c->pos = nl < c->len ? nl + 1 : c->len;
+        if (n > 0 && start[n - 1] == '\r') n--;
+        if (n == 0) continue;
+        c->row.ptr = start;
+        c->row.len = n;
+        c->fpos = 0;
+        return 1;
+    }
+    c->row.ptr = NULL;
+    c->row.len = 0;
+    c->fpos = 1;
+    return 0;
+}
+
+/* 함수 목적: 현재 행의 다음 필드를 돌려줍니다.
+ * 매개변수: c, out
+ * 반환 값: 필드가 있으면 1, 행 끝이면 0
+ */
+int csv_cursor_next_field(CsvCursor *c, CsvField *out) {
+    if (!c || !out || c->fpos > c->row.len) return 0;
+    const char *start = c->row.ptr + c->fpos;
+    size_t avail = c->row.len - c->fpos;
+    /* 행 끝(개행 또는 '\r') 너머에서 걸린 위치는 구분자가 아님 */
+    size_t base = (size_t)(start - c->data);
+    size_t hit = cursor_find(c, base, 0);
+    size_t n = hit - base < avail ? hit - base : avail;
+    int found = hit - base < avail;
+    out->ptr = start;
+    out->len = n;
+    /* 구분자 뒤로 이동. 마지막 필드였다면 row.len + 1 이 되어 끝을 표시 */
+    c->fpos += n + 1;
+    if (!found) c->fpos = c->row.len + 1;
+    return 1;
+}
+
+/* 함수 목적: 현재 행에서 아직 읽지 않은 나머지 전체를 하나의 필드로 돌려줍니다.
+ * 매개변수: c, out
+ * 반환 값: 남은 부분이 있으면 1
+ */
+int csv_cursor_rest(CsvCursor *c, CsvField *out) {
+    if (!c || !out || c->fpos > c->row.len) return 0;
+    out->ptr = c->row.ptr + c->fpos;
+    out->len = c->row.len - c->fpos;
+    c->fpos = c->row.len + 1;
+    return 1;
+}
+
+/* 함수 목적: 현재 행의 남은 필드를 최대 max 개까지 한 번에 나눕니다.
+ * 매개변수: c, out, max
+ * 반환 값: 채운 필드 수
+ */
+int csv_cursor_fields(CsvCursor *c, CsvField *out, int max) {
+    int n = 0;
+    while (n < max && csv_cursor_next_field(c, &out[n])) n++;
+    return n;
+}
+
+/* 함수 목적: 필드 앞뒤의 공백을 잘라냅니다. (복사 없음)
+ * 매개변수: f
+ * 반환 값: 잘라낸 필드
+ */
+CsvField csv_field_trim(CsvField f) {
+    while (f.len > 0 && (*f.ptr == ' ' || *f.ptr == '\t')) {
+        f.ptr++;
+        f.len--;
+    }
+    while (f.len > 0 && (f.ptr[f.len - 1] == ' ' || f.ptr[f.len - 1] == '\t')) f.len--;
+    return f;
+}
+
+/* 함수 목적: 필드가 문자열 s 와 정확히 같은지 비교합니다.
+ * 매개변수: f, s
+ * 반환 값: 같으면 1
+ */
+int csv_field_eq(CsvField f, const char *s) {
+    if (!s) return 0;
+    size_t n = strlen(s);
+    return n == f.len && (n == 0 || memcmp(f.ptr, s, n) == 0);
+}
+
+/* 함수 목적: 필드 앞부분의 정수를 읽습니다. (부호 허용, 앞 공백 무시)
+ * 매개변수: f, out
+ * 반환 값: 숫자가 하나라도 있으면 1
+ */
+int csv_field_long(CsvField f, long *out) {
+    f = csv_field_trim(f);
+    size_t i = 0;
+    int neg = 0;
+    if (i < f.len && (f.ptr[i] == '-' || f.ptr[i] == '+')) neg = f.ptr[i++] == '-';
+    size_t digits_start = i;
+    unsigned long v = 0;
+    while (i < f.len && f.ptr[i] >= '0' && f.ptr[i] <= '9') {
+        v = v * 10 + (unsigned long)(f.ptr[i] - '0');
+        i++;
+    }
+    if (i == digits_start) return 0;
+    if (out) *out = neg ? -(long)v : (long)v;
+    return 1;
+}
+
+/* 함수 목적: 필드 앞부분의 정수를 int 로 읽습니다.
+ * 매개변수: f, out
+ * 반환 값: 숫자가 하나라도 있으면 1
+ */
+int csv_field_int(CsvField f, int *out) {
+    long v = 0;
+    if (!csv_field_long(f, &v)) return 0;
+    if (out) *out = (int)v;
+    return 1;
+}
+
+/* 함수 목적: 필드 앞부분의 실수를 읽습니다.
+ * 매개변수: f, out
+ * 반환 값: 숫자를 읽었으면 1
+ */
+int csv_field_double(CsvField f, double *out) {
+    f = csv_field_trim(f);
+    char tmp[64];
+    if (f.len == 0 || f.len >= sizeof(tmp)) return 0;
+    memcpy(tmp, f.ptr, f.len);
+    tmp[f.len] = '\0';
+    char *end = NULL;
+    double v = strtod(tmp, &end);
+    if (end == tmp) return 0;
+    if (out) *out = v;
+    return 1;
+}
+
+/* 함수 목적: 필드를 NUL 종료 문자열로 복사합니다. 넘치면 잘라냅니다.
+ * 매개변수: f, dst, cap
+ * 반환 값: 복사한 바이트 수
+ */
+size_t csv_field_copy(CsvField f, char *dst, size_t cap) {
+    if (!dst || cap == 0) return 0;
+    size_t n = f.len < cap - 1 ? f.len : cap - 1;
+    if (n > 0) memcpy(dst, f.ptr, n);
+    dst[n] = '\0';
+    return n;
+}
@@ -0,0 +1,273 @@
+/*
+ * 파일 목적: 덧붙이기 전용 CSV 파일의 줄 오프셋 색인(<path>.idx) 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/csv_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
+
+#define CSV_INDEX_MAGIC 0x58495243u /* "CRIX" */
+#define CSV_INDEX_VERSION 1u
+
+typedef struct CsvIndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t stride;
+    uint32_t reserved;
+    uint64_t lines;
+    int64_t covered;
+} CsvIndexHeader;
+
+/* 함수 목적: 색인 파일 경로(<path>.idx)를 만듭니다.
+ * 매개변수: ix, out, cap
+ * 반환 값: 없음
+ */
+static void index_path(const CsvIndex *ix, char *out, size_t cap) {
+    snprintf(out, cap, "%s.idx", ix->path);
+}
+
+/* 함수 목적: 줄 앞의 정수(타임스탬프 열)를 읽습니다. 숫자가 없으면 0 입니다.
+ * 매개변수: line, len
+ * 반환 값: 키
+ */
+static int64_t line_key(const char *line, size_t len) {
+    size_t i = 0;
+    while (i < len && (line[i] == ' ' || line[i] == '\t')) i++;
+    int neg = 0;
+    if (i < len && line[i] == '-') {
+        neg = 1;
+        i++;
+    }
+    int64_t v = 0;
+    while (i < len && line[i] >= '0' && line[i] <= '9') {
+        v = v * 10 + (line[i] - '0');
+        i++;
+    }
+    return neg ? -v : v;
+}
+
+/* 함수 목적: 항목 하나를 메모리 색인 끝에 붙입니다. 배열은 두 배씩 늘립니다.
+ * 매개변수: ix, offset, key
+ * 반환 값: 성공 여부
+ */
+static int push_entry(CsvIndex *ix, int64_t offset, int64_t key) {
+    if (ix->count == ix->cap) {
+        size_t ncap = ix->cap ? ix->cap * 2 : 64;
+        CsvIndexEntry *n = realloc(ix->entries, ncap * sizeof(*n));
+        if (!n) return 0;
+        ix->entries = n;
+        ix->cap = ncap;
+    }
+    ix->entries[ix->count].offset = offset;
+    ix->entries[ix->count].key = key;
+    ix->count++;
+    return 1;
+}
+
+/* 함수 목적: 색인 파일을 읽어 메모리 색인을 채웁니다. 형식이 다르거나 잘렸으면 비워 둡니다.
+ * 매개변수: ix
+ * 반환 값: 읽었으면 1
+ */
+static int load_index(CsvIndex *ix) {
+    char path[sizeof(ix->path) + 8];
+    index_path(ix, path, sizeof(path));
+    csv_flush_path(path);
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(path, &map, &len) || !map) return 0;
+    int ok = 0;
+    CsvIndexHeader hdr;
+    if (len >= sizeof(hdr)) {
+        memcpy(&hdr, map, sizeof(hdr));
+        uint64_t want = hdr.stride ? (hdr.lines + hdr.stride - 1) / hdr.stride : 0;
+        if (hdr.magic == CSV_INDEX_MAGIC && hdr.version == CSV_INDEX_VERSION && hdr.stride == ix->stride &&
+            want <= (len - sizeof(hdr)) / sizeof(CsvIndexEntry)) {
+            const CsvIndexEntry *src = (const CsvIndexEntry *)((const char *)map + sizeof(hdr));
+            ok = 1;
+            for (uint64_t i = 0; i < want && ok; ++i) {
+                ok = push_entry(ix, src[i].offset, src[i].key);
+            }
+            if (ok) {
+                ix->lines = hdr.lines;
+                ix->covered = hdr.covered;
+            }
+        }
+    }
+    csv_unmap_file(map, len);
+    if (!ok) {
+        ix->count = 0;
+        ix->lines = 0;
+        ix->covered = 0;
+    }
+    return ok;
+}
+
+/* 함수 목적: 색인 파일을 씁니다. 전체를 새로 쓰거나, from 번째 항목부터 덧붙이고 헤더만 고칩니다.
+ * 매개변수: ix, from, whole
+ * 반환 값: 성공 여부
+ */
+static int store_index(const CsvIndex *ix, size_t from, int whole) {
+    char path[sizeof(ix->path) + 8];
+    index_path(ix, path, sizeof(path));
+    CsvIndexHeader hdr = {CSV_INDEX_MAGIC, CSV_INDEX_VERSION, ix->stride, 0, ix->lines, ix->covered};
+    if (whole) {
+        size_t len = sizeof(hdr) + ix->count * sizeof(CsvIndexEntry);
+        char *buf = malloc(len);
+        if (!buf) return 0;
+        memcpy(buf, &hdr, sizeof(hdr));
+        if (ix->count > 0) memcpy(buf + sizeof(hdr), ix->entries, ix->count * sizeof(CsvIndexEntry));
+        int ok = csv_write_file(path, buf, len);
+        free(buf);
+        return ok;
+    }
+    /* 새 항목을 먼저 쓰고 헤더를 나중에 고쳐야, 중간에 멈춰도 헤더가 없는 항목을 가리키지 않는다 */
+    if (from < ix->count) {
+        long long off = (long long)sizeof(hdr) + (long long)from * (long long)sizeof(CsvIndexEntry);
+        if (!csv_write_at(path, off, (const char *)(ix->entries + from), (ix->count - from) * sizeof(CsvIndexEntry))) {
+            return 0;
+        }
+    }
+    return csv_write_at(path, 0, (const char *)&hdr, sizeof(hdr));
+}
+
+/* 함수 목적: 데이터 파일을 열어 색인을 불러오고 마지막 동기화 이후 덧붙은 줄을 반영합니다.
+ * 매개변수: ix, path
+ * 반환 값: 성공 여부 (데이터 파일이 없으면 빈 색인으로 성공)
+ */
+int csv_index_open(CsvIndex *ix, const char *path) {
+    if (!ix) return 0;
+    memset(ix, 0, sizeof(*ix));
+    if (!path) return 0;
+    snprintf(ix->path, sizeof(ix->path), "%s", path);
+    ix->stride = CSV_INDEX_STRIDE;
+    load_index(ix);
+    return csv_index_sync(ix);
+}
+
+/* 함수 목적: 색인이 덮은 곳 뒤로 덧붙은 완결된 줄을 색인에 더합니다.
+ *           데이터 파일이 줄었거나 덮은 끝이 줄 경계가 아니면(파일이 교체됨) 처음부터 다시 만듭니다.
+ *           개행으로 끝나지 않은 마지막 줄은 다음 동기화까지 미룹니다.
+ * 매개변수: ix
+ * 반환 값: 성공 여부
+ */
+int csv_index_sync(CsvIndex *ix) {
+    if (!ix || !ix->path[0]) return 0;
+    csv_flush_path(ix->path);
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(ix->path, &map, &len)) {
+        ix->count = 0;
+        ix->lines = 0;
+        ix->covered = 0;
+        return 1;
+    }
+    const char *data = map;
+    int whole = 0;
+    if ((uint64_t)ix->covered > len || (ix->covered > 0 && data[ix->covered - 1] != '\n')) {
+        ix->count = 0;
+        ix->lines = 0;
+        ix->covered = 0;
+        whole = 1;
+    }
+    size_t from = ix->count;
+    uint64_t old_lines = ix->lines;
+    size_t pos = (size_t)ix->covered;
+    while (pos < len) {
+        const char *nl = csv_scan_find(data + pos, len - pos, '\n');
+        if (!nl) break;
+        size_t line_len = (size_t)(nl - (data + pos));
+        if (ix->lines % ix->stride == 0 && !push_entry(ix, (int64_t)pos, line_key(data + pos, line_len))) {
+            break;
+        }
+        ix->lines++;
+        pos += line_len + 1;
+        ix->covered = (int64_t)pos;
+    }
+    csv_unmap_file(map, len);
+    if (ix->lines == old_lines && !whole) return 1;
+    if (from == 0) whole = 1;
+    return store_index(ix, from, whole);
+}
+
+/* 함수 목적: 메모리 색인을 해제합니다.
+ * 매개변수: ix
+ * 반환 값: 없음
+ */
+void csv_index_close(CsvIndex *ix) {
+    if (!ix) return;
+    free(ix->entries);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/* 함수 목적: first 번째 줄부터 count 줄을 차례로 넘겨줍니다. 가장 가까운 색인 항목으로
+ *           이동한 뒤 최대 stride - 1 줄만 건너뛰므로 파일 크기와 무관하게 한 페이지만 읽습니다.
+ * 매개변수: ix, first, count, fn, ctx
+ * 반환 값: 성공 여부
+ */
+int csv_index_read(const CsvIndex *ix, uint64_t first, uint64_t count, CsvIndexLineFn fn, void *ctx) {
+    if (!ix || !fn) return 0;
+    if (first >= ix->lines || count == 0) return 1;
+    if (count > ix->lines - first) count = ix->lines - first;
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(ix->path, &map, &len) || !map) return 0;
+    size_t end = (size_t)ix->covered < len ? (size_t)ix->covered : len;
+    const char *data = map;
+    uint64_t lineno = first - first % ix->stride;
+    size_t pos = (size_t)ix->entries[first / ix->stride].offset;
+    while (pos < end && lineno < first + count) {
+        const char *nl = csv_scan_find(data + pos, end - pos, '\n');
+        size_t line_len = nl ? (size_t)(nl - (data + pos)) : end - pos;
+        if (lineno >= first) {
+            size_t n = line_len;
+            if (n > 0 && data[pos + n - 1] == '\r') n--;
+            if (!fn(data + pos, n, lineno, ctx)) break;
+        }
+        lineno++;
+        pos += line_len + 1;
+    }
+    csv_unmap_file(map, len);
+    return 1;
+}
+
+typedef struct KeySearch {
+    int64_t key;
+    uint64_t found;
+} KeySearch;
+
+/* 함수 목적: 키가 목표 이상인 첫 줄을 기록하고 멈춥니다.
+ * 매개변수: line, len, lineno, ctx
+ * 반환 값: 계속 읽으면 1
+ */
+static int match_key(const char *line, size_t len, uint64_t lineno, void *ctx) {
+    KeySearch *ks = ctx;
+    if (line_key(line, len) < ks->key) return 1;
+    ks->found = lineno;
+    return 0;
+}
+
+/* 함수 목적: 키(타임스탬프)가 key 이상인 첫 줄을 찾습니다. 색인 항목을 이분 탐색한 뒤
+ *           그 앞 구간(최대 stride 줄)만 읽습니다.
+ * 매개변수: ix, key
+ * 반환 값: 줄 번호, 없으면 ix->lines
+ */
+uint64_t csv_index_find_key(const CsvIndex *ix, int64_t key) {
+    if (!ix || ix->count == 0) return ix ? ix->lines : 0;
+    size_t lo = 0, hi = ix->count; /* 첫 entries[i].key >= key 인 i */
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ix->entries[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return 0;
+    uint64_t block = (uint64_t)(lo - 1) * ix->stride;
+    KeySearch ks = {key, (uint64_t)lo * ix->stride};
+    if (ks.found > ix->lines) ks.found = ix->lines;
+    csv_index_read(ix, block, ix->stride, match_key, &ks);
+    return ks.found;
+}
@@ -0,0 +1,327 @@
+/*
+ * 파일 목적: 백그라운드 쓰기 스레드 및 무잠금(lock-free) 쓰기 큐 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/io_writer.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 큐 크기 (2의 거듭제곱이어야 함) */
+#define IO_QUEUE_CAP 1024
+#define IO_QUEUE_MASK (IO_QUEUE_CAP - 1)
+/* 한 번 깨어났을 때 flush 전에 처리할 최대 레코드 수 */
+#define IO_WRITER_BATCH 256
+/* 경로별 마지막 제출 번호를 기억하는 슬롯 수 (해시 충돌 시 더 오래 기다릴 뿐) */
+#define IO_PATH_SLOTS 256
+/* 한가할 때 잠드는 최대 시간. 깨어날 때마다 flush 정책(주기)을 다시 확인한다. */
+#define IO_WRITER_IDLE_MS 100
+
+typedef struct {
+    IoApplyFn apply;
+    char *path;
+    char *data;
+    size_t len;
+    long long offset;
+} IoRecord;
+
+/* Vyukov 방식 bounded MPMC 큐의 칸 */
+typedef struct {
+    atomic_size_t seq;
+    IoRecord rec;
+} IoCell;
+
+static IoCell g_cells[IO_QUEUE_CAP];
+static atomic_size_t g_enqueue_pos;
+static atomic_size_t g_dequeue_pos;
+
+static atomic_size_t g_path_seq[IO_PATH_SLOTS];
+/* 적용과 flush 까지 끝난 마지막 제출 번호 */
+static atomic_size_t g_completed;
+/* 완료를 기다리는 쪽이 있어 즉시 flush 가 필요함 */
+static atomic_int g_force;
+
+static pthread_t g_thread;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_wake = PTHREAD_COND_INITIALIZER;  /* 쓰기 스레드 깨우기 */
+static pthread_cond_t g_done = PTHREAD_COND_INITIALIZER;  /* 완료 번호 갱신 */
+static pthread_cond_t g_space = PTHREAD_COND_INITIALIZER; /* 큐에 빈자리 생김 */
+static atomic_int g_running;
+static atomic_int g_stop;
+static atomic_int g_sleeping;
+static IoFlushFn g_flush = NULL;
+
+/* 함수 목적: 경로 문자열을 슬롯 번호로 해시합니다. (FNV-1a)
+ * 매개변수: path
+ * 반환 값: 슬롯 번호
+ */
+static size_t path_slot(const char *path) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)path; *p; ++p) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h & (IO_PATH_SLOTS - 1);
+}
+
+/* 함수 목적: 큐에 레코드를 넣습니다. 가득 차 있으면 바로 실패합니다.
+ * 매개변수: rec, out_seq
+ * 반환 값: 성공 1, 큐가 가득 찬 경우 0
+ */
+static int queue_try_push(const IoRecord *rec, size_t *out_seq) {
+    size_t pos = atomic_load_explicit(&g_enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        IoCell *cell = &g_cells[pos & IO_QUEUE_MASK];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->rec = *rec;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                *out_seq = pos + 1;
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&g_enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/* 함수 목적: 큐에서 레코드를 꺼냅니다. (소비자는 쓰기 스레드 하나)
+ * 매개변수: out, out_seq
+ * 반환 값: 꺼냈으면 1, 비어 있으면 0
+ */
+static int queue_try_pop(IoRecord *out, size_t *out_seq) {
+    size_t pos = atomic_load_explicit(&g_dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        IoCell *cell = &g_cells[pos & IO_QUEUE_MASK];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *out = cell->rec;
+                atomic_store_explicit(&cell->seq, pos + IO_QUEUE_CAP, memory_order_release);
+                *out_seq = pos + 1;
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&g_dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/* 함수 목적: 꺼낼 수 있는 레코드가 있는지 확인합니다.
+ * 매개변수: 없음
+ * 반환 값: 있으면 1
+ */
+static int queue_has_ready(void) {
+    size_t pos = atomic_load(&g_dequeue_pos);
+    return atomic_load(&g_cells[pos & IO_QUEUE_MASK].seq) == pos + 1;
+}
+
+/* 함수 목적: 지금부터 ms 밀리초 뒤의 절대 시각을 계산합니다.
+ * 매개변수: ts, ms
+ * 반환 값: 없음
+ */
+static void deadline_in(struct timespec *ts, long ms) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec += 1;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* 함수 목적: 쓰기 스레드 본체. 큐를 비우며 레코드를 순서대로 적용하고,
+ *           한 묶음이 끝날 때마다 flush 후 완료 번호를 공개합니다.
+ * 매개변수: arg
+ * 반환 값: NULL
+ */
+static void *writer_main(void *arg) {
+    (void)arg;
+    size_t applied = 0;
+    for (;;) {
+        IoRecord rec;
+        size_t seq = 0;
+        int done = 0;
+        while (done < IO_WRITER_BATCH && queue_try_pop(&rec, &seq)) {
+            if (rec.apply) rec.apply(rec.path, rec.data, rec.len, rec.offset);
+            free(rec.path);
+            free(rec.data);
+            applied = seq;
+            done++;
+        }
+        if (done > 0) {
+            pthread_mutex_lock(&g_lock);
+            pthread_cond_broadcast(&g_space);
+            pthread_mutex_unlock(&g_lock);
+        }
+        if (applied > atomic_load(&g_completed)) {
+            /* 기다리는 쪽이 있거나 종료 중이면 정책과 무관하게 flush 한다 */
+            int force = atomic_exchange(&g_force, 0) || atomic_load(&g_stop);
+            if (!g_flush || g_flush(force)) {
+                pthread_mutex_lock(&g_lock);
+                atomic_store(&g_completed, applied);
+                pthread_cond_broadcast(&g_done);
+                pthread_mutex_unlock(&g_lock);
+            }
+        }
+        if (done > 0) continue;
+        if (atomic_load(&g_stop) && applied == atomic_load(&g_completed)) break;
+
+        /* 할 일이 없으면 잠든다. 잠들기 직전에 한 번 더 확인해 깨우기 신호를 놓치지 않는다. */
+        pthread_mutex_lock(&g_lock);
+        atomic_store(&g_sleeping, 1);
+        if (!queue_has_ready() && !atomic_load(&g_stop) && !atomic_load(&g_force)) {
+            struct timespec ts;
+            deadline_in(&ts, IO_WRITER_IDLE_MS);
+            pthread_cond_timedwait(&g_wake, &g_lock, &ts);
+        }
+        atomic_store(&g_sleeping, 0);
+        pthread_mutex_unlock(&g_lock);
+    }
+    return NULL;
+}
+
+/* 함수 목적: 쓰기 스레드를 시작합니다.
+ * 매개변수: flush (적용한 쓰기를 내보낼 함수, NULL 가능. force 가 0 이면 정책에 따라
+ *           건너뛸 수 있고, 모두 내보냈을 때 1 을 반환해야 함)
+ * 반환 값: 성공 여부
+ */
+int io_writer_start(IoFlushFn flush) {
+    if (atomic_load(&g_running)) return 1;
+    for (size_t i = 0; i < IO_QUEUE_CAP; ++i) {
+        atomic_store(&g_cells[i].seq, i);
+    }
+    atomic_store(&g_enqueue_pos, 0);
+    atomic_store(&g_dequeue_pos, 0);
+    atomic_store(&g_completed, 0);
+    for (size_t i = 0; i < IO_PATH_SLOTS; ++i) {
+        atomic_store(&g_path_seq[i], 0);
+    }
+    atomic_store(&g_stop, 0);
+    atomic_store(&g_force, 0);
+    g_flush = flush;
+    if (pthread_create(&g_thread, NULL, writer_main, NULL) != 0) {
+        return 0;
+    }
+    atomic_store(&g_running, 1);
+    return 1;
+}
+
+/* 함수 목적: 쓰기 스레드가 동작 중인지 확인합니다.
+ * 매개변수: 없음
+ * 반환 값: 동작 중이면 1
+ */
+int io_writer_running(void) {
+    return atomic_load(&g_running);
+}
+
+/* 함수 목적: 쓰기 레코드를 큐에 넣습니다. 큐가 가득 차 있으면 자리가 날 때까지 기다립니다.
+ * 매개변수: apply, path, data, len, offset
+ * 반환 값: 성공 여부
+ */
+int io_writer_submit(IoApplyFn apply, const char *path, const char *data, size_t len, long long offset) {
+    if (!apply || !path || !atomic_load(&g_running)) return 0;
+    IoRecord rec;
+    rec.apply = apply;
+    rec.path = strdup(path);
+    rec.data = malloc(len + 1);
+    rec.len = len;
+    rec.offset = offset;
+    if (!rec.path || !rec.data) {
+        free(rec.path);
+        free(rec.data);
+        return 0;
+    }
+    if (len > 0 && data) memcpy(rec.data, data, len);
+    rec.data[len] = '\0';
+
+    size_t seq = 0;
+    if (!queue_try_push(&rec, &seq)) {
+        /* backpressure: 쓰기 스레드가 자리를 비울 때까지 기다린다 */
+        pthread_mutex_lock(&g_lock);
+        while (!queue_try_push(&rec, &seq)) {
+            pthread_cond_signal(&g_wake);
+            struct timespec ts;
+            deadline_in(&ts, 5);
+            pthread_cond_timedwait(&g_space, &g_lock, &ts);
+        }
+        pthread_mutex_unlock(&g_lock);
+    }
+
+    /* 이 경로의 마지막 제출 번호를 올린다 (여러 생산자가 있어도 최댓값 유지) */
+    atomic_size_t *slot = &g_path_seq[path_slot(path)];
+    size_t cur = atomic_load(slot);
+    while (cur < seq && !atomic_compare_exchange_weak(slot, &cur, seq)) {
+    }
+
+    if (atomic_load(&g_sleeping)) {
+        pthread_mutex_lock(&g_lock);
+        pthread_cond_signal(&g_wake);
+        pthread_mutex_unlock(&g_lock);
+    }
+    return 1;
+}
+
+/* 함수 목적: 완료 번호가 target 에 도달할 때까지 기다립니다.
+ * 매개변수: target
+ * 반환 값: 없음
+ */
+static void wait_completed(size_t target) {
+    if (!atomic_load(&g_running) || pthread_equal(pthread_self(), g_thread)) return;
+    if (atomic_load(&g_completed) >= target) return;
+    pthread_mutex_lock(&g_lock);
+    while (atomic_load(&g_completed) < target) {
+        atomic_store(&g_force, 1);
+        pthread_cond_signal(&g_wake);
+        struct timespec ts;
+        deadline_in(&ts, 50);
+        pthread_cond_timedwait(&g_done, &g_lock, &ts);
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+/* 함수 목적: path 에 대해 지금까지 제출된 쓰기가 모두 반영될 때까지 기다립니다.
+ *           파일을 직접 읽기 전에 호출하여 방금 쓴 내용을 볼 수 있게 합니다.
+ * 매개변수: path
+ * 반환 값: 없음
+ */
+void io_writer_wait_path(const char *path) {
+    if (!path) return;
+    wait_completed(atomic_load(&g_path_seq[path_slot(path)]));
+}
+
+/* 함수 목적: 지금까지 제출된 모든 쓰기가 반영될 때까지 기다립니다. (drain barrier)
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void io_writer_drain(void) {
+    wait_completed(atomic_load(&g_enqueue_pos));
+}
+
+/* 함수 목적: 남은 쓰기를 모두 반영한 뒤 쓰기 스레드를 멈춥니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void io_writer_stop(void) {
+    if (!atomic_load(&g_running)) return;
+    io_writer_drain();
+    pthread_mutex_lock(&g_lock);
+    atomic_store(&g_stop, 1);
+    pthread_cond_signal(&g_wake);
+    pthread_mutex_unlock(&g_lock);
+    pthread_join(g_thread, NULL);
+    atomic_store(&g_running, 0);
+}
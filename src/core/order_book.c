@@ -0,0 +1,489 @@
+/*
+ * 파일 목적: 가격-시간 우선 지정가 주문장(매칭 엔진) 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/order_book.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define OB_NIL UINT32_MAX
+#define OB_LEVEL_MARGIN 32 /* 가격대를 새로 잡을 때 양옆으로 더 두는 칸 */
+
+typedef struct ObOrder {
+    uint64_t id; /* (순번 << 32) | 풀 번호, 0 이면 빈 칸 */
+    uint32_t next;
+    uint32_t prev;
+    uint32_t owner;
+    int book;
+    int price;
+    int leaves;
+    ObSide side;
+} ObOrder;
+
+/* 한 가격대: 같은 가격에 걸린 주문들의 FIFO. 장이 교차하지 않으므로 한 칸에는
+ * 한쪽 주문만 있다 (best_ask 보다 아래면 매수, best_bid 보다 위면 매도).
+ */
+typedef struct ObLevel {
+    uint32_t head;
+    uint32_t tail;
+    long qty;
+} ObLevel;
+
+typedef struct ObBook {
+    ObLevel *levels;
+    int lo;       /* levels[0] 의 가격 */
+    int nlevels;
+    int best_bid; /* 칸 번호, 없으면 -1 */
+    int best_ask;
+    int bids;     /* 걸려 있는 주문 수 */
+    int asks;
+} ObBook;
+
+static ObBook *g_books = NULL;
+static int g_nbooks = 0;
+
+static ObOrder *g_pool = NULL;
+static uint32_t g_pool_cap = 0;
+static uint32_t g_free = OB_NIL;
+static uint64_t g_seq = 0;
+
+static ObReport *g_reports = NULL;
+static size_t g_nreports = 0;
+static size_t g_reports_cap = 0;
+static int g_draining = 0;
+static ObReportFn g_report_fn = NULL;
+static void *g_report_ctx = NULL;
+
+/* 함수 목적: 보고를 큐에 넣습니다. 메모리가 없으면 버립니다.
+ * 매개변수: r
+ * 반환 값: 없음
+ */
+static void report(const ObReport *r) {
+    if (!g_report_fn) return;
+    if (g_nreports == g_reports_cap) {
+        size_t cap = g_reports_cap ? g_reports_cap * 2 : 64;
+        ObReport *grown = realloc(g_reports, cap * sizeof(ObReport));
+        if (!grown) return;
+        g_reports = grown;
+        g_reports_cap = cap;
+    }
+    g_reports[g_nreports++] = *r;
+}
+
+/* 함수 목적: 쌓인 보고를 콜백에 넘깁니다. 콜백 안에서 다시 주문장을 부르면 그 보고는
+ *           같은 반복에서 이어서 넘깁니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void drain(void) {
+    if (g_draining) return;
+    g_draining = 1;
+    for (size_t i = 0; i < g_nreports; ++i) {
+        ObReport r = g_reports[i]; /* 콜백이 큐를 늘리면 배열이 옮겨질 수 있다 */
+        g_report_fn(&r, g_report_ctx);
+    }
+    g_nreports = 0;
+    g_draining = 0;
+}
+
+/* 함수 목적: 주문 보고 하나를 채웁니다.
+ * 매개변수: type, o, qty, price
+ * 반환 값: 보고
+ */
+static ObReport order_report(ObExecType type, const ObOrder *o, int qty, int price) {
+    ObReport r;
+    memset(&r, 0, sizeof(r));
+    r.type = type;
+    r.order = o->id;
+    r.book = o->book;
+    r.owner = o->owner;
+    r.side = o->side;
+    r.price = price;
+    r.limit = o->price;
+    r.qty = qty;
+    r.leaves = o->leaves;
+    return r;
+}
+
+/* 함수 목적: 풀에서 주문 칸을 하나 꺼냅니다. 칸이 없으면 두 배로 늘립니다.
+ * 매개변수: 없음
+ * 반환 값: 칸 번호, 실패하면 OB_NIL
+ */
+static uint32_t order_alloc(void) {
+    if (g_free == OB_NIL) {
+        uint32_t cap = g_pool_cap ? g_pool_cap * 2 : 1024;
+        if (cap <= g_pool_cap || cap >= OB_NIL) return OB_NIL;
+        ObOrder *grown = realloc(g_pool, (size_t)cap * sizeof(ObOrder));
+        if (!grown) return OB_NIL;
+        g_pool = grown;
+        for (uint32_t i = cap; i-- > g_pool_cap;) {
+            g_pool[i].id = 0;
+            g_pool[i].next = g_free;
+            g_free = i;
+        }
+        g_pool_cap = cap;
+    }
+    uint32_t idx = g_free;
+    g_free = g_pool[idx].next;
+    g_pool[idx].id = (++g_seq << 32) | idx;
+    g_pool[idx].next = g_pool[idx].prev = OB_NIL;
+    return idx;
+}
+
+static void order_release(uint32_t idx) {
+    g_pool[idx].id = 0;
+    g_pool[idx].next = g_free;
+    g_free = idx;
+}
+
+/* 함수 목적: 주문 번호로 살아 있는 주문 칸을 찾습니다.
+ * 매개변수: id
+ * 반환 값: 칸 번호, 없으면 OB_NIL
+ */
+static uint32_t order_find(uint64_t id) {
+    uint32_t idx = (uint32_t)(id & 0xFFFFFFFFu);
+    if (id == 0 || idx >= g_pool_cap || g_pool[idx].id != id) return OB_NIL;
+    return idx;
+}
+
+/* 함수 목적: price 가 들어갈 가격대 칸을 마련합니다. 배열 밖이면 여유를 두고 늘리고
+ *           최우선 호가 칸 번호를 옮깁니다.
+ * 매개변수: b, price
+ * 반환 값: 칸 번호, 범위가 OB_MAX_LEVELS 를 넘으면 -1
+ */
+static int level_for(ObBook *b, int price) {
+    if (b->bids == 0 && b->asks == 0 && b->nlevels > 0 &&
+        (price < b->lo || price >= b->lo + b->nlevels)) {
+        /* 빈 장은 가격대를 새로 잡는다 */
+        b->nlevels = 0;
+    }
+    if (b->nlevels > 0 && price >= b->lo && price < b->lo + b->nlevels) return price - b->lo;
+
+    long lo = b->nlevels > 0 ? b->lo : price;
+    long hi = b->nlevels > 0 ? (long)b->lo + b->nlevels : (long)price + 1;
+    if (price < lo) lo = price;
+    if (price >= hi) hi = (long)price + 1;
+    if (hi - lo > OB_MAX_LEVELS) return -1;
+    lo -= OB_LEVEL_MARGIN;
+    if (lo < 1) lo = 1;
+    hi += OB_LEVEL_MARGIN;
+    if (hi - lo > OB_MAX_LEVELS) hi = lo + OB_MAX_LEVELS;
+    if (hi - lo > OB_MAX_LEVELS || price < lo || price >= hi) return -1;
+
+    int n = (int)(hi - lo);
+    ObLevel *levels = malloc((size_t)n * sizeof(ObLevel));
+    if (!levels) return -1;
+    for (int i = 0; i < n; ++i) {
+        levels[i].head = levels[i].tail = OB_NIL;
+        levels[i].qty = 0;
+    }
+    int shift = 0;
+    if (b->nlevels > 0) {
+        shift = b->lo - (int)lo;
+        memcpy(levels + shift, b->levels, (size_t)b->nlevels * sizeof(ObLevel));
+    }
+    free(b->levels);
+    b->levels = levels;
+    b->lo = (int)lo;
+    b->nlevels = n;
+    if (b->best_bid >= 0) b->best_bid += shift;
+    if (b->best_ask >= 0) b->best_ask += shift;
+    return price - b->lo;
+}
+
+/* 함수 목적: 주문을 가격대 FIFO 에서 빼고, 그 칸이 비면 최우선 호가를 다음 칸으로 옮깁니다.
+ * 매개변수: b, idx
+ * 반환 값: 없음
+ */
+static void level_unlink(ObBook *b, uint32_t idx) {
+    ObOrder *o = &g_pool[idx];
+    int li = o->price - b->lo;
+    ObLevel *lv = &b->levels[li];
+    if (o->prev != OB_NIL) g_pool[o->prev].next = o->next;
+    else lv->head = o->next;
+    if (o->next != OB_NIL) g_pool[o->next].prev = o->prev;
+    else lv->tail = o->prev;
+    o->next = o->prev = OB_NIL;
+    lv->qty -= o->leaves;
+
+    if (o->side == OB_BUY) {
+        if (--b->bids == 0) {
+            b->best_bid = -1;
+        } else if (lv->head == OB_NIL && li == b->best_bid) {
+            while (b->levels[b->best_bid].head == OB_NIL) b->best_bid--;
+        }
+    } else {
+        if (--b->asks == 0) {
+            b->best_ask = -1;
+        } else if (lv->head == OB_NIL && li == b->best_ask) {
+            while (b->levels[b->best_ask].head == OB_NIL) b->best_ask++;
+        }
+    }
+}
+
+/* 함수 목적: 주문을 가격대 FIFO 끝에 붙이고 최우선 호가를 고칩니다.
+ * 매개변수: b, idx, li (칸 번호)
+ * 반환 값: 없음
+ */
+static void level_append(ObBook *b, uint32_t idx, int li) {
+    ObOrder *o = &g_pool[idx];
+    ObLevel *lv = &b->levels[li];
+    o->prev = lv->tail;
+    o->next = OB_NIL;
+    if (lv->tail != OB_NIL) g_pool[lv->tail].next = idx;
+    else lv->head = idx;
+    lv->tail = idx;
+    lv->qty += o->leaves;
+    if (o->side == OB_BUY) {
+        b->bids++;
+        if (b->best_bid < li) b->best_bid = li;
+    } else {
+        b->asks++;
+        if (b->best_ask < 0 || b->best_ask > li) b->best_ask = li;
+    }
+}
+
+int ob_init(int books, ObReportFn fn, void *ctx) {
+    ob_free();
+    if (books < 0) return 0;
+    g_books = calloc(books > 0 ? (size_t)books : 1, sizeof(ObBook));
+    if (!g_books) return 0;
+    for (int i = 0; i < books; ++i) g_books[i].best_bid = g_books[i].best_ask = -1;
+    g_nbooks = books;
+    g_report_fn = fn;
+    g_report_ctx = ctx;
+    return 1;
+}
+
+void ob_free(void) {
+    for (int i = 0; i < g_nbooks; ++i) free(g_books[i].levels);
+    free(g_books);
+    free(g_pool);
+    free(g_reports);
+    g_books = NULL;
+    g_nbooks = 0;
+    g_pool = NULL;
+    g_pool_cap = 0;
+    g_free = OB_NIL;
+    g_reports = NULL;
+    g_nreports = g_reports_cap = 0;
+    g_report_fn = NULL;
+    g_report_ctx = NULL;
+}
+
+/* 함수 목적: 새 주문을 반대편 최우선 호가부터 맞춰 보고, 남은 수량은 장에 겁니다.
+ *           자기 주문과 맞닿으면 걸려 있던 자기 주문을 취소합니다.
+ * 매개변수: idx (채워 둔 주문 칸)
+ * 반환 값: 장에 걸렸거나 모두 체결됐으면 1, 남은 수량을 걸 자리가 없었으면 0
+ */
+static int match_and_rest(uint32_t idx) {
+    ObOrder *in = &g_pool[idx];
+    ObBook *b = &g_books[in->book];
+    int buy = in->side == OB_BUY;
+
+    while (in->leaves > 0) {
+        int li = buy ? b->best_ask : b->best_bid;
+        if (li < 0) break;
+        int level_price = b->lo + li;
+        if (buy ? level_price > in->price : level_price < in->price) break;
+
+        uint32_t mi = b->levels[li].head;
+        ObOrder *m = &g_pool[mi];
+        if (m->owner == in->owner) {
+            ObReport r = order_report(OB_EXEC_CANCELED, m, m->leaves, m->price);
+            r.leaves = 0;
+            level_unlink(b, mi);
+            report(&r);
+            order_release(mi);
+            continue;
+        }
+
+        int q = in->leaves < m->leaves ? in->leaves : m->leaves;
+        in->leaves -= q;
+        m->leaves -= q;
+        b->levels[li].qty -= q;
+
+        ObReport taker = order_report(OB_EXEC_FILL, in, q, level_price);
+        taker.counter = m->id;
+        taker.counter_owner = m->owner;
+        ObReport maker = order_report(OB_EXEC_FILL, m, q, level_price);
+        maker.counter = in->id;
+        maker.counter_owner = in->owner;
+        report(&taker);
+        report(&maker);
+
+        if (m->leaves == 0) {
+            level_unlink(b, mi);
+            order_release(mi);
+        }
+    }
+
+    if (in->leaves == 0) {
+        order_release(idx);
+        return 1;
+    }
+    int li = level_for(b, in->price);
+    if (li < 0) {
+        ObReport r = order_report(OB_EXEC_CANCELED, in, in->leaves, in->price);
+        r.leaves = 0;
+        report(&r);
+        order_release(idx);
+        return 0;
+    }
+    level_append(b, idx, li);
+    return 1;
+}
+
+uint64_t ob_submit(int book, uint32_t owner, ObSide side, int price, int qty) {
+    uint32_t idx = OB_NIL;
+    if (book >= 0 && book < g_nbooks && price > 0 && qty > 0 && (side == OB_BUY || side == OB_SELL)) {
+        idx = order_alloc();
+    }
+    if (idx == OB_NIL) {
+        ObReport r;
+        memset(&r, 0, sizeof(r));
+        r.type = OB_EXEC_REJECTED;
+        r.book = book;
+        r.owner = owner;
+        r.side = side;
+        r.price = r.limit = price;
+        r.qty = qty;
+        report(&r);
+        drain();
+        return 0;
+    }
+
+    ObOrder *o = &g_pool[idx];
+    o->owner = owner;
+    o->book = book;
+    o->side = side;
+    o->price = price;
+    o->leaves = qty;
+    uint64_t id = o->id;
+    ObReport r = order_report(OB_EXEC_NEW, o, qty, price);
+    report(&r);
+    match_and_rest(idx);
+    drain();
+    return id;
+}
+
+int ob_cancel(uint64_t order) {
+    uint32_t idx = order_find(order);
+    if (idx == OB_NIL) return 0;
+    ObOrder *o = &g_pool[idx];
+    ObReport r = order_report(OB_EXEC_CANCELED, o, o->leaves, o->price);
+    r.leaves = 0;
+    level_unlink(&g_books[o->book], idx);
+    order_release(idx);
+    report(&r);
+    drain();
+    return 1;
+}
+
+uint64_t ob_replace(uint64_t order, int price, int qty) {
+    uint32_t idx = order_find(order);
+    if (idx == OB_NIL || price <= 0 || qty <= 0) return 0;
+    ObOrder *o = &g_pool[idx];
+    ObBook *b = &g_books[o->book];
+
+    if (price == o->price && qty <= o->leaves) {
+        /* 같은 가격에서 줄이기만 하면 순서를 지킨다 */
+        b->levels[price - b->lo].qty -= o->leaves - qty;
+        o->leaves = qty;
+        ObReport r = order_report(OB_EXEC_REPLACED, o, qty, price);
+        r.counter = order;
+        report(&r);
+        drain();
+        return order;
+    }
+
+    /* 새 가격대를 먼저 마련해 실패하면 원래 주문을 그대로 둔다 */
+    if (level_for(b, price) < 0) return 0;
+    uint32_t ni = order_alloc();
+    if (ni == OB_NIL) return 0;
+    o = &g_pool[idx]; /* 풀이 옮겨졌을 수 있다 */
+    ObOrder *n = &g_pool[ni];
+    n->owner = o->owner;
+    n->book = o->book;
+    n->side = o->side;
+    n->price = price;
+    n->leaves = qty;
+    uint64_t id = n->id;
+
+    level_unlink(b, idx);
+    order_release(idx);
+    ObReport r = order_report(OB_EXEC_REPLACED, n, qty, price);
+    r.counter = order;
+    report(&r);
+    match_and_rest(ni);
+    drain();
+    return id;
+}
+
+int ob_order(uint64_t order, ObOrderInfo *out) {
+    uint32_t idx = order_find(order);
+    if (idx == OB_NIL || !out) return 0;
+    const ObOrder *o = &g_pool[idx];
+    out->id = o->id;
+    out->book = o->book;
+    out->owner = o->owner;
+    out->side = o->side;
+    out->price = o->price;
+    out->leaves = o->leaves;
+    return 1;
+}
+
+int ob_best(int book, int *bid, int *ask) {
+    if (book < 0 || book >= g_nbooks) return 0;
+    const ObBook *b = &g_books[book];
+    if (bid) *bid = b->best_bid >= 0 ? b->lo + b->best_bid : 0;
+    if (ask) *ask = b->best_ask >= 0 ? b->lo + b->best_ask : 0;
+    return 1;
+}
+
+int ob_depth(int book, ObSide side, int *prices, long *qtys, int max) {
+    if (book < 0 || book >= g_nbooks || max <= 0) return 0;
+    const ObBook *b = &g_books[book];
+    int n = 0;
+    if (side == OB_BUY) {
+        for (int li = b->best_bid; li >= 0 && n < max && b->bids > 0; --li) {
+            if (b->levels[li].head == OB_NIL) continue;
+            if (prices) prices[n] = b->lo + li;
+            if (qtys) qtys[n] = b->levels[li].qty;
+            n++;
+        }
+    } else {
+        for (int li = b->best_ask; li >= 0 && li < b->nlevels && n < max && b->asks > 0; ++li) {
+            if (b->levels[li].head == OB_NIL) continue;
+            if (prices) prices[n] = b->lo + li;
+            if (qtys) qtys[n] = b->levels[li].qty;
+            n++;
+        }
+    }
+    return n;
+}
+
+int ob_orders(uint32_t owner, ObOrderInfo *out, int max) {
+    int total = 0;
+    for (int bi = 0; bi < g_nbooks; ++bi) {
+        const ObBook *b = &g_books[bi];
+        if (b->bids == 0 && b->asks == 0) continue;
+        for (int li = 0; li < b->nlevels; ++li) {
+            for (uint32_t idx = b->levels[li].head; idx != OB_NIL; idx = g_pool[idx].next) {
+                const ObOrder *o = &g_pool[idx];
+                if (owner != OB_ANY_OWNER && o->owner != owner) continue;
+                if (out && total < max) {
+                    out[total].id = o->id;
+                    out[total].book = o->book;
+                    out[total].owner = o->owner;
+                    out[total].side = o->side;
+                    out[total].price = o->price;
+                    out[total].leaves = o->leaves;
+                }
+                total++;
+            }
+        }
+    }
+    return total;
+}
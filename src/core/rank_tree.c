@@ -0,0 +1,216 @@
+/*
+ * 파일 목적: 순위 질의용 순서 통계 트리(크기 붙은 트립) 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/rank_tree.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* 함수 목적: 트리를 빈 상태로 만듭니다.
+ * 매개변수: t
+ * 반환 값: 없음
+ */
+void rank_tree_init(RankTree *t) {
+    memset(t, 0, sizeof(*t));
+    t->root = RANK_TREE_NIL;
+    t->rng = 0x9e3779b97f4a7c15ull;
+}
+
+/* 함수 목적: 트리가 잡은 메모리를 풀고 빈 상태로 되돌립니다.
+ * 매개변수: t
+ * 반환 값: 없음
+ */
+void rank_tree_free(RankTree *t) {
+    free(t->left);
+    free(t->right);
+    free(t->size);
+    free(t->prio);
+    free(t->score);
+    rank_tree_init(t);
+}
+
+/* 함수 목적: id 칸이 생기도록 배열들을 늘립니다. 새 칸은 트리 밖(size 0)입니다.
+ * 매개변수: t, id
+ * 반환 값: 성공 여부
+ */
+static int reserve(RankTree *t, uint32_t id) {
+    if (id < t->cap) return 1;
+    if (id == RANK_TREE_NIL) return 0;
+    uint32_t cap = t->cap ? t->cap : 64;
+    while (cap <= id) cap = cap > UINT32_MAX / 2 ? RANK_TREE_NIL : cap * 2;
+    uint32_t *l = realloc(t->left, (size_t)cap * sizeof(uint32_t));
+    if (l) t->left = l;
+    uint32_t *r = realloc(t->right, (size_t)cap * sizeof(uint32_t));
+    if (r) t->right = r;
+    uint32_t *s = realloc(t->size, (size_t)cap * sizeof(uint32_t));
+    if (s) t->size = s;
+    uint32_t *p = realloc(t->prio, (size_t)cap * sizeof(uint32_t));
+    if (p) t->prio = p;
+    long long *sc = realloc(t->score, (size_t)cap * sizeof(long long));
+    if (sc) t->score = sc;
+    if (!l || !r || !s || !p || !sc) return 0;
+    memset(t->size + t->cap, 0, (size_t)(cap - t->cap) * sizeof(uint32_t));
+    t->cap = cap;
+    return 1;
+}
+
+static uint32_t node_size(const RankTree *t, uint32_t n) {
+    return n == RANK_TREE_NIL ? 0 : t->size[n];
+}
+
+static void update(RankTree *t, uint32_t n) {
+    t->size[n] = 1 + node_size(t, t->left[n]) + node_size(t, t->right[n]);
+}
+
+/* 함수 목적: (score, id) 가 노드 n 보다 앞 순위인지 봅니다. 점수가 높을수록, 같으면 id 가
+ *           작을수록 앞입니다.
+ * 매개변수: t, score, id, n
+ * 반환 값: 앞이면 1
+ */
+static int before(const RankTree *t, long long score, uint32_t id, uint32_t n) {
+    return score > t->score[n] || (score == t->score[n] && id < n);
+}
+
+/* 함수 목적: 트리 n 을 (score, id) 보다 앞인 노드들(l)과 나머지(r)로 나눕니다.
+ * 매개변수: t, n, score, id, l, r
+ * 반환 값: 없음
+ */
+static void split(RankTree *t, uint32_t n, long long score, uint32_t id, uint32_t *l, uint32_t *r) {
+    if (n == RANK_TREE_NIL) {
+        *l = *r = RANK_TREE_NIL;
+        return;
+    }
+    if (!before(t, score, id, n)) {
+        /* n 이 기준보다 앞: n 과 왼쪽은 l, 오른쪽을 다시 나눈다 */
+        split(t, t->right[n], score, id, &t->right[n], r);
+        *l = n;
+    } else {
+        split(t, t->left[n], score, id, l, &t->left[n]);
+        *r = n;
+    }
+    update(t, n);
+}
+
+/* 함수 목적: 모든 노드가 b 의 노드보다 앞인 두 트리를 합칩니다.
+ * 매개변수: t, a, b
+ * 반환 값: 합친 트리의 뿌리
+ */
+static uint32_t merge(RankTree *t, uint32_t a, uint32_t b) {
+    if (a == RANK_TREE_NIL) return b;
+    if (b == RANK_TREE_NIL) return a;
+    if (t->prio[a] > t->prio[b]) {
+        t->right[a] = merge(t, t->right[a], b);
+        update(t, a);
+        return a;
+    }
+    t->left[b] = merge(t, a, t->left[b]);
+    update(t, b);
+    return b;
+}
+
+/* 함수 목적: 트리 n 에서 id 노드를 떼어 냅니다. 노드의 지금 점수로 길을 찾습니다.
+ * 매개변수: t, n, id
+ * 반환 값: 새 뿌리
+ */
+static uint32_t erase(RankTree *t, uint32_t n, uint32_t id) {
+    if (n == RANK_TREE_NIL) return n;
+    if (n == id) return merge(t, t->left[n], t->right[n]);
+    if (before(t, t->score[id], id, n)) {
+        t->left[n] = erase(t, t->left[n], id);
+    } else {
+        t->right[n] = erase(t, t->right[n], id);
+    }
+    update(t, n);
+    return n;
+}
+
+/* 함수 목적: id 가 트리에 있는지 봅니다.
+ * 매개변수: t, id
+ * 반환 값: 있으면 1
+ */
+int rank_tree_contains(const RankTree *t, uint32_t id) {
+    return id < t->cap && t->size[id] != 0;
+}
+
+/* 함수 목적: id 를 트리에서 뺍니다. 없으면 아무것도 하지 않습니다.
+ * 매개변수: t, id
+ * 반환 값: 없음
+ */
+void rank_tree_remove(RankTree *t, uint32_t id) {
+    if (!rank_tree_contains(t, id)) return;
+    t->root = erase(t, t->root, id);
+    t->size[id] = 0;
+    t->count--;
+}
+
+/* 함수 목적: id 의 점수를 정합니다. 없던 id 는 넣고, 있던 id 는 빼서 새 자리에 다시 넣습니다.
+ * 매개변수: t, id, score
+ * 반환 값: 성공 여부
+ */
+int rank_tree_set(RankTree *t, uint32_t id, long long score) {
+    if (rank_tree_contains(t, id)) {
+        if (t->score[id] == score) return 1;
+        rank_tree_remove(t, id);
+    } else if (!reserve(t, id)) {
+        return 0;
+    }
+    /* xorshift64 로 우선순위를 뽑는다 */
+    t->rng ^= t->rng << 13;
+    t->rng ^= t->rng >> 7;
+    t->rng ^= t->rng << 17;
+    t->prio[id] = (uint32_t)(t->rng >> 32);
+    t->score[id] = score;
+    t->left[id] = t->right[id] = RANK_TREE_NIL;
+    t->size[id] = 1;
+
+    uint32_t l, r;
+    split(t, t->root, score, id, &l, &r);
+    t->root = merge(t, merge(t, l, id), r);
+    t->count++;
+    return 1;
+}
+
+/* 함수 목적: id 의 순위를 구합니다. 뿌리에서 id 까지 내려가며 앞선 노드 수를 셉니다.
+ * 매개변수: t, id
+ * 반환 값: 0부터 센 순위, 없으면 -1
+ */
+long rank_tree_rank(const RankTree *t, uint32_t id) {
+    if (!rank_tree_contains(t, id)) return -1;
+    long long score = t->score[id];
+    long rank = 0;
+    uint32_t n = t->root;
+    while (n != RANK_TREE_NIL && n != id) {
+        if (before(t, score, id, n)) {
+            n = t->left[n];
+        } else {
+            rank += (long)node_size(t, t->left[n]) + 1;
+            n = t->right[n];
+        }
+    }
+    if (n == RANK_TREE_NIL) return -1;
+    return rank + (long)node_size(t, t->left[n]);
+}
+
+/* 함수 목적: k 번째 순위의 구성원을 찾습니다.
+ * 매개변수: t, k, out_id, out_score (NULL 가능)
+ * 반환 값: 있으면 1
+ */
+int rank_tree_at(const RankTree *t, uint32_t k, uint32_t *out_id, long long *out_score) {
+    if (k >= t->count) return 0;
+    uint32_t n = t->root;
+    while (n != RANK_TREE_NIL) {
+        uint32_t left = node_size(t, t->left[n]);
+        if (k < left) {
+            n = t->left[n];
+        } else if (k == left) {
+            if (out_id) *out_id = n;
+            if (out_score) *out_score = t->score[n];
+            return 1;
+        } else {
+            k -= left + 1;
+            n = t->right[n];
+        }
+    }
+    return 0;
+}
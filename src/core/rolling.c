@@ -0,0 +1,242 @@
+/*
+ * 파일 목적: 가격 시계열용 이동 창 지표 커널(SMA/EMA/최저·최고/RSI/VWAP) 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/rolling.h"
+
+#include <math.h>
+#include <string.h>
+
+/* 함수 목적: 기간을 1..ROLLING_MAX_PERIOD 로 맞춥니다.
+ * 매개변수: period
+ * 반환 값: 맞춘 기간
+ */
+static int clamp_period(int period) {
+    if (period < 1) return 1;
+    if (period > ROLLING_MAX_PERIOD) return ROLLING_MAX_PERIOD;
+    return period;
+}
+
+/* 함수 목적: 이동 합을 빈 창으로 만듭니다.
+ * 매개변수: r, period
+ * 반환 값: 없음
+ */
+void rolling_sum_init(RollingSum *r, int period) {
+    memset(r, 0, sizeof(*r));
+    r->period = clamp_period(period);
+}
+
+/* 함수 목적: 창 안의 값으로 합과 제곱합을 처음부터 다시 구합니다. 더하고 빼며 쌓인
+ *           반올림 오차를 버립니다. (rolling.h 의 오차 한계 참고)
+ * 매개변수: r
+ * 반환 값: 없음
+ */
+static void rolling_sum_refresh(RollingSum *r) {
+    double sum = 0.0, sumsq = 0.0;
+    for (int i = 0; i < r->n; ++i) {
+        sum += r->buf[i];
+        sumsq += r->buf[i] * r->buf[i];
+    }
+    r->sum = sum;
+    r->sumsq = sumsq;
+    r->since = 0;
+}
+
+/* 함수 목적: 값 하나를 창에 넣습니다. 창이 차 있으면 가장 오래된 값을 빼고 넣습니다.
+ *           period 번 넣을 때마다 합을 다시 구하므로 한 번에 드는 비용은 평균 O(1) 입니다.
+ * 매개변수: r, x
+ * 반환 값: 없음
+ */
+void rolling_sum_push(RollingSum *r, double x) {
+    if (r->n == r->period) {
+        double old = r->buf[r->head];
+        r->sum -= old;
+        r->sumsq -= old * old;
+    } else {
+        r->n++;
+    }
+    r->buf[r->head] = x;
+    r->sum += x;
+    r->sumsq += x * x;
+    r->head = (r->head + 1) % r->period;
+    if (++r->since >= r->period) rolling_sum_refresh(r);
+}
+
+/* 함수 목적: 창이 기간만큼 찼는지 봅니다.
+ * 매개변수: r
+ * 반환 값: 찼으면 1
+ */
+int rolling_sum_full(const RollingSum *r) {
+    return r->n == r->period;
+}
+
+/* 함수 목적: 창의 평균을 구합니다.
+ * 매개변수: r
+ * 반환 값: 평균, 빈 창이면 0
+ */
+double rolling_mean(const RollingSum *r) {
+    return r->n ? r->sum / r->n : 0.0;
+}
+
+/* 함수 목적: 창의 표준편차를 구합니다. E[x²] - E[x]² 가 반올림으로 음수가 되면 0 입니다.
+ * 매개변수: r
+ * 반환 값: 표준편차
+ */
+double rolling_stddev(const RollingSum *r) {
+    if (r->n == 0) return 0.0;
+    double mean = r->sum / r->n;
+    double var = r->sumsq / r->n - mean * mean;
+    return var > 0.0 ? sqrt(var) : 0.0;
+}
+
+/* 함수 목적: EMA 를 초기화합니다. 가중치는 2 / (period + 1) 입니다.
+ * 매개변수: e, period
+ * 반환 값: 없음
+ */
+void rolling_ema_init(RollingEma *e, int period) {
+    memset(e, 0, sizeof(*e));
+    e->period = clamp_period(period);
+    e->alpha = 2.0 / (e->period + 1);
+}
+
+/* 함수 목적: 값 하나를 EMA 에 반영합니다. 처음 period 개는 평균으로 시작값을 만듭니다.
+ * 매개변수: e, x
+ * 반환 값: 없음
+ */
+void rolling_ema_push(RollingEma *e, double x) {
+    if (e->n < e->period) {
+        e->seed_sum += x;
+        e->n++;
+        e->value = e->seed_sum / e->n;
+        return;
+    }
+    e->value += e->alpha * (x - e->value);
+}
+
+/* 함수 목적: EMA 가 시작값을 다 모았는지 봅니다.
+ * 매개변수: e
+ * 반환 값: 준비됐으면 1
+ */
+int rolling_ema_ready(const RollingEma *e) {
+    return e->n >= e->period;
+}
+
+/* 함수 목적: 이동 최저/최고를 빈 창으로 만듭니다.
+ * 매개변수: m, period, want_max (1 이면 최고, 0 이면 최저)
+ * 반환 값: 없음
+ */
+void rolling_extrema_init(RollingExtrema *m, int period, int want_max) {
+    memset(m, 0, sizeof(*m));
+    m->period = clamp_period(period);
+    m->want_max = want_max;
+}
+
+/* 함수 목적: 값 하나를 넣습니다. 창에서 벗어난 앞쪽 후보를 버리고, 새 값에 밀리는
+ *           뒤쪽 후보는 다시 극값이 될 수 없으니 버립니다. 덱은 단조롭게 유지됩니다.
+ * 매개변수: m, x
+ * 반환 값: 없음
+ */
+void rolling_extrema_push(RollingExtrema *m, double x) {
+    /* 먼저 앞을 비워야 새 값까지 period 칸 안에 들어간다 */
+    while (m->count > 0 && m->idx[m->head] <= m->next - m->period) {
+        m->head = (m->head + 1) % ROLLING_MAX_PERIOD;
+        m->count--;
+    }
+    while (m->count > 0) {
+        int back = (m->head + m->count - 1) % ROLLING_MAX_PERIOD;
+        int beaten = m->want_max ? m->val[back] <= x : m->val[back] >= x;
+        if (!beaten) break;
+        m->count--;
+    }
+    int slot = (m->head + m->count) % ROLLING_MAX_PERIOD;
+    m->idx[slot] = m->next;
+    m->val[slot] = x;
+    m->count++;
+    m->next++;
+}
+
+/* 함수 목적: 창 안의 극값을 알려줍니다. 덱의 맨 앞이 극값입니다.
+ * 매개변수: m
+ * 반환 값: 극값, 빈 창이면 0
+ */
+double rolling_extrema_value(const RollingExtrema *m) {
+    return m->count ? m->val[m->head] : 0.0;
+}
+
+/* 함수 목적: RSI 를 초기화합니다.
+ * 매개변수: r, period
+ * 반환 값: 없음
+ */
+void rolling_rsi_init(RollingRsi *r, int period) {
+    memset(r, 0, sizeof(*r));
+    r->period = clamp_period(period);
+}
+
+/* 함수 목적: 값 하나를 반영합니다. 처음 period 번의 변화는 단순 평균, 그 뒤로는
+ *           (평균 x (period - 1) + 새 변화) / period 로 다듬습니다. (Wilder)
+ * 매개변수: r, x
+ * 반환 값: 없음
+ */
+void rolling_rsi_push(RollingRsi *r, double x) {
+    if (r->n++ == 0) {
+        r->prev = x;
+        return;
+    }
+    double change = x - r->prev;
+    double gain = change > 0 ? change : 0.0;
+    double loss = change < 0 ? -change : 0.0;
+    r->prev = x;
+    int changes = r->n - 1;
+    if (changes <= r->period) {
+        r->avg_gain += (gain - r->avg_gain) / changes;
+        r->avg_loss += (loss - r->avg_loss) / changes;
+    } else {
+        r->avg_gain = (r->avg_gain * (r->period - 1) + gain) / r->period;
+        r->avg_loss = (r->avg_loss * (r->period - 1) + loss) / r->period;
+    }
+}
+
+/* 함수 목적: RSI 가 기간만큼의 변화를 모았는지 봅니다.
+ * 매개변수: r
+ * 반환 값: 준비됐으면 1
+ */
+int rolling_rsi_ready(const RollingRsi *r) {
+    return r->n > r->period;
+}
+
+/* 함수 목적: RSI 값을 구합니다.
+ * 매개변수: r
+ * 반환 값: 0..100
+ */
+double rolling_rsi_value(const RollingRsi *r) {
+    if (r->avg_loss <= 0.0) return r->avg_gain > 0.0 ? 100.0 : 50.0;
+    return 100.0 - 100.0 / (1.0 + r->avg_gain / r->avg_loss);
+}
+
+/* 함수 목적: VWAP 를 빈 창으로 만듭니다.
+ * 매개변수: v, period
+ * 반환 값: 없음
+ */
+void rolling_vwap_init(RollingVwap *v, int period) {
+    rolling_sum_init(&v->notional, period);
+    rolling_sum_init(&v->volume, period);
+}
+
+/* 함수 목적: 한 단계의 거래량과 거래대금을 넣습니다. 거래가 없던 단계는 0 을 넣습니다.
+ * 매개변수: v, qty, notional
+ * 반환 값: 없음
+ */
+void rolling_vwap_push(RollingVwap *v, double qty, double notional) {
+    rolling_sum_push(&v->notional, notional);
+    rolling_sum_push(&v->volume, qty);
+}
+
+/* 함수 목적: 창 안의 거래량 가중 평균가를 구합니다.
+ * 매개변수: v, out
+ * 반환 값: 창 안에 거래가 있었으면 1
+ */
+int rolling_vwap_value(const RollingVwap *v, double *out) {
+    if (v->volume.sum <= 0.0) return 0;
+    if (out) *out = v->notional.sum / v->volume.sum;
+    return 1;
+}
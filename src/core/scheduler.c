@@ -0,0 +1,326 @@
+/*
+ * 파일 목적: 계층형 타이머 휠 기반 주기 작업 스케줄러 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/scheduler.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define SCHED_SLOTS (1 << SCHED_SLOT_BITS)
+#define SCHED_MASK (SCHED_SLOTS - 1)
+#define SCHED_SPAN (1L << (SCHED_SLOT_BITS * SCHED_LEVELS)) /* 휠 전체가 담는 초 */
+
+typedef struct SchedJob {
+    const char *name;
+    SchedFn fn;
+    void *ctx;
+    long due;
+    long period;
+    int used;
+    int level; /* 들어 있는 단계, 휠 밖이면 -1 */
+    int slot;
+    struct SchedJob *prev;
+    struct SchedJob *next;
+} SchedJob;
+
+typedef struct SchedFire {
+    SchedFn fn;
+    void *ctx;
+} SchedFire;
+
+static SchedJob g_jobs[SCHED_MAX_JOBS];
+static SchedJob *g_wheel[SCHED_LEVELS][SCHED_SLOTS];
+static int g_level_count[SCHED_LEVELS];
+static long g_now = 0; /* 마지막으로 처리한 초 */
+
+static pthread_mutex_t g_wheel_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_world_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_wake = PTHREAD_COND_INITIALIZER; /* 작업 추가 또는 종료 */
+static pthread_t g_thread;
+static int g_started = 0;
+static int g_stop = 0;
+
+/* 함수 목적: 작업을 들어 있던 칸에서 뺍니다.
+ * 매개변수: j, slot_head (그 칸의 머리 포인터)
+ * 반환 값: 없음
+ */
+static void unlink_job(SchedJob *j, SchedJob **slot_head) {
+    if (j->prev) j->prev->next = j->next;
+    else *slot_head = j->next;
+    if (j->next) j->next->prev = j->prev;
+    j->prev = j->next = NULL;
+    g_level_count[j->level]--;
+    j->level = -1;
+}
+
+/* 함수 목적: 작업이 들어갈 단계와 칸을 정합니다. 다음에 처리할 초(g_now + 1)부터
+ *           남은 시간이 64^(L+1) 초보다 짧은 가장 낮은 단계 L 의 칸이고, 휠 범위를
+ *           넘으면 맨 위 단계의 끝에 둡니다. 이렇게 하면 한 단계 안에서 아직 돌지 않은
+ *           칸 번호가 겹치지 않습니다.
+ * 매개변수: due (g_now 보다 큼), out_level, out_slot
+ * 반환 값: 없음
+ */
+static void slot_for(long due, int *out_level, int *out_slot) {
+    long delta = due - (g_now + 1);
+    if (delta >= SCHED_SPAN) due = g_now + SCHED_SPAN;
+    int level = 0;
+    while (level < SCHED_LEVELS - 1 && delta >= (1L << (SCHED_SLOT_BITS * (level + 1)))) level++;
+    *out_level = level;
+    *out_slot = (int)((due >> (SCHED_SLOT_BITS * level)) & SCHED_MASK);
+}
+
+/* 함수 목적: 작업을 마감 시각에 맞는 칸에 넣습니다. 이미 지난 마감은 다음 초로 옮깁니다. (O(1))
+ * 매개변수: j
+ * 반환 값: 없음
+ */
+static void place_job(SchedJob *j) {
+    int level, slot;
+    if (j->due <= g_now) j->due = g_now + 1;
+    slot_for(j->due, &level, &slot);
+    j->level = level;
+    j->slot = slot;
+    j->prev = NULL;
+    j->next = g_wheel[level][slot];
+    if (j->next) j->next->prev = j;
+    g_wheel[level][slot] = j;
+    g_level_count[level]++;
+}
+
+/* 함수 목적: 윗단계 칸 하나를 비우고 그 작업들을 아래 단계로 다시 나눠 넣습니다.
+ * 매개변수: level, slot
+ * 반환 값: 없음
+ */
+static void cascade(int level, int slot) {
+    SchedJob *j = g_wheel[level][slot];
+    g_wheel[level][slot] = NULL;
+    while (j) {
+        SchedJob *next = j->next;
+        g_level_count[level]--;
+        place_job(j);
+        j = next;
+    }
+}
+
+/* 함수 목적: 다음 마감 시각을 구합니다. (작업 수가 적어 표를 훑는다)
+ * 매개변수: 없음
+ * 반환 값: 가장 이른 마감 시각, 작업이 없으면 LONG_MAX
+ */
+static long next_due_locked(void) {
+    long next = LONG_MAX;
+    for (int i = 0; i < SCHED_MAX_JOBS; ++i) {
+        if (g_jobs[i].used && g_jobs[i].due < next) next = g_jobs[i].due;
+    }
+    return next;
+}
+
+/* 함수 목적: 작업을 등록합니다. 처음 한 번은 first_due 에, 그 뒤로는 period 초마다 실행합니다.
+ * 매개변수: name, first_due, period (0 이면 한 번), fn, ctx
+ * 반환 값: 작업 번호, 표가 가득 찼으면 -1
+ */
+int sched_add(const char *name, long first_due, long period, SchedFn fn, void *ctx) {
+    if (!fn || period < 0) return -1;
+    pthread_mutex_lock(&g_wheel_lock);
+    int id = -1;
+    for (int i = 0; i < SCHED_MAX_JOBS; ++i) {
+        if (!g_jobs[i].used) {
+            id = i;
+            break;
+        }
+    }
+    if (id >= 0) {
+        int empty = 1;
+        for (int l = 0; l < SCHED_LEVELS; ++l) empty = empty && g_level_count[l] == 0;
+        /* 휠이 비어 있으면 시계를 지금으로 맞춰 빈 구간을 돌지 않게 한다 */
+        if (empty) g_now = (long)time(NULL);
+        SchedJob *j = &g_jobs[id];
+        memset(j, 0, sizeof(*j));
+        j->name = name;
+        j->fn = fn;
+        j->ctx = ctx;
+        j->due = first_due;
+        j->period = period;
+        j->used = 1;
+        place_job(j);
+        pthread_cond_signal(&g_wake);
+    }
+    pthread_mutex_unlock(&g_wheel_lock);
+    return id;
+}
+
+/* 함수 목적: 작업을 취소합니다. 이미 꺼내져 실행을 기다리는 차례는 한 번 더 돌 수 있습니다.
+ * 매개변수: job
+ * 반환 값: 성공 여부
+ */
+int sched_cancel(int job) {
+    if (job < 0 || job >= SCHED_MAX_JOBS) return 0;
+    pthread_mutex_lock(&g_wheel_lock);
+    SchedJob *j = &g_jobs[job];
+    int ok = j->used;
+    if (ok) {
+        if (j->level >= 0) unlink_job(j, &g_wheel[j->level][j->slot]);
+        j->used = 0;
+    }
+    pthread_mutex_unlock(&g_wheel_lock);
+    return ok;
+}
+
+/* 함수 목적: now 까지 휠을 돌리며 마감된 작업을 꺼내고, 다음 차례를 다시 넣은 뒤
+ *           휠 잠금을 풀고 차례대로 실행합니다. 아래 단계가 비어 있으면 다음
+ *           자리올림 시각까지 한 번에 건너뜁니다. 밀린 주기는 한 번만 실행합니다.
+ * 매개변수: now
+ * 반환 값: 실행한 작업 수
+ */
+int sched_run_due(long now) {
+    SchedFire fire[SCHED_MAX_JOBS];
+    int fired = 0;
+    pthread_mutex_lock(&g_wheel_lock);
+    while (g_now < now) {
+        int empty = 0;
+        while (empty < SCHED_LEVELS && g_level_count[empty] == 0) empty++;
+        if (empty == SCHED_LEVELS) {
+            g_now = now;
+            break;
+        }
+        long t = g_now + 1;
+        if (empty > 0) {
+            int bits = SCHED_SLOT_BITS * empty;
+            t = ((g_now >> bits) + 1) << bits;
+            if (t > now) {
+                g_now = now;
+                break;
+            }
+        }
+        /* t 의 아래 자리가 모두 0 이면 윗단계 칸을 위에서부터 풀어 내린다 */
+        for (int level = SCHED_LEVELS - 1; level > 0; --level) {
+            long low = (1L << (SCHED_SLOT_BITS * level)) - 1;
+            if ((t & low) == 0) {
+                g_now = t - 1;
+                cascade(level, (int)((t >> (SCHED_SLOT_BITS * level)) & SCHED_MASK));
+            }
+        }
+        g_now = t;
+        /* 칸을 통째로 떼어 낸다: 주기가 64초인 작업은 같은 칸으로 되돌아온다 */
+        SchedJob *head = g_wheel[0][t & SCHED_MASK];
+        g_wheel[0][t & SCHED_MASK] = NULL;
+        while (head) {
+            SchedJob *j = head;
+            unlink_job(j, &head);
+            fire[fired].fn = j->fn;
+            fire[fired].ctx = j->ctx;
+            fired++;
+            if (j->period > 0) {
+                j->due += j->period;
+                if (j->due <= now) j->due += j->period * ((now - j->due) / j->period + 1);
+                place_job(j);
+            } else {
+                j->used = 0;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_wheel_lock);
+    for (int i = 0; i < fired; ++i) fire[i].fn(now, fire[i].ctx);
+    return fired;
+}
+
+/* 함수 목적: 스케줄러 스레드 본체. 다음 마감까지 잠들었다가 세계 잠금을 잡고 작업을 실행합니다.
+ * 매개변수: arg (사용하지 않음)
+ * 반환 값: NULL
+ */
+static void *sched_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_wheel_lock);
+    while (!g_stop) {
+        long now = (long)time(NULL);
+        long next = next_due_locked();
+        if (next > now) {
+            if (next == LONG_MAX) {
+                pthread_cond_wait(&g_wake, &g_wheel_lock);
+            } else {
+                struct timespec until;
+                until.tv_sec = (time_t)next;
+                until.tv_nsec = 0;
+                pthread_cond_timedwait(&g_wake, &g_wheel_lock, &until);
+            }
+            continue;
+        }
+        pthread_mutex_unlock(&g_wheel_lock);
+        sched_lock();
+        sched_run_due((long)time(NULL));
+        sched_unlock();
+        pthread_mutex_lock(&g_wheel_lock);
+    }
+    pthread_mutex_unlock(&g_wheel_lock);
+    return NULL;
+}
+
+/* 함수 목적: 스케줄러 스레드를 띄웁니다.
+ * 매개변수: 없음
+ * 반환 값: 동작 중이면 1
+ */
+int sched_start(void) {
+    pthread_mutex_lock(&g_wheel_lock);
+    if (!g_started) {
+        g_stop = 0;
+        g_started = pthread_create(&g_thread, NULL, sched_main, NULL) == 0;
+    }
+    int ok = g_started;
+    pthread_mutex_unlock(&g_wheel_lock);
+    return ok;
+}
+
+/* 함수 목적: 스레드를 멈추고 등록된 작업을 모두 지웁니다. 세계 잠금을 쥔 채 부르면 안 됩니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void sched_stop(void) {
+    pthread_mutex_lock(&g_wheel_lock);
+    int started = g_started;
+    g_stop = 1;
+    pthread_cond_broadcast(&g_wake);
+    pthread_mutex_unlock(&g_wheel_lock);
+    if (started) pthread_join(g_thread, NULL);
+
+    pthread_mutex_lock(&g_wheel_lock);
+    g_started = 0;
+    g_stop = 0;
+    memset(g_jobs, 0, sizeof(g_jobs));
+    memset(g_wheel, 0, sizeof(g_wheel));
+    memset(g_level_count, 0, sizeof(g_level_count));
+    pthread_mutex_unlock(&g_wheel_lock);
+}
+
+/* 함수 목적: 스케줄러 스레드가 동작 중인지 알려줍니다.
+ * 매개변수: 없음
+ * 반환 값: 동작 중이면 1, 아니면 0
+ */
+int sched_running(void) {
+    pthread_mutex_lock(&g_wheel_lock);
+    int running = g_started;
+    pthread_mutex_unlock(&g_wheel_lock);
+    return running;
+}
+
+/* 함수 목적: 세계 잠금을 잡습니다. 사용자·계좌·시세 같은 도메인 상태는 이 잠금 하나로
+ *           보호하며, 도메인 함수를 부르는 쪽이 호출 전후로 쥐고 있어야 합니다.
+ *           스케줄러 스레드는 만기 작업을 돌리는 동안 쥐고, UI 스레드는 화면 루프
+ *           내내 쥐었다가 키 입력을 기다리는 동안(getch)만 놓습니다.
+ *           재귀 잠금이 아니므로 이미 쥔 스레드가 다시 부르면 교착됩니다. 작업
+ *           함수와 도메인 함수 안에서는 부르지 말고, 쥔 채로 sched_stop 을
+ *           부르지도 마세요 (스레드가 끝나기를 기다리다 멈춥니다).
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void sched_lock(void) {
+    pthread_mutex_lock(&g_world_lock);
+}
+
+/* 함수 목적: sched_lock 으로 잡은 세계 잠금을 놓습니다. 잡은 스레드가 불러야 합니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void sched_unlock(void) {
+    pthread_mutex_unlock(&g_world_lock);
+}
@@ -0,0 +1,140 @@
+/*
+ * 파일 목적: 블록 단위 델타/지그재그 varint 정수 시계열 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/series.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* 함수 목적: 시계열을 빈 상태로 만듭니다.
+ * 매개변수: s
+ * 반환 값: 없음
+ */
+void series_init(Series *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+/* 함수 목적: 시계열이 잡은 메모리를 풀고 빈 상태로 되돌립니다.
+ * 매개변수: s
+ * 반환 값: 없음
+ */
+void series_free(Series *s) {
+    free(s->bytes);
+    free(s->blocks);
+    series_init(s);
+}
+
+/* 함수 목적: 꽉 찬 꼬리를 블록 하나로 봉인합니다. 첫 값은 그대로 두고 나머지는
+ *           앞 값과의 차이를 지그재그 varint 로 적습니다.
+ * 매개변수: s
+ * 반환 값: 성공 여부
+ */
+static int seal_tail(Series *s) {
+    /* 델타 하나는 varint 로 최대 5바이트 */
+    size_t need = s->nbytes + (size_t)(SERIES_BLOCK - 1) * 5;
+    if (need > UINT32_MAX) return 0;
+    if (need > s->bytes_cap) {
+        size_t cap = s->bytes_cap ? s->bytes_cap : 1024;
+        while (cap < need) cap *= 2;
+        uint8_t *bytes = realloc(s->bytes, cap);
+        if (!bytes) return 0;
+        s->bytes = bytes;
+        s->bytes_cap = cap;
+    }
+    if (s->nblocks == s->blocks_cap) {
+        long cap = s->blocks_cap ? s->blocks_cap * 2 : 16;
+        SeriesBlock *blocks = realloc(s->blocks, (size_t)cap * sizeof(SeriesBlock));
+        if (!blocks) return 0;
+        s->blocks = blocks;
+        s->blocks_cap = cap;
+    }
+
+    SeriesBlock *b = &s->blocks[s->nblocks++];
+    b->first = s->tail[0];
+    b->offset = (uint32_t)s->nbytes;
+    uint8_t *p = s->bytes + s->nbytes;
+    for (int i = 1; i < SERIES_BLOCK; ++i) {
+        int32_t d = (int32_t)((uint32_t)s->tail[i] - (uint32_t)s->tail[i - 1]);
+        uint32_t z = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+        while (z >= 0x80) {
+            *p++ = (uint8_t)(z | 0x80);
+            z >>= 7;
+        }
+        *p++ = (uint8_t)z;
+    }
+    s->nbytes = (size_t)(p - s->bytes);
+    s->tail_len = 0;
+    return 1;
+}
+
+/* 함수 목적: 값을 하나 붙입니다. 꼬리가 차면 블록으로 봉인합니다.
+ * 매개변수: s, value
+ * 반환 값: 성공 여부
+ */
+int series_push(Series *s, int value) {
+    if (s->tail_len == SERIES_BLOCK && !seal_tail(s)) return 0;
+    s->tail[s->tail_len++] = value;
+    s->len++;
+    s->last = value;
+    if (s->tail_len == SERIES_BLOCK) seal_tail(s); /* 실패하면 다음 push 에서 다시 */
+    return 1;
+}
+
+/* 함수 목적: 블록 하나를 처음부터 풀어 [skip, skip + n) 구간만 out 에 씁니다.
+ * 매개변수: s, block, skip, out, n
+ * 반환 값: 없음
+ */
+static void decode_block(const Series *s, long block, int skip, int *out, int n) {
+    const uint8_t *p = s->bytes + s->blocks[block].offset;
+    uint32_t v = (uint32_t)s->blocks[block].first;
+    int end = skip + n;
+    for (int i = 0; i < end; ++i) {
+        if (i > 0) {
+            uint32_t z = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                byte = *p++;
+                z |= (uint32_t)(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            v += (z >> 1) ^ (0u - (z & 1));
+        }
+        if (i >= skip) out[i - skip] = (int)v;
+    }
+}
+
+int series_get(const Series *s, long i) {
+    int v = 0;
+    series_read(s, i, &v, 1);
+    return v;
+}
+
+/* 함수 목적: from 부터 n 개를 읽습니다. 겹치는 블록만 풀고, 꼬리는 그대로 복사합니다.
+ * 매개변수: s, from, out, n
+ * 반환 값: 읽은 개수
+ */
+long series_read(const Series *s, long from, int *out, long n) {
+    if (from < 0 || from >= s->len || n <= 0) return 0;
+    if (n > s->len - from) n = s->len - from;
+    long sealed = s->nblocks * SERIES_BLOCK;
+    long done = 0;
+    while (done < n && from + done < sealed) {
+        long at = from + done;
+        long block = at / SERIES_BLOCK;
+        int skip = (int)(at % SERIES_BLOCK);
+        int take = SERIES_BLOCK - skip;
+        if (take > n - done) take = (int)(n - done);
+        decode_block(s, block, skip, out + done, take);
+        done += take;
+    }
+    if (done < n) {
+        memcpy(out + done, s->tail + (from + done - sealed), (size_t)(n - done) * sizeof(int));
+    }
+    return n;
+}
+
+size_t series_footprint(const Series *s) {
+    return sizeof(*s) + s->bytes_cap + (size_t)s->blocks_cap * sizeof(SeriesBlock);
+}
@@ -0,0 +1,274 @@
+/*
+ * 파일 목적: 바이너리 스냅샷 파일 형식 (섹션 단위 쓰기/읽기) 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
+
+#define SNAP_MAGIC SNAP_TAG('C', 'R', 'S', 'N')
+#define SNAP_VERSION 2u /* 2: USER section without the legacy id string */
+
+typedef struct SnapHeader {
+    uint32_t magic;
+    uint32_t version;
+    int64_t created;
+    uint32_t count;
+    uint32_t reserved;
+} SnapHeader;
+
+/* 함수 목적: 바이트열의 체크섬을 계산합니다. (FNV-1a)
+ * 매개변수: p, len
+ * 반환 값: 체크섬
+ */
+static uint32_t snap_checksum(const unsigned char *p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* 함수 목적: 스냅샷 작성기를 초기화합니다.
+ * 매개변수: w
+ * 반환 값: 없음
+ */
+void snap_writer_init(SnapWriter *w) {
+    if (!w) return;
+    memset(w, 0, sizeof(*w));
+}
+
+/* 함수 목적: 새 섹션을 시작합니다. 이전 섹션이 열려 있으면 먼저 닫습니다.
+ * 매개변수: w, tag
+ * 반환 값: 성공 1, 섹션 수 초과 시 0
+ */
+int snap_writer_begin(SnapWriter *w, uint32_t tag) {
+    if (!w || w->failed) return 0;
+    if (w->open) snap_writer_end(w);
+    if (w->count >= SNAP_MAX_SECTIONS) {
+        w->failed = 1;
+        return 0;
+    }
+    SnapSection *s = &w->sections[w->count];
+    memset(s, 0, sizeof(*s));
+    s->tag = tag;
+    s->offset = w->len; /* commit 시 헤더 크기만큼 옮긴다 */
+    w->open = 1;
+    return 1;
+}
+
+/* 함수 목적: 현재 섹션에 바이트열을 덧붙입니다. 버퍼는 두 배씩 늘립니다.
+ * 매개변수: w, data, len
+ * 반환 값: 없음
+ */
+void snap_put(SnapWriter *w, const void *data, size_t len) {
+    if (!w || w->failed || !w->open || len == 0) return;
+    if (w->len + len > w->cap) {
+        size_t ncap = w->cap ? w->cap * 2 : 4096;
+        while (ncap < w->len + len) ncap *= 2;
+        char *nbuf = realloc(w->buf, ncap);
+        if (!nbuf) {
+            w->failed = 1;
+            return;
+        }
+        w->buf = nbuf;
+        w->cap = ncap;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+void snap_put_u32(SnapWriter *w, uint32_t v) { snap_put(w, &v, sizeof(v)); }
+void snap_put_i32(SnapWriter *w, int32_t v) { snap_put(w, &v, sizeof(v)); }
+void snap_put_i64(SnapWriter *w, int64_t v) { snap_put(w, &v, sizeof(v)); }
+
+/* 함수 목적: 길이(u32)와 내용으로 문자열을 씁니다.
+ * 매개변수: w, s (NULL 이면 빈 문자열)
+ * 반환 값: 없음
+ */
+void snap_put_str(SnapWriter *w, const char *s) {
+    uint32_t n = s ? (uint32_t)strlen(s) : 0;
+    snap_put_u32(w, n);
+    snap_put(w, s, n);
+}
+
+/* 함수 목적: 현재 섹션을 닫고 길이와 체크섬을 기록합니다.
+ * 매개변수: w
+ * 반환 값: 없음
+ */
+void snap_writer_end(SnapWriter *w) {
+    if (!w || !w->open) return;
+    SnapSection *s = &w->sections[w->count++];
+    s->length = w->len - s->offset;
+    s->checksum = snap_checksum((const unsigned char *)w->buf + s->offset, (size_t)s->length);
+    w->open = 0;
+}
+
+/* 함수 목적: 헤더와 섹션 표를 붙여 스냅샷 파일을 씁니다. (임시 파일 후 rename)
+ * 매개변수: w, path, created
+ * 반환 값: 성공 여부
+ */
+int snap_writer_commit(SnapWriter *w, const char *path, int64_t created) {
+    if (!w || !path) return 0;
+    if (w->open) snap_writer_end(w);
+    if (w->failed) return 0;
+    size_t head = sizeof(SnapHeader) + (size_t)w->count * sizeof(SnapSection);
+    char *out = malloc(head + w->len);
+    if (!out) return 0;
+    SnapHeader hdr = {SNAP_MAGIC, SNAP_VERSION, created, w->count, 0};
+    memcpy(out, &hdr, sizeof(hdr));
+    for (uint32_t i = 0; i < w->count; ++i) {
+        SnapSection s = w->sections[i];
+        s.offset += head;
+        memcpy(out + sizeof(hdr) + i * sizeof(SnapSection), &s, sizeof(s));
+    }
+    if (w->len > 0) memcpy(out + head, w->buf, w->len);
+    int ok = csv_write_file(path, out, head + w->len);
+    free(out);
+    return ok;
+}
+
+/* 함수 목적: 작성기가 잡고 있는 버퍼를 해제합니다.
+ * 매개변수: w
+ * 반환 값: 없음
+ */
+void snap_writer_free(SnapWriter *w) {
+    if (!w) return;
+    free(w->buf);
+    memset(w, 0, sizeof(*w));
+}
+
+/* 함수 목적: 스냅샷 파일을 매핑하고 헤더와 섹션 표를 검사합니다.
+ * 매개변수: r, path
+ * 반환 값: 올바른 스냅샷이면 1, 없거나 버전이 다르거나 깨졌으면 0
+ */
+int snap_open(SnapReader *r, const char *path) {
+    if (!r) return 0;
+    memset(r, 0, sizeof(*r));
+    if (!path) return 0;
+    csv_flush_path(path);
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(path, &map, &len) || !map) return 0;
+    SnapHeader hdr;
+    if (len < sizeof(hdr)) {
+        csv_unmap_file(map, len);
+        return 0;
+    }
+    memcpy(&hdr, map, sizeof(hdr));
+    size_t head = sizeof(hdr) + (size_t)hdr.count * sizeof(SnapSection);
+    if (hdr.magic != SNAP_MAGIC || hdr.version != SNAP_VERSION || hdr.count > SNAP_MAX_SECTIONS || len < head) {
+        csv_unmap_file(map, len);
+        return 0;
+    }
+    const SnapSection *table = (const SnapSection *)((const char *)map + sizeof(hdr));
+    for (uint32_t i = 0; i < hdr.count; ++i) {
+        if (table[i].offset < head || table[i].offset > len || table[i].length > len - table[i].offset) {
+            csv_unmap_file(map, len);
+            return 0;
+        }
+    }
+    r->map = map;
+    r->len = len;
+    r->created = hdr.created;
+    r->count = hdr.count;
+    r->table = table;
+    return 1;
+}
+
+/* 함수 목적: 태그로 섹션을 찾아 커서를 엽니다. 체크섬이 맞지 않으면 실패합니다.
+ * 매개변수: r, tag, out
+ * 반환 값: 성공 1, 섹션이 없거나 깨졌으면 0
+ */
+int snap_section(const SnapReader *r, uint32_t tag, SnapCursor *out) {
+    if (!r || !r->map || !out) return 0;
+    memset(out, 0, sizeof(*out));
+    for (uint32_t i = 0; i < r->count; ++i) {
+        const SnapSection *s = &r->table[i];
+        if (s->tag != tag) continue;
+        const unsigned char *p = (const unsigned char *)r->map + s->offset;
+        if (snap_checksum(p, (size_t)s->length) != s->checksum) return 0;
+        out->p = p;
+        out->len = (size_t)s->length;
+        return 1;
+    }
+    return 0;
+}
+
+/* 함수 목적: 매핑을 해제합니다.
+ * 매개변수: r
+ * 반환 값: 없음
+ */
+void snap_close(SnapReader *r) {
+    if (!r) return;
+    csv_unmap_file(r->map, r->len);
+    memset(r, 0, sizeof(*r));
+}
+
+/* 함수 목적: 섹션에서 n 바이트를 꺼냅니다. 남은 길이가 모자라면 bad 를 세웁니다.
+ * 매개변수: c, dst, n
+ * 반환 값: 없음 (실패 시 dst 는 0 으로 채움)
+ */
+static void snap_get(SnapCursor *c, void *dst, size_t n) {
+    if (c->bad || n > c->len - c->pos) {
+        c->bad = 1;
+        memset(dst, 0, n);
+        return;
+    }
+    memcpy(dst, c->p + c->pos, n);
+    c->pos += n;
+}
+
+uint32_t snap_get_u32(SnapCursor *c) { uint32_t v; snap_get(c, &v, sizeof(v)); return v; }
+int32_t snap_get_i32(SnapCursor *c) { int32_t v; snap_get(c, &v, sizeof(v)); return v; }
+int64_t snap_get_i64(SnapCursor *c) { int64_t v; snap_get(c, &v, sizeof(v)); return v; }
+
+/* 함수 목적: snap_put_str 로 쓴 문자열을 읽어 dst 에 복사합니다.
+ * 매개변수: c, dst, cap
+ * 반환 값: 없음
+ */
+void snap_get_str(SnapCursor *c, char *dst, size_t cap) {
+    uint32_t n = snap_get_u32(c);
+    if (c->bad || n > c->len - c->pos) {
+        c->bad = 1;
+        if (cap > 0) dst[0] = '\0';
+        return;
+    }
+    if (cap > 0) {
+        size_t k = n < cap - 1 ? n : cap - 1;
+        memcpy(dst, c->p + c->pos, k);
+        dst[k] = '\0';
+    }
+    c->pos += n;
+}
+
+/* 함수 목적: 파일 크기를 구합니다.
+ * 매개변수: path
+ * 반환 값: 바이트 수, 파일이 없으면 -1
+ */
+int64_t snap_file_size(const char *path) {
+    if (!path) return -1;
+    csv_flush_path(path);
+    struct stat st;
+    if (stat(path, &st) != 0) return -1;
+    return (int64_t)st.st_size;
+}
+
+/* 함수 목적: 스냅샷을 만든 뒤로 원본 파일이 바뀌지 않았는지 확인합니다.
+ *           mtime 이 초 단위라 스냅샷과 같은 초에 고친 파일은 바뀐 것으로 봅니다.
+ * 매개변수: path, recorded_size, created
+ * 반환 값: 그대로이면 1
+ */
+int snap_file_unchanged(const char *path, int64_t recorded_size, int64_t created) {
+    if (!path) return 0;
+    csv_flush_path(path);
+    struct stat st;
+    if (stat(path, &st) != 0) return recorded_size < 0;
+    return (int64_t)st.st_size == recorded_size && (int64_t)st.st_mtime < created;
+}
@@ -0,0 +1,158 @@
+/*
+ * 파일 목적: 병렬 반복문용 작업자 스레드 풀 구현
+ * 작성자: 이현준
+ */
+#include "../../include/core/worker_pool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static pthread_t g_threads[WORKER_POOL_MAX];
+static int g_thread_count = 0;
+static int g_started = 0;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_run_lock = PTHREAD_MUTEX_INITIALIZER; /* 작업은 한 번에 하나 */
+static pthread_cond_t g_work = PTHREAD_COND_INITIALIZER;       /* 새 작업 또는 종료 */
+static pthread_cond_t g_idle = PTHREAD_COND_INITIALIZER;       /* 작업자가 모두 손을 놓음 */
+
+/* 현재 작업: g_generation 이 바뀌면 작업자가 깨어나 g_next 에서 번호를 가져간다 */
+static WorkerFn g_fn = NULL;
+static void *g_ctx = NULL;
+static size_t g_count = 0;
+static atomic_size_t g_next;
+static unsigned long g_generation = 0;
+static unsigned long g_spawn_generation = 0; /* 작업자를 띄울 때의 세대, 그 전 작업은 건너뜀 */
+static int g_busy = 0;
+static int g_stop = 0;
+
+/* 함수 목적: 남은 번호를 하나씩 가져와 처리합니다.
+ * 매개변수: fn, ctx, count
+ * 반환 값: 없음
+ */
+static void drain_indices(WorkerFn fn, void *ctx, size_t count) {
+    for (;;) {
+        size_t i = atomic_fetch_add(&g_next, 1);
+        if (i >= count) return;
+        fn(i, ctx);
+    }
+}
+
+/* 함수 목적: 작업자 스레드 본체. 작업이 올 때까지 잠들고, 끝나면 g_busy 를 줄입니다.
+ * 매개변수: arg (사용하지 않음)
+ * 반환 값: NULL
+ */
+static void *worker_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_lock);
+    unsigned long seen = g_spawn_generation;
+    for (;;) {
+        while (!g_stop && g_generation == seen) pthread_cond_wait(&g_work, &g_lock);
+        if (g_stop) break;
+        seen = g_generation;
+        WorkerFn fn = g_fn;
+        void *ctx = g_ctx;
+        size_t count = g_count;
+        pthread_mutex_unlock(&g_lock);
+        drain_indices(fn, ctx, count);
+        pthread_mutex_lock(&g_lock);
+        if (--g_busy == 0) pthread_cond_broadcast(&g_idle);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return NULL;
+}
+
+/* 함수 목적: 온라인 CPU 수를 구합니다.
+ * 매개변수: 없음
+ * 반환 값: CPU 수 (알 수 없으면 1)
+ */
+static int cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int)si.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/* 함수 목적: 작업자를 처음 한 번 띄웁니다. 호출 스레드도 일하므로 CPU 수 - 1 개만 만듭니다.
+ * 매개변수: 없음
+ * 반환 값: 없음 (g_lock 을 잡은 채로 호출)
+ */
+static void start_locked(void) {
+    if (g_started) return;
+    g_started = 1;
+    g_stop = 0;
+    g_spawn_generation = g_generation;
+    int want = cpu_count() - 1;
+    if (want > WORKER_POOL_MAX) want = WORKER_POOL_MAX;
+    for (int i = 0; i < want; ++i) {
+        if (pthread_create(&g_threads[g_thread_count], NULL, worker_main, NULL) != 0) break;
+        g_thread_count++;
+    }
+}
+
+/* 함수 목적: [0, count) 의 모든 번호에 대해 fn 을 병렬로 부르고, 모두 끝나면 돌아옵니다.
+ * 매개변수: count, fn, ctx
+ * 반환 값: 없음
+ */
+void worker_pool_for(size_t count, WorkerFn fn, void *ctx) {
+    if (!fn || count == 0) return;
+    pthread_mutex_lock(&g_run_lock);
+    pthread_mutex_lock(&g_lock);
+    start_locked();
+    g_fn = fn;
+    g_ctx = ctx;
+    g_count = count;
+    atomic_store(&g_next, 0);
+    g_busy = g_thread_count;
+    g_generation++;
+    pthread_cond_broadcast(&g_work);
+    pthread_mutex_unlock(&g_lock);
+
+    drain_indices(fn, ctx, count);
+
+    pthread_mutex_lock(&g_lock);
+    while (g_busy > 0) pthread_cond_wait(&g_idle, &g_lock);
+    g_fn = NULL;
+    g_ctx = NULL;
+    pthread_mutex_unlock(&g_lock);
+    pthread_mutex_unlock(&g_run_lock);
+}
+
+/* 함수 목적: 작업 하나가 도는 스레드 수를 알려 줍니다. (호출 스레드 포함)
+ * 매개변수: 없음
+ * 반환 값: 스레드 수
+ */
+int worker_pool_size(void) {
+    pthread_mutex_lock(&g_lock);
+    start_locked();
+    int n = g_thread_count + 1;
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+/* 함수 목적: 작업자를 모두 깨워 끝내고 기다립니다. 다음 작업이 오면 다시 띄웁니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void worker_pool_stop(void) {
+    pthread_mutex_lock(&g_run_lock);
+    pthread_mutex_lock(&g_lock);
+    g_stop = 1;
+    pthread_cond_broadcast(&g_work);
+    pthread_mutex_unlock(&g_lock);
+    for (int i = 0; i < g_thread_count; ++i) pthread_join(g_threads[i], NULL);
+    pthread_mutex_lock(&g_lock);
+    g_thread_count = 0;
+    g_started = 0;
+    pthread_mutex_unlock(&g_lock);
+    pthread_mutex_unlock(&g_run_lock);
+}
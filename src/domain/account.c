@@ -10,29 +10,12 @@
 #include <time.h>
 #include <limits.h>
 
+#include "../../include/domain/ledger.h"
 #include "../../include/domain/user.h"
+#include "../../include/domain/valuation.h"
 #include "../../include/core/csv.h"
-
-/* 함수 목적: user의 bank log에 msg를 추가합니다.
- * 매개변수: user, msg
- * 반환 값: 없음
- */
-void bank_log_append(User *user, const char *msg) {
-    if (!user || !msg) return;
-
-    char  *log = user->bank.log;
-    size_t len = strlen(log);
-    size_t cap = sizeof(user->bank.log);
-
-    if (len + 1 >= cap) {
-        // 자리 없으면 포기
-        return;
-    }
-
-    size_t remain = cap - len - 1; // 마지막 널 문자 고려
-    snprintf(log + len, remain, "%s\n", msg);
-}
-
+#include "../../include/core/csv_cursor.h"
+#include "../../include/core/csv_index.h"
 
 /* 함수 목적: Bank 포인터 out을 통해 username에 해당하는 사용자의 계좌 정보를 가져옵니다.
  * 매개변수: username, out
@@ -67,26 +50,65 @@ int account_adjust(Bank *acc, int amount) {
 
     acc->balance = (int)candidate;
 
-    // --- 여기부터: 메모리 로그에 기록 ---
-    // "timestamp,amount,balance" 형태로 한 줄 만들기
-    char entry[128];
-    snprintf(entry, sizeof(entry),
-             "%ld,%+d,%d",
-             (long)time(NULL),  // 현재 시각 (epoch time)
-             amount,            // 입금/출금 금액
-             acc->balance);     // 변경 후 잔액
-
-    // acc->log 끝에 이어붙이기
-    size_t len = strlen(acc->log);
-    size_t cap = sizeof(acc->log);
-
-    if (len + 1 < cap) {  // 널 문자 자리 고려
-        size_t remain = cap - len - 1;
-        snprintf(acc->log + len, remain, "%s\n", entry);
+    /* 거래 내역은 장부와 data/txs/<user>.csv 에만 남긴다 (account_post) */
+    return 1;
+}
+
+/* 함수 목적: 거래 내역 한 줄을 사람이 읽기 쉬운 문자열로 바꿉니다.
+ *           "ts,reason,amount,balance" (새 형식)과 "ts,amount,balance" (옛 형식)을 모두 받으며
+ *           빈 필드는 열 수를 셀 때 건너뜁니다.
+ * 매개변수: line, len (개행 제외), out, cap
+ * 반환 값: 쓴 바이트 수 (snprintf 와 같음)
+ */
+int account_format_tx(const char *line, size_t len, char *out, size_t cap) {
+    if (!line || !out || cap == 0) return -1;
+    CsvCursor cur;
+    csv_cursor_init(&cur, line, len, ',');
+    csv_cursor_next_row(&cur);
+    CsvField tok[4];
+    int tc = 0;
+    CsvField fld;
+    while (tc < 4 && csv_cursor_next_field(&cur, &fld)) {
+        if (fld.len > 0) tok[tc++] = fld;
     }
-    // 로그가 다 찼으면 그냥 새로운 로그는 버림 (원하면 처리 추가 가능)
 
-    return 1;
+    long ts = 0;
+    char reason[128] = "";
+    int amount = 0;
+    int balance = 0;
+    if (tc > 0) csv_field_long(tok[0], &ts);
+
+    if (tc >= 4) {
+        /* new format with reason */
+        csv_field_copy(tok[1], reason, sizeof(reason));
+        csv_field_int(tok[2], &amount);
+        csv_field_int(tok[3], &balance);
+    } else if (tc == 3) {
+        /* old format without reason */
+        csv_field_int(tok[1], &amount);
+        csv_field_int(tok[2], &balance);
+    } else {
+        /* fallback: try to interpret second token as amount */
+        if (tc > 1) csv_field_int(tok[1], &amount);
+        balance = 0;
+    }
+
+    /* format absolute datetime */
+    char timestr[64];
+    if (ts <= 0) {
+        snprintf(timestr, sizeof(timestr), "unknown");
+    } else {
+        time_t tt = (time_t)ts;
+        struct tm *tm = localtime(&tt);
+        if (tm) strftime(timestr, sizeof(timestr), "%Y-%m-%d %H:%M", tm);
+        else snprintf(timestr, sizeof(timestr), "%ld", ts);
+    }
+
+    /* include reason if present */
+    if (reason[0]) {
+        return snprintf(out, cap, "[%s] %s %+d Cr (bal %d)", timestr, reason, amount, balance);
+    }
+    return snprintf(out, cap, "[%s] %+d Cr (bal %d)", timestr, amount, balance);
 }
 
 /* 함수 목적: account_recent_tx 함수는 주어진 사용자의 최근 거래(transaction) 기록을 읽어 사람이
@@ -98,67 +120,19 @@ int account_recent_tx(const char *username, int limit, char *buf, size_t buflen)
     if (!username || !buf || buflen == 0) return -1;
     char path[512];
     snprintf(path, sizeof(path), "data/txs/%s.csv", username);
-    char *tmp = NULL;
-    size_t tmplen = 0;
-    if (!csv_read_last_lines(path, limit, &tmp, &tmplen) || !tmp) {
+    CsvTail it;
+    if (!csv_tail_open(&it, path, limit)) {
         buf[0] = '\0';
         return 0;
     }
-    /* tmp contains lines like: "<ts>,<amount>,<balance>\n". Parse and
-       convert timestamp to readable datetime then append to `buf`. */
     size_t outpos = 0;
-    char *p = tmp;
-    while (p && *p && outpos + 1 < buflen) {
-        char *nl = strchr(p, '\n');
-        if (nl) *nl = '\0';
-
-        /* parse flexible formats:
-         * old: ts,amount,balance
-         * new: ts,reason,amount,balance
-         */
-        char *tok1 = strtok(p, ",");
-        char *tok2 = tok1 ? strtok(NULL, ",") : NULL;
-        char *tok3 = tok2 ? strtok(NULL, ",") : NULL;
-        char *tok4 = tok3 ? strtok(NULL, ",") : NULL;
-
-        long ts = tok1 ? atol(tok1) : 0;
-        char reason[128] = "";
-        int amount = 0;
-        int balance = 0;
-
-        if (tok4) {
-            /* new format with reason */
-            if (tok2) snprintf(reason, sizeof(reason), "%s", tok2);
-            amount = tok3 ? atoi(tok3) : 0;
-            balance = tok4 ? atoi(tok4) : 0;
-        } else if (tok3) {
-            /* old format without reason */
-            amount = tok2 ? atoi(tok2) : 0;
-            balance = tok3 ? atoi(tok3) : 0;
-        } else {
-            /* fallback: try to interpret second token as amount */
-            amount = tok2 ? atoi(tok2) : 0;
-            balance = 0;
-        }
-
-        /* format absolute datetime */
-        char timestr[64];
-        if (ts <= 0) {
-            snprintf(timestr, sizeof(timestr), "unknown");
-        } else {
-            time_t tt = (time_t)ts;
-            struct tm *tm = localtime(&tt);
-            if (tm) strftime(timestr, sizeof(timestr), "%Y-%m-%d %H:%M", tm);
-            else snprintf(timestr, sizeof(timestr), "%ld", ts);
-        }
-
-        /* include reason if present */
-        int wrote = 0;
-        if (reason[0]) {
-            wrote = snprintf(buf + outpos, buflen - outpos, "[%s] %s %+d Cr (bal %d)\n", timestr, reason, amount, balance);
-        } else {
-            wrote = snprintf(buf + outpos, buflen - outpos, "[%s] %+d Cr (bal %d)\n", timestr, amount, balance);
-        }
+    const char *line = NULL;
+    size_t line_len = 0;
+    while (outpos + 1 < buflen && csv_tail_next(&it, &line, &line_len)) {
+        char text[256];
+        int wrote = account_format_tx(line, line_len, text, sizeof(text));
+        if (wrote < 0) break;
+        wrote = snprintf(buf + outpos, buflen - outpos, "%s\n", text);
         if (wrote < 0) break;
         if ((size_t)wrote >= buflen - outpos) {
             outpos = buflen - 1;
@@ -166,18 +140,98 @@ int account_recent_tx(const char *username, int limit, char *buf, size_t buflen)
             break;
         }
         outpos += (size_t)wrote;
-
-        if (!nl) break;
-        p = nl + 1;
     }
 
-    free(tmp);
-    tmp = NULL;
+    csv_tail_close(&it);
     if (outpos >= buflen) outpos = buflen - 1;
     buf[outpos] = '\0';
     return (int)outpos;
 }
 
+/* 함수 목적: 사용자의 전체 거래 내역을 페이지 단위로 읽기 위한 줄 색인을 엽니다.
+ *           (data/txs/<username>.csv.idx, 마지막으로 연 뒤 덧붙은 줄만 새로 색인)
+ * 매개변수: username, ix
+ * 반환 값: 성공 여부 (내역이 없으면 줄 수 0 으로 성공)
+ */
+int account_tx_open(const char *username, CsvIndex *ix) {
+    if (!username || !ix) return 0;
+    char path[512];
+    snprintf(path, sizeof(path), "data/txs/%s.csv", username);
+    return csv_index_open(ix, path);
+}
+
+/* 함수 목적: 계좌 변경 한 건을 장부(data/ledger)에 먼저 기록한 뒤, 사용자별 거래 내역
+ *           data/txs/<username>.csv 에 같은 내용을 "ts,reason,amount,balance" 한 줄로 남깁니다.
+ *           거래 내역은 보기용이고, 잔액 복구는 장부만 사용합니다. 레코드가 일정 수 쌓이면
+ *           전체 잔액 체크포인트를 씁니다.
+ * 매개변수: user (변경이 이미 반영된 상태), type, amount (내역에 보일 부호 있는 금액), reason
+ * 반환 값: 성공 여부
+ */
+int account_post(User *user, LedgerType type, int amount, const char *reason) {
+    if (!user) return 0;
+    LedgerEntry e;
+    memset(&e, 0, sizeof(e));
+    e.ts = (long)time(NULL);
+    e.type = type;
+    snprintf(e.user, sizeof(e.user), "%s", user->name);
+    e.amount = amount;
+    e.balance = user->bank.balance;
+    e.cash = user->bank.cash;
+    e.loan = user->bank.loan;
+    snprintf(e.reason, sizeof(e.reason), "%s", reason ? reason : "");
+    int ok = ledger_append(&e); /* 이유 문자열의 쉼표/개행은 여기서 공백으로 바뀐다 */
+    valuation_touch(user);
+
+    csv_ensure_dir("data");
+    csv_ensure_dir("data/txs");
+    char path[512];
+    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
+    csv_append_row(path, "%ld,%s,%+d,%d", e.ts, e.reason, amount, user->bank.balance);
+
+    if (ledger_checkpoint_due()) user_ledger_checkpoint();
+    return ok;
+}
+
+/* 함수 목적: 이미 반영된 계좌 변경 여러 건을 한꺼번에 기록합니다. (전체 이자 정산용)
+ *           장부에는 한 번에 덧붙이고, 거래 내역 보기용 행은 사용자마다 하나씩 남기며,
+ *           체크포인트는 마지막에 한 번만 확인합니다.
+ * 매개변수: entries (user, type, amount, reason 과 변경 뒤 잔액이 채워진 상태), count
+ * 반환 값: 장부에 기록한 건수
+ */
+size_t account_post_batch(LedgerEntry *entries, size_t count) {
+    if (!entries || count == 0) return 0;
+    size_t done = ledger_append_batch(entries, count);
+    for (size_t i = 0; i < done && valuation_ready(); ++i) {
+        if (i == 0 || strcmp(entries[i].user, entries[i - 1].user) != 0) valuation_touch(user_lookup(entries[i].user));
+    }
+
+    csv_ensure_dir("data");
+    csv_ensure_dir("data/txs");
+    for (size_t i = 0; i < done;) {
+        /* 같은 사용자의 연속된 행은 한 번에 덧붙인다 */
+        char rows[512];
+        size_t len = 0;
+        size_t j = i;
+        for (; j < done && strcmp(entries[j].user, entries[i].user) == 0; ++j) {
+            const LedgerEntry *e = &entries[j];
+            int n = snprintf(rows + len, sizeof(rows) - len, "%ld,%s,%+d,%d\n", e->ts, e->reason, e->amount, e->balance);
+            if (n < 0 || (size_t)n >= sizeof(rows) - len) break;
+            len += (size_t)n;
+        }
+        if (j == i) {
+            /* 한 줄도 들어가지 않으면 빈 덧붙이기를 쓰기 스레드에 보내지 않고 건너뛴다 */
+            i = i + 1;
+            continue;
+        }
+        char path[512];
+        snprintf(path, sizeof(path), "data/txs/%s.csv", entries[i].user);
+        csv_append_raw(path, rows, len);
+        i = j;
+    }
+    if (ledger_checkpoint_due()) user_ledger_checkpoint();
+    return done;
+}
+
 /* 함수 목적: account_add_tx 함수는 account 도메인 기능 구현에서 필요한 동작을 수행합니다.
  * 매개변수: user, amount, reason
  * 반환 값: 함수 수행 결과를 나타냅니다.
@@ -188,23 +242,7 @@ int account_add_tx(User *user, int amount, const char *reason) {
     if (!account_adjust(&user->bank, amount)) {
         return 0;
     }
-
-    /* sanitize reason: replace commas/newlines with space */
-    char reason_safe[128] = "";
-    if (reason && reason[0]) {
-        snprintf(reason_safe, sizeof(reason_safe), "%s", reason);
-        for (size_t i = 0; i < sizeof(reason_safe); ++i) {
-            if (reason_safe[i] == ',' || reason_safe[i] == '\n' || reason_safe[i] == '\r') reason_safe[i] = ' ';
-            if (reason_safe[i] == '\0') break;
-        }
-    }
-
-    /* ensure directory exists and append a CSV row: ts,reason,amount,balance */
-    csv_ensure_dir("data");
-    csv_ensure_dir("data/txs");
-    char path[512];
-    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-    csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason_safe[0] ? reason_safe : "", amount, user->bank.balance);
+    account_post(user, LEDGER_ADJUST, amount, reason);
     return 1;
 }
 
@@ -224,13 +262,8 @@ int account_withdraw_to_cash(User *user, int amount, const char *reason) {
     if (newcash > INT_MAX) return 0;
     user->bank.cash = (int)newcash;
 
-    /* append tx noting withdrawal */
-    csv_ensure_dir("data");
-    csv_ensure_dir("data/txs");
-    char path[512];
-    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
     /* reason will be visible and include withdrawal note */
-    csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason ? reason : "WITHDRAW", -amount, user->bank.balance);
+    account_post(user, LEDGER_WITHDRAW, -amount, reason ? reason : "WITHDRAW");
     return 1;
 }
 
@@ -258,11 +291,7 @@ int account_deposit_from_cash(User *user, int amount, const char *reason) {
         user->bank.cash += amount;
         return 0;
     }
-    csv_ensure_dir("data");
-    csv_ensure_dir("data/txs");
-    char path[512];
-    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-    csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason ? reason : "CASH_DEPOSIT", amount, user->bank.balance);
+    account_post(user, LEDGER_DEPOSIT, amount, reason ? reason : "CASH_DEPOSIT");
     return 1;
 }
 
@@ -286,11 +315,7 @@ int account_take_loan(User *user, int amount, const char *reason) {
     user->bank.cash = (int)newcash;
 
     /* record tx */
-    csv_ensure_dir("data");
-    csv_ensure_dir("data/txs");
-    char path[512];
-    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-    csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason ? reason : "LOAN", amount, user->bank.balance);
+    account_post(user, LEDGER_LOAN, amount, reason ? reason : "LOAN");
     return 1;
 }
 
@@ -313,11 +338,7 @@ int account_repay_loan(User *user, int amount, const char *reason) {
     user->bank.loan -= amount;
 
     /* record tx */
-    csv_ensure_dir("data");
-    csv_ensure_dir("data/txs");
-    char path[512];
-    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-    csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason ? reason : "LOAN_REPAY", -amount, user->bank.balance);
+    account_post(user, LEDGER_REPAY, -amount, reason ? reason : "LOAN_REPAY");
     return 1;
 }
 
@@ -350,22 +371,20 @@ int account_grant_cash(User *user, int amount, const char *reason) {
     user->bank.cash = (int)newcash;
 
     /* append tx noting grant (balance unchanged) */
-    csv_ensure_dir("data");
-    csv_ensure_dir("data/txs");
-    char path[512];
-    snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-
-    /* sanitize reason similar to account_add_tx */
-    char reason_safe[128] = "";
-    if (reason && reason[0]) {
-        snprintf(reason_safe, sizeof(reason_safe), "%s", reason);
-        for (size_t i = 0; i < sizeof(reason_safe); ++i) {
-            if (reason_safe[i] == ',' || reason_safe[i] == '\n' || reason_safe[i] == '\r') reason_safe[i] = ' ';
-            if (reason_safe[i] == '\0') break;
-        }
-    }
+    account_post(user, LEDGER_GRANT, amount, reason);
+    return 1;
+}
 
-    csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason_safe[0] ? reason_safe : "", amount, user->bank.balance);
+/* 함수 목적: 사용자의 현금(cash)에서 amount 만큼 지출합니다. (상점 구매, 좌석 예약 등)
+ *           현금이 모자라면 아무것도 바꾸지 않습니다. 예금(balance)에는 영향이 없습니다.
+ * 매개변수: user, amount (>0), reason
+ * 반환 값: 성공 1, 인자 오류/현금 부족 0
+ */
+int account_spend_cash(User *user, int amount, const char *reason) {
+    if (!user || amount <= 0) return 0;
+    if (user->bank.cash < amount) return 0;
+    user->bank.cash -= amount;
+    account_post(user, LEDGER_SPEND, -amount, reason);
     return 1;
 }
 
@@ -16,20 +16,18 @@
 
 /* 함수 목적: 지정한 사용자(username)에게 미션을 배정합니다.
  * 설명:
- *   - 관리자 또는 시스템이 특정 사용자에게 미션을 추가할 때 호출합니다.
- *   - 사용자 존재 여부와 남아 있는 미션 슬롯을 확인한 뒤, 해당 사용자의
- *     미션 배열에 `Mission` 내용을 복사하고 `completed`를 0으로 초기화합니다.
- *   - 배정 성공 시 `mission_count`와 `total_missions`를 적절히 증가시킵니다.
- *   - 현재 구현은 배정(ASSIGN) 자체를 per-user CSV로 영속화하지 않으므로,
- *     필요하면 호출자 또는 별도 코드에서 영속화 처리를 추가해야 합니다.
+ *   - 모든 사용자는 전역 카탈로그의 미션 전부를 배정받은 것으로 보므로,
+ *     사용자별로 미션을 복사해 두지 않습니다. 미션이 카탈로그에 있는지만
+ *     확인하고, 사용자의 `total_missions`를 카탈로그 크기에 맞춥니다.
+ *   - 완료 여부는 사용자별 완료 비트셋(user_mission_done)에 있습니다.
  *
  * 매개변수:
  *   - username: 대상 사용자 이름 (NULL이면 실패)
  *   - m: 배정할 `Mission` 포인터 (NULL이면 실패)
  *
  * 반환값:
- *   - 성공: 1 (미션 배정 성공)
- *   - 실패: 0 (인자 오류, 사용자 없음, 미션 슬롯 부족 등)
+ *   - 성공: 1 (미션이 카탈로그에 있어 사용자에게 배정됨)
+ *   - 실패: 0 (인자 오류, 사용자 없음, 카탈로그에 없는 미션)
 
  */
 int admin_assign_mission(const char *username, const Mission *m) {
@@ -37,16 +35,10 @@ int admin_assign_mission(const char *username, const Mission *m) {
         return 0;
     }
     User *user = user_lookup(username);
-    if (!user) {
+    if (!user || mission_catalog_slot(m->id) < 0) {
         return 0;
     }
-    if (user->mission_count >= (int)(sizeof(user->missions) / sizeof(user->missions[0]))) {
-        return 0;
-    }
-    Mission *slot = &user->missions[user->mission_count++];
-    *slot = *m;
-    slot->completed = 0;
-    user->total_missions += 1;
+    user->total_missions = mission_catalog_count();
     /* NOTE: ASSIGN entries are no longer persisted to per-user CSVs. */
     return 1;
 }
@@ -12,9 +12,12 @@
 #include <limits.h>
 #include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../../include/domain/account.h"
 #include "../../include/core/csv.h"
+#include "../../include/domain/ledger.h"
 
 /* 함수 목적: 은행에 돈을 예금
  * 매개변수: acc, amount
@@ -50,57 +53,140 @@ int econ_repay(Bank *acc, int amount) {
     return account_adjust(acc, -amount);
 }
 
-/* 함수 목적: 1시간 단위로 이자 지급
- * 매개변수: user, hours
- * 반환 값: 성공 여부
+/* 시간당 복리 계수표: g_*_factor[h] = (1 + r)^h 를 Q32 고정소수점으로 (h = 0..ECON_FACTOR_HOURS).
+ * 금액(< 2^31) 과 계수(< 2^33) 의 곱이 64비트에 들어가므로 정산 중에는 pow 도 double 도 쓰지 않는다.
  */
-int econ_apply_hourly_interest(User *user, int hours) {
-    if (!user || hours <= 0) return 0;
+#define ECON_FACTOR_HOURS 168
+#define ECON_FACTOR_SHIFT 32
+#define ECON_RATE_DEPOSIT 0.001  /* 0.1% per hour */
+#define ECON_RATE_LOAN 0.0015    /* 0.15% per hour */
 
-    /* rates */
-    const double r_deposit = 0.001;  /* 0.1% per hour */
-    const double r_loan = 0.0015;    /* 0.15% per hour */
+static uint64_t g_deposit_factor[ECON_FACTOR_HOURS + 1];
+static uint64_t g_loan_factor[ECON_FACTOR_HOURS + 1];
+static int g_factors_ready = 0;
 
-    double bal = (double)user->bank.balance;
-    double loan = (double)user->bank.loan;
-
-    /* compound */
-    double newbal_d = floor(bal * pow(1.0 + r_deposit, hours) + 0.0000001);
-    double newloan_d = floor(loan * pow(1.0 + r_loan, hours) + 0.0000001);
-
-    if (newbal_d < 0) newbal_d = 0;
-    if (newloan_d < 0) newloan_d = 0;
+/* 함수 목적: 복리 계수표를 한 번 만듭니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void build_factor_tables(void) {
+    if (g_factors_ready) return;
+    const double one = (double)((uint64_t)1 << ECON_FACTOR_SHIFT);
+    for (int h = 0; h <= ECON_FACTOR_HOURS; ++h) {
+        g_deposit_factor[h] = (uint64_t)llround(pow(1.0 + ECON_RATE_DEPOSIT, h) * one);
+        g_loan_factor[h] = (uint64_t)llround(pow(1.0 + ECON_RATE_LOAN, h) * one);
+    }
+    g_factors_ready = 1;
+}
 
-    int newbal = (int)newbal_d;
-    int newloan = (int)newloan_d;
+/* 함수 목적: 금액에 hours 시간 복리를 적용합니다. 표보다 긴 기간은 표 끝 계수를
+ *           여러 번 곱하고, 단계마다 원 단위 아래는 버립니다. INT_MAX 에서 멈춥니다.
+ * 매개변수: amount, table, hours
+ * 반환 값: 이자를 더한 금액
+ */
+static int compound(int amount, const uint64_t *table, long hours) {
+    uint64_t v = amount > 0 ? (uint64_t)amount : 0;
+    while (hours > 0 && v > 0) {
+        long step = hours > ECON_FACTOR_HOURS ? ECON_FACTOR_HOURS : hours;
+        v = (v * table[step]) >> ECON_FACTOR_SHIFT;
+        if (v >= (uint64_t)INT_MAX) return INT_MAX;
+        hours -= step;
+    }
+    return amount > 0 ? (int)v : amount;
+}
 
-    int bal_diff = newbal - user->bank.balance;
-    int loan_diff = newloan - user->bank.loan;
+/* 함수 목적: 장부 레코드 한 건을 채웁니다.
+ * 매개변수: e, user, now, type, amount, reason
+ * 반환 값: 없음
+ */
+static void fill_entry(LedgerEntry *e, const User *user, long now, LedgerType type, int amount, const char *reason) {
+    memset(e, 0, sizeof(*e));
+    e->ts = now;
+    e->type = type;
+    snprintf(e->user, sizeof(e->user), "%s", user->name);
+    e->amount = amount;
+    e->balance = user->bank.balance;
+    e->cash = user->bank.cash;
+    e->loan = user->bank.loan;
+    snprintf(e->reason, sizeof(e->reason), "%s", reason);
+}
 
+/* 함수 목적: 계좌 하나에 hours 시간치 이자를 반영하고, 생긴 장부 레코드를 out 에 채웁니다.
+ * 매개변수: user, hours, now, out (2칸)
+ * 반환 값: 채운 레코드 수 (0~2)
+ */
+static int accrue_user(User *user, long hours, long now, LedgerEntry *out) {
+    int n = 0;
+    int bal_diff = compound(user->bank.balance, g_deposit_factor, hours) - user->bank.balance;
+    int loan_diff = compound(user->bank.loan, g_loan_factor, hours) - user->bank.loan;
     if (bal_diff != 0) {
-        /* use account_adjust so balance log is updated */
-        if (!account_adjust(&user->bank, bal_diff)) return 0;
-        /* also write a transaction row for visibility */
-        csv_ensure_dir("data");
-        csv_ensure_dir("data/txs");
-        char path[512];
-        snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-        csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), "INTEREST_DEPOSIT", bal_diff, user->bank.balance);
+        user->bank.balance += bal_diff;
+        fill_entry(&out[n++], user, now, LEDGER_INTEREST, bal_diff, "INTEREST_DEPOSIT");
     }
-
     if (loan_diff != 0) {
-        long newloan_long = (long)user->bank.loan + loan_diff;
-        if (newloan_long > INT_MAX) return 0;
-        user->bank.loan = (int)newloan_long;
-        /* persist a loan-interest row in txs for traceability */
-        csv_ensure_dir("data");
-        csv_ensure_dir("data/txs");
-        char path[512];
-        snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
+        user->bank.loan += loan_diff;
         char reason[64];
-        snprintf(reason, sizeof(reason), "INTEREST_LOAN_%dh", hours);
-        csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason, loan_diff, user->bank.balance);
+        snprintf(reason, sizeof(reason), "INTEREST_LOAN_%ldh", hours);
+        fill_entry(&out[n++], user, now, LEDGER_LOAN_INTEREST, loan_diff, reason);
     }
+    return n;
+}
 
+/* 함수 목적: 1시간 단위로 이자 지급 (사용자 한 명, 계수표 사용)
+ * 매개변수: user, hours
+ * 반환 값: 성공 여부
+ */
+int econ_apply_hourly_interest(User *user, int hours) {
+    if (!user || hours <= 0) return 0;
+    build_factor_tables();
+    LedgerEntry entries[2];
+    int n = accrue_user(user, hours, (long)time(NULL), entries);
+    account_post_batch(entries, (size_t)n);
     return 1;
 }
+
+/* 함수 목적: 모든 계좌에 밀린 이자를 한 번에 정산합니다.
+ *           계좌마다 마지막 정산 뒤로 지난 온전한 시간 수만큼 복리를 적용하고
+ *           정산 시각은 그 시간만큼만 앞으로 옮겨, 남은 분·초는 다음 정산에 넘깁니다.
+ *           장부 기록은 한 번에 덧붙이고 계좌 저장소도 마지막에 한 번만 씁니다.
+ * 매개변수: now, out (NULL 가능)
+ * 반환 값: 성공 여부
+ */
+int econ_accrue_all(long now, EconAccrualStats *out) {
+    EconAccrualStats stats;
+    memset(&stats, 0, sizeof(stats));
+    build_factor_tables();
+
+    size_t total = user_count();
+    LedgerEntry *entries = NULL;
+    size_t count = 0, cap = 0;
+    int ok = 1;
+    for (size_t i = 0; i < total; ++i) {
+        User *u = user_at_mut(i);
+        if (!u || u->name[0] == '#') continue; /* users.csv 헤더 줄 */
+        long ts = user_interest_ts(u);
+        long hours = (now - ts) / 3600;
+        if (hours <= 0) continue;
+        if (count + 2 > cap) {
+            size_t ncap = cap ? cap * 2 : 256;
+            LedgerEntry *n = realloc(entries, ncap * sizeof(*n));
+            if (!n) {
+                ok = 0;
+                break;
+            }
+            entries = n;
+            cap = ncap;
+        }
+        int before_bal = u->bank.balance, before_loan = u->bank.loan;
+        count += (size_t)accrue_user(u, hours, now, entries + count);
+        u->bank.last_interest_ts = ts + hours * 3600;
+        stats.accounts++;
+        stats.deposit_interest += u->bank.balance - before_bal;
+        stats.loan_interest += u->bank.loan - before_loan;
+    }
+    stats.postings = account_post_batch(entries, count);
+    if (stats.accounts > 0) user_store_flush();
+    free(entries);
+    if (out) *out = stats;
+    return ok;
+}
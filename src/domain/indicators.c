@@ -0,0 +1,198 @@
+/*
+ * 파일 목적: 주식 그래프용 기술 지표 시계열을 종목별로 캐시하고 이어서 계산하는 구현
+ * 작성자: 이현준
+ */
+#include "../../include/domain/indicators.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/core/rolling.h"
+#include "../../include/domain/stock.h"
+
+/* 한 번에 읽어 오는 가격 수 */
+#define INDICATOR_READ_CHUNK 512
+
+/* 종목 하나의 캐시: 지표 배열과, 다음 가격부터 이어 계산할 커널 상태 */
+typedef struct IndicatorSlot {
+    char symbol[64];
+    unsigned long used; /* 마지막으로 쓴 순번 (LRU) */
+    IndicatorSeries series;
+    float *value[IND_COUNT];
+    long cap;
+
+    RollingSum     sma;
+    RollingEma     ema;
+    RollingSum     band;
+    RollingExtrema low;
+    RollingExtrema high;
+    RollingRsi     rsi;
+    RollingVwap    vwap; /* 끝난 단계까지만 넣는다: 마지막 단계는 아직 거래가 쌓인다 */
+    long           vwap_done;
+} IndicatorSlot;
+
+static IndicatorSlot g_slots[INDICATOR_CACHE_SLOTS];
+static unsigned long g_clock = 0;
+
+/* 함수 목적: 캐시 칸 하나를 비웁니다.
+ * 매개변수: slot
+ * 반환 값: 없음
+ */
+static void slot_clear(IndicatorSlot *slot) {
+    for (int k = 0; k < IND_COUNT; ++k) free(slot->value[k]);
+    memset(slot, 0, sizeof(*slot));
+}
+
+/* 함수 목적: 캐시를 모두 비웁니다. (종목을 다시 불러올 때 등)
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void indicators_reset(void) {
+    for (int i = 0; i < INDICATOR_CACHE_SLOTS; ++i) slot_clear(&g_slots[i]);
+    g_clock = 0;
+}
+
+/* 함수 목적: 종목의 캐시 칸을 찾고, 없으면 가장 오래 안 쓴 칸을 비워 새로 시작합니다.
+ * 매개변수: symbol
+ * 반환 값: 캐시 칸
+ */
+static IndicatorSlot *slot_for(const char *symbol) {
+    IndicatorSlot *victim = &g_slots[0];
+    for (int i = 0; i < INDICATOR_CACHE_SLOTS; ++i) {
+        IndicatorSlot *slot = &g_slots[i];
+        if (slot->used && strncmp(slot->symbol, symbol, sizeof(slot->symbol)) == 0) return slot;
+        if (slot->used < victim->used) victim = slot;
+    }
+    slot_clear(victim);
+    snprintf(victim->symbol, sizeof(victim->symbol), "%s", symbol);
+    rolling_sum_init(&victim->sma, INDICATOR_SMA_PERIOD);
+    rolling_ema_init(&victim->ema, INDICATOR_EMA_PERIOD);
+    rolling_sum_init(&victim->band, INDICATOR_BAND_PERIOD);
+    rolling_extrema_init(&victim->low, INDICATOR_RANGE_PERIOD, 0);
+    rolling_extrema_init(&victim->high, INDICATOR_RANGE_PERIOD, 1);
+    rolling_rsi_init(&victim->rsi, INDICATOR_RSI_PERIOD);
+    rolling_vwap_init(&victim->vwap, INDICATOR_VWAP_PERIOD);
+    return victim;
+}
+
+/* 함수 목적: 지표 배열들이 n 칸을 담을 수 있게 늘립니다.
+ * 매개변수: slot, n
+ * 반환 값: 성공 여부
+ */
+static int slot_reserve(IndicatorSlot *slot, long n) {
+    if (n <= slot->cap) return 1;
+    long cap = slot->cap ? slot->cap : 256;
+    while (cap < n) cap *= 2;
+    for (int k = 0; k < IND_COUNT; ++k) {
+        float *p = realloc(slot->value[k], (size_t)cap * sizeof(float));
+        if (!p) return 0;
+        slot->value[k] = p;
+        slot->series.value[k] = p;
+    }
+    slot->cap = cap;
+    return 1;
+}
+
+/* 함수 목적: 가격 하나를 커널들에 넣고 그 자리의 지표(VWAP 빼고)를 적습니다.
+ * 매개변수: slot, i (가격 인덱스), price
+ * 반환 값: 없음
+ */
+static void push_price(IndicatorSlot *slot, long i, double price) {
+    rolling_sum_push(&slot->sma, price);
+    rolling_ema_push(&slot->ema, price);
+    rolling_sum_push(&slot->band, price);
+    rolling_extrema_push(&slot->low, price);
+    rolling_extrema_push(&slot->high, price);
+    rolling_rsi_push(&slot->rsi, price);
+
+    float **v = slot->value;
+    v[IND_SMA][i] = rolling_sum_full(&slot->sma) ? (float)rolling_mean(&slot->sma) : NAN;
+    v[IND_EMA][i] = rolling_ema_ready(&slot->ema) ? (float)slot->ema.value : NAN;
+    if (rolling_sum_full(&slot->band)) {
+        double mean = rolling_mean(&slot->band);
+        double width = INDICATOR_BAND_WIDTH * rolling_stddev(&slot->band);
+        v[IND_BAND_UPPER][i] = (float)(mean + width);
+        v[IND_BAND_LOWER][i] = (float)(mean - width);
+    } else {
+        v[IND_BAND_UPPER][i] = v[IND_BAND_LOWER][i] = NAN;
+    }
+    int range_full = slot->low.next >= slot->low.period;
+    v[IND_LOW][i] = range_full ? (float)rolling_extrema_value(&slot->low) : NAN;
+    v[IND_HIGH][i] = range_full ? (float)rolling_extrema_value(&slot->high) : NAN;
+    v[IND_RSI][i] = rolling_rsi_ready(&slot->rsi) ? (float)rolling_rsi_value(&slot->rsi) : NAN;
+}
+
+/* 함수 목적: VWAP 커널 상태에 한 단계의 거래를 넣은 뒤의 값을 돌려줍니다.
+ * 매개변수: vwap, qty, notional
+ * 반환 값: VWAP, 창 안에 거래가 없으면 NAN
+ */
+static float vwap_after(RollingVwap *vwap, long long qty, long long notional) {
+    double value;
+    rolling_vwap_push(vwap, (double)qty, (double)notional);
+    return rolling_vwap_value(vwap, &value) ? (float)value : NAN;
+}
+
+/* 함수 목적: 캐시를 len 까지 늘립니다. 새 가격만 읽어 커널에 넣습니다.
+ * 매개변수: slot, len
+ * 반환 값: 없음 (가격을 덜 읽으면 읽은 데까지만 늘어난다)
+ */
+static void slot_extend(IndicatorSlot *slot, long len) {
+    if (!slot_reserve(slot, len)) return;
+    int px[INDICATOR_READ_CHUNK];
+    long have = slot->series.len;
+    while (have < len) {
+        int want = len - have < INDICATOR_READ_CHUNK ? (int)(len - have) : INDICATOR_READ_CHUNK;
+        int got = stock_history_range(slot->symbol, have, px, want);
+        if (got <= 0) break;
+        for (int k = 0; k < got; ++k) push_price(slot, have + k, px[k]);
+        have += got;
+    }
+    slot->series.len = have;
+}
+
+/* 함수 목적: VWAP 를 채웁니다. 마지막 단계 앞까지는 끝난 단계라 커널에 넣어 확정하고,
+ *           마지막 단계는 커널을 복사해 지금까지의 거래로 매번 다시 구합니다.
+ * 매개변수: slot
+ * 반환 값: 없음
+ */
+static void slot_vwap(IndicatorSlot *slot) {
+    long long qty[INDICATOR_READ_CHUNK];
+    long long notional[INDICATOR_READ_CHUNK];
+    float *out = slot->value[IND_VWAP];
+    long last = slot->series.len - 1;
+
+    while (slot->vwap_done < last) {
+        long want = last - slot->vwap_done < INDICATOR_READ_CHUNK ? last - slot->vwap_done : INDICATOR_READ_CHUNK;
+        int got = stock_trade_range(slot->symbol, slot->vwap_done, qty, notional, (int)want);
+        if (got <= 0) break;
+        for (int k = 0; k < got; ++k) {
+            out[slot->vwap_done + k] = vwap_after(&slot->vwap, qty[k], notional[k]);
+        }
+        slot->vwap_done += got;
+    }
+    if (slot->vwap_done != last) {
+        for (long i = slot->vwap_done; i <= last; ++i) out[i] = NAN;
+        return;
+    }
+
+    RollingVwap live = slot->vwap;
+    if (stock_trade_range(slot->symbol, last, qty, notional, 1) != 1) qty[0] = notional[0] = 0;
+    out[last] = vwap_after(&live, qty[0], notional[0]);
+}
+
+/* 함수 목적: 종목의 지표 시계열을 돌려줍니다. 캐시보다 긴 기록을 원하면 늘어난 가격만
+ *           계산하고, 아니면 캐시를 그대로 씁니다.
+ * 매개변수: symbol, len
+ * 반환 값: 지표 시계열, 실패하면 NULL
+ */
+const IndicatorSeries *indicators_get(const char *symbol, long len) {
+    if (!symbol || len <= 0) return NULL;
+    IndicatorSlot *slot = slot_for(symbol);
+    slot->used = ++g_clock;
+    if (len > slot->series.len) slot_extend(slot, len);
+    if (slot->series.len <= 0) return NULL;
+    slot_vwap(slot);
+    return &slot->series;
+}
@@ -0,0 +1,460 @@
+/*
+ * 파일 목적: 모든 입출금을 먼저 기록하는 선기록(write-ahead) 장부와 잔액 체크포인트 구현
+ * 작성자: 박시유
+ */
+#include "../../include/domain/ledger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
+
+static const char *const g_type_names[LEDGER_TYPE_COUNT] = {
+    "ADJUST", "WITHDRAW", "DEPOSIT", "LOAN", "REPAY",
+    "GRANT", "SPEND", "INTEREST", "LOAN_INTEREST", "CHECKPOINT"
+};
+
+static int g_opened = 0;
+static int g_segment = 1;          /* 지금 덧붙이는 세그먼트 번호 */
+static long g_segment_bytes = 0;
+static uint64_t g_next_seq = 1;
+static int g_since_checkpoint = 0;
+static uint64_t g_ckpt_seq = 0;    /* 마지막 체크포인트가 담은 마지막 seq */
+static int g_ckpt_segment = 1;     /* 그 뒤 기록이 시작되는 세그먼트 */
+
+/* 함수 목적: 바이트열의 체크섬을 계산합니다. (FNV-1a)
+ * 매개변수: p, len
+ * 반환 값: 체크섬
+ */
+static uint32_t ledger_checksum(const char *p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* 함수 목적: 세그먼트 번호로 파일 경로를 만듭니다.
+ * 매개변수: segment, out, cap
+ * 반환 값: 없음
+ */
+static void segment_path(int segment, char *out, size_t cap) {
+    snprintf(out, cap, "%s/%06d.csv", LEDGER_DIR, segment);
+}
+
+/* 함수 목적: 쉼표와 개행을 공백으로 바꿔 한 필드에 들어가게 합니다.
+ * 매개변수: s
+ * 반환 값: 없음
+ */
+static void sanitize_field(char *s) {
+    for (; *s; ++s) {
+        if (*s == ',' || *s == '\n' || *s == '\r') *s = ' ';
+    }
+}
+
+/* 함수 목적: 16진수/10진수 필드를 부호 없는 정수로 읽습니다.
+ * 매개변수: f, base, out
+ * 반환 값: 숫자가 있으면 1
+ */
+static int field_u64(CsvField f, int base, uint64_t *out) {
+    char tmp[32];
+    if (f.len == 0 || f.len >= sizeof(tmp)) return 0;
+    csv_field_copy(f, tmp, sizeof(tmp));
+    char *end = NULL;
+    unsigned long long v = strtoull(tmp, &end, base);
+    if (!end || *end != '\0') return 0;
+    *out = (uint64_t)v;
+    return 1;
+}
+
+const char *ledger_type_name(LedgerType type) {
+    if ((int)type < 0 || type >= LEDGER_TYPE_COUNT) return "?";
+    return g_type_names[type];
+}
+
+/* 함수 목적: 장부 한 줄을 검사하고 해석합니다. 체크섬이 맞지 않으면 실패합니다.
+ * 매개변수: line, len (개행 제외), out
+ * 반환 값: 올바른 레코드이면 1
+ */
+static int parse_record(const char *line, size_t len, LedgerEntry *out) {
+    if (len > 0 && line[len - 1] == '\r') len--;
+    size_t comma = len;
+    while (comma > 0 && line[comma - 1] != ',') comma--;
+    if (comma == 0) return 0;
+    CsvField sum = {line + comma, len - comma};
+    uint64_t want = 0;
+    if (!field_u64(sum, 16, &want) || (uint32_t)want != ledger_checksum(line, comma - 1)) return 0;
+
+    CsvCursor cur;
+    csv_cursor_init(&cur, line, comma - 1, ',');
+    if (!csv_cursor_next_row(&cur)) return 0;
+    CsvField f[9];
+    if (csv_cursor_fields(&cur, f, 9) != 9) return 0;
+    memset(out, 0, sizeof(*out));
+    long ts = 0;
+    if (!field_u64(f[0], 10, &out->seq) || !csv_field_long(f[1], &ts)) return 0;
+    out->ts = ts;
+    out->type = LEDGER_TYPE_COUNT;
+    for (int t = 0; t < LEDGER_TYPE_COUNT; ++t) {
+        if (csv_field_eq(f[2], g_type_names[t])) out->type = (LedgerType)t;
+    }
+    if (out->type == LEDGER_TYPE_COUNT) return 0;
+    csv_field_copy(f[3], out->user, sizeof(out->user));
+    csv_field_int(f[4], &out->amount);
+    csv_field_int(f[5], &out->balance);
+    csv_field_int(f[6], &out->cash);
+    csv_field_int(f[7], &out->loan);
+    csv_field_copy(f[8], out->reason, sizeof(out->reason));
+    return 1;
+}
+
+typedef struct SegmentScan {
+    size_t valid_end;  /* 마지막 올바른 레코드 바로 뒤 */
+    size_t len;        /* 파일 길이 */
+    uint64_t last_seq;
+    int stopped;       /* 콜백이 중단을 요청함 */
+} SegmentScan;
+
+/* 함수 목적: 세그먼트 하나를 처음부터 읽어 seq 가 after_seq 보다 큰 레코드를 넘겨줍니다.
+ *           깨졌거나 개행 없이 끝난 줄(쓰다 만 꼬리)을 만나면 거기서 멈춥니다.
+ * 매개변수: segment, after_seq, fn (NULL 가능), ctx, out
+ * 반환 값: 파일이 있으면 1, 없으면 0
+ */
+static int scan_segment(int segment, uint64_t after_seq, LedgerScanFn fn, void *ctx, SegmentScan *out) {
+    memset(out, 0, sizeof(*out));
+    char path[256];
+    segment_path(segment, path, sizeof(path));
+    csv_flush_path(path);
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(path, &map, &len)) return 0;
+    out->len = len;
+    const char *data = map;
+    size_t pos = 0;
+    while (pos < len) {
+        const char *nl = memchr(data + pos, '\n', len - pos);
+        if (!nl) break;
+        size_t line_len = (size_t)(nl - (data + pos));
+        LedgerEntry e;
+        if (!parse_record(data + pos, line_len, &e)) break;
+        pos += line_len + 1;
+        out->valid_end = pos;
+        if (e.seq > out->last_seq) out->last_seq = e.seq;
+        if (e.seq > after_seq && fn && !fn(&e, ctx)) {
+            out->stopped = 1;
+            break;
+        }
+    }
+    csv_unmap_file(map, len);
+    return 1;
+}
+
+/* 함수 목적: 체크포인트 파일을 검사하고, 올바르면 각 사용자의 잔액을 apply 로 넘깁니다.
+ *           파일 끝의 "END,<행 수>,<체크섬>" 줄이 앞의 내용 전체와 맞아야 합니다.
+ * 매개변수: apply (NULL 가능), ctx
+ * 반환 값: 올바른 체크포인트가 있으면 1
+ */
+static int load_checkpoint(LedgerApplyFn apply, void *ctx) {
+    csv_flush_path(LEDGER_CHECKPOINT_PATH);
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(LEDGER_CHECKPOINT_PATH, &map, &len) || !map) return 0;
+    const char *data = map;
+    size_t end = len;
+    while (end > 0 && (data[end - 1] == '\n' || data[end - 1] == '\r')) end--;
+    size_t trailer = end;
+    while (trailer > 0 && data[trailer - 1] != '\n') trailer--;
+
+    int ok = 0;
+    CsvCursor cur;
+    csv_cursor_init(&cur, data + trailer, end - trailer, ',');
+    CsvField t[3];
+    uint64_t rows = 0, sum = 0;
+    if (csv_cursor_next_row(&cur) && csv_cursor_fields(&cur, t, 3) == 3 && csv_field_eq(t[0], "END") &&
+        field_u64(t[1], 10, &rows) && field_u64(t[2], 16, &sum) &&
+        (uint32_t)sum == ledger_checksum(data, trailer)) {
+        csv_cursor_init(&cur, data, trailer, ',');
+        int have_head = 0;
+        uint64_t seen = 0;
+        while (csv_cursor_next_row(&cur)) {
+            if (cur.row.len > 0 && cur.row.ptr[0] == '#') continue;
+            CsvField f[4];
+            int n = csv_cursor_fields(&cur, f, 4);
+            if (!have_head) {
+                uint64_t seq = 0;
+                int segment = 0;
+                if (n < 2 || !field_u64(f[0], 10, &seq) || !csv_field_int(f[1], &segment) || segment < 1) break;
+                g_ckpt_seq = seq;
+                g_ckpt_segment = segment;
+                have_head = 1;
+                continue;
+            }
+            if (n < 4) continue;
+            char name[50];
+            int balance = 0, cash = 0, loan = 0;
+            csv_field_copy(f[0], name, sizeof(name));
+            csv_field_int(f[1], &balance);
+            csv_field_int(f[2], &cash);
+            csv_field_int(f[3], &loan);
+            if (apply) apply(name, balance, cash, loan, ctx);
+            seen++;
+        }
+        ok = have_head && seen == rows;
+    }
+    csv_unmap_file(map, len);
+    if (!ok) {
+        g_ckpt_seq = 0;
+        g_ckpt_segment = 1;
+    }
+    return ok;
+}
+
+typedef struct ReplayCtx {
+    LedgerApplyFn apply;
+    void *ctx;
+    long replayed;
+} ReplayCtx;
+
+/* 함수 목적: 체크포인트 뒤의 레코드 하나를 계좌 상태로 되돌립니다.
+ * 매개변수: e, ctx
+ * 반환 값: 계속 읽으면 1
+ */
+static int replay_record(const LedgerEntry *e, void *ctx) {
+    ReplayCtx *rc = ctx;
+    if (e->type == LEDGER_CHECKPOINT || e->user[0] == '\0') return 1;
+    if (rc->apply) rc->apply(e->user, e->balance, e->cash, e->loan, rc->ctx);
+    rc->replayed++;
+    return 1;
+}
+
+/* 함수 목적: 장부를 한 번만 엽니다. 마지막 체크포인트를 반영하고 그 뒤 세그먼트를
+ *           끝까지 재생하여 다음 seq 와 덧붙일 위치를 정합니다. 마지막 세그먼트의
+ *           꼬리가 깨져 있으면 그 뒤에 이어 쓰지 않고 새 세그먼트로 넘어갑니다.
+ * 매개변수: apply (NULL 가능), ctx
+ * 반환 값: 재생한 레코드 수
+ */
+static long ledger_open(LedgerApplyFn apply, void *ctx) {
+    if (g_opened) return 0;
+    g_opened = 1;
+    csv_ensure_dir("data");
+    csv_ensure_dir(LEDGER_DIR);
+    load_checkpoint(apply, ctx);
+
+    ReplayCtx rc = {apply, ctx, 0};
+    uint64_t last_seq = g_ckpt_seq;
+    int last = 0;
+    SegmentScan tail;
+    memset(&tail, 0, sizeof(tail));
+    for (int seg = g_ckpt_segment;; ++seg) {
+        SegmentScan s;
+        if (!scan_segment(seg, g_ckpt_seq, replay_record, &rc, &s)) break;
+        if (s.last_seq > last_seq) last_seq = s.last_seq;
+        last = seg;
+        tail = s;
+    }
+    if (last == 0) {
+        g_segment = g_ckpt_segment;
+        g_segment_bytes = 0;
+    } else if (tail.valid_end < tail.len) {
+        g_segment = last + 1;
+        g_segment_bytes = 0;
+    } else {
+        g_segment = last;
+        g_segment_bytes = (long)tail.len;
+    }
+    g_next_seq = last_seq + 1;
+    g_since_checkpoint = (int)rc.replayed;
+    return rc.replayed;
+}
+
+/* 함수 목적: 레코드 하나를 체크섬이 붙은 장부 한 줄로 만듭니다. (seq 는 호출자가 채움)
+ * 매개변수: e, line, cap
+ * 반환 값: 줄 길이 (개행 포함), 들어가지 않으면 0
+ */
+static size_t format_record(LedgerEntry *e, char *line, size_t cap) {
+    sanitize_field(e->user);
+    sanitize_field(e->reason);
+    int n = snprintf(line, cap, "%llu,%ld,%s,%s,%d,%d,%d,%d,%s",
+                     (unsigned long long)e->seq, e->ts, g_type_names[e->type], e->user,
+                     e->amount, e->balance, e->cash, e->loan, e->reason);
+    if (n < 0 || (size_t)n >= cap - 11) return 0;
+    n += snprintf(line + n, cap - (size_t)n, ",%08x\n", (unsigned)ledger_checksum(line, (size_t)n));
+    return (size_t)n;
+}
+
+/* 함수 목적: 이번 덧붙이기가 세그먼트 크기를 넘기면 다음 세그먼트로 넘어갑니다.
+ * 매개변수: add (덧붙일 바이트 수)
+ * 반환 값: 없음
+ */
+static void segment_roll(size_t add) {
+    if (g_segment_bytes > 0 && g_segment_bytes + (long)add > LEDGER_SEGMENT_BYTES) {
+        char path[256];
+        segment_path(g_segment, path, sizeof(path));
+        csv_close_path(path);
+        g_segment++;
+        g_segment_bytes = 0;
+    }
+}
+
+/* 함수 목적: 레코드 하나를 현재 세그먼트 끝에 덧붙이도록 기록 스레드에 넘깁니다.
+ *           세그먼트가 LEDGER_SEGMENT_BYTES 를 넘으면 다음 번호로 넘어갑니다.
+ * 매개변수: e (seq 가 채워짐)
+ * 반환 값: 성공 여부
+ */
+int ledger_append(LedgerEntry *e) {
+    if (!e || (int)e->type < 0 || e->type >= LEDGER_TYPE_COUNT) return 0;
+    ledger_open(NULL, NULL);
+    e->seq = g_next_seq;
+
+    char line[256];
+    size_t n = format_record(e, line, sizeof(line));
+    if (n == 0) return 0;
+
+    char path[256];
+    segment_roll(n);
+    segment_path(g_segment, path, sizeof(path));
+    if (!csv_append_raw(path, line, n)) return 0;
+    g_segment_bytes += (long)n;
+    g_next_seq++;
+    g_since_checkpoint++;
+    return 1;
+}
+
+/* 함수 목적: 여러 레코드를 한 버퍼로 만들어 세그먼트마다 한 번씩만 덧붙입니다.
+ *           (전체 이자 정산처럼 한꺼번에 생기는 기록용) 레코드 순서와 seq 는
+ *           ledger_append 를 차례로 부른 것과 같습니다.
+ * 매개변수: entries (seq 가 채워짐), count
+ * 반환 값: 기록한 레코드 수
+ */
+size_t ledger_append_batch(LedgerEntry *entries, size_t count) {
+    if (!entries || count == 0) return 0;
+    ledger_open(NULL, NULL);
+    size_t cap = count < 4096 ? count * 256 : 4096 * 256;
+    char *buf = malloc(cap);
+    if (!buf) return 0;
+    char path[256];
+    size_t len = 0, done = 0, pending = 0;
+    for (size_t i = 0; i <= count; ++i) {
+        char line[256];
+        size_t n = 0;
+        if (i < count) {
+            LedgerEntry *e = &entries[i];
+            if ((int)e->type < 0 || e->type >= LEDGER_TYPE_COUNT) continue;
+            e->seq = g_next_seq + pending;
+            n = format_record(e, line, sizeof(line));
+            if (n == 0) continue;
+        }
+        /* 버퍼가 찼거나 세그먼트가 넘치거나 끝이면 모인 줄을 한 번에 넘긴다 */
+        if (len > 0 && (i == count || len + n > cap ||
+                        g_segment_bytes + (long)(len + n) > LEDGER_SEGMENT_BYTES)) {
+            segment_path(g_segment, path, sizeof(path));
+            if (!csv_append_raw(path, buf, len)) break;
+            g_segment_bytes += (long)len;
+            g_next_seq += pending;
+            g_since_checkpoint += (int)pending;
+            done += pending;
+            len = 0;
+            pending = 0;
+        }
+        if (i == count) break;
+        if (len == 0) segment_roll(n);
+        memcpy(buf + len, line, n);
+        len += n;
+        pending++;
+    }
+    free(buf);
+    return done;
+}
+
+/* 함수 목적: 마지막 체크포인트 뒤로 레코드가 충분히 쌓였는지 확인합니다.
+ * 매개변수: 없음
+ * 반환 값: 체크포인트를 쓸 때가 되었으면 1
+ */
+int ledger_checkpoint_due(void) {
+    return g_since_checkpoint >= LEDGER_CHECKPOINT_EVERY;
+}
+
+/* 함수 목적: 지금까지 기록한 레코드가 모두 반영된 잔액 표를 체크포인트로 씁니다.
+ *           (임시 파일 후 rename) 장부 쓰기와 같은 기록 스레드를 거치므로 순서가 보장됩니다.
+ * 매개변수: rows, count
+ * 반환 값: 성공 여부
+ */
+int ledger_checkpoint(const LedgerBalance *rows, size_t count) {
+    ledger_open(NULL, NULL);
+    size_t cap = 128 + count * 96;
+    char *buf = malloc(cap);
+    if (!buf) return 0;
+    uint64_t seq = g_next_seq - 1;
+    size_t len = (size_t)snprintf(buf, cap, "# seq,segment,ts\n%llu,%d,%ld\n",
+                                  (unsigned long long)seq, g_segment, (long)time(NULL));
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!rows[i].user || !rows[i].user[0]) continue;
+        char name[50];
+        snprintf(name, sizeof(name), "%s", rows[i].user);
+        sanitize_field(name);
+        int n = snprintf(buf + len, cap - len, "%s,%d,%d,%d\n", name, rows[i].balance, rows[i].cash, rows[i].loan);
+        if (n < 0 || (size_t)n >= cap - len) {
+            free(buf);
+            return 0;
+        }
+        len += (size_t)n;
+        written++;
+    }
+    uint32_t sum = ledger_checksum(buf, len);
+    int n = snprintf(buf + len, cap - len, "END,%zu,%08x\n", written, (unsigned)sum);
+    if (n < 0 || (size_t)n >= cap - len) {
+        free(buf);
+        return 0;
+    }
+    len += (size_t)n;
+    csv_ensure_dir(LEDGER_DIR);
+    int ok = csv_write_file(LEDGER_CHECKPOINT_PATH, buf, len);
+    free(buf);
+    /* 복구는 이 파일을 믿고 앞선 레코드를 건너뛰므로 디스크에 닿은 것을 확인한다.
+     * 실패하면 g_since_checkpoint 를 그대로 두어 다음 기회에 다시 쓴다. */
+    if (!ok || !csv_flush_path(LEDGER_CHECKPOINT_PATH)) return 0;
+
+    g_ckpt_seq = seq;
+    g_ckpt_segment = g_segment;
+    LedgerEntry mark;
+    memset(&mark, 0, sizeof(mark));
+    mark.ts = (long)time(NULL);
+    mark.type = LEDGER_CHECKPOINT;
+    mark.amount = (int)written;
+    ledger_append(&mark);
+    g_since_checkpoint = 0;
+    return 1;
+}
+
+/* 함수 목적: 부팅 시 한 번 호출하여 체크포인트와 그 뒤 레코드로 잔액을 복구합니다.
+ * 매개변수: apply, ctx
+ * 반환 값: 재생한 레코드 수 (이미 열려 있었으면 0)
+ */
+long ledger_recover(LedgerApplyFn apply, void *ctx) {
+    return ledger_open(apply, ctx);
+}
+
+/* 함수 목적: seq 가 after_seq 보다 큰 레코드를 순서대로 방문합니다.
+ *           체크포인트 이후만 원하면 그 세그먼트부터, 아니면 첫 세그먼트부터 읽습니다.
+ * 매개변수: after_seq, fn, ctx
+ * 반환 값: 성공 여부
+ */
+int ledger_scan(uint64_t after_seq, LedgerScanFn fn, void *ctx) {
+    if (!fn) return 0;
+    ledger_open(NULL, NULL);
+    int first = after_seq >= g_ckpt_seq ? g_ckpt_segment : 1;
+    for (int seg = first; seg <= g_segment; ++seg) {
+        SegmentScan s;
+        if (!scan_segment(seg, after_seq, fn, ctx, &s)) continue;
+        if (s.stopped) break;
+    }
+    return 1;
+}
@@ -14,6 +14,7 @@
 #include <time.h>
 
 #include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
 #include "../../include/domain/notification.h"
 #include "../../include/domain/user.h"
 
@@ -141,31 +142,48 @@ static int format_feed_line(char *dst, size_t dst_len, long ts, char dir, const
     return wrote;
 }
 
-/* 함수 목적: 라인을 컴마 단위로 쪼갬
- * 매개변수: line, out_ts, out_dir, other, other_len, message, msg_len
+/* 함수 목적: 커서의 현재 행을 컴마 단위로 쪼갬 (메시지 본문은 행의 나머지 전체)
+ * 매개변수: cur, out_ts, out_dir, other, other_len, message, msg_len
  * 반환 값: 성공 여부
  */
-static int parse_line(char *line, long *out_ts, char *out_dir, char *other, size_t other_len, char *message, size_t msg_len) {
-    if (!line) return 0;
+static int parse_row(CsvCursor *cur, long *out_ts, char *out_dir, char *other, size_t other_len, char *message, size_t msg_len) {
+    if (!cur) return 0;
     /* line format: ts,dir,other,message */
-    char *ts_tok = strtok(line, ",");
-    char *dir_tok = strtok(NULL, ",");
-    char *other_tok = strtok(NULL, ",");
-    char *msg_tok = strtok(NULL, "\n");
-    if (!ts_tok || !dir_tok || !other_tok || !msg_tok) {
+    CsvField f[3];
+    CsvField msg;
+    if (csv_cursor_fields(cur, f, 3) < 3 || !csv_cursor_rest(cur, &msg)) {
+        return 0;
+    }
+    if (f[0].len == 0 || f[1].len == 0 || f[2].len == 0 || msg.len == 0) {
         return 0;
     }
-    if (out_ts) *out_ts = atol(ts_tok);
-    if (out_dir) *out_dir = dir_tok[0];
+    if (out_ts) {
+        long ts = 0;
+        csv_field_long(f[0], &ts);
+        *out_ts = ts;
+    }
+    if (out_dir) *out_dir = f[1].ptr[0];
     if (other && other_len > 0) {
-        snprintf(other, other_len, "%s", other_tok);
+        csv_field_copy(f[2], other, other_len);
     }
     if (message && msg_len > 0) {
-        snprintf(message, msg_len, "%s", msg_tok);
+        csv_field_copy(msg, message, msg_len);
     }
     return 1;
 }
 
+/* 함수 목적: 한 줄(슬라이스)을 컴마 단위로 쪼갬
+ * 매개변수: line, line_len, out_ts, out_dir, other, other_len, message, msg_len
+ * 반환 값: 성공 여부
+ */
+static int parse_line(const char *line, size_t line_len, long *out_ts, char *out_dir, char *other, size_t other_len, char *message, size_t msg_len) {
+    if (!line) return 0;
+    CsvCursor cur;
+    csv_cursor_init(&cur, line, line_len, ',');
+    if (!csv_cursor_next_row(&cur)) return 0;
+    return parse_row(&cur, out_ts, out_dir, other, other_len, message, msg_len);
+}
+
 /* 함수 목적: 최근 메시지들을 읽기
  * 매개변수: username, limit, buf, buflen
  * 반환 값: 쓰여진 바이트를 가리키는 인덱스
@@ -178,26 +196,22 @@ int message_recent_to_buf(const char *username, int limit, char *buf, size_t buf
     char path[512];
     snprintf(path, sizeof(path), "%s/%s.csv", MESSAGE_DIR, username);
 
-    char *tmp = NULL;
-    size_t tmplen = 0;
-    if (!csv_read_last_lines(path, limit, &tmp, &tmplen) || !tmp) {
+    CsvTail it;
+    if (!csv_tail_open(&it, path, limit)) {
         return 0;
     }
 
     size_t outpos = 0;
-    char *p = tmp;
-    while (p && *p && outpos + 1 < buflen) {
-        char *nl = strchr(p, '\n');
-        if (nl) *nl = '\0';
-        char linebuf[512];
-        snprintf(linebuf, sizeof(linebuf), "%s", p);
+    const char *line = NULL;
+    size_t line_len = 0;
+    while (outpos + 1 < buflen && csv_tail_next(&it, &line, &line_len)) {
         long ts = 0;
         char dir = 'S';
         char other[64];
         char message[256];
         other[0] = '\0';
         message[0] = '\0';
-        if (parse_line(linebuf, &ts, &dir, other, sizeof(other), message, sizeof(message))) {
+        if (parse_line(line, line_len, &ts, &dir, other, sizeof(other), message, sizeof(message))) {
             char formatted[512];
             if (!format_feed_line(formatted, sizeof(formatted), ts, dir, other, message)) {
                 formatted[0] = '\0';
@@ -214,13 +228,10 @@ int message_recent_to_buf(const char *username, int limit, char *buf, size_t buf
                 buf[outpos++] = '\n';
             }
         }
-        if (!nl) break;
-        p = nl + 1;
     }
     if (outpos >= buflen) outpos = buflen - 1;
     buf[outpos] = '\0';
-    free(tmp);
-    tmp = NULL;
+    csv_tail_close(&it);
     return (int)outpos;
 }
 
@@ -235,8 +246,8 @@ int message_thread_to_buf(const char *username, const char *peer, int limit, cha
 
     char path[512];
     snprintf(path, sizeof(path), "%s/%s.csv", MESSAGE_DIR, username);
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, path, ',')) {
         return 0;
     }
     typedef struct {
@@ -246,17 +257,14 @@ int message_thread_to_buf(const char *username, const char *peer, int limit, cha
     } Entry;
     Entry entries[256];
     int count = 0;
-    char line[512];
-    while (fgets(line, sizeof(line), fp)) {
-        char linecopy[512];
-        snprintf(linecopy, sizeof(linecopy), "%s", line);
+    while (csv_cursor_next_row(&cur)) {
         long ts = 0;
         char dir = 'S';
         char other[64];
         char message[256];
         other[0] = '\0';
         message[0] = '\0';
-        if (!parse_line(linecopy, &ts, &dir, other, sizeof(other), message, sizeof(message))) {
+        if (!parse_row(&cur, &ts, &dir, other, sizeof(other), message, sizeof(message))) {
             continue;
         }
         if (strncmp(other, peer, sizeof(other)) != 0) {
@@ -275,7 +283,7 @@ int message_thread_to_buf(const char *username, const char *peer, int limit, cha
             snprintf(entries[count - 1].message, sizeof(entries[count - 1].message), "%s", message);
         }
     }
-    fclose(fp);
+    csv_cursor_close(&cur);
 
     int start = 0;
     if (count > limit) start = count - limit;
@@ -310,20 +318,16 @@ int message_list_partners(const char *username, char partners[][50], int max_par
     if (!username || !partners || max_partners <= 0) return 0;
     char path[512];
     snprintf(path, sizeof(path), "%s/%s.csv", MESSAGE_DIR, username);
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, path, ',')) {
         return 0;
     }
     int count = 0;
-    char line[512];
-    while (fgets(line, sizeof(line), fp)) {
-        char linecopy[512];
-        snprintf(linecopy, sizeof(linecopy), "%s", line);
+    while (csv_cursor_next_row(&cur)) {
         long ts = 0;
         char dir = 'S';
         char other[64];
-        char message[256];
-        if (!parse_line(linecopy, &ts, &dir, other, sizeof(other), message, sizeof(message))) {
+        if (!parse_row(&cur, &ts, &dir, other, sizeof(other), NULL, 0)) {
             continue;
         }
         int exists = 0;
@@ -338,6 +342,6 @@ int message_list_partners(const char *username, char partners[][50], int max_par
             count++;
         }
     }
-    fclose(fp);
+    csv_cursor_close(&cur);
     return count;
 }
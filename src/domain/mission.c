@@ -7,21 +7,42 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 #include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
 #include <stdlib.h>
 
 #include "../../include/domain/account.h"
 #include "../../include/domain/user.h"
 
-static Mission g_catalog[MAX_MISSIONS];
+static Mission *g_catalog = NULL;
 static int g_catalog_count = 0;
+static int g_catalog_cap = 0;
 static int g_next_id = 1;
 static int g_seeded = 0;
+/* 미션 ID -> 카탈로그 칸 번호 + 1 (0 은 없음). ID 는 1부터 차례로 붙으므로 배열로 둔다 */
+static int *g_slot_by_id = NULL;
+static int g_slot_by_id_cap = 0;
+
+#define MISSION_ID_INDEX_MAX (1 << 20) /* 이보다 큰 ID 는 색인하지 않고 훑어서 찾는다 */
+#define MISSION_MIGRATED_PATH "data/missions/.legacy_migrated"
+#define MISSION_CATALOG_PATH "data/missions.csv"
+
+/* data/missions.csv 를 어디까지 읽었는지. 새로고침은 g_cat_consumed 뒤에
+ * 덧붙은 줄만 읽고, 파일이 잘리거나 통째로 바뀌었을 때만 처음부터 다시 읽는다.
+ */
+static long long g_cat_consumed = 0;  /* 마지막으로 읽은 완전한 줄의 끝 */
+static long long g_cat_size = -1;     /* -1: 아직 읽지 않음 */
+static long long g_cat_mtime = 0;
+static unsigned long long g_cat_ino = 0;
+static int g_cat_tail_nl = 1;         /* 파일이 비었거나 줄바꿈으로 끝나는지 */
 
 /* 함수 목적: 주어진 미션 ID가 전역 미션 카탈로그(g_catalog)에 이미 존재하는지 검사합니다.
  * 설명:
- *   - 내부 전역 배열 `g_catalog`를 순회하여 동일한 `id`가 있는지 확인합니다.
+ *   - ID 색인(g_slot_by_id)으로 확인하고, 색인 범위를 넘는 ID만
+ *     `g_catalog`를 순회합니다.
  *   - 미션을 로드하거나 새로 생성할 때 중복 삽입을 방지하기 위해 사용됩니다.
  *
  * 매개변수:
@@ -32,6 +53,9 @@ static int g_seeded = 0;
  *   - 0: 존재하지 않음
  */
 static int catalog_has_id(int id) {
+    if (id >= 0 && id < MISSION_ID_INDEX_MAX) {
+        return id < g_slot_by_id_cap && g_slot_by_id[id] != 0;
+    }
     for (int i = 0; i < g_catalog_count; ++i) {
         if (g_catalog[i].id == id) return 1;
     }
@@ -59,16 +83,194 @@ static int catalog_has_name(const char *name) {
     return 0;
 }
 
-/* 함수 목적: 전역 미션 카탈로그(g_catalog)를 디스크(`data/missions.csv`)로부터 로드하고 초기화합니다.
+/* 함수 목적: 카탈로그에 새로 들어온 미션의 ID -> 칸 번호 색인을 기록합니다.
+ * 매개변수: id, slot
+ * 반환 값: 없음 (색인할 수 없으면 mission_catalog_slot 이 카탈로그를 훑는다)
+ */
+static void catalog_index_add(int id, int slot) {
+    if (id < 0 || id >= MISSION_ID_INDEX_MAX) return;
+    if (id >= g_slot_by_id_cap) {
+        int ncap = g_slot_by_id_cap ? g_slot_by_id_cap : 64;
+        while (ncap <= id) ncap *= 2;
+        int *n = realloc(g_slot_by_id, (size_t)ncap * sizeof(*n));
+        if (!n) return;
+        memset(n + g_slot_by_id_cap, 0, (size_t)(ncap - g_slot_by_id_cap) * sizeof(*n));
+        g_slot_by_id = n;
+        g_slot_by_id_cap = ncap;
+    }
+    g_slot_by_id[id] = slot + 1;
+}
+
+/* 함수 목적: 카탈로그 배열에 칸 하나를 더 확보합니다.
+ * 매개변수: 없음
+ * 반환 값: 새 칸 포인터 (0 으로 채워짐), 메모리가 없으면 NULL
+ */
+static Mission *catalog_push(void) {
+    if (g_catalog_count >= g_catalog_cap) {
+        int ncap = g_catalog_cap ? g_catalog_cap * 2 : 64;
+        Mission *n = realloc(g_catalog, (size_t)ncap * sizeof(*n));
+        if (!n) return NULL;
+        g_catalog = n;
+        g_catalog_cap = ncap;
+    }
+    Mission *slot = &g_catalog[g_catalog_count++];
+    memset(slot, 0, sizeof(*slot));
+    return slot;
+}
+
+/* 함수 목적: ID 색인으로 미션의 칸 번호를 찾습니다. (카탈로그를 읽지 않음)
+ * 매개변수: id
+ * 반환 값: 칸 번호, 없으면 -1
+ */
+static int catalog_find_slot(int id) {
+    if (id >= 0 && id < MISSION_ID_INDEX_MAX) {
+        return id < g_slot_by_id_cap ? g_slot_by_id[id] - 1 : -1;
+    }
+    for (int i = 0; i < g_catalog_count; ++i) {
+        if (g_catalog[i].id == id) return i;
+    }
+    return -1;
+}
+
+/* 함수 목적: 카탈로그와 ID 색인을 비웁니다. g_next_id 는 그대로 두어 지워진
+ *           미션의 ID 를 새 미션이 다시 받지 않게 합니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void catalog_clear(void) {
+    g_catalog_count = 0;
+    if (g_slot_by_id) memset(g_slot_by_id, 0, (size_t)g_slot_by_id_cap * sizeof(*g_slot_by_id));
+}
+
+/* 함수 목적: 카탈로그를 다시 만든 뒤 모든 사용자의 완료 비트셋을 미션 ID 기준으로
+ *           새 칸 번호에 옮깁니다. 파일에서 사라진 미션의 완료 표시는 버립니다.
+ * 매개변수: old_ids (옛 칸 번호 -> 미션 ID), old_count
+ * 반환 값: 없음
+ */
+static void catalog_remap_users(const int *old_ids, int old_count) {
+    int *new_slot = malloc((size_t)old_count * sizeof(*new_slot));
+    if (!new_slot) return;
+    int moved = 0;
+    for (int k = 0; k < old_count; ++k) {
+        new_slot[k] = catalog_find_slot(old_ids[k]);
+        if (new_slot[k] != k) moved = 1;
+    }
+    if (moved || g_catalog_count != old_count) {
+        size_t n = user_count();
+        for (size_t i = 0; i < n; ++i) {
+            User *u = user_at_mut(i);
+            int done = user_missions_remap(u, new_slot, old_count);
+            if (done < 0) continue;
+            u->completed_missions = done;
+            u->total_missions = g_catalog_count;
+        }
+    }
+    free(new_slot);
+}
+
+/* 함수 목적: missions.csv 의 한 구간을 읽어 처음 보는 미션을 카탈로그 끝에 붙입니다.
+ * 설명:
+ *   - 각 행은 "CREATE,id,name,type,reward,ts" 형식입니다.
+ *   - 이미 있는 ID 는 건너뜁니다. 덧붙은 줄만 읽을 때는 기존 칸 번호가
+ *     그대로이고, 처음부터 다시 읽을 때는 catalog_sync 가 먼저 카탈로그를 비웁니다.
+ * 매개변수: data, len (줄 단위로 시작하는 구간)
+ * 반환 값: 새로 붙인 미션 수
+ */
+static int catalog_parse(const char *data, size_t len) {
+    CsvCursor cur;
+    int added = 0;
+    csv_cursor_init(&cur, data, len, ',');
+    while (csv_cursor_next_row(&cur)) {
+        CsvField f[5];
+        if (csv_cursor_fields(&cur, f, 5) < 5 || !csv_field_eq(f[0], "CREATE")) continue;
+        int id = 0;
+        if (!csv_field_int(f[1], &id)) continue;
+        if (catalog_has_id(id)) continue;
+        Mission *slot = catalog_push();
+        if (!slot) break;
+        slot->id = id;
+        csv_field_copy(f[2], slot->name, sizeof(slot->name));
+        csv_field_int(f[3], &slot->type);
+        csv_field_int(f[4], &slot->reward);
+        catalog_index_add(id, g_catalog_count - 1);
+        if (id >= g_next_id) g_next_id = id + 1;
+        added++;
+    }
+    csv_cursor_close(&cur);
+    return added;
+}
+
+/* 함수 목적: data/missions.csv 에서 지난번 이후 바뀐 부분만 카탈로그에 반영합니다.
+ * 설명:
+ *   - 크기·mtime·inode 가 그대로면 파일을 열지 않습니다.
+ *   - 파일이 자랐고 지난번에 읽은 끝이 줄바꿈이면 그 뒤에 덧붙은 완전한 줄만
+ *     읽습니다. 쓰는 중인 마지막 줄은 다음 새로고침 때 읽습니다.
+ *   - inode 가 바뀌었거나(파일 교체), 줄었거나(잘림), 크기는 같은데 mtime 이
+ *     바뀌었으면 카탈로그를 비우고 처음부터 다시 만듭니다. 지워지거나 고쳐진
+ *     미션이 옛 내용으로 남지 않으며, 사용자 완료 비트셋은 미션 ID 로 새 칸에
+ *     옮깁니다. 이때는 마지막 줄에 줄바꿈이 없어도 읽습니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void catalog_sync(void) {
+    struct stat st;
+    csv_flush_path(MISSION_CATALOG_PATH);
+    if (stat(MISSION_CATALOG_PATH, &st) != 0) {
+        g_cat_consumed = 0;
+        g_cat_size = -1;
+        g_cat_tail_nl = 1;
+        return;
+    }
+    long long size = (long long)st.st_size;
+    long long mtime = (long long)st.st_mtime;
+    unsigned long long ino = (unsigned long long)st.st_ino;
+    if (size == g_cat_size && mtime == g_cat_mtime && ino == g_cat_ino) return;
+
+    int full = g_cat_size < 0 || ino != g_cat_ino || size < g_cat_consumed ||
+               (size == g_cat_size && mtime != g_cat_mtime);
+    void *map = NULL;
+    size_t len = 0;
+    if (!csv_map_file(MISSION_CATALOG_PATH, &map, &len)) return;
+    const char *data = map;
+    size_t from = full ? 0 : (size_t)g_cat_consumed;
+    /* 읽은 끝이 더 이상 줄 경계가 아니면 제자리에서 다시 쓰인 파일이다 */
+    if (from > len || (from > 0 && data[from - 1] != '\n')) {
+        full = 1;
+        from = 0;
+    }
+    size_t end = len;
+    while (end > from && data[end - 1] != '\n') end--;
+
+    int *old_ids = NULL;
+    int old_count = 0;
+    if (full && g_catalog_count > 0) {
+        old_ids = malloc((size_t)g_catalog_count * sizeof(*old_ids));
+        if (!old_ids) {
+            csv_unmap_file(map, len);
+            return;
+        }
+        for (int i = 0; i < g_catalog_count; ++i) old_ids[i] = g_catalog[i].id;
+        old_count = g_catalog_count;
+        catalog_clear();
+    }
+    catalog_parse(data + from, (full ? len : end) - from);
+    g_cat_tail_nl = len == 0 || data[len - 1] == '\n';
+    csv_unmap_file(map, len);
+    if (old_ids) {
+        catalog_remap_users(old_ids, old_count);
+        free(old_ids);
+    }
+
+    g_cat_consumed = (long long)end;
+    g_cat_size = (long long)len;
+    g_cat_mtime = mtime;
+    g_cat_ino = ino;
+}
+
+/* 함수 목적: 전역 미션 카탈로그(g_catalog)를 디스크(`data/missions.csv`)로부터 처음 로드합니다.
  * 설명:
- *   - 프로그램 시작 또는 카탈로그가 비어 있을 때 한 번만 실행되어
- *     `g_catalog`를 채웁니다.
- *   - `data/missions.csv` 파일의 각 행은 "CREATE,id,name,type,reward,ts"
- *     형식을 따르며, 해당 정보를 파싱해 내부 카탈로그에 추가합니다.
- *   - 이미 로드된 미션(id 중복)을 방지하기 위해 `catalog_has_id`를 사용합니다.
- *   - 최대 `MAX_MISSIONS`까지 로드하며, 로드 중 `g_next_id`를 갱신합니다.
- *   - 함수는 재진입 안전성(re-entrant)을 고려하여 `g_seeded`가 설정되어
- *     있으면 즉시 반환합니다.
+ *   - `g_seeded`가 설정되어 있으면 즉시 반환하고, 아니면 `catalog_sync()`로
+ *     파일 전체를 읽습니다. 카탈로그 크기에는 상한이 없습니다.
  *
  * 매개변수:
  *   - 없음
@@ -80,59 +282,16 @@ static void ensure_seeded(void) {
     if (g_seeded) {
         return;
     }
-    /* existing seeding logic reads data/missions.csv into g_catalog */
     csv_ensure_dir("data");
-    char *buf = NULL;
-    size_t buflen = 0;
-    if (csv_read_last_lines("data/missions.csv", 10000, &buf, &buflen) && buf && buflen > 0) {
-        char *p = buf;
-        while (p && *p) {
-            char *nl = strchr(p, '\n');
-            if (nl) *nl = '\0';
-            /* format: CREATE,id,name,type,reward,ts */
-            if (strncmp(p, "CREATE,", 7) == 0) {
-                char *s = p + 7;
-                char *tok = strtok(s, ",");
-                if (tok) {
-                    int id = atoi(tok);
-                    char *name = strtok(NULL, ",");
-                    char *typ = strtok(NULL, ",");
-                    char *rew = strtok(NULL, ",");
-                    /* skip if we already loaded this mission id (avoid duplicates from CSV) */
-                    if (catalog_has_id(id)) {
-                        /* advance to next line */
-                        if (!nl) break;
-                        p = nl + 1;
-                        continue;
-                    }
-                    if (name && typ && rew && g_catalog_count < MAX_MISSIONS) {
-                        Mission *slot = &g_catalog[g_catalog_count++];
-                        memset(slot, 0, sizeof(*slot));
-                        slot->id = id;
-                        snprintf(slot->name, sizeof(slot->name), "%s", name);
-                        slot->type = atoi(typ);
-                        slot->reward = atoi(rew);
-                        slot->completed = 0;
-                        if (id >= g_next_id) g_next_id = id + 1;
-                    }
-                }
-            }
-            if (!nl) break;
-            p = nl + 1;
-        }
-        free(buf);
-        buf = NULL;
-    }
+    catalog_sync();
     g_seeded = 1;
 }
 
 
-/* 함수 목적: 전역 미션 카탈로그를 디스크에서 다시 로드하도록 강제합니다.
+/* 함수 목적: 외부에서 갱신된 `data/missions.csv`를 카탈로그에 반영합니다.
  * 설명:
- *   - 메모리상의 미션 카탈로그(`g_catalog`)가 변경되었거나 외부에서
- *     `data/missions.csv`가 갱신된 경우, 이 함수를 호출하면 내부의
- *     `g_seeded` 플래그를 초기화하고 `ensure_seeded()`를 호출하여 파일로부터
- *     카탈로그를 재구성합니다.
+ *   - 파일이 그대로면 stat 한 번으로 끝나고, 덧붙은 경우에는 새 CREATE
+ *     줄만 읽습니다 (`catalog_sync()` 참고). 화면을 열 때마다 불러도 됩니다.
  *   - 간단한 동기화 유틸리티로, 다른 스레드 안전성이나 동시성 제어는
  *     제공하지 않습니다. 멀티스레드 환경에서는 호출자가 별도 동기화해야
  *     합니다.
@@ -144,8 +303,11 @@ static void ensure_seeded(void) {
  *   - 현재 카탈로그에 로드된 미션 수 (정수, 0 이상)
  */
 int mission_refresh_catalog(void) {
-    g_seeded = 0;
-    ensure_seeded();
+    if (!g_seeded) {
+        ensure_seeded();
+    } else {
+        catalog_sync();
+    }
     return g_catalog_count;
 }
 
@@ -153,7 +315,7 @@ int mission_refresh_catalog(void) {
  * 설명:
  *   - 전달된 `Mission` 구조체 정보를 바탕으로 내부 전역 카탈로그
  *     (`g_catalog`)에 미션을 추가합니다.
- *   - 중복 이름(name)이 존재하거나 카탈로그가 가득 찬 경우 생성을 거부합니다.
+ *   - 중복 이름(name)이 존재하거나 메모리를 확보하지 못한 경우 생성을 거부합니다.
  *   - 생성 시 자동으로 고유 ID(`g_next_id`)를 할당하며, `data/missions.csv`
  *     파일에 "CREATE,<id>,<name>,<type>,<reward>,<ts>" 형식으로 영속화합니다.
  *   - 파일 쓰기 동작은 단순 append 방식이며, 기존 파일 끝에 개행이 없으면
@@ -164,42 +326,30 @@ int mission_refresh_catalog(void) {
  *
  * 반환값:
  *   - 성공: 1 (카탈로그에 추가 및 파일에 영속화 완료)
- *   - 실패: 0 (인자 오류, 중복 이름, 카탈로그 포화 등)
+ *   - 실패: 0 (인자 오류, 중복 이름, 메모리 부족 등)
  */
 int mission_create(const Mission *m) {
-    ensure_seeded();
+    /* 디스크 상태(끝 줄바꿈 여부)를 맞추려고 새로고침까지 한다; 바뀌지 않았으면 stat 한 번 */
+    mission_refresh_catalog();
     /* prevent creating duplicate missions by name */
-    if (!m || g_catalog_count >= MAX_MISSIONS || catalog_has_name(m->name)) {
+    if (!m || catalog_has_name(m->name)) {
         return 0;
     }
-    Mission *slot = &g_catalog[g_catalog_count++];
-    memset(slot, 0, sizeof(*slot));
+    Mission *slot = catalog_push();
+    if (!slot) return 0;
     slot->id = g_next_id++;
     snprintf(slot->name, sizeof(slot->name), "%s", m->name);
     slot->type = m->type;
     slot->reward = m->reward;
     slot->completed = 0;
+    catalog_index_add(slot->id, g_catalog_count - 1);
 
-    /* persist new mission to data/missions.csv */
+    /* persist new mission to data/missions.csv (queued on the writer thread);
+     * start a fresh line if the file does not end with newline */
     csv_ensure_dir("data");
-    /* sanitize name by replacing any commas with space to keep CSV simple */
-    /* append with a preceding newline if the file does not end with newline */
-    FILE *fp = fopen("data/missions.csv", "a+");
-    if (fp) {
-        /* ensure file ends with newline before appending a new CREATE line */
-        long cur = ftell(fp);
-        if (cur > 0) {
-            /* check last byte */
-            fseek(fp, -1, SEEK_END);
-            int last = fgetc(fp);
-            fseek(fp, 0, SEEK_END);
-            if (last != '\n') {
-                fputc('\n', fp);
-            }
-        }
-        fprintf(fp, "CREATE,%d,%s,%d,%d,%ld\n", slot->id, slot->name, slot->type, slot->reward, (long)time(NULL));
-        fclose(fp);
-    }
+    csv_append_row(MISSION_CATALOG_PATH, "%sCREATE,%d,%s,%d,%d,%ld", g_cat_tail_nl ? "" : "\n",
+                   slot->id, slot->name, slot->type, slot->reward, (long)time(NULL));
+    g_cat_tail_nl = 1;
     return 1;
 }
 
@@ -207,8 +357,8 @@ int mission_create(const Mission *m) {
  * 설명:
  *   - 내부 전역 미션 카탈로그를 로드(`ensure_seeded()`)한 뒤, 아직
  *     `completed` 플래그가 없는(미완료) 미션들을 `out_arr`에 복사합니다.
- *   - 호출자는 `out_arr`가 충분한 크기(예: `MAX_MISSIONS`)를 가지고 있음을
- *     보장해야 하며, `out_n`에는 전달 가능한 최대 슬롯 수를 넣어 호출합니다.
+ *   - 카탈로그 크기에는 상한이 없으므로 `out_n`에는 `out_arr`의 칸 수를
+ *     넣어 호출해야 하며, 그보다 많은 미션은 복사하지 않습니다.
  *   - 함수는 실제로 복사된 항목 수를 `*out_n`에 저장합니다.
  *
  * 매개변수:
@@ -225,8 +375,9 @@ int mission_list_open(Mission *out_arr, int *out_n) {
     if (!out_arr || !out_n) {
         return 0;
     }
+    int cap = *out_n;
     int copied = 0;
-    for (int i = 0; i < g_catalog_count; ++i) {
+    for (int i = 0; i < g_catalog_count && copied < cap; ++i) {
         if (!g_catalog[i].completed) {
             out_arr[copied++] = g_catalog[i];
         }
@@ -235,45 +386,59 @@ int mission_list_open(Mission *out_arr, int *out_n) {
     return 1;
 }
 
-/* 함수 목적: 특정 사용자(User)의 할당된 미션 목록에서 지정한 ID를 찾아 반환합니다.
+/* 함수 목적: 미션 ID가 카탈로그의 몇 번째 칸에 있는지 찾습니다.
  * 설명:
- *   - 주어진 `user`의 `missions` 배열을 순회하여 각 항목의 `id`가
- *     `mission_id`와 일치하는지 검사합니다.
- *   - 일치하는 항목을 찾으면 해당 `Mission *`를 반환하고, 없으면 NULL을 반환합니다.
- *   - 사용자 포인터가 NULL이면 즉시 NULL을 반환합니다.
+ *   - 사용자의 미션 완료 여부는 카탈로그 칸 번호를 비트 위치로 쓰는
+ *     비트셋(user_mission_done)에 있으므로, ID를 칸 번호로 바꿀 때 사용합니다.
+ *   - 파일이 덧붙기만 하는 동안 칸 번호는 바뀌지 않습니다. 파일이 잘리거나
+ *     교체되면 카탈로그를 다시 만들고 완료 비트셋도 함께 옮깁니다.
+ *   - ID 색인(g_slot_by_id)으로 O(1)에 찾습니다.
  *
  * 매개변수:
- *   - user: 대상 사용자 포인터 (NULL 허용)
  *   - mission_id: 찾고자 하는 미션의 ID
  *
  * 반환값:
- *   - 성공: 해당 미션을 가리키는 `Mission *`
- *   - 실패/미발견: `NULL`
+ *   - 성공: 칸 번호 (0 이상)
+ *   - 실패/미발견: -1
  */
-static Mission *find_user_mission(User *user, int mission_id) {
-    if (!user) {
-        return NULL;
-    }
-    for (int i = 0; i < user->mission_count; ++i) {
-        if (user->missions[i].id == mission_id) {
-            return &user->missions[i];
-        }
-    }
-    return NULL;
+int mission_catalog_slot(int mission_id) {
+    ensure_seeded();
+    return catalog_find_slot(mission_id);
+}
+
+/* 함수 목적: 카탈로그에 등록된 미션 수를 돌려줍니다.
+ * 매개변수: 없음
+ * 반환 값: 미션 수
+ */
+int mission_catalog_count(void) {
+    ensure_seeded();
+    return g_catalog_count;
+}
+
+/* 함수 목적: 카탈로그의 slot 번째 미션을 사용자의 완료 여부와 함께 복사합니다.
+ * 매개변수: user, slot, out
+ * 반환 값: 성공 1, 범위를 벗어나면 0
+ */
+int mission_user_at(const User *user, int slot, Mission *out) {
+    ensure_seeded();
+    if (!user || !out || slot < 0 || slot >= g_catalog_count) return 0;
+    *out = g_catalog[slot];
+    out->completed = user_mission_done(user, slot);
+    return 1;
 }
 
 /* 함수 목적: 사용자가 특정 미션을 완료했을 때 상태를 갱신하고 보상을 지급합니다.
  * 설명:
  *   - 전달된 `username`과 `mission_id`로 사용자의 할당된 미션을 찾아
  *     완료 처리합니다. 내부적으로 `ensure_seeded()`로 전역 카탈로그를
- *     보장하고, `find_user_mission()`으로 사용자의 미션을 조회합니다.
+ *     보장하고, `mission_catalog_slot()`으로 미션의 칸 번호를 찾습니다.
  *   - 이미 완료된 미션이거나 미션을 찾을 수 없는 경우 실패합니다.
  *   - 완료 성공 시 다음 작업을 수행합니다:
- *     1) 사용자의 해당 미션 `completed`를 1로 설정하고 관련 카운터를 갱신.
+ *     1) 사용자의 완료 비트셋에서 해당 칸을 켜고 관련 카운터를 갱신.
  *     2) 미션 보상(`reward`)을 사용자의 현금(`user->bank.cash`)에 즉시 추가.
- *     3) 거래 로그(`data/txs/<username>.csv`)에 보상 항목을 기록합니다.
+ *     3) 장부(`data/ledger`)와 거래 로그(`data/txs/<username>.csv`)에 보상 항목을 기록합니다.
  *     4) `user_update_balance(username, user->bank.balance)`를 호출하여
- *        `data/accounts.csv`를 갱신하도록 합니다(현금 필드 포함).
+ *        `data/accounts.dat`의 해당 계좌 슬롯을 갱신합니다(현금 필드 포함).
  *     5) 사용자별 미션 파일(`data/missions/<username>.csv`)에
  *        "COMPLETE,<id>,<ts>" 항목을 append 하여 완료를 영속화합니다.
  *
@@ -294,26 +459,21 @@ int mission_complete(const char *username, int mission_id) {
     if (!user) {
         return 0;
     }
-    Mission *user_mission = find_user_mission(user, mission_id);
-    if (!user_mission || user_mission->completed) {
+    /* 이미 완료한 미션에 보상을 두 번 주지 않도록 완료 기록을 먼저 읽어 둔다 */
+    user_hydrate(user);
+    int slot = mission_catalog_slot(mission_id);
+    if (slot < 0 || user_mission_done(user, slot) || !user_mission_mark(user, slot)) {
         return 0;
     }
-    user_mission->completed = 1;
     user->completed_missions += 1;
     if (user->total_missions < user->completed_missions) {
         user->total_missions = user->completed_missions;
     }
     /* give reward to user's cash (not the balance) */
-    user->bank.cash += user_mission->reward;
-     /* record a transaction for the cash reward so it appears in user's txs */
-     csv_ensure_dir("data");
-     csv_ensure_dir("data/txs");
-     char txpath[512];
-     snprintf(txpath, sizeof(txpath), "data/txs/%s.csv", username);
-     /* format: ts,reason,amount,balance -- balance unchanged here */
-     csv_append_row(txpath, "%ld,%s,%+d,%d", (long)time(NULL), "MISSION_REWARD", user_mission->reward, user->bank.balance);
-     /* persist accounts.csv so cash change is saved to disk (user_update_balance rewrites accounts.csv)
-         pass current balance to trigger rewrite; this will include the updated cash field. */
+    /* recorded in the ledger and in user's txs; balance unchanged here */
+    account_grant_cash(user, g_catalog[slot].reward, "MISSION_REWARD");
+     /* persist the account slot so the cash change is saved to disk
+         (user_update_balance writes this user's record in data/accounts.dat, cash included). */
      user_update_balance(username, user->bank.balance);
      /* persist completion to per-user missions CSV */
     csv_ensure_dir("data/missions");
@@ -323,95 +483,121 @@ int mission_complete(const char *username, int mission_id) {
     return 1;
 }
 
-/* 함수 목적: 사용자의 미션 파일을 읽어 사용자의 미션 목록을 구성하고 완료 정보를 반영합니다.
+/* 함수 목적: 사용자의 미션 파일을 읽어 완료 비트셋을 다시 채웁니다. 파일은 읽기만 합니다.
  * 설명:
- *   - `data/missions/<username>.csv` 파일을 읽어 역사적인 "COMPLETE" 항목을
- *     수집하고, ASSIGN 항목은 무시합니다. 수집된 COMPLETE 항목만으로
- *     파일을 재작성하여 ASSIGN 기록을 제거합니다.
- *   - 전역 카탈로그가 비어있을 경우 `ensure_seeded()`를 호출하여 로드합니다.
- *   - 이후 전역 카탈로그를 기준으로 사용자의 `missions` 배열을 채우고,
- *     COMPLETE 목록과 비교하여 각 미션의 `completed` 플래그를 설정합니다.
+ *   - `data/missions/<username>.csv` 의 "COMPLETE,<id>,<ts>" 행마다 미션 ID를
+ *     카탈로그 칸 번호로 바꿔(O(1)) 비트를 켭니다. 예전 형식의 ASSIGN 행은
+ *     건너뛰며, 파일에서 지우는 일은 mission_migrate_legacy 가 한 번만 합니다.
+ *   - 비용은 비트셋 초기화 O(카탈로그/64) 와 파일 행 수에 비례합니다.
  *
  * 매개변수:
  *   - username: 미션을 로드할 대상 사용자 이름(문자열)
  *   - user: 미션 정보를 채울 `User *` (NULL이면 실패)
  *
  * 반환값:
- *   - 성공: 사용자의 미션 수 (>= 0)
+ *   - 성공: 사용자의 미션 수 (카탈로그 미션 수, >= 0)
  *   - 실패: -1 (잘못된 인자 등)
  */
 int mission_load_user(const char *username, User *user) {
     if (!username || !user) return -1;
-    /* Ensure global catalog is loaded so we can populate user's mission list from it */
+    /* Ensure global catalog is loaded so ids can be mapped to catalog slots */
     ensure_seeded();
+    user_missions_reset(user);
+    user->completed_missions = 0;
     char path[512];
     snprintf(path, sizeof(path), "data/missions/%s.csv", username);
-    char *buf = NULL;
-    size_t buflen = 0;
-    /* Read per-user file (may contain ASSIGN and COMPLETE historically) */
-    csv_read_last_lines(path, 1000, &buf, &buflen);
-
-    /* Collect COMPLETE entries (id and ts) and ignore ASSIGN entries. */
-    int completed_ids[256];
-    long completed_ts[256];
-    int completed_count = 0;
-    if (buf && buflen > 0) {
-        char *p = buf;
-        while (p && *p) {
-            char *nl = strchr(p, '\n');
-            if (nl) *nl = '\0';
-            if (strncmp(p, "COMPLETE,", 9) == 0) {
-                char *s = p + 9;
-                char *tok = strtok(s, ",");
-                if (tok) {
-                    int id = atoi(tok);
-                    char *toks = strtok(NULL, ",");
-                    long ts = toks ? atol(toks) : 0;
-                    if (completed_count < (int)(sizeof(completed_ids)/sizeof(completed_ids[0]))) {
-                        completed_ids[completed_count] = id;
-                        completed_ts[completed_count] = ts;
-                        completed_count++;
-                    }
-                }
-            }
-            if (!nl) break;
-            p = nl + 1;
+    CsvCursor cur;
+    if (csv_cursor_open(&cur, path, ',')) {
+        while (csv_cursor_next_row(&cur)) {
+            CsvField f[2];
+            int id = 0;
+            if (csv_cursor_fields(&cur, f, 2) < 2 || !csv_field_eq(f[0], "COMPLETE") || !csv_field_int(f[1], &id)) continue;
+            int slot = mission_catalog_slot(id);
+            if (slot < 0 || user_mission_done(user, slot)) continue;
+            if (user_mission_mark(user, slot)) user->completed_missions += 1;
         }
-        free(buf);
-        buf = NULL;
+        csv_cursor_close(&cur);
     }
+    user->total_missions = g_catalog_count;
+    return g_catalog_count;
+}
 
-    /* Rebuild per-user file to contain only COMPLETE lines (drop ASSIGN) */
-    if (completed_count > 0) {
-        /* overwrite file with only COMPLETE entries */
-        FILE *f = fopen(path, "w");
-        if (f) {
-            for (int i = 0; i < completed_count; ++i) {
-                fprintf(f, "COMPLETE,%d,%ld\n", completed_ids[i], completed_ts[i]);
+/* 함수 목적: 예전 형식의 사용자별 미션 파일을 한 번만 정리합니다.
+ * 설명:
+ *   - `data/missions/` 아래 `.csv` 중 COMPLETE 가 아닌 행(예전 ASSIGN 기록)이 있는
+ *     파일만 COMPLETE 행으로 다시 쓰고, COMPLETE 행이 하나도 없으면 지웁니다.
+ *   - 끝나면 `data/missions/.legacy_migrated` 표시 파일을 남겨 다음부터는
+ *     디렉터리를 훑지 않습니다.
+ *
+ * 매개변수:
+ *   - 없음
+ *
+ * 반환값:
+ *   - 다시 쓰거나 지운 파일 수 (이미 정리했으면 0), 디렉터리를 열 수 없으면 -1
+ */
+int mission_migrate_legacy(void) {
+    csv_flush_path(MISSION_MIGRATED_PATH);
+    FILE *marker = fopen(MISSION_MIGRATED_PATH, "r");
+    if (marker) {
+        fclose(marker);
+        return 0;
+    }
+    DIR *dir = opendir("data/missions");
+    if (!dir) return -1;
+    int changed = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        size_t nlen = strlen(ent->d_name);
+        if (nlen < 5 || ent->d_name[0] == '.' || strcmp(ent->d_name + nlen - 4, ".csv") != 0) continue;
+        char path[512];
+        snprintf(path, sizeof(path), "data/missions/%s", ent->d_name);
+        CsvCursor cur;
+        if (!csv_cursor_open(&cur, path, ',')) continue;
+        char *out = malloc(cur.len + 1);
+        size_t olen = 0;
+        int legacy = 0;
+        while (out && csv_cursor_next_row(&cur)) {
+            CsvField f[3];
+            int fc = csv_cursor_fields(&cur, f, 3);
+            int id = 0;
+            if (fc < 2 || !csv_field_eq(f[0], "COMPLETE") || !csv_field_int(f[1], &id)) {
+                legacy = 1;
+                continue;
             }
-            fclose(f);
+            /* 행을 그대로 옮기므로 결과는 원본보다 길어지지 않는다 */
+            memcpy(out + olen, cur.row.ptr, cur.row.len);
+            olen += cur.row.len;
+            out[olen++] = '\n';
         }
-    } else {
-        /* no COMPLETE entries -> remove file if exists */
-        remove(path);
+        csv_cursor_close(&cur);
+        if (out && legacy) {
+            if (olen > 0) csv_write_file(path, out, olen);
+            else csv_remove_file(path);
+            changed++;
+        }
+        free(out);
     }
+    closedir(dir);
+    csv_write_file(MISSION_MIGRATED_PATH, "1\n", 2);
+    return changed;
+}
 
-    /* Populate user's mission list from global catalog and mark completions */
-    user->mission_count = 0;
+/* 함수 목적: 주어진 완료 ID 목록으로 사용자의 완료 비트셋을 다시 채웁니다.
+ *           모든 사용자는 카탈로그의 모든 미션을 배정받은 것으로 봅니다.
+ *           (파일을 읽지 않으므로 스냅샷에서 복원할 때 사용)
+ * 매개변수: user, completed_ids, completed_count
+ * 반환 값: 사용자의 미션 수, 잘못된 인자면 -1
+ */
+int mission_apply_completed(User *user, const int *completed_ids, int completed_count) {
+    if (!user || (!completed_ids && completed_count > 0)) return -1;
+    ensure_seeded();
+    user_missions_reset(user);
     user->completed_missions = 0;
-    user->total_missions = 0;
-    for (int i = 0; i < g_catalog_count && user->mission_count < (int)(sizeof(user->missions)/sizeof(user->missions[0])); ++i) {
-        Mission *g = &g_catalog[i];
-        Mission *slot = &user->missions[user->mission_count++];
-        *slot = *g;
-        /* Determine if user completed this mission */
-        int done = 0;
-        for (int j = 0; j < completed_count; ++j) {
-            if (completed_ids[j] == g->id) { done = 1; break; }
-        }
-        slot->completed = done;
-        if (done) user->completed_missions += 1;
+    for (int j = 0; j < completed_count; ++j) {
+        int slot = mission_catalog_slot(completed_ids[j]);
+        if (slot < 0 || user_mission_done(user, slot)) continue;
+        if (user_mission_mark(user, slot)) user->completed_missions += 1;
     }
-    user->total_missions = user->mission_count;
-    return user->mission_count;
+    user->total_missions = g_catalog_count;
+    return g_catalog_count;
 }
@@ -73,31 +73,31 @@ int notify_recent_to_buf(const char *username, int limit, char *buf, size_t bufl
     if (!username || !buf || buflen == 0) return -1;
     char path[512];
     snprintf(path, sizeof(path), "data/notifications/%s.csv", username);
-    char *tmp = NULL;
-    size_t tmplen = 0;
-    if (!csv_read_last_lines(path, limit, &tmp, &tmplen) || !tmp) {
+    CsvTail it;
+    if (!csv_tail_open(&it, path, limit)) {
         buf[0] = '\0';
         return 0;
     }
-    /* tmp contains newline-terminated lines like: "<ts>,<message>\n".
+    /* the tail iterator yields lines like: "<ts>,<message>".
        Parse each line, convert timestamp to human-friendly string and
        append to `buf`. Return number of bytes written. */
     size_t outpos = 0;
-    char *p = tmp;
     time_t now = time(NULL);
-    while (p && *p && outpos + 1 < buflen) {
-        char *nl = strchr(p, '\n');
-        if (nl) *nl = '\0';
+    const char *line = NULL;
+    size_t line_len = 0;
+    while (outpos + 1 < buflen && csv_tail_next(&it, &line, &line_len)) {
         /* split "ts,msg" */
-        char *comma = strchr(p, ',');
+        const char *comma = memchr(line, ',', line_len);
         time_t ts = 0;
-        char *msg = NULL;
+        const char *msg = NULL;
+        int msg_len = 0;
         if (comma) {
-            *comma = '\0';
-            ts = (time_t)atoll(p);
+            ts = (time_t)atoll(line);
             msg = comma + 1;
+            msg_len = (int)(line_len - (size_t)(msg - line));
         } else {
-            msg = p;
+            msg = line;
+            msg_len = (int)line_len;
         }
 
         /* format relative time in Korean */
@@ -125,7 +125,7 @@ int notify_recent_to_buf(const char *username, int limit, char *buf, size_t bufl
         }
 
         /* append formatted line: "[timestr] message\n" */
-        int wrote = snprintf(buf + outpos, buflen - outpos, "[%s] %s\n", timestr, msg ? msg : "");
+        int wrote = snprintf(buf + outpos, buflen - outpos, "[%s] %.*s\n", timestr, msg_len, msg ? msg : "");
         if (wrote < 0) break;
         if ((size_t)wrote >= buflen - outpos) {
             /* truncated: ensure NUL and break */
@@ -134,13 +134,9 @@ int notify_recent_to_buf(const char *username, int limit, char *buf, size_t bufl
             break;
         }
         outpos += (size_t)wrote;
-
-        if (!nl) break;
-        p = nl + 1;
     }
 
-    free(tmp);
-    tmp = NULL;
+    csv_tail_close(&it);
     /* ensure NUL termination */
     if (outpos >= buflen) outpos = buflen - 1;
     buf[outpos] = '\0';
@@ -4,6 +4,7 @@
  */
 #include "../../include/domain/qotd.h"
 #include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,12 +36,9 @@ static void sanitize_field(const char *in, char *out, size_t out_sz) {
  * 반환 값: 성공 여부
  */
 int qotd_ensure_storage(void) {
-    /* ensure data directory exists; file will be created when appending */
+    /* ensure data directory exists; an empty append creates the file (on the writer thread) */
     csv_ensure_dir("data");
-    FILE *f = fopen("data/qotd.csv", "a");
-    if (!f) return 0;
-    fclose(f);
-    return 1;
+    return csv_append_raw("data/qotd.csv", "", 0);
 }
 
 /* 함수 목적: 특정 날짜에 어떤 유저가 어떤 문제에 대해 어떤 상태를 남겼는지 기록하는 함수.
@@ -59,12 +57,7 @@ int qotd_record_entry(const char *date, const char *user, const char *question,
     sanitize_field(question ? question : "", squestion, sizeof(squestion));
     sanitize_field(status ? status : "", sstatus, sizeof(sstatus));
     /* use pipe delimiter */
-    csv_ensure_dir("data");
-    FILE *fp = fopen("data/qotd.csv", "a");
-    if (!fp) return 0;
-    int ok = fprintf(fp, "%s|%s|%s|%s\n", sdate, suser, squestion, sstatus) > 0;
-    fclose(fp);
-    return ok ? 1 : 0;
+    return csv_append_row("data/qotd.csv", "%s|%s|%s|%s", sdate, suser, squestion, sstatus);
 }
 
 /* 함수 목적: qotd.csv를 읽어서, 특정 날짜에 QOTD 기록이 있는 유저 이름 목록을(중복 없이) 만듬
@@ -73,115 +66,167 @@ int qotd_record_entry(const char *date, const char *user, const char *question,
  */
 int qotd_get_solved_users_for_date(const char *date, char ***out_users, int *out_count) {
     if (!date || !out_users || !out_count) return 0;
-    FILE *f = fopen("data/qotd.csv", "r");
-    if (!f) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, "data/qotd.csv", '|')) {
         *out_users = NULL;
         *out_count = 0;
         return 1; /* no file treated as empty */
     }
-    char buf[1024];
     char **users = NULL;
     int ucount = 0;
-    while (fgets(buf, sizeof(buf), f) != NULL) {
-        size_t r = strlen(buf);
-        if (r == 0) continue;
-        if (buf[r-1] == '\n') buf[r-1] = '\0';
+    while (csv_cursor_next_row(&cur)) {
         /* parse by pipe '|' */
-        char *p = buf;
-        char *fld_date = strtok(p, "|");
-        char *fld_user = strtok(NULL, "|");
-        if (!fld_date || !fld_user) continue;
-        if (strcmp(fld_date, date) == 0) {
+        CsvField f[2];
+        if (csv_cursor_fields(&cur, f, 2) < 2 || f[0].len == 0 || f[1].len == 0) continue;
+        if (csv_field_eq(f[0], date)) {
             int dup = 0;
             for (int i = 0; i < ucount; ++i) {
-                if (strcmp(users[i], fld_user) == 0) { dup = 1; break; }
+                if (csv_field_eq(f[1], users[i])) { dup = 1; break; }
             }
             if (!dup) {
                 users = realloc(users, sizeof(char*) * (ucount + 1));
-                users[ucount++] = strdup(fld_user);
+                users[ucount] = malloc(f[1].len + 1);
+                csv_field_copy(f[1], users[ucount], f[1].len + 1);
+                ucount++;
             }
         }
     }
-    fclose(f);
+    csv_cursor_close(&cur);
     *out_users = users;
     *out_count = ucount;
     return 1;
 }
 
-/* Attempt to load today's QOTD from data/qotd_questions.csv.
- * Returns 1 if found and fills *out, 0 if not found or on error.
+/* 오늘의 문제와 오늘 푼 사람 목록. 날짜가 바뀌면 qotd_rollover 가 다시 만들고
+ * (스케줄러의 자정 작업), 화면은 여기서 읽기만 한다.
  */
-/* 함수 목적: 당일의 qotd 를 가져오는 함수
- * 매개변수: out
- * 반환 값: 당일의 qotd 를 찾았는지 여부
- */
-int qotd_get_today(QOTD *out) {
-    if (!out) return 0;
-    FILE *f = fopen("data/qotd_questions.csv", "r");
-    if (!f) return 0;
-    char buf[2048];
-    time_t tnow = time(NULL);
-    struct tm *tmnow = localtime(&tnow);
-    char today[32] = {0};
-    if (tmnow) strftime(today, sizeof(today), "%Y-%m-%d", tmnow);
+static char g_day[32];
+static QOTD g_day_q;
+static int g_day_has_q = 0;
+static char **g_day_solved = NULL;
+static int g_day_solved_count = 0;
+static int g_day_loaded = 0;
 
-    while (fgets(buf, sizeof(buf), f) != NULL) {
-        size_t r = strlen(buf);
-        if (r == 0) continue;
-        if (buf[r-1] == '\n') buf[r-1] = '\0';
+/* 함수 목적: data/qotd_questions.csv 에서 주어진 날짜의 문제를 찾는 함수
+ * 매개변수: date, out
+ * 반환 값: 찾았는지 여부
+ */
+static int load_question_for_date(const char *date, QOTD *out) {
+    CsvCursor cur;
+    if (!date[0] || !csv_cursor_open(&cur, "data/qotd_questions.csv", '|')) return 0;
+    while (csv_cursor_next_row(&cur)) {
         /* parse either pipe-delimited or comma-delimited rows:
          * name|date|question|right_index|opt1|opt2|opt3
          * or
          * name,date,question,right_index,opt1,opt2,opt3
          */
-        char *s = buf;
-        char *flds[8] = {0};
-        int fi = 0;
-        char *tok = NULL;
-        char delim[2] = {0};
-        if (strchr(s, '|')) delim[0] = '|'; else delim[0] = ',';
-        tok = strtok(s, delim);
-        while (tok && fi < 7) {
-            flds[fi++] = tok;
-            tok = strtok(NULL, delim);
-        }
-        if (fi >= 4) {
-            const char *fdate = flds[1] ? flds[1] : "";
-            if (today[0] != '\0' && strcmp(fdate, today) == 0) {
-                /* found today's entry */
-                memset(out, 0, sizeof(*out));
-                if (flds[0]) strncpy(out->name, flds[0], sizeof(out->name)-1);
-                if (flds[1]) strncpy(out->date, flds[1], sizeof(out->date)-1);
-                if (flds[2]) strncpy(out->question, flds[2], sizeof(out->question)-1);
-                out->right_index = flds[3] ? atoi(flds[3]) : 0;
-                if (fi > 4 && flds[4]) strncpy(out->opt1, flds[4], sizeof(out->opt1)-1);
-                if (fi > 5 && flds[5]) strncpy(out->opt2, flds[5], sizeof(out->opt2)-1);
-                if (fi > 6 && flds[6]) strncpy(out->opt3, flds[6], sizeof(out->opt3)-1);
-                fclose(f);
-                return 1;
-            }
+        cur.delim = memchr(cur.row.ptr, '|', cur.row.len) ? '|' : ',';
+        CsvField flds[7];
+        int fi = csv_cursor_fields(&cur, flds, 7);
+        if (fi >= 4 && csv_field_eq(flds[1], date)) {
+            memset(out, 0, sizeof(*out));
+            csv_field_copy(flds[0], out->name, sizeof(out->name));
+            csv_field_copy(flds[1], out->date, sizeof(out->date));
+            csv_field_copy(flds[2], out->question, sizeof(out->question));
+            out->right_index = 0;
+            csv_field_int(flds[3], &out->right_index);
+            if (fi > 4) csv_field_copy(flds[4], out->opt1, sizeof(out->opt1));
+            if (fi > 5) csv_field_copy(flds[5], out->opt2, sizeof(out->opt2));
+            if (fi > 6) csv_field_copy(flds[6], out->opt3, sizeof(out->opt3));
+            csv_cursor_close(&cur);
+            return 1;
         }
     }
-    fclose(f);
+    csv_cursor_close(&cur);
+    return 0;
+}
+
+/* 함수 목적: 날짜가 바뀌었으면 오늘의 문제와 푼 사람 목록을 다시 읽는 함수
+ * 매개변수: now (epoch 초, 지역 시간 기준으로 날짜를 정함)
+ * 반환 값: 다시 읽었으면 1
+ */
+int qotd_rollover(long now) {
+    char today[32] = {0};
+    time_t t = (time_t)now;
+    struct tm *tmnow = localtime(&t);
+    if (tmnow) strftime(today, sizeof(today), "%Y-%m-%d", tmnow);
+    if (g_day_loaded && strcmp(today, g_day) == 0) return 0;
+
+    for (int i = 0; i < g_day_solved_count; ++i) free(g_day_solved[i]);
+    free(g_day_solved);
+    g_day_solved = NULL;
+    g_day_solved_count = 0;
+    snprintf(g_day, sizeof(g_day), "%s", today);
+    g_day_has_q = load_question_for_date(g_day, &g_day_q);
+    if (!qotd_get_solved_users_for_date(g_day, &g_day_solved, &g_day_solved_count)) {
+        g_day_solved = NULL;
+        g_day_solved_count = 0;
+    }
+    g_day_loaded = 1;
+    return 1;
+}
+
+/* 함수 목적: 문제 파일이 바뀌었을 때 다음 조회에서 오늘 상태를 다시 읽게 하는 함수
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void qotd_invalidate(void) {
+    g_day_loaded = 0;
+}
+
+/* 함수 목적: 오늘 상태가 아직 없으면 한 번 만드는 함수
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void ensure_day_loaded(void) {
+    if (!g_day_loaded) qotd_rollover((long)time(NULL));
+}
+
+/* 함수 목적: 당일의 qotd 를 가져오는 함수 (미리 읽어 둔 값을 복사)
+ * 매개변수: out
+ * 반환 값: 당일의 qotd 를 찾았는지 여부
+ */
+int qotd_get_today(QOTD *out) {
+    if (!out) return 0;
+    ensure_day_loaded();
+    if (!g_day_has_q) return 0;
+    *out = g_day_q;
+    return 1;
+}
+
+/* 함수 목적: 사용자가 오늘의 qotd 를 이미 풀었는지 확인하는 함수
+ * 매개변수: username
+ * 반환 값: 풀었으면 1
+ */
+int qotd_solved_today(const char *username) {
+    if (!username) return 0;
+    ensure_day_loaded();
+    for (int i = 0; i < g_day_solved_count; ++i) {
+        if (g_day_solved[i] && strcmp(g_day_solved[i], username) == 0) return 1;
+    }
     return 0;
 }
 
 /* Mark today's QOTD as solved by appending a record in data/qotd.csv
  * Format: date|username|qotdname|solved\n
  */
-/* 함수 목적: qotd 해결했는지 여부를 확인하는 함수
+/* 함수 목적: qotd 를 해결한 것으로 기록하는 함수 (파일과 오늘의 푼 사람 목록 모두)
  * 매개변수: username
- * 반환 값: qotd 해결했는지 여부
+ * 반환 값: 성공 여부
  */
 int qotd_mark_solved(const char *username) {
     if (!username) return 0;
     QOTD q = {0};
     if (!qotd_get_today(&q)) return 0;
     if (!qotd_ensure_storage()) return 0;
-    csv_ensure_dir("data");
-    FILE *fp = fopen("data/qotd.csv", "a");
-    if (!fp) return 0;
-    fprintf(fp, "%s|%s|%s|solved\n", q.date[0] ? q.date : "", username, q.name);
-    fclose(fp);
+    if (!csv_append_row("data/qotd.csv", "%s|%s|%s|solved", q.date[0] ? q.date : "", username, q.name)) return 0;
+    if (!qotd_solved_today(username)) {
+        char **n = realloc(g_day_solved, sizeof(char *) * (size_t)(g_day_solved_count + 1));
+        if (n) {
+            g_day_solved = n;
+            g_day_solved[g_day_solved_count] = strdup(username);
+            if (g_day_solved[g_day_solved_count]) g_day_solved_count++;
+        }
+    }
     return 1;
 }
@@ -5,18 +5,61 @@
 #include "../../include/domain/shop.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "../../include/domain/account.h"
 #include "../../include/domain/user.h"
 #include "../../include/ui/tui_student.h"
 #include "../../include/core/csv.h"
+#include "../../include/domain/state.h"
+#include "../../include/domain/valuation.h"
 #include <time.h>
 // 최대 상점 아이템 수
 static Shop g_shop;
 // 시드 초기화 여부
 static int g_shop_seeded = 0;
 
+static Item *find_store_item(const char *name);
+
+/* 함수 목적: 스냅샷에 저장된 상점 재고/판매량/수입을 복원한다.
+ *           items.csv 가 스냅샷 이후 바뀌었으면 파일 값을 그대로 쓴다.
+ * 매개변수: 없음
+ * 반환 값: 복원했으면 1
+ */
+static int shop_restore_snapshot(void) {
+    const SnapReader *snap = state_snapshot();
+    SnapCursor c;
+    if (!snap || !snap_section(snap, STATE_SEC_SHOP, &c)) return 0;
+    int64_t src_size = snap_get_i64(&c);
+    if (!snap_file_unchanged("data/items.csv", src_size, snap->created)) return 0;
+    int income = snap_get_i32(&c);
+    uint32_t n = snap_get_u32(&c);
+    int stock[50];
+    int sales[50];
+    int seen[50] = {0};
+    for (uint32_t k = 0; k < n && !c.bad; ++k) {
+        char name[64];
+        snap_get_str(&c, name, sizeof(name));
+        int st = snap_get_i32(&c);
+        int sl = snap_get_i32(&c);
+        Item *item = find_store_item(name);
+        if (!item) continue;
+        int i = (int)(item - g_shop.items);
+        stock[i] = st;
+        sales[i] = sl;
+        seen[i] = 1;
+    }
+    if (c.bad) return 0;
+    for (int i = 0; i < g_shop.item_count; ++i) {
+        if (!seen[i]) continue;
+        g_shop.items[i].stock = stock[i];
+        g_shop.sales[i] = sales[i];
+    }
+    g_shop.income = income;
+    return 1;
+}
+
 /* 함수 목적: 기본 설정 초기화
  * 매개변수: 없음
  * 반환 값: 없음
@@ -29,6 +72,7 @@ static void ensure_seeded(void) {
     memset(&g_shop, 0, sizeof(g_shop));
     snprintf(g_shop.name, sizeof(g_shop.name), "%s", "Class");
 
+    csv_flush_path("data/items.csv");
     FILE *fp = fopen("data/items.csv", "r");
     if (!fp) {
         g_shop.item_count = 0;
@@ -63,6 +107,26 @@ static void ensure_seeded(void) {
     fclose(fp);
     g_shop.item_count = idx;
     g_shop_seeded = 1;
+    shop_restore_snapshot();
+}
+
+/* 함수 목적: 상점 재고와 판매 현황을 스냅샷 섹션으로 기록한다.
+ * 매개변수: w
+ * 반환 값: 성공 여부
+ */
+int shop_snapshot_write(SnapWriter *w) {
+    ensure_seeded();
+    if (!snap_writer_begin(w, STATE_SEC_SHOP)) return 0;
+    snap_put_i64(w, snap_file_size("data/items.csv"));
+    snap_put_i32(w, g_shop.income);
+    snap_put_u32(w, (uint32_t)g_shop.item_count);
+    for (int i = 0; i < g_shop.item_count; ++i) {
+        snap_put_str(w, g_shop.items[i].name);
+        snap_put_i32(w, g_shop.items[i].stock);
+        snap_put_i32(w, g_shop.sales[i]);
+    }
+    snap_writer_end(w);
+    return !w->failed;
 }
 
 /* 함수 목적: 상점에서 아이템을 찾는다.
@@ -86,9 +150,13 @@ static Item *find_user_item(User *user, const char *name) {
     if (!user) {
         return NULL;
     }
-    for (int i = 0; i < (int)(sizeof(user->items) / sizeof(user->items[0])); ++i) {
-        if (user->items[i].stock > 0 && strncmp(user->items[i].name, name, sizeof(user->items[i].name)) == 0) {
-            return &user->items[i];
+    Item *items = user_items_peek(user);
+    if (!items) {
+        return NULL;
+    }
+    for (int i = 0; i < USER_ITEM_SLOTS; ++i) {
+        if (items[i].stock > 0 && strncmp(items[i].name, name, sizeof(items[i].name)) == 0) {
+            return &items[i];
         }
     }
     return NULL;
@@ -103,11 +171,15 @@ static Item *find_or_create_user_item(User *user, const char *name) {
     if (item) {
         return item;
     }
-    for (int i = 0; i < (int)(sizeof(user->items) / sizeof(user->items[0])); ++i) {
-        if (user->items[i].stock == 0) {
-            snprintf(user->items[i].name, sizeof(user->items[i].name), "%s", name);
-            user->items[i].cost = 0;
-            return &user->items[i];
+    Item *items = user_items(user);
+    if (!items) {
+        return NULL;
+    }
+    for (int i = 0; i < USER_ITEM_SLOTS; ++i) {
+        if (items[i].stock == 0) {
+            snprintf(items[i].name, sizeof(items[i].name), "%s", name);
+            items[i].cost = 0;
+            return &items[i];
         }
     }
     return NULL;
@@ -152,27 +224,12 @@ int shop_buy(const char *username, const Item *item, int qty) {
     if (user->bank.cash < total_cost) {
         return 0;
     }
-    /* decrease user's cash and append tx CSV (reason = item name) */
-    {
-        /* sanitize reason similar to account_add_tx */
-        char reason_safe[128] = "";
-        if (store_item->name && store_item->name[0]) {
-            snprintf(reason_safe, sizeof(reason_safe), "%s", store_item->name);
-            for (size_t i = 0; i < sizeof(reason_safe); ++i) {
-                if (reason_safe[i] == ',' || reason_safe[i] == '\n' || reason_safe[i] == '\r') reason_safe[i] = ' ';
-                if (reason_safe[i] == '\0') break;
-            }
-        }
-        user->bank.cash -= total_cost;
-        /* append CSV row: ts,reason,amount,balance (balance == deposit balance unchanged) */
-        csv_ensure_dir("data");
-        csv_ensure_dir("data/txs");
-        char path[512];
-        snprintf(path, sizeof(path), "data/txs/%s.csv", user->name);
-        csv_append_row(path, "%ld,%s,%+d,%d", (long)time(NULL), reason_safe[0] ? reason_safe : "", -total_cost, user->bank.balance);
-        /* persist accounts.csv so cash change is saved */
-        user_update_balance(user->name, user->bank.balance);
+    /* decrease user's cash and record the spend (reason = item name) */
+    if (!account_spend_cash(user, total_cost, store_item->name)) {
+        return 0;
     }
+    /* persist the account slot so cash change is saved */
+    user_update_balance(user->name, user->bank.balance);
     if (store_item->stock >= 0) {
         store_item->stock -= qty;
     }
@@ -184,6 +241,7 @@ int shop_buy(const char *username, const Item *item, int qty) {
     }
     owned->stock += qty;
     owned->cost = store_item->cost;
+    valuation_touch(user);
     g_shop.income += total_cost;
     for (int i = 0; i < g_shop.item_count; ++i) {
         if (&g_shop.items[i] == store_item) {
@@ -227,40 +285,44 @@ int shop_sell(const char *username, const Item *item, int qty) {
     if (store_item->stock >= 0) {
         store_item->stock += qty;
     }
+    valuation_touch(user);
     return 1;
 }
 
 
 #define ITEMS_CSV_PATH "data/items.csv"
-#define ITEMS_TMP_PATH "data/items.tmp"
 #define MAX_LINE 256
 #define MAX_NAME 64
 
 /* 함수 목적: 상점에서 주식 재고를 1 감소시키고 csv 에 저장한다.
+ *           새 내용은 메모리에 만들고, 파일 교체(임시 파일 + rename)는 쓰기 스레드가 한다.
  * 매개변수: item_name
  * 반환 값: 성공 여부
  */
 bool shop_decrease_stock_csv(const char *item_name) {
+    csv_flush_path(ITEMS_CSV_PATH); /* 아직 큐에 있는 교체가 있으면 그 결과를 읽는다 */
     FILE *fp = fopen(ITEMS_CSV_PATH, "r");
     if (!fp) {
         return false;
     }
 
-    FILE *tmp = fopen(ITEMS_TMP_PATH, "w");
-    if (!tmp) {
-        fclose(fp);
-        return false;
-    }
-
     char line[MAX_LINE];
     char name[MAX_NAME];
     int qty, price;
     int found = 0;
+    size_t cap = 4096, len = 0;
+    char *buf = malloc(cap);
+    if (!buf) {
+        fclose(fp);
+        return false;
+    }
 
     while (fgets(line, sizeof(line), fp)) {
         // name,quantity,price 형식이라고 가정
         // 이름에 공백 없는 경우: "%63[^,],%d,%d"
         // 공백 있는 이름이면 CSV 규칙 더 꼼꼼히 처리해야 함
+        char out[MAX_LINE + MAX_NAME];
+        int n;
         if (sscanf(line, "%63[^,],%d,%d", name, &qty, &price) == 3) {
             if (strcmp(name, item_name) == 0) {
                 if (qty > 0) {
@@ -268,29 +330,34 @@ bool shop_decrease_stock_csv(const char *item_name) {
                 }
                 found = 1;
             }
-            fprintf(tmp, "%s,%d,%d\n", name, qty, price);
+            n = snprintf(out, sizeof(out), "%s,%d,%d\n", name, qty, price);
         } else {
             // 파싱 실패한 라인은 원본 그대로 복사
-            fputs(line, tmp);
+            n = snprintf(out, sizeof(out), "%s", line);
+        }
+        if (n < 0) continue;
+        if (len + (size_t)n > cap) {
+            char *grown = realloc(buf, cap * 2);
+            if (!grown) {
+                free(buf);
+                fclose(fp);
+                return false;
+            }
+            buf = grown;
+            cap *= 2;
         }
+        memcpy(buf + len, out, (size_t)n);
+        len += (size_t)n;
     }
-
     fclose(fp);
-    fclose(tmp);
 
     if (!found) {
         // 해당 아이템 못 찾았으면 롤백할지 말지는 선택사항
         // 여기선 그냥 파일 교체는 진행
     }
 
-    // 원본 덮어쓰기
-    if (remove(ITEMS_CSV_PATH) != 0) {
-        // 실패하면 tmp 남겨두고 false 리턴
-        return false;
-    }
-    if (rename(ITEMS_TMP_PATH, ITEMS_CSV_PATH) != 0) {
-        return false;
-    }
-
-    return true;
+    // 원본 덮어쓰기 (쓰기 스레드에서 임시 파일에 쓰고 rename)
+    int ok = csv_write_file(ITEMS_CSV_PATH, buf, len);
+    free(buf);
+    return ok != 0;
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+ * 파일 목적: 전체 상태 스냅샷(data/state.snap) 체크포인트와 부팅 시 복원 관리
+ * 작성자: 이현준
+ */
+#include "../../include/domain/state.h"
+
+#include <time.h>
+
+#include "../../include/core/csv.h"
+#include "../../include/domain/shop.h"
+#include "../../include/domain/stock.h"
+#include "../../include/domain/user.h"
+
+static SnapReader g_boot_snap;
+/* 0: 아직 열어 보지 않음, 1: 사용 가능, -1: 없거나 깨짐 */
+static int g_boot_state = 0;
+
+/* 함수 목적: 부팅 시점의 스냅샷을 돌려줍니다. 처음 호출할 때 한 번만 매핑합니다.
+ *           체크포인트로 파일이 교체되어도 이 매핑은 부팅 시점의 내용을 유지합니다.
+ * 매개변수: 없음
+ * 반환 값: 스냅샷 읽기 핸들, 없으면 NULL
+ */
+const SnapReader *state_snapshot(void) {
+    if (g_boot_state == 0) {
+        g_boot_state = snap_open(&g_boot_snap, STATE_SNAPSHOT_PATH) ? 1 : -1;
+    }
+    return g_boot_state > 0 ? &g_boot_snap : NULL;
+}
+
+/* 함수 목적: 사용자/계좌/보유 주식/인벤토리/미션 완료, 상점 재고를
+ *           하나의 스냅샷으로 기록합니다. 원본 파일의 크기를 함께 남겨 다음 부팅 때
+ *           그 뒤로 바뀐 파일만 다시 읽게 합니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+int state_checkpoint(void) {
+    /* 각 모듈을 먼저 불러 둔 뒤 쓰기를 모두 반영해야 원본 파일 크기가 정확하다 */
+    user_count();
+    user_ledger_checkpoint();
+    csv_flush_all();
+    int64_t created = (int64_t)time(NULL);
+
+    SnapWriter w;
+    snap_writer_init(&w);
+    int ok = user_snapshot_write(&w) && shop_snapshot_write(&w);
+    if (ok) {
+        csv_ensure_dir("data");
+        ok = snap_writer_commit(&w, STATE_SNAPSHOT_PATH, created);
+    }
+    snap_writer_free(&w);
+    return ok;
+}
+
+/* 함수 목적: 부팅 스냅샷 매핑을 해제합니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void state_release(void) {
+    if (g_boot_state > 0) snap_close(&g_boot_snap);
+    g_boot_state = 0;
+}
@@ -10,23 +10,99 @@
 
 #include "../../include/domain/account.h"
 #include "../../include/domain/user.h"
+#include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
+#include "../../include/core/order_book.h"
+#include "../../include/core/series.h"
+#include "../../include/domain/indicators.h"
+#include "../../include/domain/state.h"
+#include "../../include/domain/valuation.h"
 #include <time.h>
 #include <stdlib.h>
-
-#define MAX_STOCKS 16
-#define STOCK_STEP_SECONDS 600
-// 최대 거래 내역 개수
-static Stock g_stocks[MAX_STOCKS];
+#include <stdatomic.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+
+#define STOCKS_CSV_PATH "data/stocks.csv"
+#define MARKET_CSV_PATH "data/market.csv"
+#define STOCK_TICKS_CSV_PATH "data/stock_ticks.csv"
+#define STOCK_PARAMS_CSV_PATH "data/stock_params.csv"
+#define ORDERS_CSV_PATH "data/orders.csv"
+// 등록된 주식 (개수 제한 없음, 불러올 때만 늘어난다)
+static Stock *g_stocks      = NULL;
 // 현재 등록된 주식 수
 static int   g_stock_count  = 0;
+// 종목별 배열들이 잡아 둔 칸 수
+static int   g_stock_cap    = 0;
 // 시드 초기화 여부
 static int   g_seeded       = 0;
-// 마지막으로 시간 기반 업데이트가 적용된 시간
+// 시장 시계의 기준 시각: 이때 첫 가격이 공개되고 STOCK_STEP_SECONDS 마다 한 칸씩 열린다
 static time_t g_start_time   = 0;
-// 누적 적용된 시간 단위 (몇 시간치 업데이트가 적용되었는지)
-static int    g_applied_hours = 0;
-// 현재 화면에 보이는 주식 개수
-static int    g_visible_len[MAX_STOCKS];
+// 마지막으로 반영한 시장 단계 (-1 이면 아직 반영 전)
+static long   g_applied_step = -1;
+// 종목별로 지금 공개된 가격 개수
+static int   *g_visible_len = NULL;
+
+/* 종목별 전체 가격 시계열: stocks.csv 의 대본 가격 뒤로 생성한 틱이 이어진다.
+ * 인덱스가 곧 시장 단계이고, 값은 core/series 의 압축 블록에 들어 있다.
+ */
+typedef struct StockSeries {
+    Series px;
+    long script_len;
+} StockSeries;
+static StockSeries *g_series = NULL;
+
+/* 종목별 체결 기록: 거래가 있었던 가격 단계마다 한 칸씩 (단계, 수량, 대금) 을 모은다.
+ * 거래는 늘 지금 공개된 마지막 단계에 쌓이므로 단계 순으로 정렬된 채 자란다.
+ * 실행 중에만 두고 저장하지 않는다.
+ */
+typedef struct TradeTape {
+    long *step;
+    long long *qty;
+    long long *notional;
+    int count;
+    int cap;
+} TradeTape;
+static TradeTape *g_tape = NULL;
+
+/* 가격 생성기 매개변수. 한 틱에 모든 종목을 한 번에 훑도록 종목별 배열로 둔다. */
+static double   *g_drift     = NULL; // 틱당 로그 수익률 평균
+static double   *g_vol       = NULL; // 틱당 로그 수익률 표준편차
+static double   *g_jump_prob = NULL; // 틱당 뉴스 충격 확률
+static double   *g_jump_mean = NULL;
+static double   *g_jump_vol  = NULL;
+static uint64_t *g_sym_key   = NULL; // 종목 이름 해시: 난수가 종목 순서에 묶이지 않게 한다
+static uint64_t g_market_seed = 0;
+// 종목별 배당률 (한 번 지급할 때 주가 대비 비율)
+static double   *g_div_yield = NULL;
+// 마지막 배당 기준 시각 (data/market.csv 에 함께 저장)
+static time_t   g_last_dividend = 0;
+// 틱 파일의 마지막 #symbols 줄이 지금 종목 순서와 같은지
+static int      g_ticks_header_ok = 0;
+
+/* 시세판 스냅샷. 쓰는 쪽(시장 틱)은 세계 잠금 아래 하나뿐이고, 읽는 쪽은 잠금 없이
+ * 빌려 간다. 빌린 판은 읽는 쪽 칸에 빌릴 때의 세대(epoch)를 남기고, 내려간 판은
+ * 내려간 세대와 함께 g_retired 에 두었다가 그보다 앞선 세대의 독자가 없을 때 푼다.
+ */
+typedef struct QuoteReader {
+    atomic_int busy;
+    atomic_ulong epoch;                 // 0 이면 아직 세대를 적는 중
+    _Atomic(const StockQuotes *) snap;
+} QuoteReader;
+
+typedef struct RetiredQuotes {
+    StockQuotes *snap;
+    unsigned long epoch;
+} RetiredQuotes;
+
+static _Atomic(StockQuotes *) g_quotes = NULL;
+static atomic_ulong    g_quote_epoch = 1;
+static atomic_ullong   g_quote_version = 0;
+static QuoteReader     g_quote_readers[STOCK_QUOTE_READERS];
+static RetiredQuotes  *g_retired = NULL;
+static int             g_retired_count = 0;
+static int             g_retired_cap = 0;
 
 /* -------------------------------------------------------------------------- */
 /*  static 함수 선언 (프로토타입)                                             */
@@ -36,6 +112,8 @@ static void          ensure_seeded(void);
 static Stock        *find_stock(const char *symbol);
 static StockHolding *find_holding(User *user, const char *symbol);
 static StockHolding *find_or_create_holding(User *user, const char *symbol);
+static void          orders_restore(void);
+static void          tape_record(int book, int price, int qty);
 
 /* -------------------------------------------------------------------------- */
 /*  static helper 함수 정의                                                   */
@@ -51,22 +129,21 @@ static void user_stock_save_holdings(User *user) {
     char path[256];
     snprintf(path, sizeof(path), "data/stocks/%s.csv", user->name);
 
-    FILE *fp = fopen(path, "w");
-    if (!fp) {
-        // 필요하면 디버그로그:
-        // fprintf(stderr, "failed to open %s\n", path);
-        return;
-    }
-
-    for (int i = 0; i < user->holding_count; ++i) {
-        StockHolding *h = &user->holdings[i];
+    char buf[MAX_HOLDINGS * 80];
+    size_t len = 0;
+    const UserHoldings *held = user_holdings_peek(user);
+    for (int i = 0; held && i < held->count; ++i) {
+        const StockHolding *h = &held->items[i];
         if (h->qty <= 0) {
             continue; // 0 이하는 저장 안 함
         }
-        fprintf(fp, "%s,%d\n", h->symbol, h->qty);
+        int n = snprintf(buf + len, sizeof(buf) - len, "%s,%d\n", h->symbol, h->qty);
+        if (n < 0 || (size_t)n >= sizeof(buf) - len) break;
+        len += (size_t)n;
     }
 
-    fclose(fp);
+    /* 실제 파일 교체는 쓰기 스레드가 한다 */
+    csv_write_file(path, buf, len);
 }
 
 /* 함수 목적: 문자열 앞뒤의 공백을 제거한다.
@@ -102,12 +179,13 @@ static StockHolding *find_holding(User *user, const char *symbol) {
         return NULL;
     }
 
-    for (int i = 0; i < user->holding_count; ++i) {
+    UserHoldings *held = user_holdings_peek(user);
+    for (int i = 0; held && i < held->count; ++i) {
         // 심볼 문자열 비교
-        if (strncmp(user->holdings[i].symbol,
+        if (strncmp(held->items[i].symbol,
                     symbol,
-                    sizeof(user->holdings[i].symbol)) == 0) {
-            return &user->holdings[i];
+                    sizeof(held->items[i].symbol)) == 0) {
+            return &held->items[i];
         }
     }
     return NULL;
@@ -124,105 +202,220 @@ static StockHolding *find_or_create_holding(User *user, const char *symbol) {
         return holding;
     }
 
-    if (user->holding_count >= MAX_HOLDINGS) {
+    UserHoldings *held = user_holdings(user);
+    if (!held || held->count >= MAX_HOLDINGS) {
         return NULL;
     }
 
-    holding = &user->holdings[user->holding_count++];
+    holding = &held->items[held->count++];
     memset(holding, 0, sizeof(*holding));
     snprintf(holding->symbol, sizeof(holding->symbol), "%s", symbol);
     return holding;
 }
 
-/* 함수 목적: 주식 거래를 시행한다.
+/* 함수 목적: 수량이 0 인 보유 칸을 목록에서 뺀다. 검사하며 미리 잡아 둔 칸을
+ *           거래가 거절되었을 때 되돌리는 데 쓴다. 남은 칸의 순서는 그대로 둔다.
+ * 매개변수: user, symbol
+ * 반환 값: 없음
+ */
+static void drop_empty_holding(User *user, const char *symbol) {
+    UserHoldings *held = user_holdings_peek(user);
+    StockHolding *holding = find_holding(user, symbol);
+    if (!held || !holding || holding->qty != 0) return;
+    int i = (int)(holding - held->items);
+    memmove(&held->items[i], &held->items[i + 1], (size_t)(held->count - i - 1) * sizeof(StockHolding));
+    held->count--;
+}
+
+/* 함수 목적: 주식 거래를 시행한다. (한 종목짜리 거래표)
  * 매개변수: username, symbol, qty, is_buy
  * 반환 값: 성공 여부
  */
 int stock_deal(const char *username, const char *symbol, int qty, int is_buy) {
-    ensure_seeded();
-
-    if (!username || !symbol || qty <= 0) {
+    if (!symbol || qty <= 0) {
         return 0;
     }
+    StockLeg leg;
+    snprintf(leg.symbol, sizeof(leg.symbol), "%s", symbol);
+    leg.qty = qty;
+    leg.is_buy = is_buy;
+    return stock_trade_ticket(username, &leg, 1, NULL);
+}
 
-    User *user = user_lookup(username);
-    if (!user) {
+/* 함수 목적: 거래표의 여러 종목을 지금 시세로 한꺼번에 거래한다. 모든 다리를 먼저
+ *           검사해서 하나라도 안 되면 아무것도 바꾸지 않는다. 매도를 먼저 반영해
+ *           그 대금으로 매수하고, 장부에는 다리마다 한 줄씩 한 번에 덧붙이며
+ *           보유 주식 파일은 마지막에 한 번만 쓴다.
+ * 매개변수: username, legs, n, out_net (예금 순변화, NULL 가능)
+ * 반환 값: 성공 여부
+ */
+int stock_trade_ticket(const char *username, const StockLeg *legs, int n, int *out_net) {
+    ensure_seeded();
+    if (out_net) *out_net = 0;
+    if (!username || !legs || n <= 0 || n > STOCK_TICKET_MAX_LEGS) {
         return 0;
     }
 
-    Stock *stock = find_stock(symbol);
-    if (!stock) {
+    User *user = user_lookup(username);
+    if (!user) {
         return 0;
     }
-
-    if (is_buy) {
-        int cost = stock->current_price * qty;
-
-        /* 계좌에서 돈 빼기 (잔액 부족 등으로 실패하면 0 반환 가정) */
-        if (!account_add_tx(user, -cost, symbol)) {
+    /* 보유 주식 파일을 덮어쓰기 전에 기존 보유량을 읽어 둔다 */
+    user_hydrate(user);
+
+    /* 1) 검사: 종목, 금액 범위, 매도할 주식, 매수 뒤 잔액
+     *    금액은 long long 으로 센다 (mingw 의 long 은 32비트라 곱셈이 먼저 넘친다) */
+    Stock *stock[STOCK_TICKET_MAX_LEGS];
+    long long net = 0, gross = 0, sells = 0;
+    for (int i = 0; i < n; ++i) {
+        stock[i] = find_stock(legs[i].symbol);
+        if (!stock[i] || legs[i].qty <= 0) {
             return 0;
         }
-
-        StockHolding *holding = find_or_create_holding(user, symbol);
-        if (!holding) {
-            /* 홀딩 생성 실패 시, 돈 되돌리기 */
-            account_add_tx(user, cost, "STOCK_REFUND");
+        long long amount = (long long)stock[i]->current_price * legs[i].qty;
+        gross += amount;
+        if (amount > INT_MAX || gross > INT_MAX) {
             return 0;
         }
-        holding->qty += qty;
-    } else {
-        StockHolding *holding = find_holding(user, symbol);
-        if (!holding || holding->qty < qty) {
+        net += legs[i].is_buy ? -amount : amount;
+        if (legs[i].is_buy) {
+            continue;
+        }
+        sells += amount;
+        /* 같은 종목의 매도 다리는 합쳐서 본다 (같은 거래표의 매수분으로는 팔 수 없다) */
+        long long selling = 0;
+        for (int j = 0; j < n; ++j) {
+            if (!legs[j].is_buy && stock[j] == stock[i]) selling += legs[j].qty;
+        }
+        StockHolding *holding = find_holding(user, stock[i]->name);
+        if (!holding || holding->qty < selling) {
             return 0;
         }
-        holding->qty -= qty;
+    }
+    /* 반영은 매도부터 하므로 매도만 더한 중간 잔액도 int 안에 있어야 한다 */
+    if ((long long)user->bank.balance + net < 0 || (long long)user->bank.balance + sells > INT_MAX) {
+        return 0;
+    }
+    /* 매수로 새로 필요한 보유 칸 수를 세어, 칸이 모자라면 아무것도 만들기 전에 거절한다.
+     * 여기를 지나면 반영 중의 find_or_create_holding 은 실패하지 않는다. */
+    int new_slots = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!legs[i].is_buy || find_holding(user, stock[i]->name)) continue;
+        int first = 1;
+        for (int j = 0; j < i; ++j) {
+            if (legs[j].is_buy && stock[j] == stock[i]) first = 0;
+        }
+        new_slots += first;
+    }
+    if (new_slots > 0) {
+        const UserHoldings *held = user_holdings(user);
+        if (!held || held->count + new_slots > MAX_HOLDINGS) {
+            return 0;
+        }
+    }
 
-        int revenue = stock->current_price * qty;
-        account_add_tx(user, revenue, "STOCK_SELL");
+    /* 2) 반영: 매도 다리, 매수 다리 순서로 잔액을 바꾸고 장부 레코드를 채운다 */
+    LedgerEntry entries[STOCK_TICKET_MAX_LEGS];
+    int count = 0;
+    long now = (long)time(NULL);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < n; ++i) {
+            int buy = legs[i].is_buy;
+            if (buy != pass) continue;
+            int amount = stock[i]->current_price * legs[i].qty;
+            StockHolding *holding = find_or_create_holding(user, stock[i]->name);
+            holding->qty += buy ? legs[i].qty : -legs[i].qty;
+            user->bank.balance += buy ? -amount : amount;
+            valuation_position(user->id, (int)(stock[i] - g_stocks), buy ? legs[i].qty : -legs[i].qty);
+            tape_record((int)(stock[i] - g_stocks), stock[i]->current_price, legs[i].qty);
+
+            LedgerEntry *e = &entries[count++];
+            memset(e, 0, sizeof(*e));
+            e->ts = now;
+            e->type = LEDGER_ADJUST;
+            snprintf(e->user, sizeof(e->user), "%s", user->name);
+            e->amount = buy ? -amount : amount;
+            e->balance = user->bank.balance;
+            e->cash = user->bank.cash;
+            e->loan = user->bank.loan;
+            snprintf(e->reason, sizeof(e->reason), "%s", buy ? stock[i]->name : "STOCK_SELL");
+        }
     }
+    account_post_batch(entries, (size_t)count);
 
     /* 🔹 거래 성공했으니까 CSV에 현재 보유량 덤프 */
     user_stock_save_holdings(user);
 
+    if (out_net) *out_net = (int)net;
     return 1;
 }
 
 
 
+/* 함수 목적: 배열 하나를 n 칸으로 늘린다. 늘어난 칸은 0 으로 채운다.
+ * 매개변수: arr, elem (칸 크기), old_n, n
+ * 반환 값: 성공 여부
+ */
+static int grow_array(void **arr, size_t elem, int old_n, int n) {
+    void *p = realloc(*arr, (size_t)n * elem);
+    if (!p) return 0;
+    memset((char *)p + (size_t)old_n * elem, 0, (size_t)(n - old_n) * elem);
+    *arr = p;
+    return 1;
+}
+
+/* 함수 목적: 종목별 배열들이 n 종목을 담을 수 있게 함께 늘린다. 칸 수는 두 배씩 늘린다.
+ * 매개변수: n
+ * 반환 값: 성공 여부
+ */
+static int stocks_reserve(int n) {
+    if (n <= g_stock_cap) return 1;
+    int cap = g_stock_cap ? g_stock_cap * 2 : 16;
+    while (cap < n) cap *= 2;
+    int old = g_stock_cap;
+    int ok = grow_array((void **)&g_stocks, sizeof(Stock), old, cap) &&
+             grow_array((void **)&g_visible_len, sizeof(int), old, cap) &&
+             grow_array((void **)&g_series, sizeof(StockSeries), old, cap) &&
+             grow_array((void **)&g_tape, sizeof(TradeTape), old, cap) &&
+             grow_array((void **)&g_drift, sizeof(double), old, cap) &&
+             grow_array((void **)&g_vol, sizeof(double), old, cap) &&
+             grow_array((void **)&g_jump_prob, sizeof(double), old, cap) &&
+             grow_array((void **)&g_jump_mean, sizeof(double), old, cap) &&
+             grow_array((void **)&g_jump_vol, sizeof(double), old, cap) &&
+             grow_array((void **)&g_sym_key, sizeof(uint64_t), old, cap) &&
+             grow_array((void **)&g_div_yield, sizeof(double), old, cap);
+    /* 일부만 늘었어도 앞쪽 칸은 그대로라 다음 호출에서 다시 늘리면 된다 */
+    if (ok) g_stock_cap = cap;
+    return ok;
+}
+
 /* 함수 목적: 주식 정보를 csv 파일에서 불러온다.
  * 매개변수: path
  * 반환 값: 없음
  */
 static void stock_load_from_csv(const char *path) {
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, path, ',')) {
         return;
     }
 
-    char line[512];
-
     /* 1줄째: 시간일 수도 있고 아닐 수도 있음 */
-    if (!fgets(line, sizeof(line), fp)) {
-        fclose(fp);
+    if (!csv_cursor_next_row(&cur)) {
+        csv_cursor_close(&cur);
         return;
     }
 
-    /* 줄 끝의 개행 제거 */
-    size_t len_line = strlen(line);
-    while (len_line > 0 &&
-           (line[len_line - 1] == '\n' || line[len_line - 1] == '\r')) {
-        line[--len_line] = '\0';
-    }
-
     /* 앞쪽 공백 스킵 */
-    char *p = line;
-    while (*p == ' ' || *p == '\t') {
-        ++p;
-    }
+    CsvField first = csv_field_trim(cur.row);
 
     /* ---------- 1단계: YYYYMMDDHHMMSS (14자리) 포맷 시도 ---------- */
     char digits[32] = {0};
-    if (sscanf(p, "%14[0-9]", digits) == 1 && strlen(digits) == 14) {
+    size_t nd = 0;
+    while (nd < first.len && nd < 14 && first.ptr[nd] >= '0' && first.ptr[nd] <= '9') {
+        digits[nd] = first.ptr[nd];
+        nd++;
+    }
+    if (nd == 14) {
         int year, mon, day, hour, min, sec;
 
         char buf_year[5] = {0};
@@ -261,75 +454,65 @@ static void stock_load_from_csv(const char *path) {
         }
     }
 
-    memset(g_stocks, 0, sizeof(g_stocks));
+    for (int i = 0; i < g_stock_count; ++i) {
+        series_free(&g_series[i].px);
+        g_tape[i].count = 0;
+    }
     g_stock_count = 0;
+    indicators_reset();
 
-    /* 실제 종목 라인들 파싱 */
-    while (fgets(line, sizeof(line), fp)) {
-        if (line[0] == '\n' || line[0] == '\r' || line[0] == '#') {
+    /* 실제 종목 라인들 파싱 (빈 줄은 커서가 건너뜀) */
+    while (csv_cursor_next_row(&cur)) {
+        if (cur.row.ptr[0] == '#') {
             continue;
         }
 
-        if (g_stock_count >= MAX_STOCKS) {
+        if (!stocks_reserve(g_stock_count + 1)) {
             break;
         }
 
-        /* 개행 제거 */
-        size_t l = strlen(line);
-        while (l > 0 && (line[l - 1] == '\n' || line[l - 1] == '\r')) {
-            line[--l] = '\0';
-        }
-
         /* 형식: name,news,price1,price2,... */
+        CsvField name;
+        if (!csv_cursor_next_field(&cur, &name)) continue;
+        name = csv_field_trim(name);
 
-        char *name = strtok(line, ",");
-        if (!name) continue;
-
-        char *news = strtok(NULL, ",");  // 뉴스 문자열 (쉼표 기준)
-
-        /* 공백 정리 (trim_whitespace는 너가 이미 쓰던 함수 재사용) */
-        trim_whitespace(name);
-        if (news) {
-            trim_whitespace(news);
-        } else {
-            news = "";
+        CsvField news = {0};  // 뉴스 문자열 (쉼표 기준)
+        if (csv_cursor_next_field(&cur, &news)) {
+            news = csv_field_trim(news);
         }
 
         Stock *s = &g_stocks[g_stock_count];
         memset(s, 0, sizeof(*s));
 
-        snprintf(s->name, sizeof(s->name), "%s", name);
+        csv_field_copy(name, s->name, sizeof(s->name));
         s->id = g_stock_count + 1;
 
-        if (news && news[0] != '\0') {
-            snprintf(s->news, sizeof(s->news), "%s", news);
-        } else {
-            snprintf(s->news, sizeof(s->news), "");  // 없으면 빈 문자열
-        }
-
-        /* 나머지 토큰들은 전부 가격 */
-        int idx = 0;
-        char *token = NULL;
-        while ((token = strtok(NULL, ",")) != NULL) {
-            if (idx >= 200) break;
+        csv_field_copy(news, s->news, sizeof(s->news));  // 없으면 빈 문자열
 
-            trim_whitespace(token);
-            if (token[0] == '\0') continue;  // 빈 값 스킵
+        /* 나머지 필드들은 전부 가격 (개수 제한 없음, 전체는 g_series 에) */
+        StockSeries *ser = &g_series[g_stock_count];
+        series_init(&ser->px);
+        CsvField token;
+        while (csv_cursor_next_field(&cur, &token)) {
+            int price = 0;
+            if (!csv_field_int(token, &price)) continue;  // 빈 값 스킵
 
-            s->log[idx++] = atoi(token);
+            if (!series_push(&ser->px, price)) break;
         }
 
-        if (idx == 0) {
+        if (ser->px.len == 0) {
             /* 가격 기록이 없으면 이 종목은 무시 */
             continue;
         }
+        ser->script_len = ser->px.len;
 
-        s->log_len    = idx;          // 전체 시계열 길이
-        s->base_price = s->log[0];
+        int first = series_get(&ser->px, 0);
+        s->log_len    = 1;
+        s->base_price = first;
 
         /* 시간 0 기준: 첫 번째 값이 현재가 */
-        s->current_price  = s->log[0];
-        s->previous_price = s->log[0];
+        s->current_price  = first;
+        s->previous_price = first;
 
         /* 이 종목은 지금 1개까지만 공개된 상태 */
         g_visible_len[g_stock_count] = 1;
@@ -337,7 +520,7 @@ static void stock_load_from_csv(const char *path) {
         g_stock_count++;
     }
 
-    fclose(fp);
+    csv_cursor_close(&cur);
 
     if (g_stock_count == 0) {
         /* 필요하면 여기서 디버그 로그 */
@@ -345,72 +528,451 @@ static void stock_load_from_csv(const char *path) {
 }
 
 
-/* 함수 목적: 걸정을 초기화한다.
+/* 함수 목적: 시각 t 에 해당하는 시장 단계(기준 시각 이후 지난 칸 수)를 구한다.
+ * 매개변수: t
+ * 반환 값: 0 이상의 단계
+ */
+static long market_step_at(time_t t) {
+    if (t <= g_start_time) return 0;
+    return (long)((t - g_start_time) / STOCK_STEP_SECONDS);
+}
+
+/* 함수 목적: 시장 단계에서 종목이 공개한 가격 개수를 구한다. 시계열 끝에서 멈춘다.
+ * 매개변수: i (종목 번호), step
+ * 반환 값: 1 이상 시계열 길이 이하의 길이
+ */
+static int visible_at(int i, long step) {
+    long len = g_series[i].px.len;
+    if (step >= len - 1) return (int)len;
+    return (int)step + 1;
+}
+
+/* 함수 목적: 64비트 값을 고르게 섞는다 (splitmix64 마무리 단계).
+ * 매개변수: x
+ * 반환 값: 섞인 값
+ */
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/* 함수 목적: 64비트 난수를 (0, 1) 구간 실수로 바꾼다.
+ * 매개변수: x
+ * 반환 값: 0 과 1 을 뺀 균등 난수
+ */
+static double unit_draw(uint64_t x) {
+    return ((double)(x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+/* 함수 목적: 종목 이름을 해시한다 (FNV-1a).
+ * 매개변수: name
+ * 반환 값: 해시 값
+ */
+static uint64_t symbol_key(const char *name) {
+    uint64_t h = 1469598103934665603ull;
+    for (const unsigned char *p = (const unsigned char *)name; *p; ++p) {
+        h = (h ^ *p) * 1099511628211ull;
+    }
+    return h;
+}
+
+/* 함수 목적: 대본 가격의 로그 수익률로 종목별 드리프트/변동성을 정하고, 뉴스가 있는
+ *           종목에는 충격 확률을 준다. 드리프트는 로그 수익률의 평균 m 이다 (산술 드리프트
+ *           mu 가 아니므로 생성할 때 -σ²/2 를 또 빼지 않는다). data/stock_params.csv 가 있으면
+ *           "종목,드리프트,변동성,충격확률,충격평균,충격변동성,배당률" 로 덮어쓴다 (빈 칸은 유지).
  * 매개변수: 없음
  * 반환 값: 없음
  */
-static void ensure_seeded(void) {
-    if (g_seeded) return;
+static void market_load_params(void) {
+    for (int i = 0; i < g_stock_count; ++i) {
+        const StockSeries *ser = &g_series[i];
+        double sum = 0.0, sq = 0.0;
+        int n = 0;
+        int chunk[SERIES_BLOCK];
+        int prev = 0;
+        for (long at = 0; at < ser->script_len; at += SERIES_BLOCK) {
+            long got = series_read(&ser->px, at, chunk, SERIES_BLOCK);
+            if (at + got > ser->script_len) got = ser->script_len - at;
+            for (long k = 0; k < got; ++k) {
+                int cur = chunk[k];
+                if (at + k > 0 && prev > 0 && cur > 0) {
+                    double r = log((double)cur / prev);
+                    sum += r;
+                    sq += r * r;
+                    n++;
+                }
+                prev = cur;
+            }
+        }
+        double mu = n > 0 ? sum / n : 0.0;
+        double sigma = n > 1 ? sqrt((sq - sum * mu) / (n - 1)) : 0.02;
+        /* 대본이 급등락 위주여도 생성 구간이 폭주하지 않게 묶어 둔다
+         * (틱이 10분이라 하루 144 틱: 드리프트 0.0001 은 하루 약 1.4%,
+         *  변동성 0.01 은 하루 약 12%. 예전 상한 0.03 은 하루 36% 였다) */
+        if (mu > 0.0001) mu = 0.0001;
+        if (mu < -0.0001) mu = -0.0001;
+        if (!(sigma >= 0.002)) sigma = 0.002;
+        if (sigma > 0.01) sigma = 0.01;
+        g_drift[i] = mu;
+        g_vol[i] = sigma;
+        g_jump_prob[i] = g_stocks[i].news[0] ? 0.01 : 0.0;
+        g_jump_mean[i] = 0.0;
+        g_jump_vol[i] = 0.10;
+        g_sym_key[i] = symbol_key(g_stocks[i].name);
+        g_div_yield[i] = STOCK_DIVIDEND_YIELD;
+    }
 
-    srand((unsigned)time(NULL));       // 🔹 랜덤 시드
-    stock_load_from_csv("data/stocks.csv");
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, STOCK_PARAMS_CSV_PATH, ',')) return;
+    while (csv_cursor_next_row(&cur)) {
+        if (cur.row.ptr[0] == '#') continue;
+        CsvField f[7];
+        int nf = csv_cursor_fields(&cur, f, 7);
+        if (nf < 2) continue;
+        char name[64];
+        csv_field_copy(csv_field_trim(f[0]), name, sizeof(name));
+        Stock *s = find_stock(name);
+        if (!s) continue;
+        int i = (int)(s - g_stocks);
+        double *dst[6] = {&g_drift[i], &g_vol[i], &g_jump_prob[i], &g_jump_mean[i], &g_jump_vol[i], &g_div_yield[i]};
+        for (int k = 1; k < nf; ++k) csv_field_double(f[k], dst[k - 1]);
+    }
+    csv_cursor_close(&cur);
+}
 
-    if (g_start_time == 0) {
-        g_start_time = time(NULL);
+/* 함수 목적: data/stock_ticks.csv 에 남은 생성 틱을 시계열 뒤에 이어 붙인다.
+ *           "#symbols,이름,..." 줄이 열 순서를 정하고, 그 뒤 줄은 "단계,가격,..." 이다.
+ *           빈 칸은 그 단계에 아직 대본이 남아 있던 종목이다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void market_load_ticks(void) {
+    g_ticks_header_ok = 0;
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, STOCK_TICKS_CSV_PATH, ',')) return;
+    int *cols = NULL;
+    int ncols = 0, cols_cap = 0;
+    while (csv_cursor_next_row(&cur)) {
+        CsvField f;
+        if (!csv_cursor_next_field(&cur, &f)) continue;
+        if (csv_field_eq(f, "#symbols")) {
+            ncols = 0;
+            g_ticks_header_ok = 1;
+            while (csv_cursor_next_field(&cur, &f)) {
+                if (ncols == cols_cap) {
+                    int cap = cols_cap ? cols_cap * 2 : 16;
+                    int *grown = realloc(cols, (size_t)cap * sizeof(int));
+                    if (!grown) break;
+                    cols = grown;
+                    cols_cap = cap;
+                }
+                char name[64];
+                csv_field_copy(csv_field_trim(f), name, sizeof(name));
+                Stock *s = find_stock(name);
+                cols[ncols] = s ? (int)(s - g_stocks) : -1;
+                g_ticks_header_ok = g_ticks_header_ok && cols[ncols] == ncols;
+                ncols++;
+            }
+            g_ticks_header_ok = g_ticks_header_ok && ncols == g_stock_count;
+            continue;
+        }
+        long step = 0;
+        if (f.len == 0 || f.ptr[0] == '#' || !csv_field_long(f, &step)) continue;
+        for (int j = 0; j < ncols && csv_cursor_next_field(&cur, &f); ++j) {
+            int i = cols[j];
+            int price = 0;
+            if (i < 0 || !csv_field_int(f, &price)) continue;
+            StockSeries *ser = &g_series[i];
+            /* 끊기거나 겹친 줄은 버린다: 같은 씨앗으로 다시 만들면 같은 값이 나온다 */
+            if (ser->px.len == step && step >= ser->script_len) series_push(&ser->px, price);
+        }
     }
-    g_applied_hours = 0;
+    csv_cursor_close(&cur);
+    free(cols);
+}
 
-    g_seeded = 1;
+/* 함수 목적: 모든 종목의 시계열이 step 까지 닿도록 가격을 만든다. 한 틱마다 종목 전체를
+ *           한 번 훑는 기하 랜덤 워크이고, 난수는 (씨앗, 종목, 단계) 로 정해지므로 같은 씨앗이면
+ *           언제 만들어도 같은 가격이 나온다. 만든 틱은 한 번에 틱 파일 뒤에 붙인다.
+ * 매개변수: step
+ * 반환 값: 없음
+ */
+static void market_generate_until(long step) {
+    long from = LONG_MAX;
+    for (int i = 0; i < g_stock_count; ++i) {
+        if (g_series[i].px.len < from) from = g_series[i].px.len;
+    }
+    if (g_stock_count == 0 || from > step) return;
+
+    size_t cap = (size_t)g_stock_count * (sizeof(g_stocks[0].name) + 1) + 4096, len = 0;
+    char *out = malloc(cap);
+    if (out && !g_ticks_header_ok) {
+        len += (size_t)snprintf(out, cap, "#symbols");
+        for (int i = 0; i < g_stock_count; ++i) {
+            len += (size_t)snprintf(out + len, cap - len, ",%s", g_stocks[i].name);
+        }
+        out[len++] = '\n';
+        g_ticks_header_ok = 1;
+    }
+
+    for (long k = from; k <= step; ++k) {
+        if (out && cap - len < (size_t)g_stock_count * 12 + 24) {
+            char *grown = realloc(out, cap * 2);
+            if (grown) {
+                out = grown;
+                cap *= 2;
+            } else {
+                free(out);
+                out = NULL;
+            }
+        }
+        if (out) len += (size_t)snprintf(out + len, cap - len, "%ld", k);
+        for (int i = 0; i < g_stock_count; ++i) {
+            StockSeries *ser = &g_series[i];
+            if (ser->px.len != k) {
+                if (out) out[len++] = ',';
+                continue;
+            }
+            uint64_t h = mix64(g_market_seed ^ mix64(g_sym_key[i] + (uint64_t)k));
+            double u1 = unit_draw(h);
+            double u2 = unit_draw(mix64(h));
+            double u3 = unit_draw(mix64(h ^ 0x5851F42D4C957F2Dull));
+            double radius = sqrt(-2.0 * log(u1));
+            double z = radius * cos(2.0 * M_PI * u2);
+            /* p' = p·exp(m + σz). m 이 이미 로그 수익률 평균(= mu - σ²/2)이므로 -σ²/2 를
+             * 또 빼면 두 번 빼는 셈이 되어 중앙값이 틱마다 σ²/2 씩 가라앉는다 */
+            double r = g_drift[i] + g_vol[i] * z;
+            if (u3 < g_jump_prob[i]) {
+                r += g_jump_mean[i] + g_jump_vol[i] * radius * sin(2.0 * M_PI * u2);
+            }
+            double next = (double)ser->px.last * exp(r);
+            int price = next < 1.0 ? 1 : next > INT_MAX / 4 ? INT_MAX / 4 : (int)llround(next);
+            if (!series_push(&ser->px, price)) {
+                if (out) out[len++] = ',';
+                continue;
+            }
+            if (out) len += (size_t)snprintf(out + len, cap - len, ",%d", price);
+        }
+        if (out) out[len++] = '\n';
+    }
+
+    if (out) {
+        csv_ensure_dir("data");
+        csv_append_raw(STOCK_TICKS_CSV_PATH, out, len);
+        free(out);
+    }
 }
 
-/* 함수 목적: 시간 경과에 따라 주식 정보를 업데이트한다.
+/* 함수 목적: 내려간 시세판 중 지금 빌려 간 독자가 없는 것을 푼다.
+ *           독자 칸의 세대보다 앞서 내려간 판만 풀 수 있다.
  * 매개변수: 없음
  * 반환 값: 없음
  */
-void stock_maybe_update_by_time(void) {
-    ensure_seeded();
+static void quotes_reclaim(void) {
+    unsigned long oldest = ULONG_MAX;
+    for (int r = 0; r < STOCK_QUOTE_READERS; ++r) {
+        QuoteReader *rd = &g_quote_readers[r];
+        if (!atomic_load(&rd->busy)) continue;
+        unsigned long e = atomic_load(&rd->epoch);
+        if (e == 0) return;  // 칸을 잡고 세대를 적기 직전: 이번에는 아무것도 풀지 않는다
+        if (e < oldest) oldest = e;
+    }
+    int kept = 0;
+    for (int i = 0; i < g_retired_count; ++i) {
+        if (g_retired[i].epoch < oldest) {
+            free(g_retired[i].snap);
+        } else {
+            g_retired[kept++] = g_retired[i];
+        }
+    }
+    g_retired_count = kept;
+}
 
-    time_t now = time(NULL);
-    if (g_start_time == 0) {
-        g_start_time = now;
+/* 함수 목적: 지금 시세로 새 시세판을 만들어 내건다. 예전 판은 독자가 모두 돌려줄 때까지 남긴다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void quotes_publish(void) {
+    StockQuotes *q = malloc(sizeof(StockQuotes) + (size_t)g_stock_count * sizeof(StockQuote));
+    if (!q) return;  // 예전 판을 계속 보여 준다
+    if (g_retired_count == g_retired_cap) {
+        int cap = g_retired_cap ? g_retired_cap * 2 : 8;
+        RetiredQuotes *grown = realloc(g_retired, (size_t)cap * sizeof(RetiredQuotes));
+        if (!grown) {
+            free(q);
+            return;
+        }
+        g_retired = grown;
+        g_retired_cap = cap;
     }
 
-    double diff = difftime(now, g_start_time);
-    if (diff < 0) diff = 0;
+    q->version = atomic_load(&g_quote_version) + 1;
+    q->count = g_stock_count;
+    for (int i = 0; i < g_stock_count; ++i) {
+        const Stock *s = &g_stocks[i];
+        StockQuote *dst = &q->quotes[i];
+        memcpy(dst->name, s->name, sizeof(dst->name));
+        memcpy(dst->news, s->news, sizeof(dst->news));
+        dst->id = s->id;
+        dst->current_price = s->current_price;
+        dst->previous_price = s->previous_price;
+        dst->visible_len = s->log_len;
+    }
 
-    /* 총 몇 시간이 지났는지 (1시간마다 한 칸씩) */
-    int total_hours = (int)(diff / STOCK_STEP_SECONDS);
+    StockQuotes *old = atomic_exchange(&g_quotes, q);
+    atomic_store(&g_quote_version, q->version);
+    if (old) {
+        g_retired[g_retired_count].snap = old;
+        g_retired[g_retired_count].epoch = atomic_fetch_add(&g_quote_epoch, 1);
+        g_retired_count++;
+    }
+    quotes_reclaim();
+}
 
-    if (total_hours <= g_applied_hours) {
-        return;  // 새로 진행된 시간이 없음
+/* 함수 목적: 모든 종목의 공개 길이와 현재가/직전가를 시장 단계에 맞춘다.
+ *           대본이 끝난 종목은 먼저 그 단계까지 가격을 만든다.
+ * 매개변수: step
+ * 반환 값: 없음
+ */
+static void market_apply_step(long step) {
+    market_generate_until(step);
+    for (int i = 0; i < g_stock_count; ++i) {
+        Stock *s = &g_stocks[i];
+        int visible = visible_at(i, step);
+        int last2[2];
+        g_visible_len[i] = visible;
+        if (visible >= 2) {
+            series_read(&g_series[i].px, visible - 2, last2, 2);
+            s->previous_price = last2[0];
+            s->current_price = last2[1];
+        } else {
+            s->current_price = s->previous_price = series_get(&g_series[i].px, 0);
+        }
+        s->log_len = visible;
+        valuation_price(i, s->current_price);
     }
+    g_applied_step = step;
+    quotes_publish();
+}
 
-    int new_steps = total_hours - g_applied_hours;
-    if (new_steps <= 0) {
-        return;
+/* 함수 목적: data/market.csv 에 저장된 시장 기준 시각, 난수 씨앗, 마지막 배당 시각을 읽는다.
+ * 매개변수: out_start, out_seed, out_dividend (칸이 없으면 0)
+ * 반환 값: 읽었으면 1
+ */
+static int market_load(time_t *out_start, uint64_t *out_seed, time_t *out_dividend) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, MARKET_CSV_PATH, ',')) return 0;
+    int ok = 0;
+    while (!ok && csv_cursor_next_row(&cur)) {
+        if (cur.row.ptr[0] == '#') continue;
+        CsvField f;
+        long start = 0;
+        if (csv_cursor_next_field(&cur, &f) && csv_field_long(f, &start) && start > 0) {
+            long seed = 0, dividend = 0;
+            if (csv_cursor_next_field(&cur, &f)) csv_field_long(f, &seed);
+            if (csv_cursor_next_field(&cur, &f)) csv_field_long(f, &dividend);
+            *out_start = (time_t)start;
+            *out_seed = (uint64_t)seed;
+            *out_dividend = (time_t)dividend;
+            ok = 1;
+        }
     }
+    csv_cursor_close(&cur);
+    return ok;
+}
+
+/* 함수 목적: 시장 기준 시각과 씨앗을 data/market.csv 에 기록해 재시작 뒤에도 같은 시계와
+ *           같은 생성 가격을 쓰게 한다. 마지막 배당 시각도 함께 남긴다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+static int market_save(void) {
+    char buf[128];
+    int len = snprintf(buf, sizeof(buf), "# market_start_epoch,seed,last_dividend_epoch\n%ld,%ld,%ld\n",
+                       (long)g_start_time, (long)g_market_seed, (long)g_last_dividend);
+    csv_ensure_dir("data");
+    return csv_write_file(MARKET_CSV_PATH, buf, (size_t)len);
+}
 
-    g_applied_hours = total_hours;
+/* 함수 목적: 예전 스냅샷의 STCK 섹션에 남은 시장 기준 시각을 읽는다.
+ *           data/market.csv 가 생기기 전에 돌던 시장을 이어 가기 위한 한 번짜리 이전이다.
+ * 매개변수: out
+ * 반환 값: 읽었으면 1
+ */
+static int market_load_legacy_snapshot(time_t *out) {
+    const SnapReader *snap = state_snapshot();
+    SnapCursor c;
+    if (!snap || !snap_section(snap, STATE_SEC_STOCKS, &c)) return 0;
+    snap_get_i64(&c); /* stocks.csv 크기 */
+    int64_t start = snap_get_i64(&c);
+    if (c.bad || start <= 0) return 0;
+    *out = (time_t)start;
+    return 1;
+}
 
-    /* 새로 지난 시간만큼 한 칸씩 앞으로 진행 */
-    for (int step = 0; step < new_steps; ++step) {
-        for (int i = 0; i < g_stock_count; ++i) {
-            Stock *s = &g_stocks[i];
+/* 함수 목적: 종목을 불러오고 시장 시계를 맞춘다. 기준 시각은 stocks.csv 머리줄,
+ *           data/market.csv, 예전 스냅샷, 지금 순으로 정하고 파일에 없으면 새로 남긴다.
+ *           이어서 가격 생성기 매개변수와 지난 생성 틱을 불러온다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void ensure_seeded(void) {
+    if (g_seeded) return;
 
-            int visible = g_visible_len[i];
-            int total   = s->log_len;
+    srand((unsigned)time(NULL));       // 🔹 랜덤 시드
+    stock_load_from_csv(STOCKS_CSV_PATH);
+
+    time_t saved_start = 0;
+    uint64_t saved_seed = 0;
+    time_t saved_dividend = 0;
+    int saved = market_load(&saved_start, &saved_seed, &saved_dividend);
+    if (g_start_time == 0) {
+        if (saved) g_start_time = saved_start;
+        else if (!market_load_legacy_snapshot(&g_start_time)) g_start_time = time(NULL);
+    }
+    /* 씨앗이 따로 없으면 기준 시각에서 정한다 (같은 시장이면 같은 가격) */
+    g_market_seed = saved_seed ? saved_seed : (uint64_t)g_start_time;
+    /* 배당 기록이 없으면 지금부터 센다 (처음 켠 날 바로 지급하지 않는다) */
+    g_last_dividend = saved_dividend > 0 ? saved_dividend : time(NULL);
+    if (!saved || !saved_seed || saved_dividend <= 0) market_save();
 
-            /* 아직 더 보여줄 데이터가 있을 때만 한 칸 확장 */
-            if (visible < total) {
-                visible++;
-                g_visible_len[i] = visible;
+    market_load_params();
+    market_load_ticks();
+    market_apply_step(market_step_at(time(NULL)));
+    orders_restore();
 
-                s->previous_price = s->current_price;
-                s->current_price  = s->log[visible - 1];
-            }
-            /* visible == total 이면 더 이상 늘리지 않고 마지막 값 유지 */
-        }
+    g_seeded = 1;
+}
+
+/* 함수 목적: 시간 경과에 따라 주식 정보를 업데이트한다. 공개 길이는 경과 시간에서
+ *           바로 계산한다. 대본이 끝난 뒤에는 밀린 틱만큼 가격을 만들지만 틱 하나는
+ *           종목 전체를 한 번 훑는 비용이다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+void stock_maybe_update_by_time(void) {
+    ensure_seeded();
+
+    long step = market_step_at(time(NULL));
+    if (step == g_applied_step) {
+        return;  // 새로 진행된 칸이 없음
     }
+    market_apply_step(step);
+}
+
+/* 함수 목적: 시각 t 에 공개되어 있던 종목 가격을 구한다. 아직 만들지 않은 미래 단계는
+ *           시계열의 마지막 값이다. (O(1))
+ * 매개변수: symbol, t
+ * 반환 값: 가격, 종목이 없으면 -1
+ */
+int stock_price_at(const char *symbol, long t) {
+    ensure_seeded();
+    Stock *s = find_stock(symbol);
+    if (!s) return -1;
+    int i = (int)(s - g_stocks);
+    return series_get(&g_series[i].px, visible_at(i, market_step_at((time_t)t)) - 1);
 }
 
 /* 함수 목적: 주식 심볼로 주식 정보를 찾는다.
@@ -428,98 +990,653 @@ static Stock *find_stock(const char *symbol) {
     return NULL;
 }
 
-/* 함수 목적: 주식 정보를 특정 개수만큼 옮겨담는다.
- * 매개변수: out_arr, out_n
- * 반환 값: 성공 여부
+/* 함수 목적: 지금 시세판을 빌린다. 잠금 없이 빈 독자 칸 하나를 잡고, 칸에 지금 세대를
+ *           적은 뒤 판을 읽는다. 돌려줄 때까지 판의 내용은 바뀌지 않는다.
+ * 매개변수: 없음
+ * 반환 값: 시세판, 종목이 없거나 독자 칸이 모두 찼으면 NULL
  */
-int stock_list(Stock *out_arr, int *out_n) {
+const StockQuotes *stock_quotes_acquire(void) {
+    if (!atomic_load(&g_quotes)) ensure_seeded();  // 첫 판은 부팅 때 세계 잠금 아래 만들어진다
+    for (int r = 0; r < STOCK_QUOTE_READERS; ++r) {
+        QuoteReader *rd = &g_quote_readers[r];
+        int expected = 0;
+        if (!atomic_compare_exchange_strong(&rd->busy, &expected, 1)) continue;
+        atomic_store(&rd->epoch, atomic_load(&g_quote_epoch));
+        const StockQuotes *q = atomic_load(&g_quotes);
+        atomic_store(&rd->snap, q);
+        if (!q) {
+            atomic_store(&rd->epoch, 0);
+            atomic_store(&rd->busy, 0);
+        }
+        return q;
+    }
+    return NULL;
+}
+
+/* 함수 목적: 빌린 시세판을 돌려준다. NULL 이면 아무 일도 하지 않는다.
+ *           같은 판을 빌린 칸이 여럿이면 아무 칸이나 하나 비운다. 남은 칸의 세대도
+ *           그 판이 내려간 세대보다 앞서므로 판은 마지막 독자가 돌려줄 때까지 남는다.
+ *           칸은 판 포인터를 CAS 로 비워 두 독자가 같은 칸을 비우지 않게 한다.
+ * 매개변수: q
+ * 반환 값: 없음
+ */
+void stock_quotes_release(const StockQuotes *q) {
+    if (!q) return;
+    for (int r = 0; r < STOCK_QUOTE_READERS; ++r) {
+        QuoteReader *rd = &g_quote_readers[r];
+        const StockQuotes *expected = q;
+        if (atomic_load(&rd->busy) && atomic_compare_exchange_strong(&rd->snap, &expected, NULL)) {
+            atomic_store(&rd->epoch, 0);
+            atomic_store(&rd->busy, 0);
+            return;
+        }
+    }
+}
+
+unsigned long long stock_quotes_version(void) {
+    return atomic_load(&g_quote_version);
+}
+
+/* 함수 목적: 공개된 가격 기록 중 [from, from + max_len) 구간을 out_buf에 복사한다.
+ *           겹치는 압축 블록만 풀어 읽는다.
+ * 매개변수: symbol, from, out_buf, max_len
+ * 반환 값: 복사한 길이
+ */
+int stock_history_range(const char *symbol, long from, int *out_buf, int max_len) {
     ensure_seeded();
-    if (!out_arr || !out_n) return 0;
+    if (!symbol || !out_buf || max_len <= 0 || from < 0) return 0;
 
-    for (int i = 0; i < g_stock_count; ++i) {
-        Stock tmp = g_stocks[i];
+    Stock *s = find_stock(symbol);
+    if (!s) return 0;
+
+    int i = (int)(s - g_stocks);
+    long visible = g_visible_len[i];
+    if (from >= visible) return 0;
+    long n = visible - from < max_len ? visible - from : max_len;
+    return (int)series_read(&g_series[i].px, from, out_buf, n);
+}
+
+/* 함수 목적: 거래 한 건을 그 종목의 지금 단계 체결 기록에 더한다.
+ * 매개변수: book (종목 번호), price, qty
+ * 반환 값: 없음
+ */
+static void tape_record(int book, int price, int qty) {
+    if (book < 0 || book >= g_stock_count || qty <= 0) return;
+    TradeTape *t = &g_tape[book];
+    long step = g_visible_len[book] - 1;
+    if (t->count == 0 || t->step[t->count - 1] != step) {
+        if (t->count == t->cap) {
+            int cap = t->cap ? t->cap * 2 : 64;
+            long *ns = realloc(t->step, (size_t)cap * sizeof(long));
+            if (ns) t->step = ns;
+            long long *nq = realloc(t->qty, (size_t)cap * sizeof(long long));
+            if (nq) t->qty = nq;
+            long long *nn = realloc(t->notional, (size_t)cap * sizeof(long long));
+            if (nn) t->notional = nn;
+            if (!ns || !nq || !nn) return;
+            t->cap = cap;
+        }
+        t->step[t->count] = step;
+        t->qty[t->count] = 0;
+        t->notional[t->count] = 0;
+        t->count++;
+    }
+    t->qty[t->count - 1] += qty;
+    t->notional[t->count - 1] += (long long)price * qty;
+}
+
+/* 함수 목적: 공개된 가격 단계 [from, from + max_len) 의 거래량과 거래대금을 채운다.
+ *           거래가 없던 단계는 0 이고, 체결 기록은 이분 탐색으로 시작 칸을 찾는다.
+ * 매개변수: symbol, from, out_qty, out_notional, max_len
+ * 반환 값: 채운 단계 수
+ */
+int stock_trade_range(const char *symbol, long from, long long *out_qty, long long *out_notional, int max_len) {
+    ensure_seeded();
+    if (!symbol || !out_qty || !out_notional || max_len <= 0 || from < 0) return 0;
+
+    Stock *s = find_stock(symbol);
+    if (!s) return 0;
+
+    int i = (int)(s - g_stocks);
+    long visible = g_visible_len[i];
+    if (from >= visible) return 0;
+    int n = visible - from < max_len ? (int)(visible - from) : max_len;
+    memset(out_qty, 0, (size_t)n * sizeof(long long));
+    memset(out_notional, 0, (size_t)n * sizeof(long long));
+
+    const TradeTape *t = &g_tape[i];
+    int lo = 0, hi = t->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (t->step[mid] < from) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int k = lo; k < t->count && t->step[k] < from + n; ++k) {
+        out_qty[t->step[k] - from] = t->qty[k];
+        out_notional[t->step[k] - from] = t->notional[k];
+    }
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  학생 간 지정가 주문 (core/order_book)                                      */
+/* -------------------------------------------------------------------------- */
+
+/* 주문을 내면 매수는 지정가 x 수량만큼의 돈을, 매도는 그 수량의 주식을 먼저 떼어
+ * 맡겨 둔다. 체결 보고가 오면 맡긴 것에서 상대에게 넘기고, 취소되면 돌려준다.
+ * 체결가는 장에 먼저 걸려 있던 주문의 가격이고, 매수자가 더 낸 차액은 돌려준다.
+ */
 
-        int visible = g_visible_len[i];
-        if (visible <= 0) visible = 1;
-        if (visible > tmp.log_len) visible = tmp.log_len;
+// stock_order_place 가 지켜보는 주문: NEW 보고에서 번호를 받고 체결 수량을 센다
+static int      g_watching    = 0;
+static uint64_t g_watch_order = 0;
+static int      g_watch_filled = 0;
 
-        /* 이 시점에서 그래프/리스트가 보게 될 log 길이는 visible */
-        tmp.log_len       = visible;
-        tmp.current_price = tmp.log[visible - 1];
-        tmp.previous_price= (visible >= 2)
-                            ? tmp.log[visible - 2]
-                            : tmp.current_price;
+/* 함수 목적: 정산 금액을 계좌에 넣는다. 금액은 long long 으로 받아 INT_MAX 와 비교하고,
+ *           넘으면 int 로 담을 수 있는 만큼씩 나눠 넣는다. (주문 때 금액을 검사하므로
+ *           보통은 한 번에 끝난다)
+ * 매개변수: user, amount, reason
+ * 반환 값: 없음
+ */
+static void credit_settlement(User *user, long long amount, const char *reason) {
+    while (amount > 0) {
+        int part = amount > INT_MAX ? INT_MAX : (int)amount;
+        if (!account_add_tx(user, part, reason)) return;
+        amount -= part;
+    }
+}
 
-        out_arr[i] = tmp;
+/* 함수 목적: 주문 보고 하나를 정산한다. 사용자의 돈과 보유 주식을 옮긴다.
+ * 매개변수: r, ctx (사용하지 않음)
+ * 반환 값: 없음
+ */
+static void settle_report(const ObReport *r, void *ctx) {
+    (void)ctx;
+    if (r->type == OB_EXEC_NEW) {
+        if (g_watching && g_watch_order == 0) g_watch_order = r->order;
+        return;
     }
+    if (r->type == OB_EXEC_REPLACED || r->book < 0 || r->book >= g_stock_count) return;
 
-    *out_n = g_stock_count;
+    User *user = user_at_mut(r->owner);
+    if (!user) return;
+    user_hydrate(user);
+    const char *symbol = g_stocks[r->book].name;
+    int buy = r->side == OB_BUY;
+
+    if (r->type == OB_EXEC_FILL) {
+        if (g_watching && r->order == g_watch_order) g_watch_filled += r->qty;
+        valuation_position(user->id, r->book, buy ? r->qty : -r->qty);
+        if (buy) {
+            tape_record(r->book, r->price, r->qty); /* 체결 하나에 보고가 양쪽으로 오니 매수 쪽만 센다 */
+            StockHolding *holding = find_or_create_holding(user, symbol);
+            if (holding) holding->qty += r->qty;
+            valuation_escrow(user->id, -(long long)r->limit * r->qty);
+            credit_settlement(user, (long long)(r->limit - r->price) * r->qty, "ORDER_REFUND");
+            user_stock_save_holdings(user);
+        } else {
+            credit_settlement(user, (long long)r->price * r->qty, "BOOK_SELL");
+        }
+        return;
+    }
+
+    /* CANCELED / REJECTED: 맡긴 만큼 돌려준다 */
+    if (buy) {
+        valuation_escrow(user->id, -(long long)r->limit * r->qty);
+        credit_settlement(user, (long long)r->limit * r->qty, "ORDER_RELEASE");
+    } else {
+        StockHolding *holding = find_or_create_holding(user, symbol);
+        if (holding) holding->qty += r->qty;
+        user_stock_save_holdings(user);
+    }
+}
+
+/* 함수 목적: 걸려 있는 주문 전체를 data/orders.csv 로 다시 쓴다.
+ *           맡긴 돈과 주식이 재시작 뒤에도 주문으로 남게 한다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void orders_save(void) {
+    int n = ob_orders(OB_ANY_OWNER, NULL, 0);
+    ObOrderInfo *open = n > 0 ? malloc((size_t)n * sizeof(ObOrderInfo)) : NULL;
+    if (n > 0 && !open) return;
+    ob_orders(OB_ANY_OWNER, open, n);
+
+    size_t cap = (size_t)n * 160 + 64, len = 0;
+    char *buf = malloc(cap);
+    if (!buf) {
+        free(open);
+        return;
+    }
+    len += (size_t)snprintf(buf, cap, "# symbol,user,side,price,qty\n");
+    for (int i = 0; i < n; ++i) {
+        const User *u = user_at(open[i].owner);
+        if (!u) continue;
+        int w = snprintf(buf + len, cap - len, "%s,%s,%c,%d,%d\n",
+                         g_stocks[open[i].book].name, u->name,
+                         open[i].side == OB_BUY ? 'B' : 'S', open[i].price, open[i].leaves);
+        if (w < 0 || (size_t)w >= cap - len) break;
+        len += (size_t)w;
+    }
+    csv_ensure_dir("data");
+    csv_write_file(ORDERS_CSV_PATH, buf, len);
+    free(buf);
+    free(open);
+}
+
+/* 함수 목적: 주문장을 만들고 data/orders.csv 의 주문을 파일 순서대로 다시 건다.
+ *           저장된 장은 교차하지 않으므로 다시 걸어도 체결되지 않고 같은 순서가 된다.
+ *           종목이 사라진 주문은 맡긴 것을 돌려준다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void orders_restore(void) {
+    ob_init(g_stock_count, settle_report, NULL);
+
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, ORDERS_CSV_PATH, ',')) return;
+    while (csv_cursor_next_row(&cur)) {
+        if (cur.row.ptr[0] == '#') continue;
+        CsvField f[5];
+        if (csv_cursor_fields(&cur, f, 5) < 5) continue;
+        char symbol[64], name[64];
+        int price = 0, qty = 0;
+        csv_field_copy(csv_field_trim(f[0]), symbol, sizeof(symbol));
+        csv_field_copy(csv_field_trim(f[1]), name, sizeof(name));
+        ObSide side = csv_field_eq(f[2], "B") ? OB_BUY : OB_SELL;
+        if (!csv_field_int(f[3], &price) || !csv_field_int(f[4], &qty) || price <= 0 || qty <= 0) continue;
+        User *user = user_lookup(name);
+        if (!user) continue;
+
+        Stock *s = find_stock(symbol);
+        if (s) {
+            ob_submit((int)(s - g_stocks), user->id, side, price, qty);
+        } else if (side == OB_BUY) {
+            account_add_tx(user, price * qty, "ORDER_RELEASE");
+        }
+        /* 사라진 종목의 매도 주문은 돌려줄 종목이 없다 */
+    }
+    csv_cursor_close(&cur);
+}
+
+/* 함수 목적: 지정가 주문을 낸다. 맡길 돈이나 주식이 모자라거나 가격이 지금 시세의
+ *           절반~1.5배를 벗어나면 거절한다. 바로 맞는 상대가 있으면 그 자리에서 체결된다.
+ * 매개변수: username, symbol, is_buy, price, qty, out_filled (바로 체결된 수량, NULL 가능)
+ * 반환 값: 주문 번호, 실패하면 0
+ */
+uint64_t stock_order_place(const char *username, const char *symbol, int is_buy, int price, int qty, int *out_filled) {
+    ensure_seeded();
+    if (out_filled) *out_filled = 0;
+    if (!username || !symbol || price <= 0 || qty <= 0) return 0;
+
+    User *user = user_lookup(username);
+    Stock *stock = find_stock(symbol);
+    if (!user || !stock) return 0;
+    user_hydrate(user);
+
+    /* long 은 mingw 에서 32비트라 곱셈이 검사보다 먼저 넘친다; long long 으로 센다 */
+    int quote = stock->current_price;
+    if ((long long)price * 2 < quote || (long long)price * 2 > (long long)quote * 3) return 0;
+    long long cost = (long long)price * qty;
+    if (cost > INT_MAX) return 0;
+
+    if (is_buy) {
+        /* 체결될 때 보유 칸이 없어 주식을 잃지 않도록 칸을 먼저 잡아 두고,
+         * 돈을 맡기지 못하면 새로 잡은 칸은 다시 뺀다 */
+        int created = find_holding(user, symbol) == NULL;
+        if (!find_or_create_holding(user, symbol)) return 0;
+        if (!account_add_tx(user, -(int)cost, "ORDER_HOLD")) {
+            if (created) drop_empty_holding(user, symbol);
+            return 0;
+        }
+        valuation_escrow(user->id, cost);
+    } else {
+        StockHolding *holding = find_holding(user, symbol);
+        if (!holding || holding->qty < qty) return 0;
+        holding->qty -= qty;
+        user_stock_save_holdings(user);
+    }
+
+    g_watching = 1;
+    g_watch_order = 0;
+    g_watch_filled = 0;
+    uint64_t id = ob_submit((int)(stock - g_stocks), user->id, is_buy ? OB_BUY : OB_SELL, price, qty);
+    g_watching = 0;
+    if (out_filled) *out_filled = g_watch_filled;
+
+    orders_save();
+    return id;
+}
+
+/* 함수 목적: 자기 주문을 찾는다.
+ * 매개변수: username, id, out_user, out_info
+ * 반환 값: 찾았으면 1
+ */
+static int own_order(const char *username, uint64_t id, User **out_user, ObOrderInfo *out_info) {
+    ensure_seeded();
+    User *user = username ? user_lookup(username) : NULL;
+    if (!user || !ob_order(id, out_info) || out_info->owner != user->id) return 0;
+    user_hydrate(user);
+    *out_user = user;
     return 1;
 }
 
-/* 함수 목적: 주식의 히스토리를 out_buf에 복사한다. 
- * 매개변수: symbol, out_buf, max_len
- * 반환 값: 주식의 히스토리 길이
+/* 함수 목적: 걸려 있는 자기 주문을 취소한다. 남은 수량만큼 맡긴 것을 돌려받는다.
+ * 매개변수: username, id
+ * 반환 값: 성공 여부
  */
-int stock_get_history(const char *symbol, int *out_buf, int max_len) {
+int stock_order_cancel(const char *username, uint64_t id) {
+    User *user;
+    ObOrderInfo info;
+    if (!own_order(username, id, &user, &info)) return 0;
+    int ok = ob_cancel(id);
+    if (ok) orders_save();
+    return ok;
+}
+
+/* 함수 목적: 걸려 있는 자기 주문의 가격/수량을 바꾼다. 맡긴 몫의 차이를 먼저 맞추고,
+ *           주문장이 거절하면 되돌린다. 같은 가격에서 수량만 줄이면 순서를 지킨다.
+ * 매개변수: username, id, price, qty
+ * 반환 값: 살아 있는 주문 번호, 실패하면 0
+ */
+uint64_t stock_order_replace(const char *username, uint64_t id, int price, int qty) {
+    User *user;
+    ObOrderInfo info;
+    if (price <= 0 || qty <= 0 || !own_order(username, id, &user, &info)) return 0;
+    Stock *stock = &g_stocks[info.book];
+    int quote = stock->current_price;
+    if ((long long)price * 2 < quote || (long long)price * 2 > (long long)quote * 3) return 0;
+
+    /* 맡긴 몫을 새 조건에 맞춰 먼저 옮긴다 (줄어드는 쪽은 바로 돌려준다) */
+    long long delta;
+    StockHolding *holding = NULL;
+    int created = 0;
+    if (info.side == OB_BUY) {
+        long long after = (long long)price * qty;
+        if (after > INT_MAX) return 0;
+        delta = after - (long long)info.price * info.leaves;
+        if (delta != 0 && !account_add_tx(user, -(int)delta, delta > 0 ? "ORDER_HOLD" : "ORDER_RELEASE")) return 0;
+        valuation_escrow(user->id, delta);
+    } else {
+        /* 줄이면 돌려받을 칸이 있어야 한다 (0 주 칸은 저장되지 않아 재시작 뒤 없을 수 있다) */
+        created = find_holding(user, stock->name) == NULL;
+        holding = find_or_create_holding(user, stock->name);
+        if (!holding) return 0;
+        delta = (long long)qty - info.leaves;
+        if (delta > holding->qty) {
+            if (created) drop_empty_holding(user, stock->name);
+            return 0;
+        }
+        holding->qty -= (int)delta;
+    }
+
+    uint64_t live = ob_replace(id, price, qty);
+    if (!live && delta != 0) {
+        if (info.side == OB_BUY) {
+            account_add_tx(user, (int)delta, delta > 0 ? "ORDER_RELEASE" : "ORDER_HOLD");
+            valuation_escrow(user->id, -delta);
+        } else {
+            holding->qty += (int)delta;
+        }
+    }
+    if (created) drop_empty_holding(user, stock->name); /* 그대로 0 주면 잡을 필요가 없었다 */
+    if (holding && delta != 0) user_stock_save_holdings(user);
+    if (live) orders_save();
+    return live;
+}
+
+/* 함수 목적: 사용자의 걸려 있는 주문을 out 에 담는다.
+ * 매개변수: username, out, max
+ * 반환 값: 담은 개수
+ */
+int stock_order_list(const char *username, StockOrder *out, int max) {
     ensure_seeded();
-    if (!symbol || !out_buf || max_len <= 0) return 0;
+    User *user = username ? user_lookup(username) : NULL;
+    if (!user || !out || max <= 0) return 0;
+    ObOrderInfo *open = malloc((size_t)max * sizeof(ObOrderInfo));
+    if (!open) return 0;
+    int n = ob_orders(user->id, open, max);
+    if (n > max) n = max;
+    for (int i = 0; i < n; ++i) {
+        out[i].id = open[i].id;
+        snprintf(out[i].symbol, sizeof(out[i].symbol), "%s", g_stocks[open[i].book].name);
+        out[i].is_buy = open[i].side == OB_BUY;
+        out[i].price = open[i].price;
+        out[i].leaves = open[i].leaves;
+    }
+    free(open);
+    return n;
+}
 
-    Stock *s = find_stock(symbol);
-    if (!s) return 0;
+/* 함수 목적: 종목의 최우선 매수/매도 호가를 알려준다. 비어 있는 쪽은 0 이다.
+ * 매개변수: symbol, bid, ask
+ * 반환 값: 종목이 있으면 1
+ */
+int stock_book_top(const char *symbol, int *bid, int *ask) {
+    ensure_seeded();
+    Stock *stock = find_stock(symbol);
+    if (!stock) return 0;
+    return ob_best((int)(stock - g_stocks), bid, ask);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  배당                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/* 함수 목적: 종목 이름 -> 종목 번호 해시표를 만든다 (열린 주소, 칸 수는 2의 거듭제곱).
+ *           보유 목록을 한 번 훑는 동안 find_stock 의 선형 탐색을 피한다.
+ * 매개변수: out_mask
+ * 반환 값: 표 (빈 칸은 -1), 실패하면 NULL
+ */
+static int *symbol_table_build(size_t *out_mask) {
+    size_t cap = 16;
+    while (cap < (size_t)g_stock_count * 2) cap *= 2;
+    int *table = malloc(cap * sizeof(int));
+    if (!table) return NULL;
+    for (size_t k = 0; k < cap; ++k) table[k] = -1;
+    for (int i = 0; i < g_stock_count; ++i) {
+        size_t k = (size_t)g_sym_key[i] & (cap - 1);
+        while (table[k] >= 0) k = (k + 1) & (cap - 1);
+        table[k] = i;
+    }
+    *out_mask = cap - 1;
+    return table;
+}
+
+/* 함수 목적: 해시표에서 종목 번호를 찾는다.
+ * 매개변수: table, mask, symbol
+ * 반환 값: 종목 번호, 없으면 -1
+ */
+static int symbol_table_find(const int *table, size_t mask, const char *symbol) {
+    size_t k = (size_t)symbol_key(symbol) & mask;
+    for (; table[k] >= 0; k = (k + 1) & mask) {
+        if (strncmp(g_stocks[table[k]].name, symbol, sizeof(g_stocks[0].name)) == 0) return table[k];
+    }
+    return -1;
+}
+
+/* 함수 목적: 기준일 현재의 모든 주주에게 배당을 한 번에 지급한다.
+ *           종목마다 주당 배당(주가 x 배당률, 1/1000 크레딧 단위)을 먼저 정하고,
+ *           보유 목록과 매도 주문에 맡긴 주식을 한 번 훑어 사용자별로 합친다.
+ *           지급은 사용자당 장부 레코드 하나로, 한 번의 장부 덧붙이기와 한 번의 계좌
+ *           저장으로 끝낸다. 보유 파일은 바뀌지 않으므로 다시 쓰지 않는다.
+ * 매개변수: by (지급을 지시한 교사, 스케줄러면 NULL), now, out (NULL 가능)
+ * 반환 값: 지급을 진행했으면 1, 권한이 없거나 아직 때가 아니면 0
+ */
+int stock_pay_dividends(User *by, long now, StockDividendStats *out) {
+    StockDividendStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (out) *out = stats;
+    ensure_seeded();
+    if (by && by->isadmin != TEACHER) return 0;
+    if (!by && now - (long)g_last_dividend < STOCK_DIVIDEND_PERIOD) return 0;
+
+    size_t users = user_count();
+    size_t mask = 0;
+    int *table = symbol_table_build(&mask);
+    long long *rate = malloc((size_t)(g_stock_count > 0 ? g_stock_count : 1) * sizeof(long long));
+    long long *due = calloc(users > 0 ? users : 1, sizeof(long long));
+    LedgerEntry *entries = NULL;
+    if (!table || !rate || !due) {
+        free(table);
+        free(rate);
+        free(due);
+        return 0;
+    }
+
+    /* 종목별 주당 배당 (1/1000 크레딧) */
+    for (int i = 0; i < g_stock_count; ++i) {
+        double r = g_div_yield[i] > 0.0 ? (double)g_stocks[i].current_price * g_div_yield[i] * 1000.0 : 0.0;
+        rate[i] = (long long)(r + 0.5);
+    }
 
-    int len = s->log_len;
-    if (len > max_len) len = max_len;
+    /* 기준일 주주 명부: 보유 목록 + 매도 주문에 맡겨 둔 주식 */
+    user_hydrate_all();
+    for (size_t u = 0; u < users; ++u) {
+        const UserHoldings *held = user_holdings_peek(user_at(u));
+        for (int h = 0; held && h < held->count; ++h) {
+            if (held->items[h].qty <= 0) continue;
+            int i = symbol_table_find(table, mask, held->items[h].symbol);
+            if (i >= 0) due[u] += rate[i] * held->items[h].qty;
+        }
+    }
+    int open = ob_orders(OB_ANY_OWNER, NULL, 0);
+    ObOrderInfo *orders = open > 0 ? malloc((size_t)open * sizeof(ObOrderInfo)) : NULL;
+    if (orders) {
+        ob_orders(OB_ANY_OWNER, orders, open);
+        for (int k = 0; k < open; ++k) {
+            if (orders[k].side == OB_SELL && orders[k].owner < users) {
+                due[orders[k].owner] += rate[orders[k].book] * orders[k].leaves;
+            }
+        }
+        free(orders);
+    }
 
-    for (int i = 0; i < len; ++i) {
-        out_buf[i] = s->log[i];
+    size_t count = 0;
+    for (size_t u = 0; u < users; ++u) {
+        if (due[u] >= 1000) count++;
+    }
+    entries = count > 0 ? calloc(count, sizeof(LedgerEntry)) : NULL;
+    size_t n = 0;
+    for (size_t u = 0; entries && u < users; ++u) {
+        long long amount = due[u] / 1000;
+        User *user = user_at_mut(u);
+        if (amount <= 0 || !user) continue;
+        if (amount > INT_MAX - user->bank.balance) amount = INT_MAX - user->bank.balance;
+        user->bank.balance += (int)amount;
+        LedgerEntry *e = &entries[n++];
+        e->ts = now;
+        e->type = LEDGER_ADJUST;
+        snprintf(e->user, sizeof(e->user), "%s", user->name);
+        e->amount = (int)amount;
+        e->balance = user->bank.balance;
+        e->cash = user->bank.cash;
+        e->loan = user->bank.loan;
+        snprintf(e->reason, sizeof(e->reason), "DIVIDEND");
+        stats.paid += amount;
     }
-    return len;
+    stats.holders = n;
+    stats.postings = account_post_batch(entries, n);
+    if (n > 0) user_store_flush();
+
+    g_last_dividend = (time_t)now;
+    market_save();
+
+    free(entries);
+    free(due);
+    free(rate);
+    free(table);
+    if (out) *out = stats;
+    return 1;
+}
+
+/* 함수 목적: 지금 상태로 순자산 평가(domain/valuation)를 처음부터 만든다. 모든 사용자의
+ *           돈/아이템, 보유 주식, 걸려 있는 주문을 한 번 훑는다. 이후로는 거래, 체결,
+ *           시세 변동이 변화분만 넘긴다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+int stock_valuation_seed(void) {
+    ensure_seeded();
+    if (!valuation_reset(g_stock_count)) return 0;
+    for (int i = 0; i < g_stock_count; ++i) valuation_price(i, g_stocks[i].current_price);
+
+    size_t mask = 0;
+    int *table = symbol_table_build(&mask);
+    if (!table) return 0;
+    user_hydrate_all();
+    size_t users = user_count();
+    for (size_t u = 0; u < users; ++u) {
+        const User *user = user_at(u);
+        if (!user) continue;
+        valuation_touch(user);
+        const UserHoldings *held = user_holdings_peek(user);
+        for (int h = 0; held && h < held->count; ++h) {
+            int i = held->items[h].qty > 0 ? symbol_table_find(table, mask, held->items[h].symbol) : -1;
+            if (i >= 0) valuation_position(user->id, i, held->items[h].qty);
+        }
+    }
+    free(table);
+
+    /* 주문에 맡긴 것도 주인 몫이다 */
+    int open = ob_orders(OB_ANY_OWNER, NULL, 0);
+    ObOrderInfo *orders = open > 0 ? malloc((size_t)open * sizeof(ObOrderInfo)) : NULL;
+    if (orders) {
+        ob_orders(OB_ANY_OWNER, orders, open);
+        for (int k = 0; k < open; ++k) {
+            if (orders[k].side == OB_SELL) {
+                valuation_position(orders[k].owner, orders[k].book, orders[k].leaves);
+            } else {
+                valuation_escrow(orders[k].owner, (long long)orders[k].price * orders[k].leaves);
+            }
+        }
+        free(orders);
+    }
+    return 1;
 }
 
 /* data/stocks/(username).csv 에 저장된
- * "종목명,보유량" 들을 user->holdings[] 로 불러온다
+ * "종목명,보유량" 들을 사용자의 보유 주식 표(user_holdings)로 불러온다
  */
 /* 함수 목적: 사용자의 주식 보유량을 CSV 파일에서 불러온다.
  * 매개변수: user
  * 반환 값: 없음
  */
-static void user_stock_load_holdings(User *user) {
+void stock_load_holdings(User *user) {
     if (!user) return;
 
     char path[256];
     snprintf(path, sizeof(path), "data/stocks/%s.csv", user->name);
 
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, path, ',')) {
         return;  // 파일 없으면 보유량 없음
     }
 
-    user->holding_count = 0;  // 초기화
-
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        // 공백/개행 제거
-        char *p = strtok(line, ", \t\r\n");
-        if (!p) continue;
-
-        char symbol[64];
-        snprintf(symbol, sizeof(symbol), "%s", p);
+    /* 보유 주식 표는 실제로 보유한 종목이 있을 때만 만든다 */
+    UserHoldings *held = user_holdings_peek(user);
+    if (held) held->count = 0;  // 초기화
 
-        p = strtok(NULL, ", \t\r\n");
-        if (!p) continue;
+    while (csv_cursor_next_row(&cur)) {
+        // 앞뒤 공백 제거
+        CsvField sym, qf;
+        if (!csv_cursor_next_field(&cur, &sym)) continue;
+        sym = csv_field_trim(sym);
+        if (sym.len == 0) continue;
 
-        int qty = atoi(p);
+        int qty = 0;
+        if (!csv_cursor_next_field(&cur, &qf) || !csv_field_int(qf, &qty)) continue;
         if (qty <= 0) continue;
 
-        if (user->holding_count >= MAX_HOLDINGS)
+        if (!held) held = user_holdings(user);
+        if (!held || held->count >= MAX_HOLDINGS)
             break;
 
-        StockHolding *h = &user->holdings[user->holding_count++];
+        StockHolding *h = &held->items[held->count++];
         memset(h, 0, sizeof(*h));
-        snprintf(h->symbol, sizeof(h->symbol), "%s", symbol);
+        csv_field_copy(sym, h->symbol, sizeof(h->symbol));
         h->qty = qty;
     }
 
-    fclose(fp);
+    csv_cursor_close(&cur);
 }
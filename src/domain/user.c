@@ -9,224 +9,748 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <time.h>
 
+#include "../../include/domain/ledger.h"
 #include "../../include/domain/mission.h"
+#include "../../include/domain/state.h"
+#include "../../include/domain/stock.h"
+#include "../../include/domain/valuation.h"
 #include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
+#include "../../include/core/worker_pool.h"
 
-// 최대 학생 수
-static User g_users[MAX_STUDENTS];
-// 현재 등록된 학생 수
+/* 사용자 표: USER_CHUNK 명씩 묶어 할당하고 묶음은 옮기지 않으므로, 한 번 돌려준
+ * User 포인터는 사용자가 늘어나도 프로그램이 끝날 때까지 유효하다.
+ * 이름 -> 사용자 번호는 개방 주소법(선형 탐사) 해시 색인으로 찾는다.
+ * User 에는 자주 읽는 필드만 두고, 이름과 비밀번호는 문자열 풀에, 인벤토리와
+ * 보유 주식, 미션 완료 비트셋은 사용자 번호로 찾는 곁 표(g_side)에 둔다.
+ * 곁 표의 각 항목은 처음 쓸 때 할당한다. */
+#define USER_CHUNK 64
+#define USER_NONE ((size_t)-1)
+#define USER_POOL_CHUNK 4096
+
+typedef struct PoolChunk {
+    struct PoolChunk *next;
+    size_t used;
+    size_t cap;
+    char data[];
+} PoolChunk;
+
+typedef struct UserSide {
+    Item *items;            /* USER_ITEM_SLOTS 칸 */
+    UserHoldings *holdings;
+    uint64_t *done;         /* 카탈로그 칸 번호별 미션 완료 비트 */
+    uint32_t done_words;
+    unsigned char hydrated;      /* 사용자별 파일을 읽었음 (user_hydrate) */
+    unsigned char from_snapshot; /* 위 표들을 스냅샷에서 채웠고 아래 크기로 확인해야 함 */
+    int64_t holdings_size;       /* 스냅샷 당시 data/stocks/<name>.csv 크기 */
+    int64_t missions_size;       /* 스냅샷 당시 data/missions/<name>.csv 크기 */
+} UserSide;
+
+/* 사용자별 파일을 아직 읽지 않은 사용자는 스냅샷에 이 크기로 남겨, 다음 부팅 때
+ * 파일이 있으면 다시 읽게 한다 (파일이 없으면 빈 목록이 맞으므로 그대로 쓴다). */
+#define USER_FILE_UNKNOWN ((int64_t)-2)
+
+static User **g_user_chunks = NULL;
+static size_t g_chunk_count = 0;
+static size_t g_chunk_cap = 0;
+// 현재 등록된 사용자 수
 static size_t g_user_count = 0;
+// 칸마다 사용자 번호 + 1 (0 은 빈 칸), 크기는 2의 거듭제곱이고 절반 넘게 차지 않게 유지
+static uint32_t *g_name_index = NULL;
+static size_t g_name_index_cap = 0;
+// 이름/비밀번호 문자열 풀 (덧붙이기만 하고 옮기지 않음)
+static PoolChunk *g_pool = NULL;
+static size_t g_pool_bytes = 0;
+// 사용자 번호로 찾는 곁 표, 크기는 필요할 때 늘림
+static UserSide *g_side = NULL;
+static size_t g_side_cap = 0;
+// 사용자 표를 복원한 스냅샷의 작성 시각 (user_hydrate 가 파일 변경 여부를 볼 때 사용)
+static int64_t g_snap_created = 0;
 // 시드 초기화 여부
 static int g_seeded = 0;
 
-/* 함수 목적: Item 구조체 복사
- * 매개변수: dst, src
+static void seed_defaults(void);
+
+/* 함수 목적: 사용자 번호로 표의 칸을 찾습니다.
+ * 매개변수: index (< g_user_count)
+ * 반환 값: 사용자 포인터
+ */
+static User *user_slot(size_t index) {
+    return &g_user_chunks[index / USER_CHUNK][index % USER_CHUNK];
+}
+
+/* 함수 목적: 사용자 이름의 해시를 계산합니다. (FNV-1a, 이름 필드 길이까지만)
+ * 매개변수: name
+ * 반환 값: 해시
+ */
+static uint32_t name_hash(const char *name) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < USER_NAME_MAX && name[i]; ++i) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* 함수 목적: 이름으로 사용자 번호를 찾습니다. (평균 O(1))
+ * 매개변수: name
+ * 반환 값: 사용자 번호, 없으면 USER_NONE
+ */
+static size_t name_find(const char *name) {
+    if (!name || g_name_index_cap == 0) return USER_NONE;
+    size_t mask = g_name_index_cap - 1;
+    for (size_t pos = name_hash(name) & mask;; pos = (pos + 1) & mask) {
+        uint32_t v = g_name_index[pos];
+        if (v == 0) return USER_NONE;
+        if (strncmp(user_slot(v - 1)->name, name, USER_NAME_MAX) == 0) return v - 1;
+    }
+}
+
+/* 함수 목적: 사용자 번호를 해시 색인에 넣습니다. 같은 이름이 이미 있으면 먼저 들어온 쪽을 둡니다.
+ * 매개변수: index
  * 반환 값: 없음
  */
-static void copy_item(Item *dst, const Item *src) {
-    if (!dst || !src) {
-        return;
+static void name_index_put(size_t index) {
+    size_t mask = g_name_index_cap - 1;
+    const char *name = user_slot(index)->name;
+    for (size_t pos = name_hash(name) & mask;; pos = (pos + 1) & mask) {
+        uint32_t v = g_name_index[pos];
+        if (v == 0) {
+            g_name_index[pos] = (uint32_t)index + 1;
+            return;
+        }
+        if (strncmp(user_slot(v - 1)->name, name, USER_NAME_MAX) == 0) return;
     }
-    *dst = *src;
 }
 
-/* 함수 목적: Mission 구조체 복사
- * 매개변수: dst, src
+/* 함수 목적: 해시 색인을 두 배로 늘리고 모든 사용자를 다시 넣습니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+static int name_index_grow(void) {
+    size_t ncap = g_name_index_cap ? g_name_index_cap * 2 : 128;
+    uint32_t *n = calloc(ncap, sizeof(*n));
+    if (!n) return 0;
+    free(g_name_index);
+    g_name_index = n;
+    g_name_index_cap = ncap;
+    for (size_t i = 0; i < g_user_count; ++i) name_index_put(i);
+    return 1;
+}
+
+/* 함수 목적: 문자열을 풀에 복사합니다. 풀은 덧붙이기만 하므로 돌려준 포인터는
+ *           프로그램이 끝날 때까지 유효합니다. (USER_NAME_MAX 등 필드 길이까지만)
+ * 매개변수: str, max_len (끝의 '\0' 을 뺀 최대 길이)
+ * 반환 값: 풀 안의 문자열, 메모리가 없으면 NULL
+ */
+static const char *pool_strdup(const char *str, size_t max_len) {
+    if (!str) str = "";
+    size_t n = strnlen(str, max_len);
+    if (!g_pool || g_pool->cap - g_pool->used < n + 1) {
+        size_t cap = n + 1 > USER_POOL_CHUNK ? n + 1 : USER_POOL_CHUNK;
+        PoolChunk *c = malloc(sizeof(*c) + cap);
+        if (!c) return NULL;
+        c->next = g_pool;
+        c->used = 0;
+        c->cap = cap;
+        g_pool = c;
+        g_pool_bytes += sizeof(*c) + cap;
+    }
+    char *dst = g_pool->data + g_pool->used;
+    memcpy(dst, str, n);
+    dst[n] = '\0';
+    g_pool->used += n + 1;
+    return dst;
+}
+
+/* 함수 목적: 사용자 번호의 곁 표 항목을 찾습니다. 표가 작으면 두 배씩 늘립니다.
+ * 매개변수: id
+ * 반환 값: 곁 표 항목, 메모리가 없으면 NULL
+ */
+static UserSide *user_side(uint32_t id) {
+    if (id >= g_side_cap) {
+        size_t ncap = g_side_cap ? g_side_cap : 64;
+        while (ncap <= id) ncap *= 2;
+        UserSide *n = realloc(g_side, ncap * sizeof(*n));
+        if (!n) return NULL;
+        memset(n + g_side_cap, 0, (ncap - g_side_cap) * sizeof(*n));
+        g_side = n;
+        g_side_cap = ncap;
+    }
+    return &g_side[id];
+}
+
+/* 함수 목적: 곁 표 항목을 할당하지 않고 찾습니다.
+ * 매개변수: user
+ * 반환 값: 곁 표 항목, 아직 없으면 NULL
+ */
+static const UserSide *user_side_peek(const User *user) {
+    if (!user || user->id >= g_side_cap) return NULL;
+    return &g_side[user->id];
+}
+
+/* 함수 목적: 곁 표 항목 하나가 잡은 메모리를 모두 해제합니다.
+ * 매개변수: side
  * 반환 값: 없음
  */
-static void copy_mission(Mission *dst, const Mission *src) {
-    if (!dst || !src) {
-        return;
+static void user_side_free(UserSide *side) {
+    free(side->items);
+    free(side->holdings);
+    free(side->done);
+    memset(side, 0, sizeof(*side));
+}
+
+/* 함수 목적: 사용자 하나를 표 끝에 복사해 넣고 이름 색인에 등록합니다.
+ *           이름과 비밀번호는 풀에 복사하고 id 는 표 위치로 정합니다.
+ *           필요하면 새 묶음을 할당하며, 기존 사용자는 옮기지 않습니다.
+ * 매개변수: src
+ * 반환 값: 새 사용자 포인터, 메모리가 없으면 NULL
+ */
+static User *user_push(const User *src) {
+    if (g_user_count == g_chunk_count * USER_CHUNK) {
+        if (g_chunk_count == g_chunk_cap) {
+            size_t ncap = g_chunk_cap ? g_chunk_cap * 2 : 4;
+            User **n = realloc(g_user_chunks, ncap * sizeof(*n));
+            if (!n) return NULL;
+            g_user_chunks = n;
+            g_chunk_cap = ncap;
+        }
+        User *chunk = calloc(USER_CHUNK, sizeof(User));
+        if (!chunk) return NULL;
+        g_user_chunks[g_chunk_count++] = chunk;
     }
+    if ((g_user_count + 1) * 2 > g_name_index_cap && !name_index_grow()) return NULL;
+    User *dst = user_slot(g_user_count);
     *dst = *src;
+    dst->id = (uint32_t)g_user_count;
+    dst->name = pool_strdup(src->name, USER_NAME_MAX - 1);
+    dst->pw = pool_strdup(src->pw, USER_PW_MAX - 1);
+    if (!dst->name || !dst->pw) return NULL;
+    name_index_put(g_user_count);
+    g_user_count++;
+    return dst;
 }
 
-/* 함수 목적: 기본 설정 초기화
+/* 함수 목적: 사용자 표를 비웁니다. 할당한 묶음은 다시 쓰려고 남겨 두고,
+ *           곁 표 항목은 해제합니다. (문자열 풀은 덧붙이기만 하므로 그대로 둡니다)
  * 매개변수: 없음
  * 반환 값: 없음
  */
-static void seed_defaults(void) {
-    if (g_seeded) return; /* already seeded */
-    g_seeded = 1;
-
-    // 전체 유저 배열 초기화
-    memset(g_users, 0, sizeof(g_users));
+static void user_table_reset(void) {
+    for (size_t i = 0; i < g_side_cap; ++i) user_side_free(&g_side[i]);
     g_user_count = 0;
+    if (g_name_index) memset(g_name_index, 0, g_name_index_cap * sizeof(*g_name_index));
+}
 
-    FILE *fp = fopen("data/users.csv", "r");
-    if (!fp) {
-        // 파일 못 열면 예전처럼 기본 teacher / student만 넣고 끝내기
-        fprintf(stderr, "warning: could not open data.csv\n");
-        return;
-    }
+/* 계좌 저장소: 헤더 뒤에 사용자 번호(user_slot 인덱스)마다 고정 길이 슬롯 하나.
+ * 잔액이 바뀌면 그 사용자의 슬롯만 제자리에 덮어쓴다. accounts.csv 는
+ * 사람이 읽기 위한 내보내기 파일이고, 저장소가 없거나 깨진 슬롯이 있을 때만 읽는다. */
+#define ACCOUNTS_DAT_PATH "data/accounts.dat"
+#define ACCOUNTS_CSV_PATH "data/accounts.csv"
+#define USERS_CSV_PATH "data/users.csv"
+#define ACCOUNTS_DAT_MAGIC 0x43415243u /* "CRAC" */
+#define ACCOUNTS_DAT_VERSION 1u
 
-    char line[256];
+typedef struct AccountFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+} AccountFileHeader;
 
-    while (fgets(line, sizeof(line), fp)) {
-        // 개행 제거
-        line[strcspn(line, "\r\n")] = '\0';
-        // 빈 줄이면 스킵
-        if (line[0] == '\0') {
-            continue;
-        }
-        // "name,password[,role]" 파싱 (role은 optional)
-        char *name = strtok(line, ",");
-        char *pw   = strtok(NULL, ",");
-        char *role_tok = strtok(NULL, ",");
-        if (!name || !pw) {
-            // 형식이 이상하면 스킵
-            continue;
-        }
-        if (g_user_count >= MAX_STUDENTS) {
-            // 더 이상 못 넣으면 중단
-            break;
-        }
-        User u = (User){0};
-        // name, id, pw
-        snprintf(u.name, sizeof(u.name), "%s", name); 
-        snprintf(u.pw,   sizeof(u.pw),   "%s", pw);
+typedef struct AccountRecord {
+    char name[56];
+    int32_t balance;
+    int32_t cash;
+    int32_t loan;
+    int32_t reserved;
+    int64_t last_interest_ts;
+    uint32_t used;
+    uint32_t checksum; /* FNV-1a over the bytes before this field */
+} AccountRecord;
 
-        // role 처리 (기본 STUDENT)
-        RankEnum role = STUDENT;
-        if (role_tok) {
-            // 허용 형식: 숫자(1=TEACHER), 혹은 'T'/'t' 시작 또는 'teacher' 등
-            if (role_tok[0] == '1' || role_tok[0] == 'T' || role_tok[0] == 't') {
-                role = TEACHER;
-            }
-        }
-        u.isadmin = role;
+/* 함수 목적: 계좌 레코드의 체크섬을 계산합니다. (쓰다 만 슬롯 검출용)
+ * 매개변수: rec
+ * 반환 값: 체크섬
+ */
+static uint32_t account_record_checksum(const AccountRecord *rec) {
+    const unsigned char *p = (const unsigned char *)rec;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(AccountRecord, checksum); ++i) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
 
-        // bank.name 은 이름으로
-        snprintf(u.bank.name, sizeof(u.bank.name), "%s", u.name);
+/* 함수 목적: 메모리상의 사용자 계좌를 고정 길이 레코드로 만듭니다.
+ * 매개변수: u, out
+ * 반환 값: 없음
+ */
+static void account_record_from_user(const User *u, AccountRecord *out) {
+    memset(out, 0, sizeof(*out));
+    snprintf(out->name, sizeof(out->name), "%s", u->name);
+    out->balance = u->bank.balance;
+    out->cash = u->bank.cash;
+    out->loan = u->bank.loan;
+    out->last_interest_ts = u->bank.last_interest_ts;
+    out->used = 1;
+    out->checksum = account_record_checksum(out);
+}
 
-        // 미션 목록과 완료 상태를 per-user CSV에서 불러오기
-        mission_load_user(u.name, &u);
+/* 함수 목적: 슬롯 번호에 해당하는 파일 내 오프셋을 계산합니다.
+ * 매개변수: index
+ * 반환 값: 바이트 오프셋
+ */
+static long long account_slot_offset(size_t index) {
+    return (long long)sizeof(AccountFileHeader) + (long long)index * (long long)sizeof(AccountRecord);
+}
 
-        // 은행 기본값 설정 (users.csv에는 balance 정보가 없으므로 role 기준 초기화)
-        if (u.bank.balance == 0) {
-            u.bank.balance = (u.isadmin == TEACHER) ? 5000 : 1000; /* deposit */
-        }
-        /* ensure cash defaults to 0 */
-        if (u.bank.cash == 0) {
-            u.bank.cash = 0;
-        }
-        /* rating feature removed: no-op */
-        /* ensure per-user tx file exists and attach fp for writing */
-        /* holdings/items already zeroed by (User){0}; ensure counts are sensible */
-        if (u.holding_count < 0) u.holding_count = 0;
-        if (u.mission_count < 0) u.mission_count = 0;
+/* 함수 목적: 사용자 한 명의 계좌 슬롯만 제자리에 덮어씁니다. (O(1))
+ * 매개변수: index
+ * 반환 값: 성공 여부
+ */
+static int account_store_write_slot(size_t index) {
+    if (index >= g_user_count) return 0;
+    AccountRecord rec;
+    account_record_from_user(user_slot(index), &rec);
+    csv_ensure_dir("data");
+    return csv_write_at(ACCOUNTS_DAT_PATH, account_slot_offset(index), (const char *)&rec, sizeof(rec));
+}
 
-        g_users[g_user_count++] = u;
+/* 함수 목적: 계좌 저장소 전체를 현재 사용자 표로 다시 씁니다.
+ *           처음 만들 때(accounts.csv 이전)와 슬롯 배치를 바로잡을 때만 사용합니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+static int account_store_rebuild(void) {
+    size_t len = sizeof(AccountFileHeader) + g_user_count * sizeof(AccountRecord);
+    char *buf = calloc(1, len);
+    if (!buf) return 0;
+    AccountFileHeader hdr = {ACCOUNTS_DAT_MAGIC, ACCOUNTS_DAT_VERSION, (uint32_t)sizeof(AccountRecord), 0};
+    memcpy(buf, &hdr, sizeof(hdr));
+    for (size_t i = 0; i < g_user_count; ++i) {
+        account_record_from_user(user_slot(i), (AccountRecord *)(buf + account_slot_offset(i)));
     }
+    csv_ensure_dir("data");
+    int ok = csv_write_file(ACCOUNTS_DAT_PATH, buf, len);
+    free(buf);
+    /* 슬롯 배치가 바뀌었을 수 있으니 새 파일이 디스크에 닿았는지 확인한다 */
+    return ok && csv_flush_path(ACCOUNTS_DAT_PATH);
+}
 
-    fclose(fp);
+/* 함수 목적: 계좌 저장소를 읽어 사용자 표에 반영합니다.
+ *           슬롯 i 는 보통 사용자 i 이지만, users.csv 순서가 바뀐 경우에는 이름으로 찾습니다.
+ * 매개변수: loaded (사용자별로 반영되었으면 1로 표시), out_misplaced (슬롯 위치가 어긋났으면 1)
+ * 반환 값: 저장소가 있고 헤더가 올바르면 1, 아니면 0
+ */
+static int load_accounts_dat(unsigned char *loaded, int *out_misplaced) {
+    *out_misplaced = 0;
+    csv_flush_path(ACCOUNTS_DAT_PATH); /* 쓰기 스레드에 남은 슬롯 쓰기/재작성을 먼저 반영한다 */
+    FILE *f = fopen(ACCOUNTS_DAT_PATH, "rb");
+    if (!f) return 0;
+    AccountFileHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 || hdr.magic != ACCOUNTS_DAT_MAGIC ||
+        hdr.version != ACCOUNTS_DAT_VERSION || hdr.record_size != sizeof(AccountRecord)) {
+        fclose(f);
+        return 0;
+    }
+    AccountRecord rec;
+    for (size_t slot = 0; fread(&rec, sizeof(rec), 1, f) == 1; ++slot) {
+        if (!rec.used || rec.checksum != account_record_checksum(&rec)) continue;
+        rec.name[sizeof(rec.name) - 1] = '\0';
+        size_t idx = slot;
+        if (idx >= g_user_count || strcmp(user_slot(idx)->name, rec.name) != 0) {
+            *out_misplaced = 1;
+            idx = name_find(rec.name);
+            if (idx == USER_NONE) continue;
+        }
+        Bank *b = &user_slot(idx)->bank;
+        b->balance = rec.balance;
+        b->cash = rec.cash;
+        b->loan = rec.loan;
+        b->last_interest_ts = (long)rec.last_interest_ts;
+        loaded[idx] = 1;
+    }
+    fclose(f);
+    return 1;
+}
 
-    FILE *fp1 = fopen("data/accounts.csv", "r");
-    if (!fp1) {
-        fprintf(stderr, "warning: could not open accounts.csv\n");
+/* 함수 목적: accounts.csv 를 읽어 아직 계좌가 반영되지 않은 사용자에게 채웁니다.
+ *           (계좌 저장소가 생기기 전 데이터의 이전, 깨진 슬롯 복구용)
+ * 매개변수: loaded (반영된 사용자는 1로 표시)
+ * 반환 값: 없음
+ */
+static void load_accounts_csv(unsigned char *loaded) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, ACCOUNTS_CSV_PATH, ',')) {
         return;
     }
 
-    char line1[256];
-
-    while (fgets(line1, sizeof(line1), fp1)) {
-        // 개행 제거
-        line1[strcspn(line1, "\r\n")] = '\0';
-        // 빈 줄이면 스킵
-        if (line1[0] == '\0') {
-            continue;
-        }
+    while (csv_cursor_next_row(&cur)) {
         /* flexible CSV parsing (support old format with rating and new format without):
          * Old: name,balance,rating,cash,loan,last_interest_ts,log
          * New: name,balance,cash,loan,last_interest_ts,log
+         * Empty fields are skipped when counting columns.
          */
-        char *tokens[12] = {0};
+        CsvField tokens[12];
         int tc = 0;
-        char *p = strtok(line1, ",");
-        while (p && tc < (int)(sizeof(tokens)/sizeof(tokens[0]))) {
-            tokens[tc++] = p;
-            p = strtok(NULL, ",");
+        CsvField fld;
+        while (tc < (int)(sizeof(tokens)/sizeof(tokens[0])) && csv_cursor_next_field(&cur, &fld)) {
+            if (fld.len > 0) tokens[tc++] = fld;
         }
         if (tc < 2) continue; /* need at least name,balance */
-        char *name = tokens[0];
-        char *balance = tokens[1];
-        char *cash_tok = NULL;
-        char *loan_tok = NULL;
-        char *last_interest_tok = NULL;
-        char *log = NULL;
+        char name[50];
+        csv_field_copy(tokens[0], name, sizeof(name));
+        CsvField *balance = &tokens[1];
+        CsvField *cash_tok = NULL;
+        CsvField *loan_tok = NULL;
+        CsvField *last_interest_tok = NULL;
+        CsvField *log = NULL;
+        long ts4 = 0, ts5 = 0;
+        if (tc >= 5) csv_field_long(tokens[4], &ts4);
+        if (tc >= 6) csv_field_long(tokens[5], &ts5);
 
         /* Detect whether the file uses the old "rating" field by checking
          * whether the token that would be last_interest_ts (at index 5)
          * looks like a plausible epoch timestamp (> 1e9). If so, assume
          * old format (rating present at tokens[2]). Otherwise assume new format. */
-        if (tc >= 6 && atol(tokens[5]) > 1000000000L) {
+        if (tc >= 6 && ts5 > 1000000000L) {
             /* Old format: name,balance,rating,cash,loan,last_interest_ts,log */
-            cash_tok = tc > 3 ? tokens[3] : NULL;
-            loan_tok = tc > 4 ? tokens[4] : NULL;
-            last_interest_tok = tc > 5 ? tokens[5] : NULL;
-            log = tc > 6 ? tokens[6] : NULL;
-        } else if (tc >= 5 && atol(tokens[4]) > 1000000000L) {
+            cash_tok = tc > 3 ? &tokens[3] : NULL;
+            loan_tok = tc > 4 ? &tokens[4] : NULL;
+            last_interest_tok = tc > 5 ? &tokens[5] : NULL;
+            log = tc > 6 ? &tokens[6] : NULL;
+        } else if (tc >= 5 && ts4 > 1000000000L) {
             /* New format: name,balance,cash,loan,last_interest_ts,log */
-            cash_tok = tc > 2 ? tokens[2] : NULL;
-            loan_tok = tc > 3 ? tokens[3] : NULL;
-            last_interest_tok = tc > 4 ? tokens[4] : NULL;
-            log = tc > 5 ? tokens[5] : NULL;
+            cash_tok = tc > 2 ? &tokens[2] : NULL;
+            loan_tok = tc > 3 ? &tokens[3] : NULL;
+            last_interest_tok = tc > 4 ? &tokens[4] : NULL;
+            log = tc > 5 ? &tokens[5] : NULL;
         } else {
             /* Fallback: interpret third token as cash if present */
-            cash_tok = tc > 2 ? tokens[2] : NULL;
-            loan_tok = tc > 3 ? tokens[3] : NULL;
-            last_interest_tok = tc > 4 ? tokens[4] : NULL;
-            log = tc > 5 ? tokens[5] : NULL;
+            cash_tok = tc > 2 ? &tokens[2] : NULL;
+            loan_tok = tc > 3 ? &tokens[3] : NULL;
+            last_interest_tok = tc > 4 ? &tokens[4] : NULL;
+            log = tc > 5 ? &tokens[5] : NULL;
+        }
+        size_t i = name_find(name);
+        if (i != USER_NONE && !loaded[i]) {
+            User *u = user_slot(i);
+            int v = 0;
+            u->bank.balance = csv_field_int(*balance, &v) ? v : 0;
+            v = 0;
+            u->bank.cash = cash_tok && csv_field_int(*cash_tok, &v) ? v : 0;
+            v = 0;
+            u->bank.loan = loan_tok && csv_field_int(*loan_tok, &v) ? v : 0;
+            if (last_interest_tok) {
+                long lts = 0;
+                csv_field_long(*last_interest_tok, &lts);
+                u->bank.last_interest_ts = lts;
+            } else {
+                /* If accounts.csv lacks last_interest_ts, leave it 0:
+                 * user_hydrate derives it from the user's transaction log
+                 * the first time the user is loaded. */
+                u->bank.last_interest_ts = 0;
+            }
+            /* the log column is ignored; history lives in data/txs/<name>.csv */
+            (void)log;
+            loaded[i] = 1;
         }
-        if (g_user_count >= MAX_STUDENTS) {
+    }
+    csv_cursor_close(&cur);
+}
+
+/* 함수 목적: users.csv 를 offset 부터 읽어 사용자 표 끝에 추가합니다.
+ *           (스냅샷 이후 가입한 사용자만 읽을 때는 offset 이 스냅샷 당시 파일 크기)
+ * 매개변수: offset
+ * 반환 값: 없음
+ */
+static void load_users_csv(size_t offset) {
+    CsvCursor cur;
+    if (!csv_cursor_open(&cur, USERS_CSV_PATH, ',')) {
+        // 파일 못 열면 예전처럼 기본 teacher / student만 넣고 끝내기
+        fprintf(stderr, "warning: could not open data.csv\n");
+        return;
+    }
+    if (offset <= cur.len) cur.pos = offset;
+
+    // 빈 줄은 커서가 건너뜀
+    while (csv_cursor_next_row(&cur)) {
+        // "name,password[,role]" 파싱 (role은 optional)
+        CsvField f[3];
+        int fc = csv_cursor_fields(&cur, f, 3);
+        if (fc < 2 || f[0].len == 0 || f[1].len == 0) {
+            // 형식이 이상하면 스킵
+            continue;
+        }
+        User u = (User){0};
+        // name, pw (user_push 가 풀에 복사)
+        char name[USER_NAME_MAX];
+        char pw[USER_PW_MAX];
+        csv_field_copy(f[0], name, sizeof(name));
+        csv_field_copy(f[1], pw, sizeof(pw));
+        u.name = name;
+        u.pw = pw;
+
+        // role 처리 (기본 STUDENT)
+        RankEnum role = STUDENT;
+        if (fc > 2 && f[2].len > 0) {
+            // 허용 형식: 숫자(1=TEACHER), 혹은 'T'/'t' 시작 또는 'teacher' 등
+            char r0 = f[2].ptr[0];
+            if (r0 == '1' || r0 == 'T' || r0 == 't') {
+                role = TEACHER;
+            }
+        }
+        u.isadmin = role;
+
+        // 은행 기본값 설정 (users.csv에는 balance 정보가 없으므로 role 기준 초기화)
+        u.bank.balance = (u.isadmin == TEACHER) ? 5000 : 1000; /* deposit */
+
+        // 미션 완료, 보유 주식 등 사용자별 파일은 로그인하거나 볼 때 읽는다 (user_hydrate)
+        if (!user_push(&u)) break;
+    }
+
+    csv_cursor_close(&cur);
+}
+
+/* 함수 목적: 사용자별 파일 경로를 만듭니다. (data/<dir>/<name>.csv)
+ * 매개변수: dir, name, out, cap
+ * 반환 값: 없음
+ */
+static void user_file_path(const char *dir, const char *name, char *out, size_t cap) {
+    snprintf(out, cap, "data/%s/%s.csv", dir, name);
+}
+
+/* 함수 목적: 부팅 스냅샷에서 사용자 표를 복원합니다. 보유 주식과 미션 완료도
+ *           스냅샷 값으로 채우고 당시 파일 크기를 기억해 두며, 원본 파일이 그 뒤
+ *           바뀌었는지는 사용자별 파일을 건드리지 않도록 user_hydrate 에서 확인합니다.
+ * 매개변수: out_users_offset (이어 읽을 users.csv 위치), out_accounts_size (스냅샷 당시 accounts.dat 크기)
+ * 반환 값: 복원했으면 1, 스냅샷이 없거나 쓸 수 없으면 0 (사용자 표는 비어 있음)
+ */
+static int load_users_snapshot(size_t *out_users_offset, int64_t *out_accounts_size) {
+    const SnapReader *snap = state_snapshot();
+    SnapCursor c;
+    if (!snap || !snap_section(snap, STATE_SEC_USERS, &c)) return 0;
+    int64_t users_size = snap_get_i64(&c);
+    int64_t accounts_size = snap_get_i64(&c);
+    /* users.csv 는 덧붙이기만 하므로, 줄어들었다면 손으로 고친 것 -> 전부 다시 읽는다 */
+    if (users_size < 0 || snap_file_size(USERS_CSV_PATH) < users_size) return 0;
+    uint32_t n = snap_get_u32(&c);
+
+    int *ids = NULL;
+    uint32_t ids_cap = 0;
+    for (uint32_t i = 0; i < n && !c.bad; ++i) {
+        User tmp_user;
+        memset(&tmp_user, 0, sizeof(tmp_user));
+        char name[USER_NAME_MAX];
+        char pw[USER_PW_MAX];
+        snap_get_str(&c, name, sizeof(name));
+        snap_get_str(&c, pw, sizeof(pw));
+        tmp_user.name = name;
+        tmp_user.pw = pw;
+        tmp_user.isadmin = snap_get_i32(&c) == TEACHER ? TEACHER : STUDENT;
+        tmp_user.bank.balance = snap_get_i32(&c);
+        tmp_user.bank.cash = snap_get_i32(&c);
+        tmp_user.bank.loan = snap_get_i32(&c);
+        tmp_user.bank.last_interest_ts = (long)snap_get_i64(&c);
+        User *u = c.bad ? NULL : user_push(&tmp_user);
+        if (!u) {
+            c.bad = 1;
             break;
         }
-        for (int i = 0; i < g_user_count; ++i) {
-            if (strcmp(g_users[i].name, name) == 0) {
-                g_users[i].bank.balance = atoi(balance);
-                g_users[i].bank.cash = cash_tok ? atoi(cash_tok) : 0;
-                g_users[i].bank.loan = loan_tok ? atoi(loan_tok) : 0;
-                if (last_interest_tok) {
-                    g_users[i].bank.last_interest_ts = atol(last_interest_tok);
-                } else {
-                    /* If accounts.csv lacks last_interest_ts, try to derive it from
-                     * the user's transaction log (data/txs/<name>.csv) by reading
-                     * the last transaction timestamp. If that fails, fall back
-                     * to current time to avoid retroactive application. */
-                    char txpath[512];
-                    snprintf(txpath, sizeof(txpath), "data/txs/%s.csv", name);
-                    char *lastbuf = NULL;
-                    size_t lastlen = 0;
-                    long derived_ts = 0;
-                    if (csv_read_last_lines(txpath, 1, &lastbuf, &lastlen) && lastbuf) {
-                        /* lastbuf contains a line like: "<ts>,...\n" */
-                        char *tok = strtok(lastbuf, ",");
-                        if (tok) derived_ts = atol(tok);
-                        free(lastbuf);
-                        lastbuf = NULL;
-                    }
-                    if (derived_ts > 0) g_users[i].bank.last_interest_ts = derived_ts;
-                    else g_users[i].bank.last_interest_ts = (long)time(NULL);
-                }
-
-                snprintf(
-                    g_users[i].bank.name,
-                    sizeof(g_users[i].bank.name),
-                    "%s",
-                    name
-                );
-                if (log) {
-                    snprintf(g_users[i].bank.log,
-                             sizeof(g_users[i].bank.log),
-                             "%s", log);
-                }
+
+        uint32_t ni = snap_get_u32(&c);
+        for (uint32_t k = 0; k < ni && !c.bad; ++k) {
+            Item tmp = {0};
+            snap_get_str(&c, tmp.name, sizeof(tmp.name));
+            tmp.stock = snap_get_i32(&c);
+            tmp.cost = snap_get_i32(&c);
+            if (k < USER_ITEM_SLOTS && tmp.stock > 0) {
+                Item *items = user_items(u);
+                if (items) items[k] = tmp;
+            }
+        }
+
+        int64_t hsize = snap_get_i64(&c);
+        uint32_t nh = snap_get_u32(&c);
+        for (uint32_t k = 0; k < nh && !c.bad; ++k) {
+            StockHolding tmp = {0};
+            snap_get_str(&c, tmp.symbol, sizeof(tmp.symbol));
+            tmp.qty = snap_get_i32(&c);
+            UserHoldings *h = user_holdings(u);
+            if (h && h->count < MAX_HOLDINGS) h->items[h->count++] = tmp;
+        }
+
+        int64_t msize = snap_get_i64(&c);
+        uint32_t nm = snap_get_u32(&c);
+        if (nm > ids_cap) {
+            int *grown = realloc(ids, nm * sizeof(*ids));
+            if (!grown) {
+                c.bad = 1;
                 break;
             }
+            ids = grown;
+            ids_cap = nm;
+        }
+        for (uint32_t k = 0; k < nm && !c.bad; ++k) ids[k] = snap_get_i32(&c);
+        if (c.bad) break;
+        if (nm > 0) mission_apply_completed(u, ids, (int)nm);
+        UserSide *side = user_side(u->id);
+        if (!side) {
+            c.bad = 1;
+            break;
         }
+        side->from_snapshot = 1;
+        side->holdings_size = hsize;
+        side->missions_size = msize;
     }
-    fclose(fp1);
+    free(ids);
+    if (c.bad) {
+        user_table_reset();
+        return 0;
+    }
+    g_snap_created = snap->created;
+    *out_users_offset = (size_t)users_size;
+    *out_accounts_size = accounts_size;
+    return 1;
+}
+
+/* 함수 목적: 사용자 표를 스냅샷 섹션으로 기록합니다. 사용자마다 보유 주식과
+ *           미션 파일의 크기를 함께 남겨 다음 부팅 때 바뀐 파일만 다시 읽게 합니다.
+ *           아직 파일을 읽지 않은 사용자는 빈 목록과 USER_FILE_UNKNOWN 을 남깁니다.
+ * 매개변수: w
+ * 반환 값: 성공 여부
+ */
+int user_snapshot_write(SnapWriter *w) {
+    seed_defaults();
+    if (!snap_writer_begin(w, STATE_SEC_USERS)) return 0;
+    snap_put_i64(w, snap_file_size(USERS_CSV_PATH));
+    snap_put_i64(w, snap_file_size(ACCOUNTS_DAT_PATH));
+    snap_put_u32(w, (uint32_t)g_user_count);
+    int slots = mission_catalog_count();
+    for (size_t i = 0; i < g_user_count; ++i) {
+        const User *u = user_slot(i);
+        const UserSide *side = user_side_peek(u);
+        int hydrated = side && side->hydrated;
+        snap_put_str(w, u->name);
+        snap_put_str(w, u->pw);
+        snap_put_i32(w, (int32_t)u->isadmin);
+        snap_put_i32(w, u->bank.balance);
+        snap_put_i32(w, u->bank.cash);
+        snap_put_i32(w, u->bank.loan);
+        snap_put_i64(w, (int64_t)u->bank.last_interest_ts);
+
+        /* 한 번도 쓰지 않은 곁 표는 빈 목록으로 남긴다 */
+        const Item *items = user_items_peek(u);
+        uint32_t ni = items ? USER_ITEM_SLOTS : 0;
+        snap_put_u32(w, ni);
+        for (uint32_t k = 0; k < ni; ++k) {
+            snap_put_str(w, items[k].name);
+            snap_put_i32(w, items[k].stock);
+            snap_put_i32(w, items[k].cost);
+        }
+
+        char path[512];
+        user_file_path("stocks", u->name, path, sizeof(path));
+        snap_put_i64(w, hydrated ? snap_file_size(path) : USER_FILE_UNKNOWN);
+        const UserHoldings *h = hydrated ? user_holdings_peek(u) : NULL;
+        /* 보유 파일처럼 0 주 이하 칸은 저장하지 않는다 */
+        uint32_t nh = 0;
+        for (int k = 0; h && k < h->count; ++k) {
+            if (h->items[k].qty > 0) nh++;
+        }
+        snap_put_u32(w, nh);
+        for (int k = 0; h && k < h->count; ++k) {
+            if (h->items[k].qty <= 0) continue;
+            snap_put_str(w, h->items[k].symbol);
+            snap_put_i32(w, h->items[k].qty);
+        }
+
+        user_file_path("missions", u->name, path, sizeof(path));
+        snap_put_i64(w, hydrated ? snap_file_size(path) : USER_FILE_UNKNOWN);
+        uint32_t done = 0;
+        for (int k = 0; hydrated && k < slots; ++k) {
+            if (user_mission_done(u, k)) done++;
+        }
+        snap_put_u32(w, done);
+        for (int k = 0; k < slots && done > 0; ++k) {
+            Mission m;
+            if (user_mission_done(u, k) && mission_user_at(u, k, &m)) snap_put_i32(w, m.id);
+        }
+    }
+    snap_writer_end(w);
+    return !w->failed;
+}
+
+/* 함수 목적: 장부 복구 중 체크포인트 행이나 레코드 하나의 계좌 상태를 사용자에게 반영합니다.
+ * 매개변수: name, balance, cash, loan, ctx (사용자별 변경 표시 배열)
+ * 반환 값: 없음
+ */
+static void apply_ledger_state(const char *name, int balance, int cash, int loan, void *ctx) {
+    unsigned char *changed = ctx;
+    size_t i = name_find(name);
+    if (i == USER_NONE) return;
+    Bank *b = &user_slot(i)->bank;
+    if (b->balance != balance || b->cash != cash || b->loan != loan) {
+        b->balance = balance;
+        b->cash = cash;
+        b->loan = loan;
+        changed[i] = 1;
+    }
+}
+
+/* 함수 목적: 기본 설정 초기화
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void seed_defaults(void) {
+    if (g_seeded) return; /* already seeded */
+    g_seeded = 1;
+
+    // 전체 유저 표 초기화
+    user_table_reset();
+
+    /* 스냅샷이 있으면 사용자 표를 통째로 복원하고, users.csv 는 그 뒤에 덧붙은
+     * 행(스냅샷 이후 가입자)만 읽는다. */
+    size_t users_offset = 0;
+    int64_t accounts_size = -1;
+    int from_snap = load_users_snapshot(&users_offset, &accounts_size);
+    size_t snap_count = g_user_count;
+    load_users_csv(users_offset);
+
+    /* 계좌는 고정 길이 저장소에서 읽는다. 스냅샷 이후 저장소가 바뀌지 않았으면
+     * 건너뛰고, 저장소가 없거나 반영되지 못한 사용자만 accounts.csv 에서 읽는다.
+     * 그런 경우에는 저장소를 한 번 새로 쓴다. */
+    unsigned char *loaded = calloc(g_user_count ? g_user_count : 1, 1);
+    if (!loaded) return;
+    if (from_snap) memset(loaded, 1, snap_count);
+    int have_dat = 1;
+    int misplaced = 0;
+    if (!from_snap || !snap_file_unchanged(ACCOUNTS_DAT_PATH, accounts_size, state_snapshot()->created)) {
+        have_dat = load_accounts_dat(loaded, &misplaced);
+    }
+    int missing = 0;
+    for (size_t i = 0; i < g_user_count; ++i) {
+        if (!loaded[i]) missing = 1;
+    }
+    if (missing) load_accounts_csv(loaded);
+
+    /* 잔액은 장부가 기준이다: 마지막 체크포인트와 그 뒤 레코드만 재생하고,
+     * 저장소와 다른 계좌는 슬롯을 다시 쓴다. */
+    memset(loaded, 0, g_user_count ? g_user_count : 1);
+    ledger_recover(apply_ledger_state, loaded);
+    if (!have_dat || missing || misplaced) {
+        account_store_rebuild();
+    } else {
+        for (size_t i = 0; i < g_user_count; ++i) {
+            if (loaded[i]) account_store_write_slot(i);
+        }
+    }
+    free(loaded);
 }
 
 /* 함수 목적: 중복 사용자 이름 검사
@@ -234,12 +758,7 @@ static void seed_defaults(void) {
  * 반환 값: 중복검사 결과
  */
 static int has_duplicate(const char *username) {
-    for (size_t i = 0; i < g_user_count; ++i) {
-        if (strncmp(g_users[i].name, username, sizeof(g_users[i].name)) == 0) {
-            return 1;
-        }
-    }
-    return 0;
+    return name_find(username) != USER_NONE;
 }
 
 User *user_lookup(const char *username) {
@@ -247,12 +766,8 @@ User *user_lookup(const char *username) {
     if (!username) {
         return NULL;
     }
-    for (size_t i = 0; i < g_user_count; ++i) {
-        if (strncmp(g_users[i].name, username, sizeof(g_users[i].name)) == 0) {
-            return &g_users[i];
-        }
-    }
-    return NULL;
+    size_t i = name_find(username);
+    return i == USER_NONE ? NULL : user_slot(i);
 }
 
 /* 함수 목적: 사용자 수를 센다.
@@ -273,7 +788,19 @@ const User *user_at(size_t index) {
     if (index >= g_user_count) {
         return NULL;
     }
-    return &g_users[index];
+    return user_slot(index);
+}
+
+/* 함수 목적: 특정 위치 사용자를 고칠 수 있는 포인터로 반환 (전원을 도는 일괄 처리용)
+ * 매개변수: index
+ * 반환 값: 사용자 포인터, 범위를 벗어나면 NULL
+ */
+User *user_at_mut(size_t index) {
+    seed_defaults();
+    if (index >= g_user_count) {
+        return NULL;
+    }
+    return user_slot(index);
 }
 
 /* 함수 목적: 새 사용자 등록
@@ -282,7 +809,7 @@ const User *user_at(size_t index) {
  */
 int user_register(const User *new_user) {
     seed_defaults();
-    if (!new_user || g_user_count >= MAX_STUDENTS) {
+    if (!new_user) {
         return 0;
     }
     /* reject empty name or password */
@@ -292,30 +819,24 @@ int user_register(const User *new_user) {
         return 0;
     }
 
-    User *dst = &g_users[g_user_count++];
-    memset(dst, 0, sizeof(*dst));
-    snprintf(dst->name, sizeof(dst->name), "%s", new_user->name);
-    snprintf(dst->id, sizeof(dst->id), "%s", new_user->id);
-    snprintf(dst->pw, sizeof(dst->pw), "%s", new_user->pw);
-    dst->isadmin = new_user->isadmin;
-    dst->bank = new_user->bank;
+    User tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.name = new_user->name;
+    tmp.pw = new_user->pw;
+    tmp.isadmin = new_user->isadmin;
+    tmp.bank = new_user->bank;
     /* ensure last_interest_ts initialized */
-    if (dst->bank.last_interest_ts == 0) dst->bank.last_interest_ts = (long)time(NULL);
-    dst->completed_missions = new_user->completed_missions;
-    dst->total_missions = new_user->total_missions;
-    dst->mission_count = new_user->mission_count;
-    dst->holding_count = new_user->holding_count;
-
-    for (int i = 0; i < 10; ++i) {
-        copy_item(&dst->items[i], &new_user->items[i]);
-    }
-    for (int i = 0; i < new_user->mission_count && i < (int)(sizeof(dst->missions) / sizeof(dst->missions[0])); ++i) {
-        copy_mission(&dst->missions[i], &new_user->missions[i]);
-    }
-    for (int i = 0; i < new_user->holding_count && i < MAX_HOLDINGS; ++i) {
-        dst->holdings[i] = new_user->holdings[i];
-    }
+    if (tmp.bank.last_interest_ts == 0) tmp.bank.last_interest_ts = (long)time(NULL);
+    tmp.total_missions = mission_catalog_count();
 
+    User *dst = user_push(&tmp);
+    if (!dst) return 0;
+    /* 새 사용자에게는 읽을 사용자별 파일이 없다 */
+    UserSide *side = user_side(dst->id);
+    if (side) side->hydrated = 1;
+    /* 새 사용자의 계좌 슬롯은 저장소 끝에 붙는다 */
+    account_store_write_slot(g_user_count - 1);
+    valuation_touch(dst);
     return 1;
 }
 
@@ -332,11 +853,11 @@ int user_auth(const char *username, const char *password) {
     if (!user) {
         return 0;
     }
-    return strncmp(user->pw, password, sizeof(user->pw)) == 0;
+    return strncmp(user->pw, password, USER_PW_MAX) == 0;
 }
 
-// Persist updated balance to data/accounts.csv (rewrites file from in-memory user table)
-/* 함수 목적: 사용자 잔고 갱신
+/* 함수 목적: 사용자 잔고 갱신. 계좌 저장소에서 그 사용자의 슬롯 하나만 덮어씁니다.
+ *           (현금, 대출, 이자 시각도 함께 저장되므로 계좌가 바뀐 뒤 호출하면 됩니다)
  * 매개변수: username, new_balance
  * 반환 값: 성공 여부
  */
@@ -344,37 +865,303 @@ int user_update_balance(const char *username, int new_balance) {
     if (!username) return 0;
     seed_defaults(); /* ensure in-memory users are loaded */
 
-    int found = 0;
-    for (size_t i = 0; i < g_user_count; ++i) {
-        if (strncmp(g_users[i].name, username, sizeof(g_users[i].name)) == 0) {
-            g_users[i].bank.balance = new_balance; /* deposit */
-            found = 1;
-            break;
-        }
+    size_t i = name_find(username);
+    if (i == USER_NONE) return 0;
+    user_slot(i)->bank.balance = new_balance; /* deposit */
+    valuation_touch(user_slot(i));
+    account_store_write_slot(i);
+    return 1;
+}
+
+/* 함수 목적: 사용자의 인벤토리(USER_ITEM_SLOTS 칸)를 돌려줍니다. 처음 부르면 빈 칸으로 할당합니다.
+ * 매개변수: user
+ * 반환 값: 인벤토리 배열, 메모리가 없으면 NULL
+ */
+Item *user_items(User *user) {
+    UserSide *side = user ? user_side(user->id) : NULL;
+    if (!side) return NULL;
+    if (!side->items) side->items = calloc(USER_ITEM_SLOTS, sizeof(Item));
+    return side->items;
+}
+
+/* 함수 목적: 인벤토리를 할당하지 않고 봅니다.
+ * 매개변수: user
+ * 반환 값: 인벤토리 배열, 한 번도 쓰지 않았으면 NULL
+ */
+Item *user_items_peek(const User *user) {
+    const UserSide *side = user_side_peek(user);
+    return side ? side->items : NULL;
+}
+
+/* 함수 목적: 사용자의 보유 주식 표를 돌려줍니다. 처음 부르면 빈 표로 할당합니다.
+ * 매개변수: user
+ * 반환 값: 보유 주식 표, 메모리가 없으면 NULL
+ */
+UserHoldings *user_holdings(User *user) {
+    UserSide *side = user ? user_side(user->id) : NULL;
+    if (!side) return NULL;
+    if (!side->holdings) side->holdings = calloc(1, sizeof(UserHoldings));
+    return side->holdings;
+}
+
+/* 함수 목적: 보유 주식 표를 할당하지 않고 봅니다.
+ * 매개변수: user
+ * 반환 값: 보유 주식 표, 한 번도 쓰지 않았으면 NULL
+ */
+UserHoldings *user_holdings_peek(const User *user) {
+    const UserSide *side = user_side_peek(user);
+    return side ? side->holdings : NULL;
+}
+
+/* 함수 목적: 카탈로그 slot 번째 미션을 사용자가 완료했는지 봅니다.
+ * 매개변수: user, slot
+ * 반환 값: 완료 1, 아니면 0
+ */
+int user_mission_done(const User *user, int slot) {
+    const UserSide *side = user_side_peek(user);
+    if (!side || slot < 0 || (uint32_t)slot / 64 >= side->done_words) return 0;
+    return (int)((side->done[slot / 64] >> (slot % 64)) & 1u);
+}
+
+/* 함수 목적: 카탈로그 slot 번째 미션을 완료로 표시합니다. 비트셋은 필요한 만큼 늘립니다.
+ * 매개변수: user, slot
+ * 반환 값: 성공 여부
+ */
+int user_mission_mark(User *user, int slot) {
+    UserSide *side = user ? user_side(user->id) : NULL;
+    if (!side || slot < 0) return 0;
+    uint32_t word = (uint32_t)slot / 64;
+    if (word >= side->done_words) {
+        uint32_t nwords = word + 1;
+        uint64_t *n = realloc(side->done, nwords * sizeof(*n));
+        if (!n) return 0;
+        memset(n + side->done_words, 0, (nwords - side->done_words) * sizeof(*n));
+        side->done = n;
+        side->done_words = nwords;
     }
+    side->done[word] |= (uint64_t)1 << (slot % 64);
+    return 1;
+}
 
-    /* ensure data dir exists and rewrite accounts.csv from current in-memory table */
-    csv_ensure_dir("data");
-    FILE *fp = fopen("data/accounts.csv", "w");
-    if (!fp) {
-        return found;
+/* 함수 목적: 카탈로그를 처음부터 다시 만든 뒤 완료 비트를 새 칸 번호로 옮깁니다.
+ * 매개변수: user, new_slot (옛 칸 번호 -> 새 칸 번호, 없어진 미션은 -1), old_count
+ * 반환 값: 옮긴 뒤의 완료 수, 비트셋이 없는 사용자면 -1
+ */
+int user_missions_remap(User *user, const int *new_slot, int old_count) {
+    if (!user || user->id >= g_side_cap || !g_side[user->id].done) return -1;
+    UserSide *side = &g_side[user->id];
+    size_t bytes = side->done_words * sizeof(*side->done);
+    uint64_t *old = malloc(bytes ? bytes : 1);
+    if (!old) return -1;
+    memcpy(old, side->done, bytes);
+    uint32_t old_words = side->done_words;
+    memset(side->done, 0, bytes);
+    int done = 0;
+    for (int k = 0; k < old_count && (uint32_t)k / 64 < old_words; ++k) {
+        if (!((old[k / 64] >> (k % 64)) & 1u) || new_slot[k] < 0) continue;
+        if (!user_mission_done(user, new_slot[k]) && user_mission_mark(user, new_slot[k])) done++;
     }
+    free(old);
+    return done;
+}
+
+/* 함수 목적: 사용자의 미션 완료 표시를 모두 지웁니다.
+ * 매개변수: user
+ * 반환 값: 없음
+ */
+void user_missions_reset(User *user) {
+    if (!user || user->id >= g_side_cap) return;
+    UserSide *side = &g_side[user->id];
+    if (side->done) memset(side->done, 0, side->done_words * sizeof(*side->done));
+}
+
+/* 함수 목적: 거래 내역 파일의 마지막 줄에서 마지막 거래 시각을 읽습니다.
+ * 매개변수: name
+ * 반환 값: epoch 초, 없으면 0
+ */
+static long last_tx_ts(const char *name) {
+    char txpath[512];
+    user_file_path("txs", name, txpath, sizeof(txpath));
+    long ts = 0;
+    CsvTail it;
+    if (csv_tail_open(&it, txpath, 1)) {
+        /* the last line looks like: "<ts>,..." */
+        const char *last = NULL;
+        size_t lastlen = 0;
+        if (csv_tail_prev(&it, &last, &lastlen)) ts = atol(last);
+        csv_tail_close(&it);
+    }
+    return ts;
+}
+
+/* 함수 목적: 사용자 한 명의 사용자별 파일을 읽어 곁 표와 이자 시각을 채웁니다.
+ *           곁 표 배열이 이미 이 사용자 번호까지 늘어나 있어야 합니다.
+ *           (여러 스레드가 서로 다른 사용자에 대해 동시에 불러도 됩니다)
+ * 매개변수: u, side
+ * 반환 값: 없음
+ */
+static void hydrate_user(User *u, UserSide *side) {
+    char path[512];
+    if (side->from_snapshot) {
+        /* 스냅샷 값은 원본 파일이 그 뒤로 그대로일 때만 쓴다 */
+        user_file_path("stocks", u->name, path, sizeof(path));
+        if (!snap_file_unchanged(path, side->holdings_size, g_snap_created)) stock_load_holdings(u);
+        user_file_path("missions", u->name, path, sizeof(path));
+        if (!snap_file_unchanged(path, side->missions_size, g_snap_created)) mission_load_user(u->name, u);
+        else u->total_missions = mission_catalog_count();
+    } else {
+        mission_load_user(u->name, u);
+        stock_load_holdings(u);
+    }
+    user_interest_ts(u);
+    side->hydrated = 1;
+}
+
+/* 함수 목적: 이자를 마지막으로 계산한 시각을 돌려줍니다. accounts.csv 에 이자 시각이
+ *           없던 계좌는 마지막 거래 시각으로, 그것도 없으면 지금으로 정해 소급 이자를
+ *           주지 않습니다. (다른 사용자별 파일은 읽지 않음)
+ * 매개변수: user
+ * 반환 값: epoch 초
+ */
+long user_interest_ts(User *user) {
+    if (!user) return 0;
+    if (user->bank.last_interest_ts == 0) {
+        long ts = last_tx_ts(user->name);
+        user->bank.last_interest_ts = ts > 0 ? ts : (long)time(NULL);
+    }
+    return user->bank.last_interest_ts;
+}
+
+/* 함수 목적: 사용자별 파일(미션 완료, 보유 주식, 거래 내역 끝)을 처음 필요할 때 읽습니다.
+ *           로그인할 때와 화면에서 사용자를 볼 때 부릅니다. 이미 읽었으면 아무 일도 하지 않습니다.
+ * 매개변수: user
+ * 반환 값: 성공 여부
+ */
+int user_hydrate(User *user) {
+    if (!user) return 0;
+    seed_defaults();
+    UserSide *side = user_side(user->id);
+    if (!side) return 0;
+    if (!side->hydrated) hydrate_user(user, side);
+    return 1;
+}
+
+/* 함수 목적: 작업자 스레드에서 사용자 한 명을 불러옵니다.
+ * 매개변수: index, ctx (사용하지 않음)
+ * 반환 값: 없음
+ */
+static void hydrate_worker(size_t index, void *ctx) {
+    (void)ctx;
+    UserSide *side = &g_side[index];
+    if (!side->hydrated) hydrate_user(user_slot(index), side);
+}
+
+/* 함수 목적: 아직 읽지 않은 모든 사용자를 불러옵니다. (교사 화면처럼 전원을 보여줄 때)
+ *           파일 쓰기가 백그라운드 스레드로 넘어가 있으면 작업자 풀에서 나누어 읽습니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+int user_hydrate_all(void) {
+    seed_defaults();
+    if (g_user_count == 0) return 1;
+    /* 작업자들이 g_side 를 다시 할당하지 않도록 미리 늘리고, 미션 카탈로그도 먼저 읽어 둔다 */
+    if (!user_side((uint32_t)(g_user_count - 1))) return 0;
+    mission_catalog_count();
+    if (csv_async_running()) {
+        worker_pool_for(g_user_count, hydrate_worker, NULL);
+    } else {
+        for (size_t i = 0; i < g_user_count; ++i) hydrate_worker(i, NULL);
+    }
+    return 1;
+}
+
+/* 함수 목적: 사용자 표가 잡고 있는 메모리를 항목별로 셉니다. (할당 크기 기준)
+ * 매개변수: out
+ * 반환 값: 없음
+ */
+void user_memory_stats(UserMemoryStats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    out->users = g_user_count;
+    out->table_bytes = g_chunk_count * USER_CHUNK * sizeof(User) + g_chunk_cap * sizeof(User *);
+    out->index_bytes = g_name_index_cap * sizeof(*g_name_index);
+    out->string_bytes = g_pool_bytes;
+    out->side_bytes = g_side_cap * sizeof(UserSide);
+    for (size_t i = 0; i < g_side_cap; ++i) {
+        const UserSide *side = &g_side[i];
+        if (side->items) out->side_bytes += USER_ITEM_SLOTS * sizeof(Item);
+        if (side->holdings) out->side_bytes += sizeof(UserHoldings);
+        out->side_bytes += side->done_words * sizeof(*side->done);
+    }
+    out->total_bytes = out->table_bytes + out->index_bytes + out->string_bytes + out->side_bytes;
+}
+
+/* 함수 목적: 모든 계좌를 계좌 저장소에 한 번에 다시 씁니다. 슬롯을 하나씩 덮어쓰는
+ *           대신 많은 계좌가 함께 바뀐 뒤(전체 이자 정산) 한 번 부릅니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+int user_store_flush(void) {
+    seed_defaults();
+    return account_store_rebuild();
+}
+
+/* 함수 목적: 모든 사용자의 현재 잔액으로 장부 체크포인트를 씁니다.
+ *           다음 부팅 때는 이 체크포인트 뒤의 장부 레코드만 재생합니다.
+ * 매개변수: 없음
+ * 반환 값: 성공 여부
+ */
+int user_ledger_checkpoint(void) {
+    seed_defaults();
+    LedgerBalance *rows = calloc(g_user_count ? g_user_count : 1, sizeof(*rows));
+    if (!rows) return 0;
+    size_t n = 0;
     for (size_t i = 0; i < g_user_count; ++i) {
-        /* CSV format (new): name,balance,cash,loan,last_interest_ts,log
-         * For compatibility the loader accepts old rows that included a rating column.
-         */
-        /* Do NOT persist the in-memory bank.log into accounts.csv to avoid
-         * corrupting the CSV when log contains commas/newlines. The full
+        const User *u = user_slot(i);
+        if (u->name[0] == '#') continue; /* users.csv 헤더 줄 */
+        rows[n].user = u->name;
+        rows[n].balance = u->bank.balance;
+        rows[n].cash = u->bank.cash;
+        rows[n].loan = u->bank.loan;
+        n++;
+    }
+    int ok = ledger_checkpoint(rows, n);
+    free(rows);
+    return ok;
+}
+
+/* 함수 목적: 현재 계좌 표를 사람이 읽을 수 있는 CSV 로 내보냅니다.
+ *           형식: name,balance,cash,loan,last_interest_ts,log (log 는 비워 둠)
+ * 매개변수: path (NULL 이면 data/accounts.csv)
+ * 반환 값: 성공 여부
+ */
+int user_export_accounts_csv(const char *path) {
+    seed_defaults();
+    if (!path) path = ACCOUNTS_CSV_PATH;
+    static const char header[] = "# Username,Balance,Cash,Loan,Last_Login_Timestamp\n";
+    size_t cap = sizeof(header) + g_user_count * 128 + 1;
+    char *buf = malloc(cap);
+    if (!buf) return 0;
+    size_t len = sizeof(header) - 1;
+    memcpy(buf, header, len);
+    for (size_t i = 0; i < g_user_count; ++i) {
+        const User *u = user_slot(i);
+        if (u->name[0] == '#') continue; /* users.csv 헤더 줄 */
+        /* The log column stays empty for older readers; the full
          * transaction history is stored under data/txs/<username>.csv.
          */
-        fprintf(fp, "%s,%d,%d,%d,%ld,%s\n",
-            g_users[i].name,
-            g_users[i].bank.balance,
-            g_users[i].bank.cash,
-            g_users[i].bank.loan,
-            g_users[i].bank.last_interest_ts,
+        int n = snprintf(buf + len, cap - len, "%s,%d,%d,%d,%ld,%s\n",
+            u->name,
+            u->bank.balance,
+            u->bank.cash,
+            u->bank.loan,
+            u->bank.last_interest_ts,
             "");
+        if (n < 0 || (size_t)n >= cap - len) break;
+        len += (size_t)n;
     }
-    fclose(fp);
-    return found;
+    csv_ensure_dir("data");
+    int ok = csv_write_file(path, buf, len);
+    free(buf);
+    return ok;
 }
@@ -0,0 +1,280 @@
+/*
+ * 파일 목적: 사용자별 순자산의 증분 평가와 순자산 순위표 구현
+ * 작성자: 이현준
+ */
+#include "../../include/domain/valuation.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/core/rank_tree.h"
+#include "../../include/domain/stock.h"
+#include "../../include/domain/user.h"
+
+/* 종목별 주주 목록. 사용자 쪽에는 (종목, 목록 안 위치) 를 두어 찾지 않고 바로 고친다. */
+typedef struct Holders {
+    uint32_t *user;
+    int *qty;
+    int count;
+    int cap;
+} Holders;
+
+typedef struct Position {
+    int symbol;
+    int slot; /* Holders 안 위치 */
+} Position;
+
+typedef struct UserWorth {
+    long long base;   /* 예금 + 현금 - 대출 + 아이템 */
+    long long escrow; /* 매수 주문에 맡긴 돈 */
+    long long worth;  /* base + escrow + 주식 평가액 */
+    Position *pos;
+    int npos;
+    int pos_cap;
+    int ranked;       /* 학생이면 순위표에 오른다 */
+} UserWorth;
+
+static int        g_ready = 0;
+static int        g_symbols = 0;
+static int       *g_price = NULL;
+static Holders   *g_holders = NULL;
+static UserWorth *g_users = NULL;
+static uint32_t   g_user_cap = 0;
+static RankTree   g_rank;
+
+/* 함수 목적: 모든 상태를 풀고 처음으로 되돌립니다.
+ * 매개변수: 없음
+ * 반환 값: 없음
+ */
+static void release_all(void) {
+    for (int i = 0; i < g_symbols; ++i) {
+        free(g_holders[i].user);
+        free(g_holders[i].qty);
+    }
+    for (uint32_t u = 0; u < g_user_cap; ++u) free(g_users[u].pos);
+    free(g_holders);
+    free(g_price);
+    free(g_users);
+    rank_tree_free(&g_rank);
+    g_holders = NULL;
+    g_price = NULL;
+    g_users = NULL;
+    g_symbols = 0;
+    g_user_cap = 0;
+    g_ready = 0;
+}
+
+/* 함수 목적: 평가를 비우고 symbols 개 종목(가격 0)으로 다시 시작합니다.
+ * 매개변수: symbols
+ * 반환 값: 성공 여부
+ */
+int valuation_reset(int symbols) {
+    release_all();
+    rank_tree_init(&g_rank);
+    if (symbols < 0) symbols = 0;
+    g_price = calloc((size_t)symbols + 1, sizeof(int));
+    g_holders = calloc((size_t)symbols + 1, sizeof(Holders));
+    if (!g_price || !g_holders) {
+        release_all();
+        return 0;
+    }
+    g_symbols = symbols;
+    g_ready = 1;
+    return 1;
+}
+
+/* 함수 목적: 평가가 만들어졌는지 봅니다.
+ * 매개변수: 없음
+ * 반환 값: 만들어졌으면 1
+ */
+int valuation_ready(void) {
+    return g_ready;
+}
+
+/* 함수 목적: 첫 질의 때 지금 상태로 평가를 만듭니다.
+ * 매개변수: 없음
+ * 반환 값: 준비되었으면 1
+ */
+static int ensure_ready(void) {
+    if (!g_ready) stock_valuation_seed();
+    return g_ready;
+}
+
+/* 함수 목적: 사용자 칸을 id 까지 늘립니다.
+ * 매개변수: id
+ * 반환 값: 사용자 칸, 실패하면 NULL
+ */
+static UserWorth *user_slot(uint32_t id) {
+    if (id >= g_user_cap) {
+        uint32_t cap = g_user_cap ? g_user_cap : 64;
+        while (cap <= id) cap *= 2;
+        UserWorth *n = realloc(g_users, (size_t)cap * sizeof(UserWorth));
+        if (!n) return NULL;
+        memset(n + g_user_cap, 0, (size_t)(cap - g_user_cap) * sizeof(UserWorth));
+        g_users = n;
+        g_user_cap = cap;
+    }
+    return &g_users[id];
+}
+
+/* 함수 목적: 사용자의 순자산을 delta 만큼 바꾸고 순위표를 고칩니다.
+ * 매개변수: id, w, delta
+ * 반환 값: 없음
+ */
+static void add_worth(uint32_t id, UserWorth *w, long long delta) {
+    w->worth += delta;
+    if (w->ranked) rank_tree_set(&g_rank, id, w->worth);
+}
+
+/* 함수 목적: 사용자의 돈과 아이템을 다시 읽어 순자산에 반영합니다. 역할이 바뀌었으면
+ *           순위표에 넣거나 뺍니다.
+ * 매개변수: user
+ * 반환 값: 없음
+ */
+void valuation_touch(const User *user) {
+    if (!g_ready || !user) return;
+    UserWorth *w = user_slot(user->id);
+    if (!w) return;
+    long long base = (long long)user->bank.balance + user->bank.cash - user->bank.loan;
+    const Item *items = user_items_peek(user);
+    for (int i = 0; items && i < USER_ITEM_SLOTS; ++i) {
+        if (items[i].stock > 0) base += (long long)items[i].stock * items[i].cost;
+    }
+    int ranked = user->isadmin == STUDENT && user->name[0] != '#'; /* users.csv 헤더 줄은 빼고 */
+    if (w->ranked && !ranked) rank_tree_remove(&g_rank, user->id);
+    w->ranked = ranked;
+    long long delta = base - w->base;
+    w->base = base;
+    if (delta != 0 || (ranked && !rank_tree_contains(&g_rank, user->id))) add_worth(user->id, w, delta);
+}
+
+/* 함수 목적: 매수 주문에 맡긴 돈의 변화를 반영합니다. 맡긴 돈도 사용자 몫이라
+ *           통장에서 빠진 만큼 여기에 더해 순자산은 그대로 둡니다.
+ * 매개변수: user, delta
+ * 반환 값: 없음
+ */
+void valuation_escrow(uint32_t user, long long delta) {
+    if (!g_ready || delta == 0) return;
+    UserWorth *w = user_slot(user);
+    if (!w) return;
+    w->escrow += delta;
+    add_worth(user, w, delta);
+}
+
+/* 함수 목적: 보유 수량 변화를 반영합니다. 종목 주주 목록에서 사용자 자리를 고치고
+ *           0 주가 되면 목록에서 빼 다음 시세 변동 때 훑지 않게 합니다.
+ * 매개변수: user, symbol, delta_qty
+ * 반환 값: 없음
+ */
+void valuation_position(uint32_t user, int symbol, int delta_qty) {
+    if (!g_ready || symbol < 0 || symbol >= g_symbols || delta_qty == 0) return;
+    UserWorth *w = user_slot(user);
+    if (!w) return;
+    Holders *h = &g_holders[symbol];
+
+    int k = 0;
+    while (k < w->npos && w->pos[k].symbol != symbol) k++;
+    if (k == w->npos) {
+        if (w->npos == w->pos_cap) {
+            int cap = w->pos_cap ? w->pos_cap * 2 : 4;
+            Position *p = realloc(w->pos, (size_t)cap * sizeof(Position));
+            if (!p) return;
+            w->pos = p;
+            w->pos_cap = cap;
+        }
+        if (h->count == h->cap) {
+            int cap = h->cap ? h->cap * 2 : 16;
+            uint32_t *nu = realloc(h->user, (size_t)cap * sizeof(uint32_t));
+            if (nu) h->user = nu;
+            int *nq = realloc(h->qty, (size_t)cap * sizeof(int));
+            if (nq) h->qty = nq;
+            if (!nu || !nq) return;
+            h->cap = cap;
+        }
+        h->user[h->count] = user;
+        h->qty[h->count] = 0;
+        w->pos[w->npos].symbol = symbol;
+        w->pos[w->npos].slot = h->count++;
+        w->npos++;
+    }
+
+    int slot = w->pos[k].slot;
+    h->qty[slot] += delta_qty;
+    add_worth(user, w, (long long)delta_qty * g_price[symbol]);
+
+    if (h->qty[slot] == 0) {
+        /* 목록 끝의 주주를 빈 자리로 옮기고 그 사용자의 위치도 고친다 */
+        int last = --h->count;
+        if (slot != last) {
+            h->user[slot] = h->user[last];
+            h->qty[slot] = h->qty[last];
+            UserWorth *moved = &g_users[h->user[slot]];
+            for (int m = 0; m < moved->npos; ++m) {
+                if (moved->pos[m].symbol == symbol) {
+                    moved->pos[m].slot = slot;
+                    break;
+                }
+            }
+        }
+        w->pos[k] = w->pos[--w->npos];
+    }
+}
+
+/* 함수 목적: 종목 가격 변화를 반영합니다. 그 종목 주주만 다시 평가합니다.
+ * 매개변수: symbol, price
+ * 반환 값: 없음
+ */
+void valuation_price(int symbol, int price) {
+    if (!g_ready || symbol < 0 || symbol >= g_symbols) return;
+    long long diff = (long long)price - g_price[symbol];
+    g_price[symbol] = price;
+    if (diff == 0) return;
+    const Holders *h = &g_holders[symbol];
+    for (int i = 0; i < h->count; ++i) {
+        add_worth(h->user[i], &g_users[h->user[i]], diff * h->qty[i]);
+    }
+}
+
+/* 함수 목적: 사용자의 순자산을 알려줍니다.
+ * 매개변수: user
+ * 반환 값: 순자산, 모르는 사용자면 -1
+ */
+long long valuation_net_worth(const User *user) {
+    if (!user || !ensure_ready() || user->id >= g_user_cap) return -1;
+    return g_users[user->id].worth;
+}
+
+/* 함수 목적: 학생 중 사용자의 순위를 알려줍니다.
+ * 매개변수: user
+ * 반환 값: 0부터 센 순위, 순위표에 없으면 -1
+ */
+long valuation_rank(const User *user) {
+    if (!user || !ensure_ready()) return -1;
+    return rank_tree_rank(&g_rank, user->id);
+}
+
+/* 함수 목적: 순자산 상위 k 명을 out 에 담습니다.
+ * 매개변수: out, k
+ * 반환 값: 담은 수
+ */
+int valuation_top(NetWorthEntry *out, int k) {
+    if (!out || k <= 0 || !ensure_ready()) return 0;
+    int n = 0;
+    uint32_t id;
+    long long worth;
+    while (n < k && rank_tree_at(&g_rank, (uint32_t)n, &id, &worth)) {
+        out[n].user = user_at(id);
+        out[n].worth = worth;
+        n++;
+    }
+    return n;
+}
+
+/* 함수 목적: 순위표에 오른 사용자 수를 알려줍니다.
+ * 매개변수: 없음
+ * 반환 값: 사용자 수
+ */
+size_t valuation_ranked(void) {
+    if (!ensure_ready()) return 0;
+    return g_rank.count;
+}
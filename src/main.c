@@ -11,7 +11,6 @@
  */
 int main(void) {
     app_bootstrap();
-    app_shutdown();
-    return 0;
+    return app_shutdown() ? 0 : 1;
 }
     
\ No newline at end of file
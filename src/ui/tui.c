@@ -8,6 +8,9 @@
 #include <string.h>
 #include <time.h>
 
+#include "../../include/core/csv.h"
+#include "../../include/core/scheduler.h"
+#include "../../include/domain/state.h"
 #include "../../include/domain/user.h"
 #include "../../include/ui/tui_login.h"
 #include "../../include/ui/tui_ncurses.h"
@@ -21,6 +24,8 @@
 void tui_run() {
     tui_ncurses_init();
     srand((unsigned)time(NULL));
+    /* 화면 코드는 키를 기다릴 때(tui_ncurses_getch)만 세계 잠금을 놓는다 */
+    sched_lock();
 
     while (1) {
         User *user = tui_login_flow();
@@ -32,10 +37,14 @@ void tui_run() {
         } else {
             tui_student_loop(user);
         }
+        /* 로그아웃 시 모아 둔 쓰기 버퍼를 디스크로 내보내고 스냅샷을 남긴다 */
+        csv_flush_all();
+        state_checkpoint();
         tui_ncurses_toast("Logging out...", 800);
         clear();
         refresh();
     }
 
+    sched_unlock();
     tui_ncurses_shutdown();
 }
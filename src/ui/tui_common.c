@@ -119,3 +119,13 @@ void tui_common_print_multiline(WINDOW *win, int row, int col, const char *const
     }
     wrefresh(win);
 }
+
+/* 함수 목적: 목록이 창보다 길 때, 강조된 줄이 보이도록 맨 위에 그릴 항목 번호를 정한다.
+ *           강조 줄이 아래로 벗어나면 그 줄이 마지막 줄이 되게 내린다.
+ * 매개변수: highlight (강조된 항목 번호), visible (창에 그릴 수 있는 줄 수)
+ * 반환 값: 맨 위에 그릴 항목 번호
+ */
+int tui_common_list_top(int highlight, int visible) {
+    if (visible < 1) visible = 1;
+    return highlight >= visible ? highlight - visible + 1 : 0;
+}
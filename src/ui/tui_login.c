@@ -10,11 +10,13 @@
 #include <time.h>
 
 #include "../../include/domain/user.h"
+#include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
 #include "../../include/domain/economy.h"
+#include "../../include/domain/stock.h"
 #include "../../include/ui/tui_common.h"
 #include "../../include/ui/tui_ncurses.h"
 
-static void user_stock_load_holdings(User *user);
 /* 함수 목적: 로그인 화면에서 환영 메시지와 메뉴를 그리는 함수
  * 매개변수: highlight, status_line
  * 반환 값: 없음
@@ -70,7 +72,7 @@ static RankEnum prompt_role(WINDOW *form) {
         }
         mvwprintw(form, 5, 2, "Select role (arrow keys, Enter)");
         wrefresh(form);
-        int ch = wgetch(form);
+        int ch = tui_ncurses_getch(form);
         if (ch == KEY_UP || ch == KEY_LEFT) {
             highlight = (highlight + 1) % 2;
         } else if (ch == KEY_DOWN || ch == KEY_RIGHT) {
@@ -104,8 +106,8 @@ static void trim_whitespace(char *s) {
 }
 
 enum {
-    NAME_FIELD_CAP = sizeof(((User *)0)->name),
-    PW_FIELD_CAP = sizeof(((User *)0)->pw)
+    NAME_FIELD_CAP = USER_NAME_MAX,
+    PW_FIELD_CAP = USER_PW_MAX
 };
 
 /* 함수 목적: 로그인을 진행하는 함수
@@ -139,23 +141,8 @@ static User *prompt_login(void) {
     User *user = user_lookup(username);
 
     if (user) {
-    user_stock_load_holdings(user);
-}
-    /* Apply accumulated hourly interest since last_interest_ts */
-    if (user) {
-        long now = (long)time(NULL);
-        if (user->bank.last_interest_ts == 0) {
-            user->bank.last_interest_ts = now; /* initialize without applying retroactive interest */
-        } else {
-            long diff = now - user->bank.last_interest_ts;
-            int hours = (int)(diff / 3600);
-            if (hours > 0) {
-                econ_apply_hourly_interest(user, hours);
-                user->bank.last_interest_ts = now;
-                /* persist updated balance/interest timestamp */
-                user_update_balance(user->name, user->bank.balance);
-            }
-        }
+        /* 미션 완료, 보유 주식 등 사용자별 파일은 로그인할 때 처음 읽는다 */
+        user_hydrate(user);
     }
     tui_common_destroy_box(form);
     return user;
@@ -193,11 +180,9 @@ static void prompt_register(void) {
     }
     RankEnum role = prompt_role(form);
     User newbie = {0};
-    snprintf(newbie.name, sizeof(newbie.name), "%s", username);
-    snprintf(newbie.id, sizeof(newbie.id), "%s", username);
-    snprintf(newbie.pw, sizeof(newbie.pw), "%s", password);
+    newbie.name = username; /* user_register copies both strings */
+    newbie.pw = password;
     newbie.isadmin = role;
-    snprintf(newbie.bank.name, sizeof(newbie.bank.name), "%s", username);
     newbie.bank.balance = role == STUDENT ? 1000 : 5000;
     newbie.bank.cash = 0;
     newbie.bank.loan = 0;
@@ -205,27 +190,16 @@ static void prompt_register(void) {
     if (user_register(&newbie)) {
         tui_ncurses_toast("Registration complete! Please log in", 1200);
         /* persist only on successful registration */
-        FILE *fp = fopen("data/users.csv", "a");
-        if (fp) {
-            fprintf(fp, "\n%s,%s,%d", username, password, (int)role);
-            fclose(fp);
-        }
-        FILE *fp1 = fopen("data/accounts.csv", "a");
-        if (fp1) {
-            /* persist format: name,balance,cash,loan,last_interest_ts,log */
-            long ts = (long)time(NULL);
-            fprintf(fp1, "\n%s,%d,%d,%d,%ld,", username, newbie.bank.balance, newbie.bank.cash, newbie.bank.loan, ts);
-            fclose(fp1);
-        }
+        char row[256];
+        int n = snprintf(row, sizeof(row), "\n%s,%s,%d", username, password, (int)role);
+        if (n > 0 && (size_t)n < sizeof(row)) csv_append_raw("data/users.csv", row, (size_t)n);
+        /* 계좌는 user_register 가 data/accounts.dat 슬롯으로 저장한다 */
 
         {
             char path[256];
             snprintf(path, sizeof(path), "data/stocks/%s.csv", username);
-            FILE *fp_stocks = fopen(path, "w");
-            if (fp_stocks) {
-                // 일단 빈 파일로 생성만 해둠
-                fclose(fp_stocks);
-            }
+            // 일단 빈 파일로 생성만 해둠
+            csv_write_file(path, "", 0);
         }
     
     } else {
@@ -240,7 +214,7 @@ User *tui_login_flow(void) {
     const char *status = "";
     while (1) {
         draw_welcome(selection, status);
-        int ch = getch();
+        int ch = tui_ncurses_getch(stdscr);
         if (ch == KEY_UP) {
             selection = (selection - 1 + menu_count) % menu_count;
         } else if (ch == KEY_DOWN) {
@@ -263,50 +237,3 @@ User *tui_login_flow(void) {
         }
     }
 }
-
-/* data/stocks/(username).csv 에 저장된
- * "종목명,보유량" 들을 user->holdings[] 로 불러온다
- */
-/* 함수 목적: 사용자의 주식 정보를 불러오는 함수
- * 매개변수: user
- * 반환 값: 없음
- */
-static void user_stock_load_holdings(User *user) {
-    if (!user) return;
-
-    char path[256];
-    snprintf(path, sizeof(path), "data/stocks/%s.csv", user->name);
-
-    FILE *fp = fopen(path, "r");
-    if (!fp) {
-        return;  // 파일 없으면 보유량 없음
-    }
-
-    user->holding_count = 0;  // 초기화
-
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        // 공백/개행 제거
-        char *p = strtok(line, ", \t\r\n");
-        if (!p) continue;
-
-        char symbol[64];
-        snprintf(symbol, sizeof(symbol), "%s", p);
-
-        p = strtok(NULL, ", \t\r\n");
-        if (!p) continue;
-
-        int qty = atoi(p);
-        if (qty <= 0) continue;
-
-        if (user->holding_count >= MAX_HOLDINGS)
-            break;
-
-        StockHolding *h = &user->holdings[user->holding_count++];
-        memset(h, 0, sizeof(*h));
-        snprintf(h->symbol, sizeof(h->symbol), "%s", symbol);
-        h->qty = qty;
-    }
-
-    fclose(fp);
-}
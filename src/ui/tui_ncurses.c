@@ -9,6 +9,8 @@
 #include <string.h>
 #include <time.h>
 
+#include "../../include/core/scheduler.h"
+
 static WINDOW *g_main_window = NULL;
 
 /* 함수 목적: ncurses 초기화 및 설정을 수행합니다.
@@ -122,7 +124,7 @@ int tui_ncurses_prompt_line(WINDOW *win, int row, int col, const char *label, ch
 
     int index = 0;
     int ch;
-    while ((ch = wgetch(win)) != '\n' && ch != '\r') {
+    while ((ch = tui_ncurses_getch(win)) != '\n' && ch != '\r') {
         if (ch == KEY_BACKSPACE || ch == 127) {
             if (index > start_index) {
                 index--;
@@ -176,6 +178,20 @@ int tui_ncurses_prompt_number(WINDOW *context, const char *label, int *out_value
     return 1;
 }
 
+/* 함수 목적: 키 입력을 기다립니다. 기다리는 동안에는 세계 잠금을 풀어 스케줄러
+ *           작업(주가, 이자, 자정 QOTD 교체 등)이 돌 수 있게 하고, 키가 들어오면 다시 잡습니다.
+ *           스케줄러 스레드가 없으면 밀린 작업을 여기서 대신 실행합니다.
+ * 매개변수: win
+ * 반환 값: 입력된 키
+ */
+int tui_ncurses_getch(WINDOW *win) {
+    if (!sched_running()) sched_run_due((long)time(NULL));
+    sched_unlock();
+    int ch = wgetch(win);
+    sched_lock();
+    return ch;
+}
+
 /* 함수 목적: 토스트 메시지를 일정 시간 동안 표시합니다.
  * 매개변수: message, delay_ms
  * 반환 값: 없음
@@ -4,13 +4,237 @@
  */
 #include "../../include/ui/tui_stock.h"
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../../include/domain/stock.h"
 #include "../../include/domain/user.h"
 #include "../../include/ui/tui_common.h"
 #include "../../include/ui/tui_ncurses.h"
 
+#define STOCK_ORDERS_MAX 64
+
+/* 함수 목적: 사용자가 가진 종목 수량을 구한다.
+ * 매개변수: user, symbol
+ * 반환 값: 보유 수량
+ */
+static int owned_qty(const User *user, const char *symbol) {
+    const UserHoldings *held = user_holdings_peek(user);
+    for (int i = 0; held && i < held->count; ++i) {
+        if (strncmp(held->items[i].symbol, symbol, sizeof(held->items[i].symbol)) == 0) {
+            return held->items[i].qty;
+        }
+    }
+    return 0;
+}
+
+/* 함수 목적: 장바구니에 담긴 다리들의 예상 예금 변화를 구한다. (담을 때 가격 기준)
+ * 매개변수: basket
+ * 반환 값: 매도 대금 - 매수 대금
+ */
+long tui_stock_basket_net(const TuiStockBasket *basket) {
+    long net = 0;
+    for (int i = 0; basket && i < basket->count; ++i) {
+        long amount = (long)basket->quoted[i] * basket->legs[i].qty;
+        net += basket->legs[i].is_buy ? -amount : amount;
+    }
+    return net;
+}
+
+/* 함수 목적: 거래 수량을 입력받아 바로 거래하거나, 장바구니 모드면 다리로 담는다.
+ *           m 은 예금(장바구니 예상 변화 포함)으로 살 수 있는 최대, a 는 보유 전량이다.
+ * 매개변수: win, user, quote, is_buy, basket
+ * 반환 값: 없음
+ */
+void tui_stock_ticket(WINDOW *win, User *user, const StockQuote *quote, int is_buy, TuiStockBasket *basket) {
+    if (!win || !user || !quote) {
+        return;
+    }
+    char buf[16] = {0};
+    int row = getmaxy(win) - 2;
+    if (!tui_ncurses_prompt_line(win, row, 2, is_buy ? "Buy qty (m = max)" : "Sell qty (a = all)", buf, sizeof(buf), 0)) {
+        return;
+    }
+    int queued = basket && basket->active;
+    int qty;
+    if (buf[0] == '\0') {
+        qty = 1;
+    } else if (is_buy && (buf[0] == 'm' || buf[0] == 'M')) {
+        long budget = user->bank.balance + (queued ? tui_stock_basket_net(basket) : 0);
+        qty = quote->current_price > 0 && budget > 0 ? (int)(budget / quote->current_price) : 0;
+    } else if (!is_buy && (buf[0] == 'a' || buf[0] == 'A')) {
+        qty = owned_qty(user, quote->name);
+        for (int i = 0; queued && i < basket->count; ++i) {
+            if (!basket->legs[i].is_buy && strcmp(basket->legs[i].symbol, quote->name) == 0) qty -= basket->legs[i].qty;
+        }
+    } else {
+        qty = atoi(buf);
+    }
+    if (qty <= 0) {
+        tui_ncurses_toast("Nothing to trade", 700);
+        return;
+    }
+
+    char msg[96];
+    if (queued) {
+        if (basket->count >= STOCK_TICKET_MAX_LEGS) {
+            tui_ncurses_toast("Basket is full", 700);
+            return;
+        }
+        StockLeg *leg = &basket->legs[basket->count];
+        snprintf(leg->symbol, sizeof(leg->symbol), "%s", quote->name);
+        leg->qty = qty;
+        leg->is_buy = is_buy;
+        basket->quoted[basket->count++] = quote->current_price;
+        snprintf(msg, sizeof(msg), "Queued %s %d %s", is_buy ? "buy" : "sell", qty, quote->name);
+        tui_ncurses_toast(msg, 700);
+        return;
+    }
+
+    StockLeg leg;
+    snprintf(leg.symbol, sizeof(leg.symbol), "%s", quote->name);
+    leg.qty = qty;
+    leg.is_buy = is_buy;
+    if (stock_trade_ticket(user->name, &leg, 1, NULL)) {
+        snprintf(msg, sizeof(msg), "%s %d %s", is_buy ? "Bought" : "Sold", qty, quote->name);
+    } else {
+        snprintf(msg, sizeof(msg), is_buy ? "Buy failed" : "Sell failed");
+    }
+    tui_ncurses_toast(msg, 800);
+}
+
+/* 함수 목적: 장바구니 전체를 거래표 하나로 보낸다. 하나라도 안 되면 아무것도 거래하지 않고
+ *           장바구니를 그대로 둔다.
+ * 매개변수: user, basket
+ * 반환 값: 없음
+ */
+void tui_stock_basket_execute(User *user, TuiStockBasket *basket) {
+    if (!user || !basket || basket->count == 0) {
+        tui_ncurses_toast("Basket is empty", 700);
+        return;
+    }
+    int net = 0;
+    if (!stock_trade_ticket(user->name, basket->legs, basket->count, &net)) {
+        tui_ncurses_toast("Basket rejected - nothing traded", 900);
+        return;
+    }
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Basket done: %d legs, %+dCr", basket->count, net);
+    basket->count = 0;
+    tui_ncurses_toast(msg, 900);
+}
+
+/* 함수 목적: 장바구니 상태 한 줄을 그린다.
+ * 매개변수: win, row, basket
+ * 반환 값: 없음
+ */
+void tui_stock_basket_draw(WINDOW *win, int row, const TuiStockBasket *basket) {
+    if (!win || !basket) {
+        return;
+    }
+    if (!basket->active) {
+        mvwprintw(win, row, 2, "Basket off (t to queue trades)");
+        return;
+    }
+    mvwprintw(win, row, 2, "Basket: %d legs, est %+ldCr (e execute / c clear / t off)", basket->count,
+              tui_stock_basket_net(basket));
+}
+
+/* 함수 목적: 지정가 주문의 가격과 수량을 입력받는다.
+ * 매개변수: win, out_price, out_qty
+ * 반환 값: 둘 다 입력했으면 1
+ */
+static int prompt_limit(WINDOW *win, int *out_price, int *out_qty) {
+    if (!tui_ncurses_prompt_number(win, "Limit price", out_price) || *out_price <= 0) {
+        return 0;
+    }
+    return tui_ncurses_prompt_number(win, "Quantity", out_qty) && *out_qty > 0;
+}
+
+/* 함수 목적: 지정가 주문을 내고 결과를 알린다.
+ * 매개변수: win, user, symbol, is_buy
+ * 반환 값: 없음
+ */
+static void place_limit(WINDOW *win, User *user, const char *symbol, int is_buy) {
+    int price = 0, qty = 0;
+    if (!prompt_limit(win, &price, &qty)) {
+        return;
+    }
+    int filled = 0;
+    if (!stock_order_place(user->name, symbol, is_buy, price, qty, &filled)) {
+        tui_ncurses_toast("Order rejected", 700);
+        return;
+    }
+    char msg[64];
+    if (filled >= qty) {
+        snprintf(msg, sizeof(msg), "Filled %d", filled);
+    } else {
+        snprintf(msg, sizeof(msg), "Filled %d, %d resting", filled, qty - filled);
+    }
+    tui_ncurses_toast(msg, 900);
+}
+
+/* 함수 목적: 내 지정가 주문 목록을 보여주고 취소/정정을 처리한다.
+ * 매개변수: user
+ * 반환 값: 없음
+ */
+static void show_my_orders(User *user) {
+    int height = LINES - 6;
+    int width = COLS - 10;
+    WINDOW *win = tui_common_create_box(height, width, 3, 5, "My Orders (c cancel / r replace / q close)");
+    keypad(win, TRUE);
+    StockOrder orders[STOCK_ORDERS_MAX];
+    int highlight = 0;
+    while (1) {
+        int count = stock_order_list(user->name, orders, STOCK_ORDERS_MAX);
+        if (highlight >= count) {
+            highlight = count > 0 ? count - 1 : 0;
+        }
+        werase(win);
+        box(win, 0, 0);
+        mvwprintw(win, 0, 2, " My Orders ");
+        if (count == 0) {
+            mvwprintw(win, 1, 2, "No open orders");
+        }
+        int visible = height - 4;
+        int top = tui_common_list_top(highlight, visible);
+        for (int i = top; i < count && i < top + visible; ++i) {
+            if (i == highlight) {
+                wattron(win, A_REVERSE);
+            }
+            mvwprintw(win, 1 + i - top, 2, "%-12s %s %4d x%d", orders[i].symbol, orders[i].is_buy ? "BUY " : "SELL",
+                      orders[i].price, orders[i].leaves);
+            if (i == highlight) {
+                wattroff(win, A_REVERSE);
+            }
+        }
+        wrefresh(win);
+        int ch = tui_ncurses_getch(win);
+        if (ch == 'q' || ch == 27) {
+            break;
+        }
+        if (count == 0) {
+            continue;
+        }
+        if (ch == KEY_UP) {
+            highlight = (highlight - 1 + count) % count;
+        } else if (ch == KEY_DOWN) {
+            highlight = (highlight + 1) % count;
+        } else if (ch == 'c' || ch == 'C') {
+            tui_ncurses_toast(stock_order_cancel(user->name, orders[highlight].id) ? "Order canceled" : "Cancel failed", 700);
+        } else if (ch == 'r' || ch == 'R') {
+            int price = 0, qty = 0;
+            if (prompt_limit(win, &price, &qty)) {
+                tui_ncurses_toast(stock_order_replace(user->name, orders[highlight].id, price, qty) ? "Order replaced"
+                                                                                                   : "Replace failed",
+                                  700);
+            }
+        }
+    }
+    tui_common_destroy_box(win);
+}
+
 /* 함수 목적: 주식 시장 UI 표시 및 거래 처리
  * 매개변수: user
  * 반환 값: 없음
@@ -19,57 +243,90 @@ void tui_stock_show_market(User *user) {
     if (!user) {
         return;
     }
-    Stock stocks[16];
-    int count = 0;
-    if (!stock_list(stocks, &count) || count == 0) {
+    const StockQuotes *q = stock_quotes_acquire();
+    if (!q || q->count == 0) {
+        stock_quotes_release(q);
         tui_ncurses_toast("No stocks available for trading", 800);
         return;
     }
     int height = LINES - 4;
     int width = COLS - 6;
-    WINDOW *win = tui_common_create_box(height, width, 2, 3, "Stock Market (Enter buy / s sell / q close)");
+    WINDOW *win = tui_common_create_box(height, width, 2, 3, "Stock Market (Enter buy / s sell / t basket / b bid / a ask / o orders / q close)");
     int highlight = 0;
+    int dirty = 1;
+    TuiStockBasket basket;
+    memset(&basket, 0, sizeof(basket));
     keypad(win, TRUE);
+    /* 키가 없어도 1초마다 깨어나 새 시세판이 걸렸는지만 본다 */
+    wtimeout(win, 1000);
     while (1) {
-        werase(win);
-        box(win, 0, 0);
-        mvwprintw(win, 0, 2, " Stock Market - Deposit:%dCr Cash:%dCr ", user->bank.balance, user->bank.cash);
-        int visible = height - 4;
-        for (int i = 0; i < count && i < visible; ++i) {
-            if (i == highlight) {
-                wattron(win, A_REVERSE);
+        if (stock_quotes_version() != q->version) {
+            const StockQuotes *next = stock_quotes_acquire();
+            if (next) {
+                stock_quotes_release(q);
+                q = next;
+                dirty = 1;
             }
-            mvwprintw(win, 1 + i, 2, "%s Price:%4d News:%s", stocks[i].name, stocks[i].current_price, stocks[i].news);
-            if (i == highlight) {
-                wattroff(win, A_REVERSE);
+        }
+        int count = q->count;
+        if (dirty) {
+            werase(win);
+            box(win, 0, 0);
+            mvwprintw(win, 0, 2, " Stock Market - Deposit:%dCr Cash:%dCr ", user->bank.balance, user->bank.cash);
+            int visible = height - 5;
+            int top = tui_common_list_top(highlight, visible);
+            for (int i = top; i < count && i < top + visible; ++i) {
+                const StockQuote *sq = &q->quotes[i];
+                if (i == highlight) {
+                    wattron(win, A_REVERSE);
+                }
+                int bid = 0, ask = 0;
+                stock_book_top(sq->name, &bid, &ask);
+                mvwprintw(win, 1 + i - top, 2, "%s Price:%4d Bid:%4d Ask:%4d News:%s", sq->name, sq->current_price, bid,
+                          ask, sq->news);
+                if (i == highlight) {
+                    wattroff(win, A_REVERSE);
+                }
+            }
+            int row = height - 3;
+            tui_stock_basket_draw(win, row - 1, &basket);
+            mvwprintw(win, row, 2, "Holdings:");
+            const UserHoldings *held = user_holdings_peek(user);
+            for (int i = 0; held && i < held->count && i < 3; ++i) {
+                mvwprintw(win, row, 14 + i * 12, "%s x%d", held->items[i].symbol, held->items[i].qty);
             }
+            wrefresh(win);
+            dirty = 0;
         }
-        int row = height - 3;
-        mvwprintw(win, row, 2, "Holdings:");
-        for (int i = 0; i < user->holding_count && i < 3; ++i) {
-            mvwprintw(win, row, 14 + i * 12, "%s x%d", user->holdings[i].symbol, user->holdings[i].qty);
+        int ch = tui_ncurses_getch(win);
+        if (ch == ERR) {
+            continue;  // 시간만 지났다: 시세판이 그대로면 다시 그리지 않는다
         }
-        wrefresh(win);
-        int ch = wgetch(win);
+        dirty = 1;
         if (ch == KEY_UP) {
             highlight = (highlight - 1 + count) % count;
         } else if (ch == KEY_DOWN) {
             highlight = (highlight + 1) % count;
         } else if (ch == '\n' || ch == '\r') {
-            if (stock_deal(user->name, stocks[highlight].name, 1, 1)) {
-                tui_ncurses_toast("Buy complete", 700);
-            } else {
-                tui_ncurses_toast("Buy failed", 700);
-            }
+            tui_stock_ticket(win, user, &q->quotes[highlight], 1, &basket);
         } else if (ch == 's' || ch == 'S') {
-            if (stock_deal(user->name, stocks[highlight].name, 1, 0)) {
-                tui_ncurses_toast("Sell complete", 700);
-            } else {
-                tui_ncurses_toast("Sell failed", 700);
-            }
+            tui_stock_ticket(win, user, &q->quotes[highlight], 0, &basket);
+        } else if (ch == 't' || ch == 'T') {
+            basket.active = !basket.active;
+        } else if (ch == 'e' || ch == 'E') {
+            tui_stock_basket_execute(user, &basket);
+        } else if (ch == 'c' || ch == 'C') {
+            basket.count = 0;
+        } else if (ch == 'b' || ch == 'B') {
+            place_limit(win, user, q->quotes[highlight].name, 1);
+        } else if (ch == 'a' || ch == 'A') {
+            place_limit(win, user, q->quotes[highlight].name, 0);
+        } else if (ch == 'o' || ch == 'O') {
+            show_my_orders(user);
         } else if (ch == 'q' || ch == 27) {
             break;
         }
     }
     tui_common_destroy_box(win);
+    stock_quotes_release(q);
 }
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <time.h>
 #include <ctype.h>
+#include <math.h>
 #ifdef _WIN32
 #include <process.h> /* _getpid */
 #define GETPID() _getpid()
@@ -28,13 +29,19 @@
 #include "../../include/ui/tui_ncurses.h"
 #include "../../include/ui/tui_stock.h"
 #include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
+#include "../../include/core/csv_index.h"
 #include "../../include/domain/notification.h"
 #include "../../include/domain/account.h"
 #include "../../include/domain/message.h"
 #include "../../include/domain/qotd.h"
+#include "../../include/domain/valuation.h"
+#include "../../include/domain/indicators.h"
 
 // 최대 거래 내역 개수
 #define ACCOUNT_STATS_MAX_TX 256
+// 순자산 순위표에 보여줄 인원
+#define NET_WORTH_TOP 10
 
 static void handle_class_seats_view(User *user);
 static void handle_tutorial_view(User *user);
@@ -43,96 +50,26 @@ static void handle_mission_play_math(User *user, Mission *m);
 static void handle_stocks_view(User *user);
 static void handle_account_statistics(User *user);
 static void handle_transactions_view(User *user);
-static void handle_stock_graph_view(const Stock *stock);
-
-/* 함수 목적: user 에게 미션이 있는지 확인한다.
- * 매개변수: user, mission_id
- * 반환 값: 미션 존재 : 1 / 미션 부재 : 0
- */
-static int user_has_mission(User *user, int mission_id) {
-    if (!user) return 0;
-    for (int i = 0; i < user->mission_count; ++i) {
-        if (user->missions[i].id == mission_id) return 1;
-    }
-    return 0;
-}
+static void handle_net_worth_ranking(User *user);
+static void handle_stock_graph_view(const StockQuote *stock);
 
 /* 함수 목적: user 의 기본값들을 재설정한다.
  * 매개변수: user
  * 반환 값: 없음
  */
 static void ensure_student_seed(User *user) {
-    if (!user || user->mission_count > 0) {
+    if (!user || user->total_missions > 0) {
         return;
     }
     /* reload mission catalog from disk at each login/start of student UI */
     mission_refresh_catalog();
 
-    /* try to load persisted missions from CSV first */
-    mission_load_user(user->name, user);
-    Mission open[8];
-    int count = 0;
-    if (mission_list_open(open, &count)) {
-        for (int i = 0; i < count && i < 4; ++i) {
-            /* avoid assigning a mission the user already has (prevents duplicates) */
-            if (!user_has_mission(user, open[i].id)) {
-                admin_assign_mission(user->name, &open[i]);
-            }
-        }
-    }
-    /* ensure per-user tx file exists and set bank metadata */
-    snprintf(user->bank.name, sizeof(user->bank.name), "%s", user->name);
-    // 로그 버퍼가 비어 있으면 초기 메시지 넣기 (원하면 생략해도 됨)
-    if (user->bank.log[0] == '\0') {
-        snprintf(
-            user->bank.log,
-            sizeof(user->bank.log),
-            "== Transaction log for %s ==\n",
-            user->name);
-    }
-    }
-
-// --- QOTD viewer integration ---
-static char *qotd_solved_users[256];
-static int qotd_solved_count = 0;
-
-/* 함수 목적: qotd 가 해결되었는지 확인한다.
- * 매개변수: name
- * 반환 값: 해결 : 1 / 미해결 : 0
- */
-static int qotd_is_solved(const char *name) {
-    if (!name) return 0;
-    for (int i = 0; i < qotd_solved_count; ++i) {
-        if (qotd_solved_users[i] && strcmp(qotd_solved_users[i], name) == 0) return 1;
-    }
-    return 0;
-}
-
-
-/* 함수 목적: 문제풀이 진행도를 초기화한다.
- * 매개변수: 없음
- * 반환 값: 없음
- */
-static void qotd_runtime_clear(void) {
-    for (int i = 0; i < qotd_solved_count; ++i) {
-        if (qotd_solved_users[i]) free(qotd_solved_users[i]);
-        qotd_solved_users[i] = NULL;
-    }
-    qotd_solved_count = 0;
-}
-
-/* 함수 목적: 푼 사람들을 런타임 캐시에 표시한다.
- * 매개변수: name
- * 반환 값: 없음
- */
-static void qotd_runtime_mark_solved(const char *name) {
-    if (!name || qotd_solved_count >= (int)(sizeof(qotd_solved_users)/sizeof(qotd_solved_users[0]))) return;
-    for (int i = 0; i < qotd_solved_count; ++i) {
-        if (qotd_solved_users[i] && strcmp(qotd_solved_users[i], name) == 0) return;
-    }
-    qotd_solved_users[qotd_solved_count++] = strdup(name);
+    /* every user is assigned the whole catalog; completions load once per session */
+    user_hydrate(user);
+    user->total_missions = mission_catalog_count();
 }
 
+// --- QOTD viewer integration ---
 /* QOTD viewer:
  * - open with 'd' from student menu
  * - shows question and choices
@@ -147,26 +84,7 @@ static void qotd_runtime_mark_solved(const char *name) {
  */
 static void handle_qotd_view(User *user) {
     if (!user) return;
-        /* load today's solved users into runtime cache */
-    char today[32];
-    time_t tnow = time(NULL);
-    struct tm *tmnow = localtime(&tnow);
-    if (tmnow) {
-        strftime(today, sizeof(today), "%Y-%m-%d", tmnow);
-        qotd_runtime_clear();
-        char **users = NULL;
-        int ucount = 0;
-        if (qotd_get_solved_users_for_date(today, &users, &ucount)) {
-            for (int i = 0; i < ucount; ++i) {
-                if (users[i]) qotd_runtime_mark_solved(users[i]);
-                free(users[i]);
-                users[i] = NULL;
-            }
-            free(users);
-            users = NULL;
-        }
-    }
-    if (qotd_is_solved(user->name)) {
+    if (qotd_solved_today(user->name)) {
         tui_ncurses_toast("QOTD already solved", 900);
         return;
     }
@@ -207,7 +125,7 @@ static void handle_qotd_view(User *user) {
         mvwprintw(win, height - 2, 2, ""); /* reserved for messages (Try again etc) */
         wrefresh(win);
 
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (ch == 'q' || ch == 27) {
             break;
         }
@@ -217,18 +135,13 @@ static void handle_qotd_view(User *user) {
                 /* grant cash directly and persist tx (award to on-hand cash) */
                 int ok = account_grant_cash(user, reward, "QOTD_REWARD");
                 if (ok) {
-                    /* persist solved entry for today */
-                    if (tmnow) {
-                        /* persist solved entry via domain API */
-                        qotd_mark_solved(user->name);
-                    }
-                    /* mark in-memory runtime cache so UI hides QOTD */
-                    qotd_runtime_mark_solved(user->name);
-                    /* persist balance to accounts CSV as other flows do */
+                    /* persist solved entry via domain API (also hides today's QOTD in the UI) */
+                    qotd_mark_solved(user->name);
+                    /* persist balance to the account store as other flows do */
                     user_update_balance(user->name, user->bank.balance);
                     mvwprintw(win, height - 2, 2, "Correct! +%dCr awarded. Press any key.", reward);
                     wrefresh(win);
-                    wgetch(win);
+                    tui_ncurses_getch(win);
                     tui_ncurses_toast("Correct! Reward granted", 1000);
                     running = 0;
                     break;
@@ -259,15 +172,17 @@ static void handle_qotd_view(User *user) {
  * 반환 값: 없음
  */
 static void render_mission_preview(WINDOW *win, const User *user) {
-    mvwprintw(win, 1, 2, "Completed %d of %d missions", user->completed_missions, user->mission_count);
+    int mission_count = mission_catalog_count();
+    mvwprintw(win, 1, 2, "Completed %d of %d missions", user->completed_missions, mission_count);
     int row = 2;
-    for (int i = 0; i < user->mission_count && row < getmaxy(win) - 1; ++i, ++row) {
-        const Mission *mission = &user->missions[i];
-        mvwprintw(win, row, 2, "#%d %-12s [%s] +%dCr", mission->id, mission->name,
-              mission->completed ? "Completed" : "In Progress", mission->reward);
+    for (int i = 0; i < mission_count && row < getmaxy(win) - 1; ++i, ++row) {
+        Mission mission;
+        if (!mission_user_at(user, i, &mission)) break;
+        mvwprintw(win, row, 2, "#%d %-12s [%s] +%dCr", mission.id, mission.name,
+              mission.completed ? "Completed" : "In Progress", mission.reward);
     }
         /* show QOTD hint only if the current user hasn't solved it yet */
-    if (user && !qotd_is_solved(user->name)) {
+    if (user && !qotd_solved_today(user->name)) {
         QOTD tq = {0};
         if (qotd_get_today(&tq)) {
             mvwprintw(win, getmaxy(win) - 4, 2, "QOTD: %s", tq.name);
@@ -280,7 +195,7 @@ static void render_mission_preview(WINDOW *win, const User *user) {
         }
     }
 
-    if (user->mission_count == 0 && qotd_is_solved(user->name)) {
+    if (mission_count == 0 && qotd_solved_today(user->name)) {
         mvwprintw(win, row, 2, "No assigned missions.");
     }
     wrefresh(win);
@@ -308,9 +223,6 @@ static void render_shop_preview(WINDOW *win) {
     wrefresh(win);
 }
 
-/* forward declare QOTD helper so render_news can check per-user state */
-static int qotd_is_solved(const char *name);
-
 /* 함수 목적: 뉴스 미리보기 화면을 구현한다.
  * 매개변수: win, user
  * 반환 값: 없음
@@ -380,30 +292,10 @@ static void render_news(WINDOW *win, const User *user) {
  */
 static void draw_dashboard(User *user, const char *status) {
     erase();
-    /* refresh today's QOTD runtime cache so hints reflect persisted state */
-    if (user) {
-        char today[32];
-        time_t tnow = time(NULL);
-        struct tm *tmnow = localtime(&tnow);
-        if (tmnow) {
-            strftime(today, sizeof(today), "%Y-%m-%d", tmnow);
-            qotd_runtime_clear();
-            char **users = NULL;
-            int ucount = 0;
-            if (qotd_get_solved_users_for_date(today, &users, &ucount)) {
-                for (int i = 0; i < ucount; ++i) {
-                    if (users[i]) qotd_runtime_mark_solved(users[i]);
-                    free(users[i]);
-                    users[i] = NULL;
-                }
-                free(users);
-                users = NULL;
-            }
-        }
-    }
     mvprintw(1, (COLS - 30) / 2, "Class Royale - Student Dashboard");
     mvprintw(3, 2, "Name: %s | Deposit: %d Cr | Cash: %d Cr", user->name, user->bank.balance, user->bank.cash);
-    mvprintw(4, 2, "Items owned: %d | Stocks owned: %d", 10, user->holding_count);
+    const UserHoldings *held = user_holdings_peek(user);
+    mvprintw(4, 2, "Items owned: %d | Stocks owned: %d", USER_ITEM_SLOTS, held ? held->count : 0);
     int percent = user->total_missions > 0 ? (user->completed_missions * 100) / user->total_missions : 0;
     const char *mc_label = "Mission Completion Rate:";
     int label_x = 2;
@@ -467,7 +359,7 @@ static void draw_dashboard(User *user, const char *status) {
     render_news(news_win, user);
     tui_common_destroy_box(news_win);
 
-    tui_common_draw_help("m:Missions s:Shop a:Account t:Transactions d:QOTD n:Messages r:Tutorial q:Logout");
+    tui_common_draw_help("m:Missions s:Shop a:Account t:Transactions l:Ranking d:QOTD n:Messages r:Tutorial q:Logout");
     tui_ncurses_draw_status(status);
     refresh();
 }
@@ -481,25 +373,11 @@ static void handle_mission_board(User *user) {
         return;
     }
 
-    /* ensure the latest missions from data/missions.csv are loaded,
-       and refresh the user's mission list before showing the board */
-    mission_refresh_catalog();
-    mission_load_user(user->name, user);
-
-    /* assign any newly opened missions (avoid duplicates via user_has_mission) */
-    Mission open[8];
-    int open_count = 0;
-    if (mission_list_open(open, &open_count)) {
-        for (int i = 0; i < open_count && i < 4; ++i) {
-            if (!user_has_mission(user, open[i].id)) {
-                admin_assign_mission(user->name, &open[i]);
-            }
-        }
-    }
-    /* ensure the latest missions from data/missions.csv are loaded,
-       and refresh the user's mission list before showing the board */
+    /* ensure the latest missions from data/missions.csv are loaded;
+       the user's completion bits are kept current by mission_complete */
     mission_refresh_catalog();
-    mission_load_user(user->name, user);
+    user_hydrate(user);
+    user->total_missions = mission_catalog_count();
     int height = LINES - 4;
     int width = COLS - 6;
     WINDOW *win = tui_common_create_box(height, width, 2, 3, "Mission Board (Enter to complete/ a new mission/ q to close)");
@@ -512,7 +390,7 @@ static void handle_mission_board(User *user) {
         mvwprintw(win, 0, 2, " Mission Board (Enter to complete/ q to close) ");
 
 
-        int available = user->mission_count;
+        int available = mission_catalog_count();
         if (available == 0) {
             mvwprintw(win, 2, 2, "No assigned missions.");
         }
@@ -520,15 +398,16 @@ static void handle_mission_board(User *user) {
             if (i == highlight) {
                 wattron(win, A_REVERSE);
             }
-            Mission *mission = &user->missions[i];
-            mvwprintw(win, 1 + i, 2, "#%d %-20s [%s] +%d", mission->id, mission->name,
-                      mission->completed ? "Completed" : "In Progress", mission->reward);
+            Mission mission;
+            mission_user_at(user, i, &mission);
+            mvwprintw(win, 1 + i, 2, "#%d %-20s [%s] +%d", mission.id, mission.name,
+                      mission.completed ? "Completed" : "In Progress", mission.reward);
             if (i == highlight) {
                 wattroff(win, A_REVERSE);
             }
         }
         wrefresh(win);
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if ((ch == KEY_UP || ch == KEY_DOWN) && available > 0) {
             if (ch == KEY_UP) {
                 highlight = (highlight - 1 + available) % available;
@@ -536,7 +415,9 @@ static void handle_mission_board(User *user) {
                 highlight = (highlight + 1) % available;
             }
         } else if ((ch == '\n' || ch == '\r') && available > 0) {
-            Mission *sel = &user->missions[highlight];
+            Mission selected;
+            Mission *sel = &selected;
+            mission_user_at(user, highlight, sel);
             if (sel->completed) {
                 tui_ncurses_toast("Mission already completed", 800);
             } else {
@@ -546,9 +427,8 @@ static void handle_mission_board(User *user) {
                 } else {
                     handle_mission_play_math(user, sel);
                 }
-                /* reload user's missions so completion / rewards show immediately */
-                mission_load_user(user->name, user);
-                available = user->mission_count;
+                /* mission_complete already set the completion bit and paid the reward */
+                available = mission_catalog_count();
                 if (available == 0) {
                     highlight = 0;
                 } else if (highlight >= available) {
@@ -672,7 +552,7 @@ static void handle_shop_view(User *user) {
         wrefresh(win);
 
         /* ------------------------- 입력 처리 ---------------------------- */
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
 
         if (ch == KEY_UP) {
             highlight = (highlight - 1 + total_choices) % total_choices;
@@ -792,38 +672,30 @@ static int collect_asset_points(User *user, AssetPoint *points, int max_points)
     AccountTxRow rows[ACCOUNT_STATS_MAX_TX];
     int row_count = 0;
 
-    char *cursor = raw;
-    while (cursor && *cursor && row_count < ACCOUNT_STATS_MAX_TX) {
-        char *line = cursor;
-        char *nl = strchr(line, '\n');
-        if (nl) *nl = '\0';
-
-        if (*line) {
-            char *tokens[4] = {0};
-            int tokc = 0;
-            char *tok = strtok(line, ",");
-            while (tok && tokc < 4) {
-                tokens[tokc++] = tok;
-                tok = strtok(NULL, ",");
-            }
-            if (tokc >= 3) {
-                AccountTxRow row = {0};
-                row.ts = tokens[0] ? atol(tokens[0]) : 0;
-                if (tokc == 4) {
-                    snprintf(row.reason, sizeof(row.reason), "%s", tokens[1] ? tokens[1] : "");
-                    row.amount = tokens[2] ? atoi(tokens[2]) : 0;
-                    row.balance = tokens[3] ? atoi(tokens[3]) : 0;
-                } else {
-                    row.reason[0] = '\0';
-                    row.amount = tokens[1] ? atoi(tokens[1]) : 0;
-                    row.balance = tokens[2] ? atoi(tokens[2]) : 0;
-                }
-                rows[row_count++] = row;
+    CsvCursor cur;
+    csv_cursor_init(&cur, raw, raw_len, ',');
+    while (row_count < ACCOUNT_STATS_MAX_TX && csv_cursor_next_row(&cur)) {
+        /* 빈 필드는 건너뛰고 열 위치를 센다 */
+        CsvField tokens[4];
+        int tokc = 0;
+        CsvField fld;
+        while (tokc < 4 && csv_cursor_next_field(&cur, &fld)) {
+            if (fld.len > 0) tokens[tokc++] = fld;
+        }
+        if (tokc >= 3) {
+            AccountTxRow row = {0};
+            csv_field_long(tokens[0], &row.ts);
+            if (tokc == 4) {
+                csv_field_copy(tokens[1], row.reason, sizeof(row.reason));
+                csv_field_int(tokens[2], &row.amount);
+                csv_field_int(tokens[3], &row.balance);
+            } else {
+                row.reason[0] = '\0';
+                csv_field_int(tokens[1], &row.amount);
+                csv_field_int(tokens[2], &row.balance);
             }
+            rows[row_count++] = row;
         }
-
-        if (!nl) break;
-        cursor = nl + 1;
     }
 
     free(raw);
@@ -949,17 +821,59 @@ static void handle_account_statistics(User *user) {
                   points[point_count - 1].total_asset, max_total, min_total);
     }
 
+    long long worth = valuation_net_worth(user);
+    if (worth >= 0) {
+        mvwprintw(win, height - 3, 2, "Net worth now (with stocks, items, open orders): %lld Cr", worth);
+    }
     mvwprintw(win, height - 2, 2, "Total = deposit + cash - loan. Press q / ESC to close.");
     wrefresh(win);
 
     int ch;
-    while ((ch = wgetch(win)) != 'q' && ch != 'Q' && ch != 27) {
+    while ((ch = tui_ncurses_getch(win)) != 'q' && ch != 'Q' && ch != 27) {
         /* wait */
     }
     tui_common_destroy_box(win);
 }
 
 
+/* 함수 목적: 학생 순자산 순위표(상위 NET_WORTH_TOP 명과 내 순위)를 보여준다.
+ * 매개변수: user
+ * 반환 값: 없음
+ */
+static void handle_net_worth_ranking(User *user) {
+    if (!user) return;
+    int height = NET_WORTH_TOP + 8;
+    if (height > LINES - 2) height = LINES - 2;
+    int width = COLS - 8;
+    if (width < 48) width = 48;
+    if (width > COLS - 2) width = COLS - 2;
+    WINDOW *win = tui_common_create_box(height, width, (LINES - height) / 2, (COLS - width) / 2,
+                                        "Net Worth Ranking (q to close)");
+    if (!win) return;
+    keypad(win, TRUE);
+
+    NetWorthEntry top[NET_WORTH_TOP];
+    int n = valuation_top(top, NET_WORTH_TOP);
+    mvwprintw(win, 1, 2, "%-6s %-20s %14s", "Rank", "Name", "Net worth");
+    for (int i = 0; i < n && 2 + i < height - 4; ++i) {
+        if (top[i].user == user) wattron(win, A_REVERSE);
+        mvwprintw(win, 2 + i, 2, "#%-5d %-20.20s %11lld Cr", i + 1, top[i].user ? top[i].user->name : "?", top[i].worth);
+        if (top[i].user == user) wattroff(win, A_REVERSE);
+    }
+    long rank = valuation_rank(user);
+    if (rank >= 0) {
+        mvwprintw(win, height - 3, 2, "You: #%ld of %zu, %lld Cr", rank + 1, valuation_ranked(), valuation_net_worth(user));
+    }
+    mvwprintw(win, height - 2, 2, "Net worth = deposit + cash - loan + items + stocks at market + open buy orders.");
+    wrefresh(win);
+
+    int ch;
+    while ((ch = tui_ncurses_getch(win)) != 'q' && ch != 'Q' && ch != 27) {
+        /* wait */
+    }
+    tui_common_destroy_box(win);
+}
+
 /* 함수 목적: 유저의 계좌 관리 화면을 그리고 루프를 처리한다.
  * 매개변수: user
  * 반환 값: 없음
@@ -980,7 +894,7 @@ static void handle_account_view(User *user) {
         /* rating removed */
         mvwprintw(win, 5, 2, "Commands: d)deposit  w)withdraw  b)borrow  r)repay  q)close");
         wrefresh(win);
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (ch == 'd' || ch == 'b' || ch == 'r' || ch == 'w') {
             char label[32];
                 if (ch == 'd') {
@@ -1026,7 +940,25 @@ static void handle_account_view(User *user) {
     tui_common_destroy_box(win);
 }
 
+#define TX_PAGE_TEXT 256
+
+typedef struct TxPage {
+    char (*rows)[TX_PAGE_TEXT];
+    uint64_t newest; /* 화면 첫 줄의 줄 번호 */
+} TxPage;
+
+/* 함수 목적: 색인에서 읽은 거래 한 줄을 화면 페이지의 제자리(최신이 위)에 채운다.
+ * 매개변수: line, len, lineno, ctx
+ * 반환 값: 계속 읽으면 1
+ */
+static int fill_tx_row(const char *line, size_t len, uint64_t lineno, void *ctx) {
+    TxPage *page = ctx;
+    account_format_tx(line, len, page->rows[page->newest - lineno], TX_PAGE_TEXT);
+    return 1;
+}
+
 /* 함수 목적: 유저의 거래 내역 화면을 그리고 루프를 처리한다.
+ *           줄 색인으로 보이는 한 페이지만 읽으므로 내역 전체를 거슬러 올라가도 메모리는 일정하다.
  * 매개변수: user
  * 반환 값: 없음
  */
@@ -1039,35 +971,24 @@ static void handle_transactions_view(User *user) {
                                         "Transactions (t:stats / q:close)");
     keypad(win, TRUE);
 
-    char txbuf[8192];
-    txbuf[0] = '\0';
-    int got = account_recent_tx(user->name, ACCOUNT_STATS_MAX_TX, txbuf, sizeof(txbuf));
-
-    char *lines[2048];
-    int line_count = 0;
-    if (got > 0) {
-        char *p = txbuf;
-        while (p && *p && line_count < (int)(sizeof(lines)/sizeof(lines[0]))) {
-            char *nl = strchr(p, '\n');
-            if (nl) *nl = '\0';
-            lines[line_count++] = p;
-            if (!nl) break;
-            p = nl + 1;
-        }
-        /* reverse order so newest transactions appear first */
-        for (int i = 0; i < line_count / 2; ++i) {
-            char *tmp = lines[i];
-            lines[i] = lines[line_count - 1 - i];
-            lines[line_count - 1 - i] = tmp;
-        }
-    }
+    CsvIndex ix;
+    account_tx_open(user->name, &ix);
+    long line_count = (long)ix.lines;
 
-    int start = 0;
     int inner_rows = height - 3;
+    if (inner_rows < 1) inner_rows = 1;
     int win_w = getmaxx(win);
     int max_print = win_w - 4;
     if (max_print < 1) max_print = 1;
+    TxPage page;
+    page.rows = calloc((size_t)inner_rows, sizeof(*page.rows));
+    if (!page.rows) {
+        csv_index_close(&ix);
+        tui_common_destroy_box(win);
+        return;
+    }
 
+    long start = 0; /* 최신 거래로부터 몇 줄 아래부터 보여 줄지 */
     int running = 1;
     while (running) {
         werase(win);
@@ -1077,26 +998,52 @@ static void handle_transactions_view(User *user) {
         if (line_count == 0) {
             mvwprintw(win, 2, 2, "No transactions");
         } else {
-            for (int i = 0; i < inner_rows && (start + i) < line_count; ++i) {
-                mvwprintw(win, 1 + i, 2, "%.*s", max_print, lines[start + i]);
+            long shown = line_count - start < inner_rows ? line_count - start : inner_rows;
+            page.newest = (uint64_t)(line_count - 1 - start);
+            csv_index_read(&ix, page.newest + 1 - (uint64_t)shown, (uint64_t)shown, fill_tx_row, &page);
+            for (long i = 0; i < shown; ++i) {
+                mvwprintw(win, 1 + (int)i, 2, "%.*s", max_print, page.rows[i]);
             }
-            mvwprintw(win, height - 2, 2, "Up/Down/PageUp/PageDown to scroll. t:stats q:close");
+            mvwprintw(win, height - 2, 2, "%ld-%ld of %ld  Up/Down/PgUp/PgDn/Home/End, g:go to date, t:stats q:close",
+                      start + 1, start + shown, line_count);
         }
 
         wrefresh(win);
 
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
+        long last_start = line_count - inner_rows > 0 ? line_count - inner_rows : 0;
         if (ch == KEY_UP) {
             if (start > 0) start--;
         } else if (ch == KEY_DOWN) {
-            if (start + inner_rows < line_count) start++;
+            if (start < last_start) start++;
         } else if (ch == KEY_NPAGE) {
             start += inner_rows;
-            if (start + inner_rows > line_count) start = line_count - inner_rows;
-            if (start < 0) start = 0;
+            if (start > last_start) start = last_start;
         } else if (ch == KEY_PPAGE) {
             start -= inner_rows;
             if (start < 0) start = 0;
+        } else if (ch == KEY_HOME) {
+            start = 0;
+        } else if (ch == KEY_END) {
+            start = last_start;
+        } else if ((ch == 'g' || ch == 'G') && line_count > 0) {
+            char date[16] = "";
+            int y = 0, mo = 0, d = 0;
+            if (tui_ncurses_prompt_line(win, height - 2, 2, "Go to date (YYYY-MM-DD)", date, sizeof(date), 0) &&
+                sscanf(date, "%d-%d-%d", &y, &mo, &d) == 3) {
+                struct tm tm;
+                memset(&tm, 0, sizeof(tm));
+                tm.tm_year = y - 1900;
+                tm.tm_mon = mo - 1;
+                tm.tm_mday = d;
+                tm.tm_isdst = -1;
+                /* 그날 첫 거래를 화면 맨 아래에 두어 그 뒤 거래가 위로 이어지게 한다 */
+                uint64_t line = csv_index_find_key(&ix, (int64_t)mktime(&tm));
+                if (line >= ix.lines) line = ix.lines - 1;
+                start = line_count - 1 - (long)line - (inner_rows - 1);
+                if (start < 0) start = 0;
+                if (start > last_start) start = last_start;
+            }
         } else if (ch == 'q' || ch == 27) {
             running = 0;
         } else if (ch == 't' || ch == 'T') {
@@ -1104,6 +1051,8 @@ static void handle_transactions_view(User *user) {
         }
     }
 
+    free(page.rows);
+    csv_index_close(&ix);
     tui_common_destroy_box(win);
 }
 
@@ -1217,7 +1166,7 @@ static void handle_message_center(User *user) {
         mvwprintw(win, maxy - 2, 2, "Commands: c)compose  v)view user  a)show all  q)close");
         wrefresh(win);
 
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (ch == 'q' || ch == 'Q' || ch == 27) {
             running = 0;
         } else if (ch == 'a' || ch == 'A') {
@@ -1283,7 +1232,7 @@ void tui_student_loop(User *user) {
      int running = 1;
      while (running) {
          draw_dashboard(user, status);
-         int ch = getch();
+         int ch = tui_ncurses_getch(stdscr);
          switch (ch) {
             case 'm':
             case 'M':
@@ -1320,6 +1269,11 @@ void tui_student_loop(User *user) {
                 handle_message_center(user);
                 status = "Checked messages";
                 break;
+            case 'l':
+            case 'L':
+                handle_net_worth_ranking(user);
+                status = "Viewed net worth ranking";
+                break;
             case 'r':
             case 'R':
                 handle_tutorial_view(user);
@@ -1347,6 +1301,7 @@ static Seat g_seats[31]; // 1~30까지 사용
  * 반환 값: 없음
  */
 static void load_seats_csv(void) {
+    csv_flush_path("data/seats.csv"); /* 저장은 쓰기 스레드가 하므로 먼저 끝낸다 */
     FILE *fp = fopen("data/seats.csv", "r");
     if (!fp) return;
 
@@ -1377,19 +1332,22 @@ static void load_seats_csv(void) {
 }
 
 
-/* 함수 목적: g_seats 배열을 seats.csv 파일에 저장한다.
+/* 함수 목적: g_seats 배열을 seats.csv 파일에 저장한다. 파일 교체는 쓰기 스레드가 한다.
  * 매개변수: 없음
  * 반환 값: 없음
  */
 void save_seats_csv(void) {
-    FILE *fp = fopen("data/seats.csv", "w");
-    if (!fp) return;
+    char buf[30 * (sizeof(g_seats[0].name) + 8)];
+    size_t len = 0;
 
     for (int i = 1; i <= 30; i++) {
-        fprintf(fp, "%d,%s\n", i, g_seats[i].name);
+        int n = snprintf(buf + len, sizeof(buf) - len, "%d,%s\n", i, g_seats[i].name);
+        if (n < 0 || (size_t)n >= sizeof(buf) - len) break;
+        len += (size_t)n;
     }
 
-    fclose(fp);
+    csv_ensure_dir("data");
+    csv_write_file("data/seats.csv", buf, len);
 }
 
 /* --- Class seats view (stub) --- */
@@ -1448,7 +1406,7 @@ static void handle_class_seats_view(User *user) {
         }
 
         wrefresh(win);
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
 
         // ===== 입력 처리 =====
         switch (ch) {
@@ -1495,8 +1453,8 @@ static void handle_class_seats_view(User *user) {
                 save_seats_csv();
                 mvwprintw(win, height - 3, 2,
                     "Seat %d cancelled.", cursor);
-                user->bank.cash += 1000;
-                /* persist accounts.csv so cash change is saved */
+                account_grant_cash(user, 1000, "SEAT_REFUND");
+                /* persist the account slot so cash change is saved */
                 user_update_balance(user->name, user->bank.balance);
                 wrefresh(win);
                 napms(500);
@@ -1505,13 +1463,19 @@ static void handle_class_seats_view(User *user) {
 
             // == 3) 빈 좌석이면 예약 ==
             if (strlen(g_seats[cursor].name) == 0) {
+                if (!account_spend_cash(user, 1000, "SEAT_RESERVE")) {
+                    mvwprintw(win, height - 3, 2,
+                        "Not enough cash (1000 Cr needed).");
+                    wrefresh(win);
+                    napms(500);
+                    break;
+                }
                 strcpy(g_seats[cursor].name, user->name);
                 save_seats_csv();
 
                 mvwprintw(win, height - 3, 2,
                     "Seat %d reserved for %s   ", cursor, user->name);
-                user->bank.cash -= 1000; 
-                /* persist accounts.csv so cash change is saved */
+                /* persist the account slot so cash change is saved */
                 user_update_balance(user->name, user->bank.balance);
                  
                 wrefresh(win);
@@ -1583,7 +1547,7 @@ static void handle_tutorial_view(User *user) {
         }
 
         wrefresh(win);
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (ch == KEY_UP) {
             highlight = (highlight - 1 + opt_count) % opt_count;
         } else if (ch == KEY_DOWN) {
@@ -1711,7 +1675,7 @@ static void handle_tutorial_view(User *user) {
             }
             mvwprintw(win, maxy - 2, 2, "Press any key to go back to the tutorial menu");
             wrefresh(win);
-            wgetch(win);
+            tui_ncurses_getch(win);
         } else if (ch == 'q' || ch == 'Q' || ch == 27) {
             running = 0;
         }
@@ -1725,11 +1689,9 @@ static void handle_tutorial_view(User *user) {
  */
 static void append_typing_leaderboard(const char *username, int mission_id, double wpm, double accuracy) {
     csv_ensure_dir("data");
-    FILE *fp = fopen("data/typing_leaderboard.csv", "a");
-    if (!fp) return;
     /* format: username,mission_id,wpm,accuracy_percent */
-    fprintf(fp, "%s,%d,%.2f,%.2f\n", username ? username : "unknown", mission_id, wpm, accuracy);
-    fclose(fp);
+    csv_append_row("data/typing_leaderboard.csv", "%s,%d,%.2f,%.2f",
+                   username ? username : "unknown", mission_id, wpm, accuracy);
 }
 
 /* 함수 목적: 수학 퀴즈 리더보드 파일에 결과를 추가한다.
@@ -1738,10 +1700,7 @@ static void append_typing_leaderboard(const char *username, int mission_id, doub
  */
 static void append_math_leaderboard(const char *username, int mission_id, double total_seconds) {
     csv_ensure_dir("data");
-    FILE *fp = fopen("data/math_leaderboard.csv", "a");
-    if (!fp) return;
-    fprintf(fp, "%s,%d,%.3f\n", username ? username : "unknown", mission_id, total_seconds);
-    fclose(fp);
+    csv_append_row("data/math_leaderboard.csv", "%s,%d,%.3f", username ? username : "unknown", mission_id, total_seconds);
 }
 
 /* comparator for math leaderboard sort (ascending time) */
@@ -1870,7 +1829,7 @@ static void handle_mission_play_typing(User *user, Mission *m) {
 
         wrefresh(win);
 
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (!tstart && ch != ERR && ch != '\n' && ch != '\r') {
             tstart = time(NULL);
         }
@@ -1901,7 +1860,6 @@ static void handle_mission_play_typing(User *user, Mission *m) {
 
                 if (mission_complete(user->name, m->id)) {
                     tui_ncurses_toast("Mission complete! Reward granted", 900);
-                    mission_load_user(user->name, user);
                 } else {
                     tui_ncurses_toast("Failed to mark mission complete", 900);
                 }
@@ -1919,22 +1877,23 @@ static void handle_mission_play_typing(User *user, Mission *m) {
                 /* read leaderboard, filter 100% accuracy and sort by WPM desc */
                 typing_lbent entries[256];
                 int n = 0;
-                FILE *fp = fopen("data/typing_leaderboard.csv", "r");
-                if (fp) {
-                    char linebuf[256];
-                    while (fgets(linebuf, sizeof(linebuf), fp) && n < (int)(sizeof(entries)/sizeof(entries[0]))) {
-                        char uname[128]; int mid = 0; double w = 0, a = 0;
-                        if (sscanf(linebuf, "%127[^,],%d,%lf,%lf", uname, &mid, &w, &a) == 4) {
+                CsvCursor lb;
+                if (csv_cursor_open(&lb, "data/typing_leaderboard.csv", ',')) {
+                    while (n < (int)(sizeof(entries)/sizeof(entries[0])) && csv_cursor_next_row(&lb)) {
+                        /* format: username,mission_id,wpm,accuracy_percent */
+                        CsvField f[4];
+                        int mid = 0; double w = 0, a = 0;
+                        if (csv_cursor_fields(&lb, f, 4) == 4 && f[0].len > 0 &&
+                            csv_field_int(f[1], &mid) && csv_field_double(f[2], &w) && csv_field_double(f[3], &a)) {
                             if (mid == m->id && a >= 99.999) { /* treat >=100 as 100% */
-                                strncpy(entries[n].name, uname, sizeof(entries[n].name)-1);
-                                entries[n].name[sizeof(entries[n].name)-1] = '\0';
+                                csv_field_copy(f[0], entries[n].name, sizeof(entries[n].name));
                                 entries[n].wpm = w;
                                 entries[n].acc = a;
                                 n++;
                             }
                         }
                     }
-                    fclose(fp);
+                    csv_cursor_close(&lb);
                 }
                 /* sort by wpm desc */
                 if (n > 1) {
@@ -1955,7 +1914,7 @@ static void handle_mission_play_typing(User *user, Mission *m) {
                 wrefresh(win);
                 /* wait for Enter / Esc / q */
                 int k;
-                while ((k = wgetch(win)) != '\n' && k != '\r' && k != 27 && k != 'q' && k != 'Q') {
+                while ((k = tui_ncurses_getch(win)) != '\n' && k != '\r' && k != 27 && k != 'q' && k != 'Q') {
                     /* looping until expected key */
                 }
 
@@ -2057,7 +2016,7 @@ static void handle_mission_play_math(User *user, Mission *m) {
             mvwprintw(win, height - 3, 2, "Enter numeric answer and press Enter. q to cancel.");
             wrefresh(win);
 
-            int ch = wgetch(win);
+            int ch = tui_ncurses_getch(win);
             if (!started && ch != ERR) {
                 tstart = tstart ? tstart : time(NULL);
                 started = 1;
@@ -2107,21 +2066,21 @@ static void handle_mission_play_math(User *user, Mission *m) {
     typedef struct { char name[128]; double time; } mentry;
     mentry entries[256];
     int nents = 0;
-    FILE *fp = fopen("data/math_leaderboard.csv", "r");
-    if (fp) {
-        char line[256];
-        while (fgets(line, sizeof(line), fp) && nents < (int)(sizeof(entries)/sizeof(entries[0]))) {
-            char uname[128]; int mid = 0; double t = 0;
-            if (sscanf(line, "%127[^,],%d,%lf", uname, &mid, &t) == 3) {
+    CsvCursor lb;
+    if (csv_cursor_open(&lb, "data/math_leaderboard.csv", ',')) {
+        while (nents < (int)(sizeof(entries)/sizeof(entries[0])) && csv_cursor_next_row(&lb)) {
+            CsvField f[3];
+            int mid = 0; double t = 0;
+            if (csv_cursor_fields(&lb, f, 3) == 3 && f[0].len > 0 &&
+                csv_field_int(f[1], &mid) && csv_field_double(f[2], &t)) {
                 if (mid == m->id) {
-                    strncpy(entries[nents].name, uname, sizeof(entries[nents].name)-1);
-                    entries[nents].name[sizeof(entries[nents].name)-1] = '\0';
+                    csv_field_copy(f[0], entries[nents].name, sizeof(entries[nents].name));
                     entries[nents].time = t;
                     nents++;
                 }
             }
         }
-        fclose(fp);
+        csv_cursor_close(&lb);
     }
     /* sort ascending by time and display top (fastest) entries */
     if (nents > 1) {
@@ -2139,11 +2098,10 @@ static void handle_mission_play_math(User *user, Mission *m) {
 
     mvwprintw(win, height - 3, 2, "Press Enter to complete mission and exit.");
     wrefresh(win);
-    wgetch(win);
+    tui_ncurses_getch(win);
 
     if (mission_complete(user->name, m->id)) {
         tui_ncurses_toast("Mission complete! Reward granted", 900);
-        mission_load_user(user->name, user);
     } else {
         tui_ncurses_toast("Failed to mark mission complete", 900);
     }
@@ -2162,27 +2120,77 @@ static void handle_mission_play_math(User *user, Mission *m) {
 static int get_owned_qty(User *user, const char *symbol) {
     if (!user || !symbol) return 0;
 
-    for (int i = 0; i < user->holding_count; ++i) {
-        if (strncmp(user->holdings[i].symbol,
+    const UserHoldings *held = user_holdings_peek(user);
+    for (int i = 0; held && i < held->count; ++i) {
+        if (strncmp(held->items[i].symbol,
                     symbol,
-                    sizeof(user->holdings[i].symbol)) == 0) {
-            return user->holdings[i].qty;
+                    sizeof(held->items[i].symbol)) == 0) {
+            return held->items[i].qty;
         }
     }
     return 0;
 }
 
-/* 선택한 한 종목의 log[] 전체를 그래프(@)로 보여주는 화면 */
-/* log 길이가 화면보다 길면 ← / → 로 스크롤 가능 */
+/* 그래프 위에 겹쳐 그리는 지표 묶음 (m/b/h/v 로 켜고 끈다) */
+#define GRAPH_SHOW_AVERAGES 0x1 /* SMA '-', EMA '~' */
+#define GRAPH_SHOW_BANDS    0x2 /* 볼린저 밴드 '.' */
+#define GRAPH_SHOW_RANGE    0x4 /* 이동 최저/최고 ':' */
+#define GRAPH_SHOW_VWAP     0x8 /* 거래량 가중 평균가 '=' */
+
+/* 함수 목적: 값을 그래프 영역의 행으로 바꾼다.
+ * 매개변수: v, minv, maxv, plot_top, plot_bottom
+ * 반환 값: 화면 행
+ */
+static int graph_row(double v, int minv, int maxv, int plot_top, int plot_bottom) {
+    int plot_height = plot_bottom - plot_top + 1;
+    double ratio = (v - minv) / (double)(maxv - minv);
+    if (ratio < 0.0) ratio = 0.0;
+    if (ratio > 1.0) ratio = 1.0;
+
+    int bar_h = (int)(ratio * (plot_height - 1)) + 1; // 최소 1칸은 찍히게
+    if (bar_h > plot_height) bar_h = plot_height;
+    int y = plot_bottom - (bar_h - 1);
+    return y < plot_top ? plot_top : y;
+}
+
+/* 함수 목적: 지표 시계열의 보이는 구간을 점으로 겹쳐 그린다. 값이 없는(NAN) 칸은 건너뛴다.
+ * 매개변수: win, series, offset, got, ch, minv, maxv, plot_top, plot_bottom, plot_left
+ * 반환 값: 없음
+ */
+static void graph_overlay(WINDOW *win, const float *series, int offset, int got, chtype ch,
+                          int minv, int maxv, int plot_top, int plot_bottom, int plot_left) {
+    for (int x = 0; x < got; ++x) {
+        float v = series[offset + x];
+        if (isnan(v)) continue;
+        mvwaddch(win, graph_row(v, minv, maxv, plot_top, plot_bottom), plot_left + x, ch);
+    }
+}
+
+/* 함수 목적: 보이는 구간의 지표 값까지 포함하도록 min/max 를 넓힌다.
+ * 매개변수: series, offset, got, minv, maxv
+ * 반환 값: 없음
+ */
+static void graph_widen(const float *series, int offset, int got, int *minv, int *maxv) {
+    for (int x = 0; x < got; ++x) {
+        float v = series[offset + x];
+        if (isnan(v)) continue;
+        if (v < *minv) *minv = (int)floorf(v);
+        if (v > *maxv) *maxv = (int)ceilf(v);
+    }
+}
+
+/* 선택한 한 종목의 가격 기록을 그래프(*)로 보여주는 화면 */
+/* 기록이 화면보다 길면 ← / → 로 스크롤 가능, 화면에 보이는 구간만 읽어 온다 */
+/* 지표는 domain/indicators 의 종목별 캐시에서 보이는 구간만 꺼내 쓴다 (스크롤해도 다시 계산하지 않음) */
 /* 함수 목적: 주식 그래프를 그려준다.
  * 매개변수: stock
  * 반환 값: 없음
  */
-static void handle_stock_graph_view(const Stock *stock) {
+static void handle_stock_graph_view(const StockQuote *stock) {
     if (!stock) {
         return;
     }
-    if (stock->log_len <= 0) {
+    if (stock->visible_len <= 0) {
         tui_ncurses_toast("No history for this stock", 800);
         return;
     }
@@ -2193,7 +2201,7 @@ static void handle_stock_graph_view(const Stock *stock) {
     if (width  < 30) width  = COLS;
 
     char title[80];
-    snprintf(title, sizeof(title), "Graph - %s (log size: %d)", stock->name, stock->log_len);
+    snprintf(title, sizeof(title), "Graph - %s (log size: %d)", stock->name, stock->visible_len);
 
     WINDOW *win = tui_common_create_box(
         height,
@@ -2206,7 +2214,15 @@ static void handle_stock_graph_view(const Stock *stock) {
 
     keypad(win, TRUE);
 
-    int offset  = 0;   // log[]에서 시작 인덱스
+    /* 한 화면 분량의 가격만 담는 버퍼 (plot_width 는 width 보다 작다) */
+    int *px = malloc(sizeof(int) * (size_t)(width > 5 ? width : 5));
+    if (!px) {
+        tui_common_destroy_box(win);
+        return;
+    }
+
+    int offset  = 0;   // 가격 기록에서 시작 인덱스
+    int show    = GRAPH_SHOW_AVERAGES;
     int running = 1;
 
     while (running) {
@@ -2215,21 +2231,20 @@ static void handle_stock_graph_view(const Stock *stock) {
 
         /* 상단 정보 */
         mvwprintw(win, 0, 2, " %s Graph | points=%d ",
-                  stock->name, stock->log_len);
+                  stock->name, stock->visible_len);
 
-        /* 그래프 그릴 영역 설정 */
+        /* 그래프 그릴 영역 설정 (아래 두 줄은 지표 값과 안내용) */
         int plot_top    = 2;
-        int plot_bottom = height - 3;        // 아래 한 줄은 안내용
+        int plot_bottom = height - 4;
         int plot_left   = 5;
         int plot_right  = width - 3;
 
-        int plot_height = plot_bottom - plot_top + 1;
         int plot_width  = plot_right - plot_left + 1;
 
-        if (plot_height < 3) plot_height = 3;
+        if (plot_bottom < plot_top + 2) plot_bottom = plot_top + 2;
         if (plot_width  < 5) plot_width  = 5;
 
-        int len = stock->log_len;
+        int len = stock->visible_len;
 
         /* offset 범위 정리 */
         if (offset < 0) offset = 0;
@@ -2243,14 +2258,34 @@ static void handle_stock_graph_view(const Stock *stock) {
         }
 
         /* 현재 화면에 보여줄 구간의 min/max 찾기 */
-        int window_end = offset + plot_width;
-        if (window_end > len) window_end = len;
-
-        int minv = stock->log[offset];
-        int maxv = stock->log[offset];
-        for (int i = offset + 1; i < window_end; ++i) {
-            if (stock->log[i] < minv) minv = stock->log[i];
-            if (stock->log[i] > maxv) maxv = stock->log[i];
+        int got = stock_history_range(stock->name, offset, px, plot_width);
+        if (got <= 0) {
+            px[0] = stock->current_price;
+            got = 1;
+        }
+        int window_end = offset + got;
+
+        const IndicatorSeries *ind = indicators_get(stock->name, len);
+        if (ind && ind->len < window_end) ind = NULL;
+
+        int minv = px[0];
+        int maxv = px[0];
+        for (int i = 1; i < got; ++i) {
+            if (px[i] < minv) minv = px[i];
+            if (px[i] > maxv) maxv = px[i];
+        }
+        if (ind) {
+            if (show & GRAPH_SHOW_AVERAGES) {
+                graph_widen(ind->value[IND_SMA], offset, got, &minv, &maxv);
+                graph_widen(ind->value[IND_EMA], offset, got, &minv, &maxv);
+            }
+            if (show & GRAPH_SHOW_BANDS) {
+                graph_widen(ind->value[IND_BAND_UPPER], offset, got, &minv, &maxv);
+                graph_widen(ind->value[IND_BAND_LOWER], offset, got, &minv, &maxv);
+            }
+            if (show & GRAPH_SHOW_VWAP) {
+                graph_widen(ind->value[IND_VWAP], offset, got, &minv, &maxv);
+            }
         }
         if (maxv == minv) {
             /* 모두 같은 값이면, 수직 크기 1이라도 나오게 보정 */
@@ -2261,80 +2296,87 @@ static void handle_stock_graph_view(const Stock *stock) {
         mvwprintw(win, plot_top,   1, "%d", maxv);
         mvwprintw(win, plot_bottom,1, "%d", minv);
 
-        /* 실제 그래프 그리기: 각 x(열)마다 수직 바를 @로 찍는다 */
-        for (int x = 0; x < plot_width; ++x) {
-            int idx = offset + x;
-            if (idx >= len) break;
-
-            int v = stock->log[idx];
-
-            double ratio = (double)(v - minv) / (double)(maxv - minv);
-            if (ratio < 0.0) ratio = 0.0;
-            if (ratio > 1.0) ratio = 1.0;
-
-            int bar_h = (int)(ratio * (plot_height - 1)) + 1; // 최소 1칸은 찍히게
-            if (bar_h > plot_height) bar_h = plot_height;
-
-            
-            int screen_x = plot_left + x;
-            /* --- 스무스 라인 그래프: 점과 점 사이 채우기 --- */
-            int prev_x = -1;
-            int prev_y = -1;
-
-            for (int x = 0; x < plot_width; ++x) {
-                int idx = offset + x;
-                if (idx >= len) break;
-
-                int v = stock->log[idx];
-                double ratio = (double)(v - minv) / (double)(maxv - minv);
-                if (ratio < 0) ratio = 0;
-                if (ratio > 1) ratio = 1;
-
-                int bar_h = (int)(ratio * (plot_height - 1)) + 1;
-                if (bar_h > plot_height) bar_h = plot_height;
+        /* 지표를 먼저 깔고 가격 선을 그 위에 그린다 */
+        if (ind) {
+            if (show & GRAPH_SHOW_RANGE) {
+                graph_overlay(win, ind->value[IND_LOW], offset, got, ':', minv, maxv, plot_top, plot_bottom, plot_left);
+                graph_overlay(win, ind->value[IND_HIGH], offset, got, ':', minv, maxv, plot_top, plot_bottom, plot_left);
+            }
+            if (show & GRAPH_SHOW_BANDS) {
+                graph_overlay(win, ind->value[IND_BAND_UPPER], offset, got, '.', minv, maxv, plot_top, plot_bottom, plot_left);
+                graph_overlay(win, ind->value[IND_BAND_LOWER], offset, got, '.', minv, maxv, plot_top, plot_bottom, plot_left);
+            }
+            if (show & GRAPH_SHOW_VWAP) {
+                graph_overlay(win, ind->value[IND_VWAP], offset, got, '=', minv, maxv, plot_top, plot_bottom, plot_left);
+            }
+            if (show & GRAPH_SHOW_AVERAGES) {
+                graph_overlay(win, ind->value[IND_SMA], offset, got, '-', minv, maxv, plot_top, plot_bottom, plot_left);
+                graph_overlay(win, ind->value[IND_EMA], offset, got, '~', minv, maxv, plot_top, plot_bottom, plot_left);
+            }
+        }
 
-                int y = plot_bottom - (bar_h - 1);
-                if (y < plot_top) y = plot_top;
+        /* --- 스무스 라인 그래프: 점과 점 사이 채우기 --- */
+        int prev_x = -1;
+        int prev_y = -1;
 
-                int sx = plot_left + x;
+        for (int x = 0; x < got; ++x) {
+            int y  = graph_row(px[x], minv, maxv, plot_top, plot_bottom);
+            int sx = plot_left + x;
 
-                /* 현재 점 찍기 */
-                mvwaddch(win, y, sx, '*');
+            /* 현재 점 찍기 */
+            mvwaddch(win, y, sx, '*');
 
-                /* 이전 점과 연결해주기 */
-                if (prev_x >= 0) {
-                    int dx = sx - prev_x;
-                    int dy = y  - prev_y;
+            /* 이전 점과 연결해주기 */
+            if (prev_x >= 0) {
+                int dx = sx - prev_x;
+                int dy = y  - prev_y;
 
-                    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
-                    if (steps == 0) steps = 1;
+                int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+                if (steps == 0) steps = 1;
 
-                    double stepx = dx / (double)steps;
-                    double stepy = dy / (double)steps;
+                double stepx = dx / (double)steps;
+                double stepy = dy / (double)steps;
 
-                    double cx = prev_x;
-                    double cy = prev_y;
+                double cx = prev_x;
+                double cy = prev_y;
 
-                    for (int s = 1; s < steps; ++s) {
-                        cx += stepx;
-                        cy += stepy;
-                        mvwaddch(win, (int)(cy + 0.5), (int)(cx + 0.5), '*');
-                    }
+                for (int s = 1; s < steps; ++s) {
+                    cx += stepx;
+                    cy += stepy;
+                    mvwaddch(win, (int)(cy + 0.5), (int)(cx + 0.5), '*');
                 }
+            }
 
-                prev_x = sx;
-                prev_y = y;
-}
+            prev_x = sx;
+            prev_y = y;
+        }
+
+        /* 보이는 구간 오른쪽 끝 시점의 지표 값 (아직 값이 없으면 -) */
+        if (ind) {
+            int last = window_end - 1;
+            char vals[IND_COUNT][16];
+            for (int k = 0; k < IND_COUNT; ++k) {
+                float v = ind->value[k][last];
+                if (isnan(v)) snprintf(vals[k], sizeof(vals[k]), "-");
+                else snprintf(vals[k], sizeof(vals[k]), "%.1f", v);
+            }
+            mvwprintw(win, height - 3, 2,
+                      "SMA%d %s  EMA%d %s  BB %s/%s  Lo/Hi %s/%s  RSI%d %s  VWAP %s",
+                      INDICATOR_SMA_PERIOD, vals[IND_SMA], INDICATOR_EMA_PERIOD, vals[IND_EMA],
+                      vals[IND_BAND_LOWER], vals[IND_BAND_UPPER], vals[IND_LOW], vals[IND_HIGH],
+                      INDICATOR_RSI_PERIOD, vals[IND_RSI], vals[IND_VWAP]);
         }
 
         /* 아래쪽 안내 & 현재 구간 표시 */
         mvwprintw(win, height - 2, 2,
-                  "<-/-> scroll  q back  range [%d - %d] / %d",
+                  "<-/-> scroll  m avg%s b bands%s h lo/hi%s v vwap%s  q back  [%d - %d] / %d",
+                  show & GRAPH_SHOW_AVERAGES ? "*" : "", show & GRAPH_SHOW_BANDS ? "*" : "",
+                  show & GRAPH_SHOW_RANGE ? "*" : "", show & GRAPH_SHOW_VWAP ? "*" : "",
                   offset, window_end - 1, len);
 
         wrefresh(win);
 
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (ch == KEY_LEFT) {
             /* 왼쪽으로 plot_width/2 만큼 스크롤 */
             int step = plot_width / 2;
@@ -2346,11 +2388,20 @@ static void handle_stock_graph_view(const Stock *stock) {
             if (step < 1) step = 1;
             offset += step;
             if (offset > len - 1) offset = len - 1;
+        } else if (ch == 'm') {
+            show ^= GRAPH_SHOW_AVERAGES;
+        } else if (ch == 'b') {
+            show ^= GRAPH_SHOW_BANDS;
+        } else if (ch == 'h') {
+            show ^= GRAPH_SHOW_RANGE;
+        } else if (ch == 'v') {
+            show ^= GRAPH_SHOW_VWAP;
         } else if (ch == 'q' || ch == 27) {
             running = 0;
         }
     }
 
+    free(px);
     tui_common_destroy_box(win);
 }
 
@@ -2359,12 +2410,10 @@ static void handle_stock_graph_view(const Stock *stock) {
  * 반환 값: 없음
  */
 static void handle_stocks_view(User *user) {
-    Stock stocks[16];
-    int count = 0;
-
-    /* 들어올 때 한 번 시간 업데이트 */
-    stock_maybe_update_by_time();
-    if (!stock_list(stocks, &count) || count == 0) {
+    /* 가격은 스케줄러가 STOCK_STEP_SECONDS 마다 새 시세판으로 내걸고, 화면은 빌려 읽기만 한다 */
+    const StockQuotes *q = stock_quotes_acquire();
+    if (!q || q->count == 0) {
+        stock_quotes_release(q);
         tui_ncurses_toast("No stock data", 800);
         return;
     }
@@ -2377,79 +2426,102 @@ static void handle_stocks_view(User *user) {
         width,
         2,
         3,
-        "Stocks (Enter=Buy / s=Sell / d=Dividend / g=Graph / q=Close)"
+        "Stocks (Enter=Buy / s=Sell / t=Basket / g=Graph / q=Close)"
     );
-    if (!win) return;
+    if (!win) {
+        stock_quotes_release(q);
+        return;
+    }
 
     keypad(win, TRUE);
+    /* 키가 없어도 1초마다 깨어나 새 시세판이 걸렸는지만 본다 */
+    wtimeout(win, 1000);
     int highlight = 0;
     int running   = 1;
+    int dirty     = 1;
+    TuiStockBasket basket;
+    memset(&basket, 0, sizeof(basket));
 
     while (running) {
-        /* 1시간 지났으면 내부에서 주가 변경 (CSV는 안 건드림) */
-        stock_maybe_update_by_time();
-        stock_list(stocks, &count);
-
-        werase(win);
-        box(win, 0, 0);
-
-        /* 상단 타이틀 + 잔액 표시 */
-        mvwprintw(win, 0, 2,
-                  " Stocks - Balance %dCr ",
-                  user->bank.balance);
-
-        /* 헤더 */
-        mvwprintw(win, 1, 2,
-                  "%-3s %-8s %-7s %-5s %-6s %-20s",
-                  "ID", "NAME", "PRICE", "OWN", "diff", "NEWS");
-
-        int visible_rows = height - 4; // 위에 2줄 + 아래 안내 한 줄 빼고
-
-        for (int i = 0; i < count && i < visible_rows; ++i) {
-            int row    = 2 + i;
-            int owned  = get_owned_qty(user, stocks[i].name);
-            int diff   = stocks[i].current_price - stocks[i].previous_price;
-            char diff_str[8];
-
-            if (stocks[i].previous_price == 0) {
-                snprintf(diff_str, sizeof(diff_str), " - ");
-            } else if (diff > 0) {
-                snprintf(diff_str, sizeof(diff_str), "+%d", diff);
-            } else if (diff < 0) {
-                snprintf(diff_str, sizeof(diff_str), "%d", diff);
-            } else {
-                snprintf(diff_str, sizeof(diff_str), "0");
+        if (stock_quotes_version() != q->version) {
+            const StockQuotes *next = stock_quotes_acquire();
+            if (next) {
+                stock_quotes_release(q);
+                q = next;
+                dirty = 1;
             }
+        }
+        const StockQuote *stocks = q->quotes;
+        int count = q->count;
+        if (dirty) {
+            werase(win);
+            box(win, 0, 0);
 
-            if (i == highlight) {
-                wattron(win, A_REVERSE);
-            }
+            /* 상단 타이틀 + 잔액 표시 */
+            mvwprintw(win, 0, 2,
+                      " Stocks - Balance %dCr ",
+                      user->bank.balance);
+
+            /* 헤더 */
+            mvwprintw(win, 1, 2,
+                      "%-3s %-8s %-7s %-5s %-6s %-20s",
+                      "ID", "NAME", "PRICE", "OWN", "diff", "NEWS");
+
+            int visible_rows = height - 5; // 위에 2줄 + 아래 장바구니/안내 줄 빼고
+
+            int top = tui_common_list_top(highlight, visible_rows);
+            for (int i = top; i < count && i < top + visible_rows; ++i) {
+                int row    = 2 + i - top;
+                int owned  = get_owned_qty(user, stocks[i].name);
+                int diff   = stocks[i].current_price - stocks[i].previous_price;
+                char diff_str[8];
+
+                if (stocks[i].previous_price == 0) {
+                    snprintf(diff_str, sizeof(diff_str), " - ");
+                } else if (diff > 0) {
+                    snprintf(diff_str, sizeof(diff_str), "+%d", diff);
+                } else if (diff < 0) {
+                    snprintf(diff_str, sizeof(diff_str), "%d", diff);
+                } else {
+                    snprintf(diff_str, sizeof(diff_str), "0");
+                }
 
-            mvwprintw(
-                win,
-                row,
-                2,
-                "%-3d %-8s %-7d %-5d %-4s %-20s",
-                stocks[i].id,
-                stocks[i].name,
-                stocks[i].current_price,
-                owned,
-                diff_str,
-                stocks[i].news
-            );
+                if (i == highlight) {
+                    wattron(win, A_REVERSE);
+                }
 
-            if (i == highlight) {
-                wattroff(win, A_REVERSE);
+                mvwprintw(
+                    win,
+                    row,
+                    2,
+                    "%-3d %-8s %-7d %-5d %-4s %-20s",
+                    stocks[i].id,
+                    stocks[i].name,
+                    stocks[i].current_price,
+                    owned,
+                    diff_str,
+                    stocks[i].news
+                );
+
+                if (i == highlight) {
+                    wattroff(win, A_REVERSE);
+                }
             }
-        }
 
-        /* 아래쪽 조작 안내 (여기를 '버튼' 느낌으로 써도 됨) */
-        mvwprintw(win, height - 2, 2,
-                  "up/down move  Enter buy  s sell  g graph  q close");
+            /* 아래쪽 조작 안내 (여기를 '버튼' 느낌으로 써도 됨) */
+            tui_stock_basket_draw(win, height - 3, &basket);
+            mvwprintw(win, height - 2, 2,
+                      "up/down move  Enter buy  s sell  t basket  g graph  q close");
 
-        wrefresh(win);
+            wrefresh(win);
+            dirty = 0;
+        }
 
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
+        if (ch == ERR) {
+            continue;  // 시간만 지났다: 시세판이 그대로면 다시 그리지 않는다
+        }
+        dirty = 1;
 
         if (ch == KEY_UP) {
             if (count > 0) {
@@ -2460,31 +2532,24 @@ static void handle_stocks_view(User *user) {
                 highlight = (highlight + 1) % count;
             }
         } else if (ch == '\n' || ch == '\r') {
-            /* 매수: 선택 종목 1주 */
+            /* 매수: 수량 입력 (m = 최대), 장바구니 모드면 담기만 한다 */
             if (count <= 0) continue;
-            Stock *s = &stocks[highlight];
-
-            if (stock_deal(user->name, s->name, 1, 1)) {
-                tui_ncurses_toast("Buy complete", 800);
-                /* stock_maybe_update_by_time() + stock_list()에서 가격 갱신 */
-            } else {
-                tui_ncurses_toast("Buy failed", 800);
-            }
+            tui_stock_ticket(win, user, &stocks[highlight], 1, &basket);
         } else if (ch == 's' || ch == 'S') {
-            /* 매도: 선택 종목 1주 */
+            /* 매도: 수량 입력 (a = 전량) */
             if (count <= 0) continue;
-            Stock *s = &stocks[highlight];
-
-            if (stock_deal(user->name, s->name, 1, 0)) {
-                tui_ncurses_toast("Sell complete", 800);
-            } else {
-                tui_ncurses_toast("Not enough shares", 800);
-            }
+            tui_stock_ticket(win, user, &stocks[highlight], 0, &basket);
+        } else if (ch == 't' || ch == 'T') {
+            basket.active = !basket.active;
+        } else if (ch == 'e' || ch == 'E') {
+            tui_stock_basket_execute(user, &basket);
+        } else if (ch == 'c' || ch == 'C') {
+            basket.count = 0;
         } else if (ch == 'g' || ch == 'G') {
             /* 🔹 현재 선택된 종목의 그래프 화면으로 진입 */
             if (count > 0) {
-                Stock s = stocks[highlight];       // 복사해서 넘김(log 포함)
-                handle_stock_graph_view(&s);
+                /* 빌린 시세판은 돌려줄 때까지 그대로라 복사 없이 넘긴다 */
+                handle_stock_graph_view(&stocks[highlight]);
                 /* 돌아오면 다시 while 루프 계속 → 리스트 화면 유지 */
             }
         } else if (ch == 'q' || ch == 27) {
@@ -2493,4 +2558,5 @@ static void handle_stocks_view(User *user) {
     }
 
     tui_common_destroy_box(win);
+    stock_quotes_release(q);
 }
\ No newline at end of file
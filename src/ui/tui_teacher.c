@@ -5,16 +5,20 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "../../include/ui/tui_teacher.h"
 #include "../../include/domain/account.h"
 #include "../../include/domain/admin.h"
 #include "../../include/domain/mission.h"
+#include "../../include/domain/qotd.h"
 #include "../../include/domain/shop.h"
+#include "../../include/domain/stock.h"
 #include "../../include/domain/user.h"
 #include "../../include/ui/tui_common.h"
 #include "../../include/ui/tui_ncurses.h"
 #include "../../include/core/csv.h"
+#include "../../include/core/csv_cursor.h"
 
 /* 함수 목적: 학생 계정들을 수집하여 제공된 배열에 저장
  * 매개변수: out[], max_items
@@ -63,7 +67,7 @@ static void draw_teacher_dashboard(User *user, const char *status) {
     tui_common_destroy_box(summary);
 
     Mission missions[10];
-    int mission_count = 0;
+    int mission_count = (int)(sizeof(missions) / sizeof(missions[0]));
     mission_list_open(missions, &mission_count);
     WINDOW *mission_win = tui_common_create_box(LINES - 12, (COLS / 2) - 3, 9, 2, "Mission Management");
     mvwprintw(mission_win, 1, 2, "Ongoing Missions");
@@ -92,7 +96,7 @@ static void draw_teacher_dashboard(User *user, const char *status) {
     wrefresh(shop_win);
     tui_common_destroy_box(shop_win);
 
-    tui_common_draw_help("m:New mission s:Student management n:Message d:Assign QOTD q:Logout");
+    tui_common_draw_help("m:New mission s:Student management n:Message d:Assign QOTD x:Export accounts p:Pay dividends u:Memory q:Logout");
     tui_ncurses_draw_status(status);
     refresh();
 }
@@ -200,25 +204,17 @@ static void handle_qotd_assign(void) {
 
         /* check for duplicate date in existing CSV (pipe-delimited single-line rows) */
         int duplicate = 0;
-        FILE *rf = fopen("data/qotd_questions.csv", "r");
-        if (rf) {
-            char line[2048];
-            while (fgets(line, sizeof(line), rf)) {
-                size_t r = strlen(line);
-                if (r == 0) continue;
-                if (line[r-1] == '\n') line[r-1] = '\0';
+        CsvCursor rc;
+        if (csv_cursor_open(&rc, "data/qotd_questions.csv", ',')) {
+            while (csv_cursor_next_row(&rc)) {
                 /* parse simple: fields separated by ',' */
-                char *pc = line;
-                char *flds[8] = {0};
-                int fi = 0;
-                char *tok = strtok(pc, ",");
-                while (tok && fi < 7) { flds[fi++] = tok; tok = strtok(NULL, ","); }
-                if (fi >= 2 && flds[1] && strcmp(flds[1], date) == 0) {
+                CsvField flds[2];
+                if (csv_cursor_fields(&rc, flds, 2) >= 2 && csv_field_eq(flds[1], date)) {
                     duplicate = 1;
                     break;
                 }
             }
-            fclose(rf);
+            csv_cursor_close(&rc);
         }
 
         if (duplicate) {
@@ -236,14 +232,13 @@ static void handle_qotd_assign(void) {
 
         /* persist as single pipe-delimited row: name|date|question|right_index|opt1|opt2|opt3 */
         csv_ensure_dir("data");
-        FILE *fp = fopen("data/qotd_questions.csv", "a");
-        if (!fp) {
+        if (!csv_append_row("data/qotd_questions.csv", "%s,%s,%s,%d,%s,%s,%s",
+                            name, date, problem, right_idx, ans1, ans2, ans3)) {
             tui_ncurses_toast("Failed to open QOTD file", 900);
             tui_common_destroy_box(win);
             return;
         }
-        fprintf(fp, "%s,%s,%s,%d,%s,%s,%s\n", name, date, problem, right_idx, ans1, ans2, ans3);
-        fclose(fp);
+        qotd_invalidate(); /* 오늘 날짜의 문제를 넣었을 수 있다 */
 
         tui_ncurses_toast("QOTD assigned and saved", 900);
         tui_common_destroy_box(win);
@@ -256,9 +251,15 @@ static void handle_qotd_assign(void) {
  * 반환 값: 없음
  */
 static void handle_student_list(void) {
-    User *students[MAX_STUDENTS];
-    int count = collect_students(students, MAX_STUDENTS);
+    /* 사용자 수에 상한이 없으므로 목록은 사용자 수만큼 할당한다 */
+    size_t total = user_count();
+    /* 미션 완료 수를 보여 주려면 모든 학생의 파일이 필요하다: 작업자 풀에서 한꺼번에 읽는다 */
+    user_hydrate_all();
+    User **students = malloc((total ? total : 1) * sizeof(*students));
+    if (!students) return;
+    int count = collect_students(students, (int)total);
     if (count == 0) {
+        free(students);
         tui_ncurses_toast("No student accounts", 800);
         return;
     }
@@ -324,7 +325,7 @@ static void handle_student_list(void) {
         }
 
         wrefresh(win);
-        int ch = wgetch(win);
+        int ch = tui_ncurses_getch(win);
         if (ch == KEY_UP) {
             if (highlight > 0) {
                 highlight--;
@@ -346,6 +347,7 @@ static void handle_student_list(void) {
             break;
         }
     }
+    free(students);
     tui_common_destroy_box(win);
 }
 
@@ -363,7 +365,7 @@ void tui_teacher_loop(User *user) {
     int running = 1;
     while (running) {
         draw_teacher_dashboard(user, status);
-        int ch = getch();
+        int ch = tui_ncurses_getch(stdscr);
         switch (ch) {
             case 'm':
             case 'M':
@@ -385,12 +387,38 @@ void tui_teacher_loop(User *user) {
                 handle_broadcast();
                 status = "Sent announcement message";
                 break;
+            case 'x':
+            case 'X':
+                status = user_export_accounts_csv(NULL) ? "Exported data/accounts.csv" : "Account export failed";
+                break;
+            case 'p':
+            case 'P': {
+                static char paid_msg[96];
+                StockDividendStats stats;
+                if (stock_pay_dividends(user, (long)time(NULL), &stats)) {
+                    snprintf(paid_msg, sizeof(paid_msg), "Paid %lldCr dividends to %zu holders", stats.paid, stats.holders);
+                    status = paid_msg;
+                } else {
+                    status = "Dividend payout failed";
+                }
+                break;
+            }
+            case 'u':
+            case 'U': {
+                static char mem_msg[128];
+                UserMemoryStats mem;
+                user_memory_stats(&mem);
+                snprintf(mem_msg, sizeof(mem_msg), "User table: %zu users, %zu B (%zu B/user; side tables %zu B)",
+                         mem.users, mem.total_bytes, mem.users ? mem.total_bytes / mem.users : 0, mem.side_bytes);
+                status = mem_msg;
+                break;
+            }
             case 'q':
             case 'Q':
                 running = 0;
                 break;
             default:
-                status = "Available commands: m,s,n,d,q";
+                status = "Available commands: m,s,n,d,x,p,u,q";
                 break;
         }
     }
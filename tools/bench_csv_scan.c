@@ -0,0 +1,176 @@
+/*
+ * 파일 목적: CSV 구분자 스캐너(csv_scan_block) 벤치마크 - AVX2/SSE2/스칼라 구현과
+ *           예전 strchr/strtok 경로를 합성 거래 로그 위에서 비교한다
+ * 작성자: 이현준
+ *
+ * 빌드 (저장소 루트에서, csv.c 는 이 파일이 직접 포함한다):
+ *   gcc -O2 -Iinclude tools/bench_csv_scan.c src/core/csv_cursor.c src/core/io_writer.c src/core/worker_pool.c -o bench_csv_scan -lpthread
+ * 실행:
+ *   ./bench_csv_scan [로그 크기 MB (기본 100)]
+ *
+ * 로그 줄 형식은 "ts,user,reason,amount,balance". 구현마다 세 가지를 잰다.
+ *   scan   : 버퍼 전체에 csv_scan_block 만 돌려 구분자/개행 비트 수를 센다
+ *   lines  : csv_scan_count_newlines 로 줄 수를 센다
+ *   parse  : csv_cursor 로 줄과 필드를 나누고 amount 열을 더한다
+ * 기준선은 strchr 로 줄을 나누고 strtok 으로 필드를 나누는 예전 방식이다.
+ */
+#include "../src/core/csv.c"
+
+#include <time.h>
+
+#include "core/csv_cursor.h"
+
+/* 함수 목적: 단조 시계를 초로 읽는다.
+ * 매개변수: 없음
+ * 반환 값: 초
+ */
+static double now_sec(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* 함수 목적: size 바이트 남짓의 합성 거래 로그를 만든다.
+ * 매개변수: size, out_len
+ * 반환 값: NUL 로 끝나는 버퍼 (호출자가 해제), 실패하면 NULL
+ */
+static char *make_log(size_t size, size_t *out_len) {
+    static const char *reasons[] = {"INTEREST_DEPOSIT", "STOCK_SELL", "SHOP_BUY", "ADMIN_GRANT", "DIVIDEND", "ORDER_HOLD"};
+    char *buf = malloc(size + 128);
+    if (!buf) return NULL;
+    size_t len = 0;
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    long ts = 1760000000;
+    while (len < size) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        ts += (long)(rng % 90);
+        int n = snprintf(buf + len, 128, "%ld,student%04u,%s,%+d,%u\n", ts, (unsigned)(rng >> 20) % 5000,
+                         reasons[(rng >> 8) % 6], (int)(rng >> 40) % 2000 - 1000, (unsigned)(rng >> 32) % 100000);
+        len += (size_t)n;
+    }
+    buf[len] = '\0';
+    *out_len = len;
+    return buf;
+}
+
+/* 함수 목적: 예전 방식으로 로그를 읽는다. strchr 로 줄을 자르고 strtok 으로 필드를 나눈다.
+ * 매개변수: log (복사본, 고쳐 쓴다), rows
+ * 반환 값: amount 열의 합
+ */
+static long long parse_strtok(char *log, long *rows) {
+    long long sum = 0;
+    long n = 0;
+    char *line = log;
+    while (*line) {
+        char *nl = strchr(line, '\n');
+        if (nl) *nl = '\0';
+        int col = 0;
+        for (char *tok = strtok(line, ","); tok; tok = strtok(NULL, ","), ++col) {
+            if (col == 3) sum += atoi(tok);
+        }
+        n++;
+        if (!nl) break;
+        line = nl + 1;
+    }
+    *rows = n;
+    return sum;
+}
+
+/* 함수 목적: csv_cursor 로 로그를 읽는다.
+ * 매개변수: log, len, rows
+ * 반환 값: amount 열의 합
+ */
+static long long parse_cursor(const char *log, size_t len, long *rows) {
+    CsvCursor cur;
+    CsvField fields[5];
+    long long sum = 0;
+    long n = 0;
+    csv_cursor_init(&cur, log, len, ',');
+    while (csv_cursor_next_row(&cur)) {
+        int amount = 0;
+        if (csv_cursor_fields(&cur, fields, 5) >= 4 && csv_field_int(fields[3], &amount)) sum += amount;
+        n++;
+    }
+    csv_cursor_close(&cur);
+    *rows = n;
+    return sum;
+}
+
+/* 함수 목적: 버퍼 전체를 64바이트씩 스캔해 구분자/개행 비트 수를 센다.
+ * 매개변수: log, len, out_nl
+ * 반환 값: 구분자 수
+ */
+static size_t scan_all(const char *log, size_t len, size_t *out_nl) {
+    size_t delims = 0, nls = 0;
+    for (size_t off = 0; off < len; off += CSV_SCAN_BLOCK) {
+        size_t chunk = len - off < CSV_SCAN_BLOCK ? len - off : CSV_SCAN_BLOCK;
+        uint64_t d, n;
+        csv_scan_block(log + off, chunk, ',', &d, &n);
+        delims += (size_t)__builtin_popcountll(d);
+        nls += (size_t)__builtin_popcountll(n);
+    }
+    *out_nl = nls;
+    return delims;
+}
+
+/* 함수 목적: 지금 고른 스캐너 구현으로 세 가지를 재고 한 줄로 찍는다.
+ * 매개변수: name, log, len, mb, expect_sum, expect_rows
+ * 반환 값: 결과가 기준선과 같으면 1
+ */
+static int run_impl(const char *name, const char *log, size_t len, double mb, long long expect_sum, long expect_rows) {
+    size_t nl = 0;
+    double t0 = now_sec();
+    size_t delims = scan_all(log, len, &nl);
+    double t1 = now_sec();
+    size_t lines = csv_scan_count_newlines(log, len);
+    double t2 = now_sec();
+    long rows = 0;
+    long long sum = parse_cursor(log, len, &rows);
+    double t3 = now_sec();
+    printf("%-8s scan %6.3f s (%6.0f MB/s)  lines %6.3f s  parse %6.3f s  [%zu delims, %zu lines]\n",
+           name, t1 - t0, mb / (t1 - t0), t2 - t1, t3 - t2, delims, lines);
+    return sum == expect_sum && rows == expect_rows && (long)lines == expect_rows && nl == lines;
+}
+
+int main(int argc, char **argv) {
+    long mb_arg = argc > 1 ? atol(argv[1]) : 100;
+    if (mb_arg <= 0) {
+        fprintf(stderr, "usage: %s [megabytes]\n", argv[0]);
+        return 1;
+    }
+    size_t len = 0;
+    char *log = make_log((size_t)mb_arg * 1024 * 1024, &len);
+    char *copy = log ? malloc(len + 1) : NULL;
+    if (!log || !copy) return 1;
+    memcpy(copy, log, len + 1);
+    double mb = (double)len / (1024 * 1024);
+    printf("synthetic transaction log: %.1f MB\n", mb);
+
+    long rows = 0;
+    double t0 = now_sec();
+    long long sum = parse_strtok(copy, &rows);
+    double t1 = now_sec();
+    printf("%-8s parse %6.3f s  [%ld rows]\n", "strtok", t1 - t0, rows);
+
+    int ok = 1;
+    g_scan_block = scan_block_scalar;
+    ok &= run_impl("scalar", log, len, mb, sum, rows);
+#if defined(CSV_SCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        g_scan_block = scan_block_sse2;
+        ok &= run_impl("sse2", log, len, mb, sum, rows);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        g_scan_block = scan_block_avx2;
+        ok &= run_impl("avx2", log, len, mb, sum, rows);
+    }
+#endif
+    if (!ok) printf("MISMATCH: a scanner disagreed with the strtok baseline\n");
+
+    free(copy);
+    free(log);
+    return ok ? 0 : 1;
+}
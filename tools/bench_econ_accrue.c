@@ -0,0 +1,121 @@
+/*
+ * 파일 목적: econ_accrue_all 의 계좌당 이자 정산 비용 벤치마크
+ * 작성자: 이현준
+ *
+ * 빌드 (저장소 루트에서):
+ *   gcc -O2 -Iinclude tools/bench_econ_accrue.c src/core/[a-z]*.c src/domain/[a-z]*.c -o bench_econ_accrue -lpthread -lm
+ * 실행 (빈 작업 디렉터리에서, data/ 를 새로 만든다):
+ *   rm -rf data; ./bench_econ_accrue batch  [계좌 수 (기본 10000)]
+ *   rm -rf data; ./bench_econ_accrue legacy [계좌 수]
+ *
+ * 모든 계좌에 5시간치 이자가 밀려 있는 상태를 만들고 쓰기 스레드를 켠 채로 잰다.
+ * batch 는 econ_accrue_all 한 번(곧이어 밀린 것이 없는 빈 정산 한 번도 잰다),
+ * legacy 는 예전 로그인 경로(계좌마다 pow 두 번, 장부 두 줄, 계좌 슬롯 쓰기)를 흉내 낸다.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/csv.h"
+#include "domain/account.h"
+#include "domain/economy.h"
+#include "domain/user.h"
+
+#define DUE_HOURS 5
+
+/* 함수 목적: 단조 시계를 밀리초로 읽는다.
+ * 매개변수: 없음
+ * 반환 값: 밀리초
+ */
+static double now_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+/* 함수 목적: 학생 n 명과 그 계좌(마지막 이자 시각 last_ts)를 data/ 에 만든다.
+ * 매개변수: n, last_ts
+ * 반환 값: 성공 여부
+ */
+static int write_accounts(int n, long last_ts) {
+    if (!csv_ensure_dir("data")) return 0;
+    FILE *users = fopen("data/users.csv", "w");
+    FILE *accounts = fopen("data/accounts.csv", "w");
+    if (!users || !accounts) {
+        if (users) fclose(users);
+        if (accounts) fclose(accounts);
+        return 0;
+    }
+    fprintf(users, "# Username,Password,is_admin\n");
+    fprintf(accounts, "# Username,Balance,Cash,Loan,Last_Login_Timestamp\n");
+    for (int i = 0; i < n; ++i) {
+        fprintf(users, "u%d,pw,0\n", i);
+        fprintf(accounts, "u%d,%d,0,%d,%ld\n", i, 1000 + i, 500, last_ts);
+    }
+    int ok = fclose(users) == 0;
+    return fclose(accounts) == 0 && ok;
+}
+
+/* 함수 목적: 예전 로그인 때의 이자 정산을 한 계좌에 그대로 적용한다. (비교용)
+ * 매개변수: user, hours
+ * 반환 값: 없음
+ */
+static void legacy_accrue(User *user, int hours) {
+    double balance = floor(user->bank.balance * pow(1.001, hours) + 1e-7);
+    double loan = floor(user->bank.loan * pow(1.0015, hours) + 1e-7);
+    int deposit_delta = (int)balance - user->bank.balance;
+    int loan_delta = (int)loan - user->bank.loan;
+    if (deposit_delta) {
+        account_adjust(&user->bank, deposit_delta);
+        account_post(user, LEDGER_INTEREST, deposit_delta, "INTEREST_DEPOSIT");
+    }
+    if (loan_delta) {
+        char reason[64];
+        user->bank.loan += loan_delta;
+        snprintf(reason, sizeof(reason), "INTEREST_LOAN_%dh", hours);
+        account_post(user, LEDGER_LOAN_INTEREST, loan_delta, reason);
+    }
+    user->bank.last_interest_ts = time(NULL);
+    user_update_balance(user->name, user->bank.balance);
+}
+
+int main(int argc, char **argv) {
+    int legacy = argc > 1 && strcmp(argv[1], "legacy") == 0;
+    int n = argc > 2 ? atoi(argv[2]) : 10000;
+    long now = (long)time(NULL);
+    if (argc < 2 || n <= 0 || !write_accounts(n, now - DUE_HOURS * 3600 - 100)) {
+        fprintf(stderr, "usage: %s batch|legacy [accounts]  (run in an empty directory)\n", argv[0]);
+        return 1;
+    }
+
+    csv_async_start();
+    size_t users = user_count(); /* 불러오기는 재는 구간에서 뺀다 */
+
+    double t0 = now_ms();
+    if (legacy) {
+        for (size_t i = 0; i < users; ++i) {
+            User *u = user_at_mut(i);
+            if (u->name[0] == '#') continue; /* users.csv 헤더 줄 */
+            legacy_accrue(u, (int)((now - u->bank.last_interest_ts) / 3600));
+        }
+    } else {
+        EconAccrualStats stats;
+        econ_accrue_all(now, &stats);
+        printf("accounts %zu, postings %zu, deposit interest %lld, loan interest %lld\n",
+               stats.accounts, stats.postings, stats.deposit_interest, stats.loan_interest);
+    }
+    double t1 = now_ms();
+    if (!legacy) {
+        econ_accrue_all(now, NULL);
+        printf("idle pass (nothing due): %.3f ms\n", now_ms() - t1);
+    }
+    csv_shutdown();
+    double t2 = now_ms();
+
+    printf("%s, %d accounts: apply %.1f ms (%.2f us/account), with writer drain %.1f ms (%.2f us/account)\n",
+           legacy ? "legacy login path" : "econ_accrue_all", n,
+           t1 - t0, (t1 - t0) * 1e3 / n, t2 - t0, (t2 - t0) * 1e3 / n);
+    return 0;
+}
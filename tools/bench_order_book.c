@@ -0,0 +1,123 @@
+/*
+ * 파일 목적: core/order_book 의 체결 처리량과 지연 시간 벤치마크
+ * 작성자: 이현준
+ *
+ * 빌드 (저장소 루트에서):
+ *   gcc -O2 -Iinclude tools/bench_order_book.c src/core/order_book.c -o bench_order_book
+ * 실행:
+ *   ./bench_order_book [연산 수 (기본 2000000)] [종목 수 (기본 16)]
+ *
+ * 종목마다 기준가 1000 근처에 매수/매도 지정가 주문을 섞어 내고, 열 번 중 한 번은
+ * 살아 있는 주문을 취소한다. 가격대가 겹치게 잡아 주문 상당수가 바로 체결된다.
+ * 연산마다 시간을 재서 전체와 "체결이 난 주문"의 p50/p99/p99.9 지연을 따로 보고한다.
+ * match_and_rest / level_for 를 고친 뒤 같은 인자로 다시 돌려 비교한다.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "core/order_book.h"
+
+static long g_fills = 0;
+
+/* 함수 목적: 주문 보고를 받아 체결 보고 수를 센다.
+ * 매개변수: r, ctx (사용하지 않음)
+ * 반환 값: 없음
+ */
+static void count_report(const ObReport *r, void *ctx) {
+    (void)ctx;
+    if (r->type == OB_EXEC_FILL) g_fills++;
+}
+
+/* 함수 목적: 재현 가능한 난수 (xorshift64)
+ * 매개변수: s (상태)
+ * 반환 값: 난수
+ */
+static uint64_t next_rand(uint64_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+/* 함수 목적: 단조 시계를 나노초로 읽는다.
+ * 매개변수: 없음
+ * 반환 값: 나노초
+ */
+static long long now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 함수 목적: 정렬된 지연 시간 배열의 백분위 값을 구한다.
+ * 매개변수: v, n, permille (1000 분율)
+ * 반환 값: 지연 시간 (ns), 비어 있으면 0
+ */
+static long long percentile(const long long *v, long n, int permille) {
+    if (n <= 0) return 0;
+    long i = (long)((long long)n * permille / 1000);
+    return v[i < n ? i : n - 1];
+}
+
+int main(int argc, char **argv) {
+    long ops = argc > 1 ? atol(argv[1]) : 2000000;
+    int books = argc > 2 ? atoi(argv[2]) : 16;
+    if (ops <= 0 || books <= 0 || !ob_init(books, count_report, NULL)) {
+        fprintf(stderr, "usage: %s [ops] [books]\n", argv[0]);
+        return 1;
+    }
+
+    long long *lat = malloc(sizeof(long long) * (size_t)ops);
+    long long *match_lat = malloc(sizeof(long long) * (size_t)ops);
+    uint64_t *live = malloc(sizeof(uint64_t) * (size_t)ops);
+    if (!lat || !match_lat || !live) return 1;
+
+    uint64_t rng = 0x2545f4914f6cdd1dULL;
+    long nlive = 0, matched = 0, submits = 0;
+    long long start = now_ns();
+    for (long i = 0; i < ops; ++i) {
+        int book = (int)(next_rand(&rng) % (uint64_t)books);
+        long long t0 = now_ns();
+        if (next_rand(&rng) % 10 == 0 && nlive > 0) {
+            long k = (long)(next_rand(&rng) % (uint64_t)nlive);
+            ob_cancel(live[k]); /* 이미 다 체결된 주문이면 그냥 실패한다 */
+            live[k] = live[--nlive];
+            lat[i] = now_ns() - t0;
+            continue;
+        }
+        ObSide side = (next_rand(&rng) & 1) ? OB_SELL : OB_BUY;
+        int spread = (int)(next_rand(&rng) % 20) - 5;
+        int price = 1000 + (side == OB_BUY ? -spread : spread);
+        int qty = 1 + (int)(next_rand(&rng) % 10);
+        long before = g_fills;
+        uint64_t id = ob_submit(book, (uint32_t)(next_rand(&rng) % 1000), side, price, qty);
+        long long dt = now_ns() - t0;
+        lat[i] = dt;
+        submits++;
+        if (g_fills > before) match_lat[matched++] = dt;
+        if (id) live[nlive++] = id;
+    }
+    double secs = (double)(now_ns() - start) / 1e9;
+
+    qsort(lat, (size_t)ops, sizeof(long long), cmp_ll);
+    qsort(match_lat, (size_t)matched, sizeof(long long), cmp_ll);
+    printf("ops %ld (%ld submits, %d books) in %.3f s: %.0f ops/s\n", ops, submits, books, secs, ops / secs);
+    printf("matched orders %ld: %.0f/s, trades %ld\n", matched, matched / secs, g_fills / 2);
+    printf("latency all ops    p50 %lld ns  p99 %lld ns  p99.9 %lld ns\n",
+           percentile(lat, ops, 500), percentile(lat, ops, 990), percentile(lat, ops, 999));
+    printf("latency matching   p50 %lld ns  p99 %lld ns  p99.9 %lld ns\n",
+           percentile(match_lat, matched, 500), percentile(match_lat, matched, 990), percentile(match_lat, matched, 999));
+
+    free(lat);
+    free(match_lat);
+    free(live);
+    ob_free();
+    return 0;
+}
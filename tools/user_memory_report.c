@@ -0,0 +1,74 @@
+/*
+ * 파일 목적: 사용자 수에 따른 사용자 표 메모리(사용자당 바이트)를 재는 보고 도구
+ * 작성자: 이현준
+ *
+ * 빌드 (저장소 루트에서):
+ *   gcc -O2 -Iinclude tools/user_memory_report.c src/core/[a-z]*.c src/domain/[a-z]*.c -o user_memory_report -lpthread -lm
+ * 실행 (빈 작업 디렉터리에서, data/users.csv 를 새로 만든다):
+ *   for n in 50 1000 10000; do rm -rf data; ./user_memory_report $n; done
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "domain/mission.h"
+#include "domain/user.h"
+#include "core/csv.h"
+
+/* 나누기 전 User 한 개의 크기 (Bank.name[50], Bank.log[128], Item/Mission 배열 포함) */
+#define LEGACY_USER_BYTES 9648
+#define LEGACY_USER_CHUNK 64
+
+/* 함수 목적: 학생 n 명짜리 data/users.csv 를 만든다.
+ * 매개변수: n
+ * 반환 값: 성공 여부
+ */
+static int write_users(long n) {
+    if (!csv_ensure_dir("data")) return 0;
+    FILE *fp = fopen("data/users.csv", "w");
+    if (!fp) return 0;
+    fprintf(fp, "# Username,Password,is_admin\n");
+    for (long i = 0; i < n; ++i) fprintf(fp, "student%05ld,pw%ld,0\n", i, i);
+    return fclose(fp) == 0;
+}
+
+/* 함수 목적: 한 줄 보고를 찍는다.
+ * 매개변수: label, s
+ * 반환 값: 없음
+ */
+static void print_stats(const char *label, const UserMemoryStats *s) {
+    printf("  %-16s %10zu B  %7.0f B/user  (table %zu, index %zu, strings %zu, side %zu)\n",
+           label, s->total_bytes, (double)s->total_bytes / (double)s->users,
+           s->table_bytes, s->index_bytes, s->string_bytes, s->side_bytes);
+}
+
+int main(int argc, char **argv) {
+    long n = argc > 1 ? atol(argv[1]) : 1000;
+    if (n <= 0 || !write_users(n)) {
+        fprintf(stderr, "usage: %s <students>  (run in an empty directory)\n", argv[0]);
+        return 1;
+    }
+
+    size_t users = user_count(); /* users.csv 헤더 줄도 사용자 하나로 잡힌다 */
+    UserMemoryStats hot;
+    user_memory_stats(&hot);
+
+    /* 모든 사용자에게 인벤토리, 보유 주식, 미션 완료 비트를 잡아 최악의 경우를 잰다 */
+    int slots = mission_catalog_count();
+    for (size_t i = 0; i < users; ++i) {
+        User *u = user_at_mut(i);
+        user_items(u);
+        user_holdings(u);
+        user_mission_mark(u, slots > 0 ? slots - 1 : 0);
+    }
+    UserMemoryStats full;
+    user_memory_stats(&full);
+
+    size_t chunks = (users + LEGACY_USER_CHUNK - 1) / LEGACY_USER_CHUNK;
+    size_t legacy = chunks * LEGACY_USER_CHUNK * LEGACY_USER_BYTES + hot.index_bytes;
+    printf("%zu users\n", users);
+    printf("  %-16s %10zu B  %7.0f B/user  (%d-byte records in %d-user chunks, same index)\n",
+           "before (model)", legacy, (double)legacy / (double)users, LEGACY_USER_BYTES, LEGACY_USER_CHUNK);
+    print_stats("after, hot only", &hot);
+    print_stats("after, all side", &full);
+    return 0;
+}